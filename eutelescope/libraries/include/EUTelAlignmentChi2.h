@@ -0,0 +1,101 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELALIGNMENTCHI2_H
+#define EUTELALIGNMENTCHI2_H 1
+
+// eutelescope includes ".h"
+#include "EUTelParallel.h"
+
+// system includes <>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Chi2 objective for the two plane alignment of EUTelAlign
+  /*! The hit pairs (measured position on the aligned plane and the
+   *  position predicted there) are kept as structure of arrays, so the
+   *  objective streams through four contiguous columns. The instance
+   *  owns its data, hence several alignments can be minimised at the
+   *  same time; it is meant to be wrapped in a ROOT::Math::Functor.
+   *
+   *  The parameters are
+   *  par[0]: off_x, par[1]: off_y, par[2]: theta_x, par[3]: theta_y,
+   *  par[4]: theta_z, par[5]: chi2 cut (0 disables the cut).
+   *
+   *  The reduction is done in blocks of fixed size which are summed in
+   *  order, so the result does not depend on the number of threads.
+   *  The threads are kept between calls and only used when there are
+   *  enough hit pairs to be worth waking them. Evaluating the
+   *  objective does not allocate memory once the number of hit pairs
+   *  has stopped changing, it must not be called by several threads
+   *  at the same time.
+   */
+  class EUTelAlignmentChi2 {
+
+  public:
+    //! Number of parameters of the objective
+    static const unsigned int nParameters = 6;
+
+    //! Constructor
+    /*! @param nThreads number of threads for the reduction, 0 means
+     *  one per hardware thread
+     */
+    explicit EUTelAlignmentChi2(int nThreads = 1);
+
+    EUTelAlignmentChi2(EUTelAlignmentChi2 const &) = delete;
+    EUTelAlignmentChi2 &operator=(EUTelAlignmentChi2 const &) = delete;
+
+    //! Change the number of threads for the reduction
+    void setNThreads(int nThreads);
+
+    //! Add one hit pair
+    void addHitPair(double measuredX, double measuredY, double predictedX,
+                    double predictedY);
+
+    //! Reserve space for n hit pairs
+    void reserve(std::size_t n);
+
+    //! Remove all hit pairs
+    void clear();
+
+    //! Number of stored hit pairs
+    std::size_t size() const { return _measuredX.size(); }
+
+    //! Evaluate the objective
+    double operator()(double const *par) const;
+
+    //! Evaluate the objective for an explicit parameter vector
+    double evaluate(double offX, double offY, double thetaX, double thetaY,
+                    double thetaZ, double chi2Cut) const;
+
+    //! Column accessors, e.g. for filling residual histograms
+    std::vector<double> const &measuredX() const { return _measuredX; }
+    std::vector<double> const &measuredY() const { return _measuredY; }
+    std::vector<double> const &predictedX() const { return _predictedX; }
+    std::vector<double> const &predictedY() const { return _predictedY; }
+
+  private:
+    //! Partial sum over the hit pairs [begin, end)
+    double partialSum(std::size_t begin, std::size_t end, double const *rot,
+                      double offX, double offY, double chi2Cut) const;
+
+    std::vector<double> _measuredX;
+    std::vector<double> _measuredY;
+    std::vector<double> _predictedX;
+    std::vector<double> _predictedY;
+
+    std::unique_ptr<Utility::WorkerPool> _pool;
+
+    //! Result of every block, kept to avoid an allocation per call
+    mutable std::vector<double> _blockSums;
+  };
+}
+#endif
@@ -0,0 +1,73 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELALIGNMENTTRANSFORMS_H
+#define EUTELALIGNMENTTRANSFORMS_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Alignment corrections of the sensors as affine transformations
+  /*! The correction of EUTelProcessorApplyAlign moves a hit at p on a
+   *  sensor with plane center c to
+   *
+   *    R (p - c) + c - offset,  R = Rz(-gamma) Ry(-beta) Rx(-alpha)
+   *
+   *  i.e. the rotations are applied around the plane center in the
+   *  order X, Y, Z as with TVector3::RotateX/Y/Z, then the offsets
+   *  are subtracted. This is kept as one 3 x 4 matrix [R | t] per
+   *  sensor, together with its inverse [R^T | -R^T t] which undoes
+   *  the correction.
+   *
+   *  The transformations are stored in a vector indexed by the sensor
+   *  ID, so that the lookup for a hit is a plain index.
+   */
+  class EUTelAlignmentTransforms {
+
+  public:
+    EUTelAlignmentTransforms();
+
+    //! Forget all sensors
+    void clear();
+
+    //! Set the alignment correction of a sensor
+    /*! Negative sensor IDs are ignored.
+     *  @param center the plane center the rotations are done around
+     */
+    void set(int sensorID, const double center[3], double xOffset,
+             double yOffset, double zOffset, double alpha, double beta,
+             double gamma);
+
+    //! Whether a sensor has an alignment correction
+    bool has(int sensorID) const;
+
+    //! Correct n positions of a sensor
+    /*! The positions are x, y, z triplets, output may be the same
+     *  array as input. Sensors without correction are copied.
+     *  @param inverse undo the correction instead
+     */
+    void apply(int sensorID, const double *input, double *output,
+               std::size_t n, bool inverse = false) const;
+
+    //! The 3 x 4 matrix of a sensor, row by row
+    const double *getMatrix(int sensorID, bool inverse = false) const;
+
+  private:
+    struct Transform {
+      bool valid;
+      double forward[12];
+      double inverse[12];
+    };
+
+    std::vector<Transform> _transforms;
+  };
+}
+#endif
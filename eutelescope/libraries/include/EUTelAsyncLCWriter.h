@@ -0,0 +1,121 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELASYNCLCWRITER_H
+#define EUTELASYNCLCWRITER_H 1
+
+// eutelescope includes ".h"
+#include "EUTelBoundedQueue.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCRunHeader.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IO/LCWriter.h>
+
+// system includes <>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace eutelescope {
+
+  //! Writes LCIO run headers and events in a separate thread
+  /*! Compressing and writing an event can take as long as its whole
+   *  reconstruction. This class hands the records to a writer thread
+   *  through a bounded queue, so that the event loop only waits when
+   *  the thread is more than the queue size behind.
+   *
+   *  The records are written in the order they are queued. The queue
+   *  owns them, so an event coming from Marlin has to be moved into
+   *  an event of its own with takeEvent() first: the reader deletes
+   *  its events as soon as all processors are done with them.
+   *
+   *  The LCWriter is not owned and must not be used by anyone else
+   *  until finish() has returned. Before LCIO v02-13 SIO keeps global
+   *  stream and block managers, the writer thread must then be the
+   *  only thread using SIO at all, see hasReentrantSIO(). Exceptions thrown while writing are
+   *  rethrown in the calling thread by the next call, at the latest
+   *  by finish().
+   */
+  class EUTelAsyncLCWriter {
+
+  public:
+    //! Start the writer thread
+    /*! @param writer an open writer
+     *  @param capacity maximum number of queued records
+     */
+    EUTelAsyncLCWriter(IO::LCWriter *writer, std::size_t capacity);
+
+    //! Write what is queued and stop the thread, errors are dropped
+    ~EUTelAsyncLCWriter();
+
+    EUTelAsyncLCWriter(EUTelAsyncLCWriter const &) = delete;
+    EUTelAsyncLCWriter &operator=(EUTelAsyncLCWriter const &) = delete;
+
+    //! Queue a copy of a run header
+    void writeRunHeader(EVENT::LCRunHeader const *header);
+
+    //! Queue an event, the writer takes ownership
+    void writeEvent(std::unique_ptr<IMPL::LCEventImpl> event);
+
+    //! Write all queued records and stop the thread
+    /*! The LCWriter can be used (and closed) again afterwards. Nothing
+     *  can be queued any more.
+     */
+    void finish();
+
+    //! Move an event into a new one owning its collections
+    /*! The header, the int, float and string parameters and all
+     *  collections which are not transient are taken from @a event,
+     *  which keeps them listed but does not own them any more. They
+     *  are written with the new event, @a event must not be written
+     *  itself afterwards.
+     *  Transient collections are not written anyway and stay where
+     *  they are.
+     */
+    static std::unique_ptr<IMPL::LCEventImpl> takeEvent(EVENT::LCEvent *event);
+
+    //! Whether SIO may be used by several threads at the same time
+    /*! True from LCIO v02-13 on. Otherwise nobody, e.g. a reader in the
+     *  event loop, may use SIO while the writer thread is running.
+     */
+    static bool hasReentrantSIO();
+
+    //! Copy of a run header with its int, float and string parameters
+    static std::unique_ptr<IMPL::LCRunHeaderImpl> copyRunHeader(EVENT::LCRunHeader const *header);
+
+  private:
+    //! Either a run header or an event
+    struct Record {
+      Record() : runHeader(), event() {}
+      std::unique_ptr<IMPL::LCRunHeaderImpl> runHeader;
+      std::unique_ptr<IMPL::LCEventImpl> event;
+    };
+
+    //! Main loop of the writer thread
+    void run();
+
+    //! Queue a record, rethrowing earlier errors of the writer
+    void push(Record record);
+
+    //! Rethrow a stored error of the writer thread
+    void rethrow();
+
+    IO::LCWriter *_writer;
+    EUTelBoundedQueue<Record> _queue;
+    std::mutex _errorMutex;
+    std::exception_ptr _error;
+    bool _errorReported;
+    std::thread _thread;
+  };
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBOUNDEDQUEUE_H
+#define EUTELBOUNDEDQUEUE_H 1
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace eutelescope {
+
+  //! First in, first out queue between threads with a maximum size
+  /*! push() blocks while the queue is full and pop() while it is
+   *  empty, so that a fast producer can not get arbitrarily far ahead
+   *  of its consumer. After close() no more items are accepted, pop()
+   *  still returns the remaining ones and then fails instead of
+   *  waiting.
+   */
+  template <class T> class EUTelBoundedQueue {
+
+  public:
+    //! Constructor
+    /*! @param capacity maximum number of queued items, at least 1
+     */
+    explicit EUTelBoundedQueue(std::size_t capacity)
+        : _mutex(), _notFull(), _notEmpty(), _items(), _capacity(capacity > 0 ? capacity : 1),
+          _closed(false) {}
+
+    //! Append an item, waiting for space
+    /*! @return false if the queue has been closed, the item is then
+     *  dropped
+     */
+    bool push(T item) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notFull.wait(lock, [this] { return _closed || _items.size() < _capacity; });
+      if(_closed) return false;
+      _items.push_back(std::move(item));
+      _notEmpty.notify_one();
+      return true;
+    }
+
+    //! Take the oldest item, waiting for one
+    /*! @return false if the queue is closed and empty
+     */
+    bool pop(T &item) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notEmpty.wait(lock, [this] { return _closed || !_items.empty(); });
+      if(_items.empty()) return false;
+      item = std::move(_items.front());
+      _items.pop_front();
+      _notFull.notify_one();
+      return true;
+    }
+
+    //! Stop accepting items and wake up all waiting threads
+    void close() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+      _notFull.notify_all();
+      _notEmpty.notify_all();
+    }
+
+    //! Number of queued items
+    std::size_t size() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _items.size();
+    }
+
+    //! Maximum number of queued items
+    std::size_t capacity() const { return _capacity; }
+
+  private:
+    mutable std::mutex _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+    std::deque<T> _items;
+    std::size_t const _capacity;
+    bool _closed;
+  };
+}
+#endif
@@ -0,0 +1,94 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCLUSTERSHAPE_H
+#define EUTELCLUSTERSHAPE_H 1
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Bounding box and occupancy of the pixels of one cluster
+  /*! The pixels are added while the cluster is decoded, the bounding
+   *  box is updated pixel by pixel. build() then fills an occupancy
+   *  bitmask of the bounding box grown by one pixel on every side and
+   *  finds out whether the cluster has an empty middle: fired pixels
+   *  around one or more pixels which did not fire. The not fired
+   *  pixels are flood filled from a corner of the grown box, with
+   *  pixels sharing an edge as neighbours, an empty middle is left
+   *  wherever the fill does not reach.
+   *
+   *  The buffers are kept between clusters, so that an instance can be
+   *  reused cluster after cluster.
+   */
+  class EUTelClusterShape {
+
+  public:
+    EUTelClusterShape();
+
+    //! Start a new cluster
+    void clear();
+
+    //! Add a pixel, a pixel added twice counts once in the bitmask
+    void addPixel(int x, int y);
+
+    //! Fill the bitmask and look for an empty middle
+    void build();
+
+    std::size_t getNPixels() const { return _nPixels; }
+    int getXMin() const { return _xMin; }
+    int getXMax() const { return _xMax; }
+    int getYMin() const { return _yMin; }
+    int getYMax() const { return _yMax; }
+
+    //! Width of the bounding box in x, 0 without pixels
+    int getWidthX() const { return _nPixels == 0 ? 0 : _xMax - _xMin + 1; }
+
+    //! Width of the bounding box in y, 0 without pixels
+    int getWidthY() const { return _nPixels == 0 ? 0 : _yMax - _yMin + 1; }
+
+    //! Whether a pixel fired, after build()
+    bool isFired(int x, int y) const;
+
+    //! Whether not fired pixels are enclosed by the cluster, after build()
+    bool hasEmptyMiddle() const { return _emptyMiddle; }
+
+  private:
+    //! Bit of a pixel in the grown bounding box
+    std::size_t bit(int x, int y) const {
+      return static_cast<std::size_t>(y - _yMin + 1) * _stride +
+             static_cast<std::size_t>(x - _xMin + 1);
+    }
+
+    static bool test(const std::vector<std::uint64_t> &mask,
+                     std::size_t bit) {
+      return (mask[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    static void set(std::vector<std::uint64_t> &mask, std::size_t bit) {
+      mask[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+    }
+
+    std::size_t _nPixels;
+    int _xMin;
+    int _xMax;
+    int _yMin;
+    int _yMax;
+    //! Width of the grown bounding box
+    std::size_t _stride;
+    bool _emptyMiddle;
+    std::vector<int> _pixels;
+    std::vector<std::uint64_t> _fired;
+    std::vector<std::uint64_t> _reached;
+    std::vector<std::size_t> _stack;
+  };
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELDUTHITMATCHER_H
+#define EUTELDUTHITMATCHER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Matching of fitted track positions to measured DUT hits
+  /*! Every track has one or more fitted positions at the DUT. A track
+   *  is matched to at most one measured hit, the closest one to any of
+   *  its fitted positions, if it is closer than distMax. A hit is
+   *  matched to at most one track.
+   *
+   *  The hits are sorted into a grid of cells of size distMax, so that
+   *  only the hits in the 3 x 3 cells around a fitted position are
+   *  compared to it. Two ways to resolve tracks competing for a hit
+   *  are available:
+   *   - global: all pairs closer than distMax are taken by increasing
+   *     distance, a pair is accepted if neither its track nor its hit
+   *     is matched yet;
+   *   - greedy: the tracks are taken in order, each one gets its
+   *     closest hit not matched to a previous track. This is the
+   *     matching EUTelDUTHistograms always did.
+   *  Equal distances are resolved by the lower track, fit and hit
+   *  index. Non finite positions are never matched.
+   *
+   *  The buffers are kept between calls, so that an instance can be
+   *  reused event after event.
+   */
+  class EUTelDUTHitMatcher {
+
+  public:
+    //! Match of a track, hit is -1 for unmatched tracks
+    struct Match {
+      int fit;
+      int hit;
+      double distance2;
+    };
+
+    EUTelDUTHitMatcher();
+
+    //! Start a new event with the maximum matching distance
+    void reset(double distMax);
+
+    //! Add the next measured hit, hits are numbered in order
+    void addHit(double x, double y);
+
+    //! Add the fitted position number fit of a track
+    void addFit(int track, int fit, double x, double y);
+
+    //! Match the tracks 0 ... nTracks - 1
+    void match(int nTracks, bool greedy);
+
+    //! Match of a track after match()
+    const Match &getMatch(int track) const { return _matches[track]; }
+
+    //! Whether a hit was matched to a track
+    bool isHitMatched(int hit) const { return _hitMatched[hit] != 0; }
+
+    //! Number of matched tracks
+    std::size_t getNMatches() const { return _nMatches; }
+
+    //! Number of track hit pairs closer than distMax
+    std::size_t getNCandidates() const { return _candidates.size(); }
+
+  private:
+    typedef std::pair<long long, long long> Cell;
+
+    struct Point {
+      int track;
+      int fit;
+      double x;
+      double y;
+    };
+
+    struct Candidate {
+      double distance2;
+      int track;
+      int fit;
+      int hit;
+    };
+
+    //! Cell of a position, false if it has none
+    bool cell(double x, double y, Cell &result) const;
+
+    double _distMax;
+    std::vector<Point> _hits;
+    std::vector<Point> _fits;
+    //! Hits sorted by grid cell
+    std::vector<std::pair<Cell, int>> _grid;
+    std::vector<Candidate> _candidates;
+    std::vector<Match> _matches;
+    std::vector<char> _hitMatched;
+    std::size_t _nMatches;
+  };
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELDIGITALFIXEDFRAMEFINDER_H
+#define EUTELDIGITALFIXEDFRAMEFINDER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Digital fixed frame cluster finding on a dense pixel map
+  /*! This is the cluster search of the digital fixed frame clustering
+   *  in EUTelClusteringProcessor, with the fired pixels of one sensor
+   *  kept in an array covering the whole matrix instead of a map.
+   *
+   *  Every pixel carries a label: empty, hot, fired or already used
+   *  in a cluster. The array is allocated once per sensor and reused
+   *  frame after frame; only the pixels which fired are reset after
+   *  the cluster search, the hot pixels stay.
+   *
+   *  Seed candidates are ranked by the number of direct neighbours,
+   *  then by the number of fired pixels in the frame around them and
+   *  finally by decreasing x and y, which is the order the former
+   *  std::list based sorting produced. Each candidate not used yet
+   *  collects the free fired pixels in the xClusterSize x yClusterSize
+   *  frame around it into a cluster.
+   */
+  class EUTelDigitalFixedFrameFinder {
+
+  public:
+    //! A pixel of a cluster
+    struct Pixel {
+      int x;
+      int y;
+    };
+
+    //! A found cluster, its pixels are in getPixels()
+    struct Cluster {
+      int seedX;
+      int seedY;
+      std::size_t firstPixel;
+      std::size_t nPixels;
+    };
+
+    EUTelDigitalFixedFrameFinder();
+
+    //! Set the pixel range of the sensor, this also forgets the hot pixels
+    void configure(int minX, int minY, int maxX, int maxY);
+
+    //! Whether configure() was called with this range
+    bool isConfigured(int minX, int minY, int maxX, int maxY) const;
+
+    //! Mark a pixel as hot, it is then ignored in all frames
+    /*! @param index the pixel index as given by
+     *  EUTelMatrixDecoder::getIndexFromXY for the configured range
+     */
+    void setHotPixel(int index);
+
+    //! Add a fired pixel of the current frame
+    /*! Hot pixels, repeated pixels and pixels outside of the
+     *  configured range are ignored.
+     */
+    void addPixel(int x, int y);
+
+    //! Find the clusters of the current frame and start a new one
+    void findClusters(int xClusterSize, int yClusterSize);
+
+    //! Clusters of the last findClusters(), in order of creation
+    const std::vector<Cluster> &getClusters() const { return _clusters; }
+
+    //! Pixels of all clusters, see Cluster::firstPixel
+    const std::vector<Pixel> &getPixels() const { return _pixels; }
+
+  private:
+    enum Label : unsigned char { kEmpty = 0, kFired, kUsed, kHot };
+
+    struct Seed {
+      int x;
+      int y;
+      int neighbours;
+      int nPixels;
+    };
+
+    //! Label of a pixel, kEmpty outside of the matrix
+    Label label(int x, int y) const {
+      if(x < _minX || x > _maxX || y < _minY || y > _maxY) return kEmpty;
+      return _labels[position(x, y)];
+    }
+
+    //! Column wise, so that increasing positions are increasing x, then y
+    std::size_t position(int x, int y) const {
+      return static_cast<std::size_t>(x - _minX) * _nY + static_cast<std::size_t>(y - _minY);
+    }
+
+    int _minX;
+    int _minY;
+    int _maxX;
+    int _maxY;
+    std::size_t _nY;
+
+    std::vector<Label> _labels;
+    std::vector<std::size_t> _fired;
+    std::vector<Seed> _seeds;
+    std::vector<Cluster> _clusters;
+    std::vector<Pixel> _pixels;
+  };
+}
+#endif
@@ -12,6 +12,9 @@
 
 #define ETA_VERSION 2
 
+// eutelescope includes ".h"
+#include "EUTelEtaLookup.h"
+
 // lcio includes <.h>
 #include <IMPL/LCGenericObjectImpl.h>
 #include <lcio.h>
@@ -141,6 +144,18 @@ namespace eutelescope {
      */
     double getEtaFromCoG(double x) const;
 
+    //! Build a compiled lookup of this Eta function
+    /*! The returned object resamples the function once onto a
+     *  uniform grid and replaces the binary search of getEtaFromCoG
+     *  with a constant time interpolation. It should be built once
+     *  per sensor and reused for all clusters.
+     *
+     *  @param nGrid number of grid points, 0 means
+     *  EUTelEtaLookup::defaultOversampling times the number of bins
+     *  @return the lookup object
+     */
+    EUTelEtaLookup makeLookup(unsigned int nGrid = 0) const;
+
   protected:
     //! Get the begin iterator for the CoG vector
     /*! This method is used to get an iterator corresponding to the
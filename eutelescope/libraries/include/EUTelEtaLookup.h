@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELETALOOKUP_H
+#define EUTELETALOOKUP_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Compiled eta correction lookup on a uniform grid
+  /*! EUTelEtaFunctionImpl::getEtaFromCoG binary searches the bin
+   *  centers for every call. This class resamples the piecewise
+   *  linear eta function once onto a uniform grid spanning the first
+   *  to the last bin center, so that a lookup is one multiplication,
+   *  one index and one linear interpolation.
+   *
+   *  Values outside the bin center range are clamped to the first
+   *  and the last eta value, exactly as getEtaFromCoG does.
+   *
+   *  Since the eta function is monotonic, the deviation from the
+   *  binary search result is bounded by the largest eta increment
+   *  over one grid step; it vanishes if the original bin centers lie
+   *  on the grid. It is best obtained through
+   *  EUTelEtaFunctionImpl::makeLookup.
+   *
+   *  @see EUTelEtaFunctionImpl
+   */
+  class EUTelEtaLookup {
+
+  public:
+    //! Default number of grid points per original bin
+    static const unsigned int defaultOversampling = 8;
+
+    //! Build the lookup from bin centers and eta values
+    /*! @param binCenters sorted bin centers, at least one
+     *  @param etaValues eta value for each bin center
+     *  @param nGrid number of grid points, 0 means defaultOversampling
+     *  times the number of bins
+     *
+     *  @throw InvalidParameterException if the vectors are empty or
+     *  of different size
+     */
+    EUTelEtaLookup(std::vector<double> const &binCenters,
+                   std::vector<double> const &etaValues,
+                   unsigned int nGrid = 0);
+
+    //! Eta for a given CoG value
+    double operator()(double x) const {
+      if(x <= _xMin) return _grid.front();
+      if(x >= _xMax) return _grid.back();
+      double const t = (x - _xMin) * _invStep;
+      std::size_t i = static_cast<std::size_t>(t);
+      if(i > _lastCell) i = _lastCell;
+      double const frac = t - static_cast<double>(i);
+      return _grid[i] + frac * (_grid[i + 1] - _grid[i]);
+    }
+
+    //! Number of grid points
+    std::size_t getGridSize() const { return _grid.size(); }
+
+    //! Distance between two grid points
+    double getGridStep() const { return _step; }
+
+    //! Largest eta increment over one grid step, bounds the resampling error
+    double getMaxCellIncrement() const { return _maxCellIncrement; }
+
+  private:
+    double _xMin;
+    double _xMax;
+    double _step;
+    double _invStep;
+    std::size_t _lastCell;
+    double _maxCellIncrement;
+    std::vector<double> _grid;
+  };
+}
+#endif
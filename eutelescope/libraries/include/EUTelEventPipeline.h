@@ -0,0 +1,332 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELEVENTPIPELINE_H
+#define EUTELEVENTPIPELINE_H 1
+
+// eutelescope includes ".h"
+#include "EUTelParallel.h"
+
+// system includes <>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Runs a chain of processing stages on several events at a time
+  /*! Every stage declares whether it is thread safe. A thread safe
+   *  stage only works on the event it gets and on per thread state,
+   *  so it may run for different events on different threads at the
+   *  same time. Any other stage keeps state from event to event: it
+   *  runs for one event at a time and sees the events in the order
+   *  they were pushed, the pipeline reorders them in front of it.
+   *
+   *  The optional final stage runs in the thread calling push() and
+   *  finish(), also in push order. It is the place for everything
+   *  which has to stay in one thread, e.g. writing the output with
+   *  an LCIO which is not thread safe.
+   *
+   *  With one thread the stages run one after the other in push(),
+   *  as Marlin runs its processors. With more threads up to
+   *  maxInFlight events are in the pipeline, push() waits while it is
+   *  full. The output of a chain of stages is then the same as with
+   *  one thread, as long as the stages declared thread safe really
+   *  are.
+   *
+   *  Stages are called as stage(event, threadIndex) with threadIndex
+   *  in [0, getNThreads()), per thread state of a stage can be indexed
+   *  by it without locking. The final stage gets getNThreads().
+   *
+   *  An exception thrown by a stage is rethrown in the calling thread
+   *  by the next call to push(), at the latest by finish(). The stages
+   *  are not called any more afterwards, the remaining events are
+   *  dropped.
+   */
+  template <class Event> class EUTelEventPipeline {
+
+  public:
+    typedef std::function<void(Event &, unsigned int)> Stage;
+
+    //! Constructor
+    /*! @param nThreads number of worker threads, 0 for as many as the
+     *  hardware supports
+     *  @param maxInFlight maximum number of events in the pipeline, at
+     *  least the number of threads
+     */
+    EUTelEventPipeline(int nThreads, std::size_t maxInFlight)
+        : _nThreads(Utility::resolveThreadCount(nThreads)), _maxInFlight(std::max<std::size_t>(maxInFlight, _nThreads)),
+          _segments(), _finalStage(), _finished(), _nextFinal(0), _mutex(), _workAvailable(), _spaceAvailable(), _ready(),
+          _workers(), _nPushed(0), _inFlight(0), _nProcessed(0), _stopping(false), _failed(false), _error() {}
+
+    //! Finish the events in the pipeline, errors are dropped
+    ~EUTelEventPipeline() {
+      try {
+        finish();
+      } catch(...) {
+      }
+    }
+
+    EUTelEventPipeline(EUTelEventPipeline const &) = delete;
+    EUTelEventPipeline &operator=(EUTelEventPipeline const &) = delete;
+
+    //! Append a stage to the chain, before the first push()
+    /*! @return false if events have been pushed already, the stage is
+     *  then not added
+     */
+    bool addStage(Stage stage, bool threadSafe) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(_nPushed > 0) return false;
+      //consecutive thread safe stages run in one go
+      if(!threadSafe || _segments.empty() || _segments.back().serial) _segments.push_back(Segment(!threadSafe));
+      _segments.back().stages.push_back(std::move(stage));
+      return true;
+    }
+
+    //! Set the stage run in the calling thread, before the first push()
+    /*! @return false if events have been pushed already, the stage is
+     *  then not set
+     */
+    bool setFinalStage(Stage stage) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(_nPushed > 0) return false;
+      _finalStage = std::move(stage);
+      return true;
+    }
+
+    //! Hand an event to the pipeline, waiting for space
+    void push(Event event) {
+      if(_nThreads == 1) {
+        rethrow();
+        ++_nPushed;
+        if(!_failed) {
+          try {
+            for(auto &segment : _segments) {
+              for(auto &stage : segment.stages) stage(event, 0);
+            }
+            if(_finalStage) _finalStage(event, _nThreads);
+          } catch(...) {
+            _failed = true;
+            _error = std::current_exception();
+          }
+        }
+        ++_nProcessed;
+        rethrow();
+        return;
+      }
+
+      std::unique_lock<std::mutex> lock(_mutex);
+      if(_workers.empty()) {
+        _stopping = false;
+        for(unsigned int thread = 0; thread < _nThreads; ++thread) _workers.emplace_back(&EUTelEventPipeline::work, this, thread);
+      }
+      while(true) {
+        runFinalStage(lock);
+        if(_inFlight < _maxInFlight) break;
+        _spaceAvailable.wait(lock);
+      }
+      ++_inFlight;
+      enqueue(Task{_nPushed++, 0, std::move(event)});
+      rethrow();
+    }
+
+    //! Wait until all pushed events are through the pipeline
+    /*! The worker threads are stopped, they are started again by the
+     *  next push().
+     */
+    void finish() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while(true) {
+        runFinalStage(lock);
+        if(_inFlight == 0) break;
+        _spaceAvailable.wait(lock);
+      }
+      _stopping = true;
+      _workAvailable.notify_all();
+      std::vector<std::thread> workers;
+      workers.swap(_workers);
+      lock.unlock();
+      for(auto &worker : workers) worker.join();
+      lock.lock();
+      rethrow();
+    }
+
+    //! Number of worker threads
+    unsigned int getNThreads() const { return _nThreads; }
+
+    //! Maximum number of events in the pipeline
+    std::size_t getMaxInFlight() const { return _maxInFlight; }
+
+    //! Number of events which went through all stages or were dropped
+    std::size_t getNProcessed() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _nProcessed;
+    }
+
+  private:
+    //! Consecutive thread safe stages, or a single other one
+    struct Segment {
+      explicit Segment(bool isSerial) : stages(), serial(isSerial), busy(false), next(0), waiting() {}
+      std::vector<Stage> stages;
+      bool serial;
+      //! Whether one of the events is running this segment
+      bool busy;
+      //! Number of the event allowed to run the segment next
+      std::size_t next;
+      //! Events waiting for their turn, by their number
+      std::map<std::size_t, Event> waiting;
+    };
+
+    //! An event on its way through the segments
+    struct Task {
+      std::size_t number;
+      std::size_t segment;
+      Event event;
+    };
+
+    //! Put an event in front of its next segment, with the lock held
+    void enqueue(Task task) {
+      if(task.segment == _segments.size() && _finalStage) {
+        _finished.emplace(task.number, std::move(task.event));
+        _spaceAvailable.notify_all();
+        return;
+      }
+      if(task.segment == _segments.size()) {
+        --_inFlight;
+        ++_nProcessed;
+        _spaceAvailable.notify_all();
+        return;
+      }
+      Segment &segment = _segments[task.segment];
+      if(!segment.serial) {
+        _ready.push_back(std::move(task));
+        _workAvailable.notify_one();
+        return;
+      }
+      segment.waiting.emplace(task.number, std::move(task.event));
+      schedule(task.segment);
+    }
+
+    //! Start the next event on a serial segment if it is its turn
+    void schedule(std::size_t index) {
+      Segment &segment = _segments[index];
+      if(segment.busy || segment.waiting.empty() || segment.waiting.begin()->first != segment.next) return;
+      segment.busy = true;
+      _ready.push_back(Task{segment.next, index, std::move(segment.waiting.begin()->second)});
+      segment.waiting.erase(segment.waiting.begin());
+      _workAvailable.notify_one();
+    }
+
+    //! Run the final stage on the events whose turn it is
+    /*! Called with the lock held, it is released around the stage.
+     */
+    void runFinalStage(std::unique_lock<std::mutex> &lock) {
+      while(!_finished.empty() && _finished.begin()->first == _nextFinal) {
+        std::exception_ptr error;
+        {
+          //the event is gone before the lock is taken again
+          Event event = std::move(_finished.begin()->second);
+          _finished.erase(_finished.begin());
+          bool const skip = _failed;
+          lock.unlock();
+          if(!skip) {
+            try {
+              _finalStage(event, _nThreads);
+            } catch(...) {
+              error = std::current_exception();
+            }
+          }
+        }
+
+        lock.lock();
+        if(error && !_failed) {
+          _failed = true;
+          _error = error;
+        }
+        ++_nextFinal;
+        --_inFlight;
+        ++_nProcessed;
+      }
+    }
+
+    //! Main loop of a worker thread
+    void work(unsigned int thread) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while(true) {
+        _workAvailable.wait(lock, [this] { return _stopping || !_ready.empty(); });
+        if(_ready.empty()) return;
+        Task task = std::move(_ready.front());
+        _ready.pop_front();
+        bool const skip = _failed;
+        lock.unlock();
+
+        if(!skip) {
+          try {
+            for(auto &stage : _segments[task.segment].stages) stage(task.event, thread);
+          } catch(...) {
+            lock.lock();
+            if(!_failed) {
+              _failed = true;
+              _error = std::current_exception();
+            }
+            lock.unlock();
+          }
+        }
+
+        lock.lock();
+        Segment &segment = _segments[task.segment];
+        if(segment.serial) {
+          segment.busy = false;
+          ++segment.next;
+          schedule(task.segment);
+        }
+        ++task.segment;
+        enqueue(std::move(task));
+      }
+    }
+
+    //! Rethrow a stored error of a stage, once
+    void rethrow() {
+      if(!_error) return;
+      std::exception_ptr error = _error;
+      _error = nullptr;
+      std::rethrow_exception(error);
+    }
+
+    unsigned int const _nThreads;
+    std::size_t const _maxInFlight;
+    std::vector<Segment> _segments;
+    Stage _finalStage;
+    //! Events through all segments waiting for the final stage
+    std::map<std::size_t, Event> _finished;
+    //! Number of the event allowed to run the final stage next
+    std::size_t _nextFinal;
+    mutable std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _spaceAvailable;
+    //! Events which can run their next segment
+    std::deque<Task> _ready;
+    std::vector<std::thread> _workers;
+    std::size_t _nPushed;
+    std::size_t _inFlight;
+    std::size_t _nProcessed;
+    bool _stopping;
+    //! The stages are not called any more after an error
+    bool _failed;
+    std::exception_ptr _error;
+  };
+}
+#endif
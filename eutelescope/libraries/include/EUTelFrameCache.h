@@ -0,0 +1,99 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELFRAMECACHE_H
+#define EUTELFRAMECACHE_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! In-memory copy of the raw frames of a range of events
+  /*! Processors iterating several times over the same raw data (like
+   *  the pedestal and noise calculation with its common mode
+   *  iterations) can store the ADC frames once here instead of
+   *  rewinding and decoding the input files for every loop.
+   *
+   *  For each detector there is one contiguous buffer of shorts in
+   *  which the frames of consecutive events are appended. The total
+   *  memory is bounded by a budget given at configuration time: as
+   *  soon as the next event would exceed it, the cache is
+   *  invalidated and its memory released, so that the caller can
+   *  fall back to rewinding.
+   *
+   *  An event is started with beginEvent() and every detector has to
+   *  be filled exactly once with a frame of the configured size.
+   *  Anything else invalidates the cache as well.
+   */
+  class EUTelFrameCache {
+
+  public:
+    //! Reason for which the cache has been invalidated
+    enum Status { kNotConfigured, kValid, kBudgetExceeded, kInconsistentEvent };
+
+    EUTelFrameCache();
+
+    //! Set up the cache for a set of detectors
+    /*! @param frameSizes number of pixels per detector
+     *  @param memoryBudget maximum number of bytes for all frames
+     */
+    void configure(std::vector<std::size_t> const &frameSizes, std::size_t memoryBudget);
+
+    //! Release all memory and return to the not configured state
+    void clear();
+
+    //! Start a new event
+    /*! @return false if the cache is not (or no more) valid, for
+     *  example because this event would exceed the memory budget
+     */
+    bool beginEvent();
+
+    //! Store the frame of a detector for the current event
+    void fill(std::size_t iDetector, std::vector<short> const &frame);
+
+    //! Drop all frames, the cache will not be used any more
+    void invalidate(Status reason = kInconsistentEvent);
+
+    //! True if all events so far have been completely stored
+    bool isValid() const;
+
+    //! Current status
+    Status getStatus() const { return _status; }
+
+    //! Number of stored events
+    std::size_t getNEvents() const { return _nEvents; }
+
+    //! Number of detectors
+    std::size_t getNDetectors() const { return _frameSizes.size(); }
+
+    //! Number of pixels of a detector frame
+    std::size_t getFrameSize(std::size_t iDetector) const { return _frameSizes[iDetector]; }
+
+    //! Pointer to the frame of a detector in a given event
+    const short *getFrame(std::size_t iDetector, std::size_t iEvent) const {
+      return _buffers[iDetector].data() + iEvent * _frameSizes[iDetector];
+    }
+
+    //! Memory needed by one event in bytes
+    std::size_t getEventSize() const { return _eventSize; }
+
+    //! Memory budget in bytes
+    std::size_t getMemoryBudget() const { return _memoryBudget; }
+
+  private:
+    Status _status;
+    std::size_t _memoryBudget;
+    std::size_t _eventSize;
+    std::size_t _nEvents;
+    std::vector<std::size_t> _frameSizes;
+    std::vector<std::vector<short>> _buffers;
+  };
+}
+#endif
@@ -0,0 +1,66 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELGAUSSJORDAN_H
+#define EUTELGAUSSJORDAN_H 1
+
+// system includes <>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Gauss-Jordan elimination with full pivoting, split in two steps
+  /*! factorise() inverts an n x n matrix in place, exactly like the
+   *  classic gaussj routine does, and records the pivots and row
+   *  multipliers it used. solve() then replays the same operations on
+   *  a right-hand side in O(n^2), which gives bit for bit the solution
+   *  the routine would have found when eliminating both together.
+   *
+   *  This allows to factorise a matrix once and to solve for many
+   *  right-hand sides, e.g. track fits with the same planes fired.
+   */
+  class EUTelGaussJordan {
+
+  public:
+    EUTelGaussJordan();
+
+    //! Invert alfa (n x n, row by row) in place
+    /*! @return false if the matrix is singular, alfa is then left
+     *  partially eliminated and solve() must not be used
+     */
+    bool factorise(double *alfa, int n);
+
+    //! Transform beta into the solution of alfa x = beta
+    void solve(double *beta) const;
+
+    //! Result of the last factorise()
+    bool isValid() const { return _valid; }
+
+    //! Matrix size of the last factorise()
+    int getSize() const { return _n; }
+
+    //! Inverse matrix as left in alfa by the last factorise()
+    const std::vector<double> &getInverse() const { return _inverse; }
+
+  private:
+    int _n;
+    bool _valid;
+
+    //! Pivot row and column of each elimination step
+    std::vector<int> _pivotRow;
+    std::vector<int> _pivotColumn;
+    std::vector<double> _pivotInverse;
+
+    //! Multipliers of all rows of each step, n per step
+    std::vector<double> _multiplier;
+
+    std::vector<double> _inverse;
+    std::vector<int> _pivotUsed;
+  };
+}
+#endif
@@ -55,6 +55,25 @@ namespace eutelescope {
                           double ySize, double zSize, double radLength,
                           std::string planeVolume);
 
+      /** Same as addPlane, but the pixel geometry is not loaded into any
+       *  plane volume. Used if the TGeo description (which already holds
+       *  the pixel volumes) has been read from a file.
+       */
+      EUTelGenericPixGeoDescr *loadPlane(int planeID, std::string geoName);
+
+      /** Same as addCastedPlane without loading the pixel geometry into a
+       *  plane volume. */
+      EUTelGenericPixGeoDescr *loadCastedPlane(int planeID, int xPixel,
+                                               int yPixel, double xSize,
+                                               double ySize, double zSize,
+                                               double radLength);
+
+      /** File name of the shared library holding the pixel geometry
+       *  geoName, as resolved by the dynamic linker. Empty if it cannot
+       *  be loaded.
+       */
+      static std::string getLibraryFile(std::string geoName);
+
       /** Method to get the EUTelGenericPixGeoDescr of a plane.
        *
        *  @param planeID The plane of which the EUTelGenericPixGeoDescr
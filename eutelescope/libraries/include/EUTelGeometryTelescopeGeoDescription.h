@@ -3,6 +3,7 @@
 
 // C++
 #include <array>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
@@ -105,6 +106,16 @@ namespace eutelescope {
       /** Map holding the transformation matrix for each plane (identified by its planeID) */
 	    std::map<int, TGeoMatrix*> _TGeoMatrixMap;
 
+      /** Directory of the persistent TGeo cache, caching is disabled if empty */
+      std::string _geometryCacheDir;
+
+      /** Flag if the TGeo description has been read from the cache */
+      bool _isLoadedFromCache;
+
+      /** Geometry manager owning the (never placed) volumes of the pixel
+       *  descriptions which are created after a cached load */
+      std::unique_ptr<TGeoManager> _pixelScratchManager;
+
       /** Conter to indicate if instance of this object exists */
       static unsigned _counter;
 
@@ -418,6 +429,32 @@ namespace eutelescope {
         return _planePath.find(planeID)->second;
       };
 
+      /** Enable the persistent TGeo cache: initializeTGeoDescription()
+       *  stores the finished geometry in this directory and loads it on
+       *  later runs with the same GEAR content and pixel geometry
+       *  libraries. An empty string disables the cache. The default is
+       *  taken from the EUTELESCOPE_GEOMETRY_CACHE environment variable.
+       */
+      void setGeometryCacheDirectory(std::string const &dir) {
+        _geometryCacheDir = dir;
+      };
+
+      /** Directory of the persistent TGeo cache, empty if disabled */
+      std::string const &getGeometryCacheDirectory() const {
+        return _geometryCacheDir;
+      };
+
+      /** Cache file for the current GEAR content, empty if disabled */
+      std::string getGeometryCacheFile();
+
+      /** True if the TGeo description has been read from the cache */
+      bool isLoadedFromCache() const { return _isLoadedFromCache; };
+
+      /** Drop the TGeo description and the pixel descriptions, the next
+       *  call of initializeTGeoDescription() builds (or loads) them again
+       */
+      void resetTGeoDescription();
+
       /** Geometry manager global object */
       std::unique_ptr<TGeoManager> _geoManager = nullptr;
 
@@ -443,6 +480,20 @@ namespace eutelescope {
 
       void translateSiPlane2TGeo(TGeoVolume *, int);
 
+      /** Hash of everything the TGeo description is built from */
+      std::string geometryCacheKey();
+
+      /** Read the TGeo description from the cache file
+       *  @return false if the file does not exist or does not match
+       */
+      bool loadGeometryCache(std::string const &fileName);
+
+      /** Store the TGeo description in the cache file */
+      void writeGeometryCache(std::string const &fileName);
+
+      /** Fill the map of transformation matrices from the plane paths */
+      void updateTGeoMatrixMap();
+
       void clearMemoizedValues() {
         _planeNormalMap.clear();
         _planeXMap.clear();
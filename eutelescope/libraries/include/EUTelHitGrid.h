@@ -0,0 +1,78 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHITGRID_H
+#define EUTELHITGRID_H 1
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Neighbour search for hits in a plane
+  /*! find() gives the hits inside the square of half width limit
+   *  around a position, |dx| <= limit and |dy| <= limit as the former
+   *  loops over all pairs of hits tested it.
+   *
+   *  The hits are sorted into a grid of cells of size 2 limit, so that
+   *  only the hits in the 3 x 3 cells around the position are tested,
+   *  rounding in the cell numbers can not lose a hit on the border of
+   *  the square. Hits and positions without a cell, non finite or far
+   *  beyond any sensor, are tested against everything, and so is
+   *  everything for a limit which is not positive: the result is the
+   *  same as testing every hit.
+   *
+   *  The buffers are kept between calls, so that an instance can be
+   *  reused event after event.
+   */
+  class EUTelHitGrid {
+
+  public:
+    EUTelHitGrid();
+
+    //! Start a new set of hits, searched with the given limit
+    void reset(double limit);
+
+    //! Add a hit with an identifier, e.g. its index in the collection
+    void addHit(int id, double x, double y);
+
+    //! Sort the hits into the grid, after all hits are added
+    void build();
+
+    //! Identifiers of the hits around a position, in increasing order
+    void find(double x, double y, std::vector<int> &result) const;
+
+    std::size_t getNHits() const { return _hits.size(); }
+
+  private:
+    typedef std::pair<long long, long long> Cell;
+
+    struct Hit {
+      int id;
+      double x;
+      double y;
+    };
+
+    //! Cell of a position, false if it has none
+    bool cell(double x, double y, Cell &result) const;
+
+    //! The test of the former loops
+    bool isInside(const Hit &hit, double x, double y) const;
+
+    double _limit;
+    bool _useGrid;
+    std::vector<Hit> _hits;
+    //! Hits sorted by grid cell
+    std::vector<std::pair<Cell, int>> _grid;
+    //! Hits without a cell
+    std::vector<int> _outside;
+  };
+}
+#endif
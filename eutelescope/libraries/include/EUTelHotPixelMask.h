@@ -0,0 +1,71 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHOTPIXELMASK_H
+#define EUTELHOTPIXELMASK_H 1
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Hot pixels of all sensors as one bitset per sensor
+  /*! The hot pixels are collected with setHotPixel(), build() then
+   *  gives every sensor a bitset over the bounding box of its hot
+   *  pixels. A lookup is a range check and a bit test, clusters are
+   *  checked directly on the charge values of their TrackerData.
+   *
+   *  Sensor IDs are the index of the sensor in a vector, pixels of
+   *  negative sensor IDs are ignored.
+   */
+  class EUTelHotPixelMask {
+
+  public:
+    EUTelHotPixelMask();
+
+    //! Forget all hot pixels
+    void clear();
+
+    //! Add a hot pixel, used after the next build()
+    void setHotPixel(int sensorID, int x, int y);
+
+    //! Fill the bitsets with the hot pixels added so far
+    void build();
+
+    //! Whether a pixel is hot, after build()
+    bool isHot(int sensorID, int x, int y) const;
+
+    //! Whether any pixel of a sparse cluster is hot, after build()
+    /*! The charge values hold pixelSize values per pixel, the first two
+     *  are x and y, as for EUTelGenericSparsePixel with a pixelSize
+     *  of 4.
+     */
+    bool containsHotPixel(int sensorID, const std::vector<float> &charges,
+                          std::size_t pixelSize = 4) const;
+
+    //! Number of distinct hot pixels, after build()
+    std::size_t getNHotPixels() const { return _nHotPixels; }
+
+  private:
+    struct Sensor {
+      int xMin;
+      int yMin;
+      std::size_t width;
+      std::size_t height;
+      std::vector<std::uint64_t> bits;
+      std::vector<std::pair<int, int>> pixels;
+    };
+
+    std::vector<Sensor> _sensors;
+    std::size_t _nHotPixels;
+  };
+}
+#endif
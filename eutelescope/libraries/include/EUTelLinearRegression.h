@@ -0,0 +1,94 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELLINEARREGRESSION_H
+#define EUTELLINEARREGRESSION_H 1
+
+namespace eutelescope {
+
+  //! Closed-form weighted least squares fit of a straight line
+  /*! Points are accumulated one by one; instead of the raw sums
+   *  Sum(w x), Sum(w x^2), ... the weighted means and the centred
+   *  second moments are updated, so that the result stays accurate
+   *  when the x values are large compared to their spread (e.g.
+   *  injected charges of 10^4 to 10^5 electrons).
+   *
+   *  The fit minimises Sum(w (y - offset - slope x)^2). With w =
+   *  1/sigma^2 of each point this is the minimum of the chi2 of a pol1
+   *  fit; the default w = 1 gives an unweighted fit. Two accumulators
+   *  can be merged, so that partial sums of different threads can be
+   *  combined.
+   */
+  class EUTelLinearRegression {
+
+  public:
+    EUTelLinearRegression()
+        : _sumW(0.), _meanX(0.), _meanY(0.), _cXX(0.), _cXY(0.), _cYY(0.) {}
+
+    //! Add a point with weight w
+    void add(double x, double y, double w = 1.) {
+      if(!(w > 0.)) return;
+      _sumW += w;
+      double const dx = x - _meanX;
+      double const dy = y - _meanY;
+      _meanX += dx * w / _sumW;
+      _meanY += dy * w / _sumW;
+      _cXX += w * dx * (x - _meanX);
+      _cXY += w * dx * (y - _meanY);
+      _cYY += w * dy * (y - _meanY);
+    }
+
+    //! Add all points of another accumulator
+    void merge(EUTelLinearRegression const &other) {
+      if(!(other._sumW > 0.)) return;
+      double const sumW = _sumW + other._sumW;
+      double const dx = other._meanX - _meanX;
+      double const dy = other._meanY - _meanY;
+      double const f = _sumW * other._sumW / sumW;
+      _cXX += other._cXX + dx * dx * f;
+      _cXY += other._cXY + dx * dy * f;
+      _cYY += other._cYY + dy * dy * f;
+      _meanX += dx * other._sumW / sumW;
+      _meanY += dy * other._sumW / sumW;
+      _sumW = sumW;
+    }
+
+    //! Remove all points
+    void clear() { *this = EUTelLinearRegression(); }
+
+    //! Sum of weights, the number of points for unit weights
+    double getSumOfWeights() const { return _sumW; }
+
+    //! Solve for offset and slope
+    /*! @return false if there are less than two distinct x values,
+     *  offset and slope are then left unchanged
+     */
+    bool solve(double &offset, double &slope) const {
+      if(!(_sumW > 0.) || !(_cXX > 0.)) return false;
+      slope = _cXY / _cXX;
+      offset = _meanY - slope * _meanX;
+      return true;
+    }
+
+    //! Weighted sum of squared residuals of the solution
+    double getResidualSum() const {
+      if(!(_cXX > 0.)) return _cYY;
+      double const r = _cYY - _cXY * _cXY / _cXX;
+      return r > 0. ? r : 0.;
+    }
+
+  private:
+    double _sumW;
+    double _meanX;
+    double _meanY;
+    double _cXX;
+    double _cXY;
+    double _cYY;
+  };
+}
+#endif
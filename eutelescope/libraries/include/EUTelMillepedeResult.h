@@ -0,0 +1,102 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMILLEPEDERESULT_H
+#define EUTELMILLEPEDERESULT_H 1
+
+// system includes <>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Parsed content of a millepede.res file
+  /*! The result file written by pede contains one row per global
+   *  parameter label. EUTelescope labels are sensorID * 10 + n, with
+   *  n = 1..9 the parameter number within the sensor. Each row is
+   *  decoded on its own and keyed on its label, so fixed parameters,
+   *  missing rows or absent sensors never shift the following ones.
+   *
+   *  Rows with 3 columns (label, value, presigma), 5 columns (plus
+   *  difference and error) and 6 columns (plus global correlation)
+   *  are accepted; anything else (e.g. the header line) is skipped.
+   *
+   *  The result is stored as a flat table with maxParameters entries
+   *  per sensor, sensors being sorted by their ID.
+   */
+  class EUTelMillepedeResult {
+
+  public:
+    //! Highest parameter number per sensor which can be encoded in a label
+    static const int maxParameters = 9;
+
+    //! One global parameter as read from the file
+    struct Parameter {
+      Parameter() : value(0), presigma(0), error(0), present(false) {}
+      double value;
+      double presigma;
+      //! Only available for 5 and 6 column rows, 0 otherwise
+      double error;
+      bool present;
+    };
+
+    //! The alignment quantities a parameter number can stand for
+    enum Quantity { kXOff, kYOff, kZOff, kAlpha, kBeta, kGamma };
+
+    //! Parameter number to quantity assignment used by the EUTelescope aligners
+    /*! The meaning of a parameter number depends on how many
+     *  parameters per sensor are fitted: 2 (XYShifts), 3
+     *  (XYShiftsRotZ), 4 (XYZShiftsRotZ) or 6 (XYZShiftsRotXYZ and
+     *  XYShiftsAllRot). Element i describes parameter number i+1. An
+     *  empty vector is returned for any other number.
+     */
+    static std::vector<Quantity> layout(unsigned int nParameters);
+
+    EUTelMillepedeResult();
+
+    //! Read and parse a millepede.res file
+    /*! @return false if the file could not be opened
+     */
+    bool read(std::string const &fileName);
+
+    //! Parse a millepede.res formatted stream, replacing any previous content
+    void parse(std::istream &input);
+
+    //! Sorted IDs of all sensors with at least one parameter in the file
+    std::vector<int> const &sensorIDs() const { return _sensorIDs; }
+
+    //! Check whether a sensor appears in the file
+    bool hasSensor(int sensorID) const;
+
+    //! Access a parameter of a sensor
+    /*! @param sensorID the sensor ID
+     *  @param parameter the parameter number, 1..maxParameters
+     *  @return the parameter, with present == false if the row was missing
+     */
+    Parameter const &getParameter(int sensorID, int parameter) const;
+
+    //! Highest parameter number found for any sensor
+    int maxParameterNumber() const { return _maxParameterNumber; }
+
+    //! Number of rows which could not be interpreted
+    unsigned int skippedLines() const { return _skippedLines; }
+
+  private:
+    //! Index of the sensor in _sensorIDs or -1
+    int sensorIndex(int sensorID) const;
+
+    std::vector<int> _sensorIDs;
+    //! maxParameters entries per sensor, ordered as _sensorIDs
+    std::vector<Parameter> _table;
+    int _maxParameterNumber;
+    unsigned int _skippedLines;
+    Parameter _missing;
+  };
+}
+#endif
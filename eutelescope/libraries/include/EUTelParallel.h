@@ -0,0 +1,174 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPARALLEL_H
+#define EUTELPARALLEL_H 1
+
+// system includes <>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  namespace Utility {
+
+    //! Number of worker threads to use for a requested thread count
+    /*! A request of 0 means "as many as the hardware supports".
+     */
+    inline unsigned int resolveThreadCount(int requested) {
+      if(requested > 0) return static_cast<unsigned int>(requested);
+      unsigned int const hw = std::thread::hardware_concurrency();
+      return hw > 0 ? hw : 1;
+    }
+
+    //! Split [0, nItems) into contiguous ranges and process them in parallel
+    /*! The body is called as body(begin, end, threadIndex) with
+     *  threadIndex in [0, nThreads). Each range is handled by exactly one
+     *  thread, so per-thread state can be indexed by threadIndex
+     *  without locking. With a single thread (or a single item) the
+     *  body runs in the calling thread.
+     */
+    template <typename Body>
+    void parallelFor(std::size_t nItems, unsigned int nThreads, Body body) {
+      if(nItems == 0) return;
+      nThreads = std::max(1u, std::min<unsigned int>(nThreads, static_cast<unsigned int>(std::min<std::size_t>(nItems, 1024))));
+      if(nThreads == 1) {
+        body(std::size_t(0), nItems, 0u);
+        return;
+      }
+
+      std::size_t const chunk = (nItems + nThreads - 1) / nThreads;
+      std::vector<std::thread> workers;
+      workers.reserve(nThreads - 1);
+      for(unsigned int t = 1; t < nThreads; ++t) {
+        std::size_t const begin = std::min(nItems, t * chunk);
+        std::size_t const end = std::min(nItems, begin + chunk);
+        workers.emplace_back(body, begin, end, t);
+      }
+      body(std::size_t(0), std::min(nItems, chunk), 0u);
+      for(auto &worker : workers) worker.join();
+    }
+
+    //! Worker threads which stay alive between parallel loops
+    /*! Does the same as parallelFor(), but the threads are started by
+     *  the first loop which needs them and then wait for the next one,
+     *  so a loop which is run very often, e.g. in a minimiser's
+     *  objective, does not start threads every time. Starting a loop
+     *  does not allocate memory.
+     *
+     *  Only one loop may run at a time. The body must not throw when
+     *  it runs in a worker thread, as with parallelFor().
+     */
+    class WorkerPool {
+
+    public:
+      //! Constructor
+      /*! @param nThreads number of threads including the calling one,
+       *  0 for as many as the hardware supports
+       */
+      explicit WorkerPool(int nThreads)
+          : _nThreads(resolveThreadCount(nThreads)), _mutex(), _start(), _done(), _workers(), _invoke(nullptr),
+            _body(nullptr), _nItems(0), _chunk(0), _generation(0), _busy(0), _stopping(false) {}
+
+      //! Stop and join the worker threads
+      ~WorkerPool() {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _stopping = true;
+        }
+        _start.notify_all();
+        for(auto &worker : _workers) worker.join();
+      }
+
+      WorkerPool(WorkerPool const &) = delete;
+      WorkerPool &operator=(WorkerPool const &) = delete;
+
+      //! Number of threads including the calling one
+      unsigned int getNThreads() const { return _nThreads; }
+
+      //! Process [0, nItems) in contiguous ranges, as parallelFor()
+      template <typename Body> void parallelFor(std::size_t nItems, Body body) {
+        if(nItems == 0) return;
+        unsigned int const nThreads = std::min<unsigned int>(_nThreads, static_cast<unsigned int>(std::min<std::size_t>(nItems, 1024)));
+        if(nThreads == 1) {
+          body(std::size_t(0), nItems, 0u);
+          return;
+        }
+
+        std::size_t const chunk = (nItems + nThreads - 1) / nThreads;
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          while(_workers.size() + 1 < _nThreads) {
+            _workers.emplace_back(&WorkerPool::work, this, static_cast<unsigned int>(_workers.size() + 1), _generation);
+          }
+          _invoke = &WorkerPool::invoke<Body>;
+          _body = &body;
+          _nItems = nItems;
+          _chunk = chunk;
+          _busy = _workers.size();
+          ++_generation;
+        }
+        _start.notify_all();
+
+        body(std::size_t(0), std::min(nItems, chunk), 0u);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _busy == 0; });
+      }
+
+    private:
+      typedef void (*Invoker)(void *, std::size_t, std::size_t, unsigned int);
+
+      //! Call a body of known type through a type erased pointer
+      template <typename Body> static void invoke(void *body, std::size_t begin, std::size_t end, unsigned int thread) {
+        (*static_cast<Body *>(body))(begin, end, thread);
+      }
+
+      //! Main loop of a worker thread
+      void work(unsigned int thread, std::size_t seen) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while(true) {
+          _start.wait(lock, [this, seen] { return _stopping || _generation != seen; });
+          if(_stopping) return;
+          seen = _generation;
+          Invoker const invoker = _invoke;
+          void *const body = _body;
+          std::size_t const begin = std::min(_nItems, thread * _chunk);
+          std::size_t const end = std::min(_nItems, begin + _chunk);
+          lock.unlock();
+
+          if(begin < end) invoker(body, begin, end, thread);
+
+          lock.lock();
+          if(--_busy == 0) _done.notify_one();
+        }
+      }
+
+      unsigned int const _nThreads;
+      std::mutex _mutex;
+      std::condition_variable _start;
+      std::condition_variable _done;
+      std::vector<std::thread> _workers;
+      //! The loop currently running
+      Invoker _invoke;
+      void *_body;
+      std::size_t _nItems;
+      std::size_t _chunk;
+      //! Number of loops started, tells the workers about a new one
+      std::size_t _generation;
+      //! Number of workers which have not finished the current loop
+      std::size_t _busy;
+      bool _stopping;
+    };
+  }
+}
+#endif
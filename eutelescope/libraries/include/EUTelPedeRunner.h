@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPEDERUNNER_H
+#define EUTELPEDERUNNER_H 1
+
+// system includes <>
+#include <functional>
+#include <string>
+
+namespace eutelescope {
+
+  //! Runs the external pede program and supervises its output
+  /*! The command is started through /bin/sh with its stdout and
+   *  stderr connected to two pipes. Both pipes are watched with
+   *  poll(), so the calling process sleeps until pede writes
+   *  something or the optional wall-clock timeout expires.
+   *
+   *  The output is split into lines as it streams in. Every line is
+   *  handed to the corresponding line handler (if set) and scanned
+   *  for the markers pede uses to report problems which are not
+   *  reflected in its exit code (in V03-04-00), i.e. "Too many
+   *  rejects", and for the final "Sum(Chi^2)/Sum(Ndf)" result.
+   *
+   *  When the timeout expires the process group of the command gets
+   *  SIGTERM, and SIGKILL if it has not exited after a grace period.
+   */
+  class EUTelPedeRunner {
+
+  public:
+    //! Callback type receiving one line of output without the newline
+    typedef std::function<void(std::string const &)> LineHandler;
+
+    //! Constructor
+    /*! @param command the shell command to execute, e.g. "pede steer.txt"
+     *  @param timeout wall-clock limit in seconds, 0 or negative disables it
+     */
+    explicit EUTelPedeRunner(std::string const &command, double timeout = 0);
+
+    //! Set the handler called for every line pede writes to stdout
+    void setStdoutHandler(LineHandler handler) { _outHandler = handler; }
+
+    //! Set the handler called for every line pede writes to stderr
+    void setStderrHandler(LineHandler handler) { _errHandler = handler; }
+
+    //! Set the time between SIGTERM and SIGKILL after a timeout
+    /*! @param seconds grace period in seconds, 5 by default
+     */
+    void setKillGracePeriod(double seconds) { _killGracePeriod = seconds; }
+
+    //! Start the process and block until it exits or times out
+    /*! @return true if the process could be started and exited with
+     *  status zero before the timeout
+     */
+    bool run();
+
+    //! True if the process could not be started at all
+    bool startFailed() const { return _startFailed; }
+
+    //! True if the process was killed because the timeout expired
+    bool timedOut() const { return _timedOut; }
+
+    //! Exit status of the process, -1 if it did not exit normally
+    int exitStatus() const { return _exitStatus; }
+
+    //! True if pede reported "Too many rejects"
+    bool tooManyRejects() const { return _tooManyRejects; }
+
+    //! True if the final Sum(Chi^2)/Sum(Ndf) value has been found
+    bool hasChi2Ndf() const { return !_chi2Ndf.empty(); }
+
+    //! The final Sum(Chi^2)/Sum(Ndf) value as printed by pede
+    std::string const &chi2Ndf() const { return _chi2Ndf; }
+
+    //! Everything pede wrote to stderr
+    std::string const &errors() const { return _errors; }
+
+  private:
+    //! Scan one complete line of stdout for the known markers
+    void parseOutputLine(std::string const &line);
+
+    //! Split the pending buffer into lines and dispatch them
+    void flushLines(std::string &pending, bool isError, bool final);
+
+    std::string _command;
+    double _timeout;
+    double _killGracePeriod;
+
+    LineHandler _outHandler;
+    LineHandler _errHandler;
+
+    bool _startFailed;
+    bool _timedOut;
+    int _exitStatus;
+    bool _tooManyRejects;
+
+    //! Number of lines left to look for the '=' of the chi2/ndf result
+    int _chi2LinesLeft;
+    std::string _chi2Ndf;
+    std::string _errors;
+  };
+}
+#endif
@@ -0,0 +1,114 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPIPELINEDRIVER_H
+#define EUTELPIPELINEDRIVER_H 1
+
+// eutelescope includes ".h"
+#include "EUTelEventPipeline.h"
+#include "EUTelThreadSafeProcessor.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCRunHeader.h>
+#include <IMPL/LCEventImpl.h>
+#include <IO/LCEventListener.h>
+#include <IO/LCRunListener.h>
+
+// system includes <>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Event loop running the first processors of a job on several events at a time
+  /*! Registered with an LCReader in place of Marlin's ProcessorMgr.
+   *  The leading active processors which derive from
+   *  EUTelThreadSafeProcessor, report isThreadSafe() and have no
+   *  condition are taken out of the ProcessorMgr after init(). They
+   *  run on the worker threads of an EUTelEventPipeline, up to
+   *  maxInFlight events at a time. The events are then put back into
+   *  read order and handed to the ProcessorMgr for the remaining
+   *  processors, in the thread reading them. All reading and writing
+   *  of files thus stays in one thread, which an LCIO before v02-13
+   *  requires.
+   *
+   *  The output is the same as with Marlin as long as the processors
+   *  taken out keep the contract of EUTelThreadSafeProcessor. A
+   *  marlin::SkipEventException skips the rest of the processors as
+   *  Marlin does. Any other exception ends the event loop, the events
+   *  still in the pipeline are dropped.
+   */
+  class EUTelPipelineDriver : public IO::LCRunListener, public IO::LCEventListener {
+
+  public:
+    //! Constructor
+    /*! @param nThreads number of worker threads, 0 for as many as the
+     *  hardware supports
+     *  @param maxInFlight maximum number of events in the pipeline
+     */
+    EUTelPipelineDriver(int nThreads, std::size_t maxInFlight);
+
+    EUTelPipelineDriver(EUTelPipelineDriver const &) = delete;
+    EUTelPipelineDriver &operator=(EUTelPipelineDriver const &) = delete;
+
+    //! Initialise the active processors and split off the thread safe ones
+    /*! @param activeProcessors names of the processors added to the
+     *  ProcessorMgr, in their order
+     *  @param conditions their conditions, empty if none were given
+     */
+    void init(std::vector<std::string> const &activeProcessors, std::vector<std::string> const &conditions);
+
+    //! Finish the events in flight, then hand the run header to all processors
+    virtual void processRunHeader(EVENT::LCRunHeader *header);
+
+    //! Finish the events in flight, then let the event modifiers see the run header
+    virtual void modifyRunHeader(EVENT::LCRunHeader *header);
+
+    //! Take the event from the reader and push it into the pipeline
+    virtual void processEvent(EVENT::LCEvent *event);
+
+    //! Let the event modifiers see the event, before it is pushed
+    virtual void modifyEvent(EVENT::LCEvent *event);
+
+    //! Finish the events in flight and end all processors
+    void end();
+
+    //! Names of the processors running on the worker threads
+    std::vector<std::string> getConcurrentProcessors() const;
+
+    //! Number of worker threads
+    unsigned int getNThreads() const { return _pipeline.getNThreads(); }
+
+  private:
+    //! An event owned by the pipeline
+    struct Event {
+      std::unique_ptr<IMPL::LCEventImpl> event;
+      //! Index of the concurrent processor which skipped it, or -1
+      int skippedBy;
+    };
+
+    //! check() of the concurrent processors and the remaining processors
+    void finalStage(Event &event);
+
+    //! Processors taken out of the ProcessorMgr, in their order
+    std::vector<marlin::Processor *> _processors;
+    //! The same processors
+    std::vector<EUTelThreadSafeProcessor *> _concurrent;
+    //! Events skipped by each of them
+    std::vector<long> _nSkipped;
+    //! Declared last, it finishes its events before the rest is gone
+    EUTelEventPipeline<Event> _pipeline;
+  };
+}
+#endif
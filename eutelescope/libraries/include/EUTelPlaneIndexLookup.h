@@ -0,0 +1,81 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPLANEINDEXLOOKUP_H
+#define EUTELPLANEINDEXLOOKUP_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Map sensor IDs (or z positions) to the plane index of a tracker
+  /*! Planes are registered once with their sensor ID and z position;
+   *  the plane index is the registration order. The sensor ID lookup
+   *  is a single access into a dense array indexed by the ID.
+   *
+   *  The z position match is only meant as a fallback for hits which
+   *  carry no (known) sensor ID. It returns the plane closest in z,
+   *  provided it lies within the tolerance, and -1 otherwise.
+   */
+  class EUTelPlaneIndexLookup {
+
+  public:
+    EUTelPlaneIndexLookup() : _indexByID(), _planeZ() {}
+
+    //! Remove all planes
+    void clear() {
+      _indexByID.clear();
+      _planeZ.clear();
+    }
+
+    //! Register the next plane, returns its plane index
+    /*! Negative sensor IDs are only reachable through the z match.
+     */
+    int addPlane(int sensorID, double zPos) {
+      int const index = static_cast<int>(_planeZ.size());
+      _planeZ.push_back(zPos);
+      if(sensorID >= 0) {
+        if(static_cast<std::size_t>(sensorID) >= _indexByID.size()) {
+          _indexByID.resize(sensorID + 1, -1);
+        }
+        _indexByID[sensorID] = index;
+      }
+      return index;
+    }
+
+    //! Number of registered planes
+    int getNPlanes() const { return static_cast<int>(_planeZ.size()); }
+
+    //! Plane index for a sensor ID, -1 if the ID is unknown
+    int getPlaneIndex(int sensorID) const {
+      if(sensorID < 0 || static_cast<std::size_t>(sensorID) >= _indexByID.size()) return -1;
+      return _indexByID[sensorID];
+    }
+
+    //! Plane index of the plane closest in z, -1 if none is within tolerance
+    int getPlaneIndexFromZ(double zPos, double tolerance) const {
+      int best = -1;
+      double bestDistance = tolerance;
+      for(std::size_t i = 0; i < _planeZ.size(); ++i) {
+        double const distance = zPos > _planeZ[i] ? zPos - _planeZ[i] : _planeZ[i] - zPos;
+        if(distance < bestDistance) {
+          bestDistance = distance;
+          best = static_cast<int>(i);
+        }
+      }
+      return best;
+    }
+
+  private:
+    std::vector<int> _indexByID;
+    std::vector<double> _planeZ;
+  };
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELROOTOUTPUTSETTINGS_H
+#define EUTELROOTOUTPUTSETTINGS_H 1
+
+class TFile;
+class TTree;
+
+namespace eutelescope {
+
+  //! Storage settings of ROOT output files and trees
+  /*! Every setting left at its default keeps the ROOT default, so a
+   *  default constructed object changes nothing.
+   *
+   *  The compression has to be set on the file before the trees and
+   *  their branches are created, the basket size and the auto flush
+   *  on a tree after its branches are created.
+   */
+  class EUTelRootOutputSettings {
+
+  public:
+    EUTelRootOutputSettings();
+
+    //! Basket size in bytes of all branches, 0 keeps the default
+    void setBasketSize(int basketSize) { _basketSize = basketSize; }
+
+    //! Auto flush of the trees, 0 keeps the default
+    /*! As TTree::SetAutoFlush: positive values are a number of
+     *  entries, negative values a number of bytes.
+     */
+    void setAutoFlush(long long autoFlush) { _autoFlush = autoFlush; }
+
+    //! Compression algorithm, as ROOT::RCompressionSetting::EAlgorithm,
+    //! negative keeps the default
+    void setCompressionAlgorithm(int algorithm) { _compressionAlgorithm = algorithm; }
+
+    //! Compression level 0 - 9, negative keeps the default
+    void setCompressionLevel(int level) { _compressionLevel = level; }
+
+    int getBasketSize() const { return _basketSize; }
+    long long getAutoFlush() const { return _autoFlush; }
+    int getCompressionAlgorithm() const { return _compressionAlgorithm; }
+    int getCompressionLevel() const { return _compressionLevel; }
+
+    //! Set the compression of a file
+    void apply(TFile *file) const;
+
+    //! Set the basket size and auto flush of a tree
+    void apply(TTree *tree) const;
+
+  private:
+    int _basketSize;
+    long long _autoFlush;
+    int _compressionAlgorithm;
+    int _compressionLevel;
+  };
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSTRIPCLUSTERASSEMBLER_H
+#define EUTELSTRIPCLUSTERASSEMBLER_H 1
+
+// eutelescope includes ".h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelSparseClusterImpl.h"
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Groups the strips of a strip sensor by their cluster ID
+  /*! The strip clustering of the CMS CBC processors labels every strip
+   *  with the number of the cluster it belongs to, 0 meaning no
+   *  cluster, and the clusters are numbered 1, 2, ... This class
+   *  turns such a label vector into the list of strips of every
+   *  cluster with a counting sort: one pass to count the strips per
+   *  ID, one to distribute them into contiguous buckets. The
+   *  buckets are kept between calls, so that after the first events
+   *  no memory is allocated any more.
+   *
+   *  The strips of a cluster come out in increasing order.
+   */
+  class EUTelStripClusterAssembler {
+
+  public:
+    EUTelStripClusterAssembler();
+
+    //! Group the strips by cluster ID
+    /*! @param clusterNumber cluster ID of every strip, strips with an
+     *  ID of 0 or below do not belong to any cluster
+     */
+    void assemble(std::vector<int> const &clusterNumber);
+
+    //! Largest cluster ID found, clusters are 1 to this value
+    int getMaxClusterID() const { return static_cast<int>(_offsets.size()) - 2; }
+
+    //! Number of strips of a cluster, 0 for IDs without strips
+    std::size_t getClusterSize(int clusterID) const {
+      return _offsets[clusterID + 1] - _offsets[clusterID];
+    }
+
+    //! Strip indices of a cluster, getClusterSize() of them
+    const std::size_t *getStrips(int clusterID) const {
+      return _strips.data() + _offsets[clusterID];
+    }
+
+    //! Add the strips of a cluster as pixels
+    /*! The strip index becomes the y coordinate if @a stripsAlongY,
+     *  otherwise the x coordinate, the other one is 0.
+     *
+     *  @param clusterID cluster between 1 and getMaxClusterID()
+     *  @param signals signal of every strip, indexed like the
+     *  vector given to assemble()
+     *  @param stripsAlongY true if x is the non-sensitive axis
+     *  @param cluster the cluster to fill
+     */
+    void fillCluster(int clusterID, std::vector<float> const &signals, bool stripsAlongY,
+                     EUTelSparseClusterImpl<EUTelGenericSparsePixel> &cluster) const;
+
+  private:
+    //! Start of the strips of each ID in _strips, one more than IDs
+    std::vector<std::size_t> _offsets;
+
+    //! Strips of all clusters, sorted by ID
+    std::vector<std::size_t> _strips;
+
+    //! Next free position per ID while filling
+    std::vector<std::size_t> _fill;
+  };
+}
+#endif
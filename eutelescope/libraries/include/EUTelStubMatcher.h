@@ -0,0 +1,66 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSTUBMATCHER_H
+#define EUTELSTUBMATCHER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Finds the pairs of hits on the two sensors of a CMS module forming a stub
+  /*! Two hits form a stub if their cluster centres differ by less
+   *  than the maximum residual in x and in y, which is what
+   *  CMSStubGenerator used to check for every pair of hits.
+   *
+   *  The hits of the second sensor are sorted along the axis on which
+   *  they are spread out most (the sensitive axis of the strips), so
+   *  that the candidates for a hit of the first sensor are found with
+   *  a binary search and only a window of hits has to be compared.
+   */
+  class EUTelStubMatcher {
+
+  public:
+    //! Cluster of a hit, decoded once per event
+    struct Hit {
+      float x;
+      float y;
+      float q;
+    };
+
+    EUTelStubMatcher();
+
+    //! The stub condition for a single pair
+    static bool isStub(Hit const &hit1, Hit const &hit2, float maxResidual);
+
+    //! Set the hits of the second sensor
+    void setSecondPlane(std::vector<Hit> const &hits);
+
+    //! Find the hits of the second sensor forming a stub with hit1
+    /*! @param hit1 hit of the first sensor
+     *  @param maxResidual maximum distance in x and y
+     *  @param matches filled with the indices into the vector given to
+     *  setSecondPlane(), in increasing order
+     */
+    void findMatches(Hit const &hit1, float maxResidual, std::vector<std::size_t> &matches) const;
+
+  private:
+    //! Hits as given
+    std::vector<Hit> _hits;
+
+    //! Coordinate along the sort axis and index of every hit, sorted
+    std::vector<std::pair<float, std::size_t>> _sorted;
+
+    //! Sort axis, x or y
+    bool _sortByX;
+  };
+}
+#endif
@@ -0,0 +1,60 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTHREADSAFEPROCESSOR_H
+#define EUTELTHREADSAFEPROCESSOR_H 1
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+
+namespace eutelescope {
+
+  //! Opt-in of a Marlin processor to run on several events at a time
+  /*! A processor derives from this class next to marlin::Processor.
+   *  EUTelPipelineDriver then calls processEventConcurrently() on its
+   *  worker threads for several events at the same time, if the
+   *  processor is among the first ones of the job and isThreadSafe()
+   *  returns true. Marlin itself keeps calling processEvent(), which
+   *  usually forwards to processEventConcurrently() with thread 0.
+   *
+   *  processEventConcurrently() only works on the event it gets and on
+   *  the state of its thread. It must not
+   *  - change any other member, counters are kept per thread and
+   *    summed up in end(),
+   *  - print with streamlog: Marlin changes its level from processor
+   *    to processor without locking,
+   *  - use isFirstEvent(), setReturnValue() or the event seeder, these
+   *    are only maintained for the processors Marlin runs.
+   *  It may throw marlin::SkipEventException as usual.
+   *
+   *  init(), processRunHeader(), check() and end() are called in the
+   *  main thread with no event being processed, check() in the order
+   *  of the events.
+   */
+  class EUTelThreadSafeProcessor {
+
+  public:
+    virtual ~EUTelThreadSafeProcessor();
+
+    //! Whether processEventConcurrently() may run for several events at a time
+    /*! Asked once after init(), so it may depend on the parameters.
+     */
+    virtual bool isThreadSafe() const = 0;
+
+    //! Set up the state of the worker threads
+    /*! Called after init() and before the first event.
+     *  @param nThreads number of threads, processEventConcurrently() is
+     *  called with a thread index in [0, nThreads)
+     */
+    virtual void prepareThreads(unsigned int nThreads) = 0;
+
+    //! Process an event on a worker thread
+    virtual void processEventConcurrently(EVENT::LCEvent *event, unsigned int thread) = 0;
+  };
+}
+#endif
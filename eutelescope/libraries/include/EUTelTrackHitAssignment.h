@@ -0,0 +1,71 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRACKHITASSIGNMENT_H
+#define EUTELTRACKHITASSIGNMENT_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! One to one association of tracks and hits
+  /*! Given the distances between nTracks tracks and nHits hits, where
+   *  pairs outside of the association gate are marked by a negative
+   *  distance, the association with the largest number of pairs is
+   *  found and among those the one with the smallest total distance.
+   *  No hit is shared between tracks.
+   *
+   *  This is a rectangular assignment problem. Every track gets one
+   *  extra "not associated" column of cost zero, a gated pair costs
+   *  its distance minus a constant larger than any possible total
+   *  distance, so that one more pair always wins over a shorter
+   *  total. The problem is then solved with the shortest augmenting
+   *  path version of the Hungarian method (Jonker-Volgenant style
+   *  potentials) in O(nTracks^2 (nTracks + nHits)).
+   *
+   *  The buffers are kept between calls, so that an instance can be
+   *  reused event after event without allocations.
+   */
+  class EUTelTrackHitAssignment {
+
+  public:
+    EUTelTrackHitAssignment();
+
+    //! Find the best association
+    /*! @param distances nTracks x nHits distances, row by row, negative
+     *  for pairs which may not be associated
+     */
+    void solve(std::vector<double> const &distances, std::size_t nTracks, std::size_t nHits);
+
+    //! Hit associated to a track, -1 if none
+    int getHit(std::size_t track) const { return _trackToHit[track]; }
+
+    //! Number of associated pairs
+    std::size_t getNAssociations() const { return _nAssociations; }
+
+    //! Sum of the distances of the associated pairs
+    double getTotalDistance() const { return _totalDistance; }
+
+  private:
+    std::vector<int> _trackToHit;
+    std::size_t _nAssociations;
+    double _totalDistance;
+
+    //! Solver workspace, the columns are the hits followed by one dummy per track
+    std::vector<double> _cost;
+    std::vector<double> _rowPotential;
+    std::vector<double> _columnPotential;
+    std::vector<double> _minSlack;
+    std::vector<std::size_t> _columnRow;
+    std::vector<std::size_t> _previousColumn;
+    std::vector<char> _visited;
+  };
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELVIRTUALDUT_H
+#define EUTELVIRTUALDUT_H 1
+
+// system includes <>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cmath>
+
+namespace eutelescope {
+
+  //! Geometry of a virtual DUT placed between two real sensors
+  /*! A module of two sensors (like the CMS CBC modules) can be fitted
+   *  as a single virtual plane in the middle; the track points on the
+   *  real sensors are then recovered from the fitted point on the
+   *  virtual plane and the track direction.
+   */
+  namespace VirtualDUT {
+
+    //! Cosine of the angle between two vectors
+    inline double cosAlpha(Eigen::Vector3d const &vec1, Eigen::Vector3d const &vec2) {
+      return vec1.dot(vec2) / (vec1.norm() * vec2.norm());
+    }
+
+    //! Point of a track on a plane parallel to the virtual DUT
+    /*! @param track direction of the track, pointing from the virtual
+     *  hit towards the plane
+     *  @param normal normal of the virtual DUT, pointing towards the
+     *  plane
+     *  @param virtualHit track point on the virtual DUT
+     *  @param distance distance of the plane from the virtual DUT
+     *  along the normal, only the absolute value is used
+     */
+    inline Eigen::Vector3d hitPosition(Eigen::Vector3d const &track, Eigen::Vector3d const &normal,
+                                       Eigen::Vector3d const &virtualHit, double distance) {
+      return virtualHit + track.normalized() * (std::fabs(distance) / cosAlpha(track, normal));
+    }
+  }
+}
+#endif
@@ -0,0 +1,139 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELZSFIXEDFRAMEFINDER_H
+#define EUTELZSFIXEDFRAMEFINDER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Fixed frame cluster finding on zero suppressed data
+  /*! This is the cluster search of the zsFixedFrameClustering in
+   *  EUTelClusteringProcessor, working on the pixel status and noise
+   *  vectors of one sensor.
+   *
+   *  Pixels above the seed cut and with good status are seed
+   *  candidates. They are taken by decreasing signal, candidates with
+   *  the same signal in reverse order of arrival as the former
+   *  std::multimap did. Hot pixels are not used as seeds. For each
+   *  seed which is still good the xClusterSize x yClusterSize frame
+   *  around it is collected; if the sum of the signals passes the
+   *  cluster cut, the good pixels of the frame are marked as hit.
+   *  Good pixels of a frame without signal are marked as missing.
+   *
+   *  All buffers are allocated once per sensor: the signal map is
+   *  only reset at the pixels which fired, the seed candidates are
+   *  kept in a heap and taken from it one at a time, and the frame is
+   *  collected in buffers of the cluster size. Nothing is allocated
+   *  per event once the buffers have grown to the largest event.
+   */
+  class EUTelZSFixedFrameFinder {
+
+  public:
+    //! A found cluster, its charges are in getCharges()
+    struct Cluster {
+      int seedX;
+      int seedY;
+      //! Frame partly outside of the sensor
+      bool border;
+      //! Frame with pixels which are not good
+      bool incomplete;
+      //! Frame with pixels already in another cluster
+      bool merged;
+      std::size_t firstCharge;
+    };
+
+    //! Status values of good, hit and missing pixels
+    EUTelZSFixedFrameFinder(int goodPixel, int hitPixel, int missingPixel);
+
+    //! Set the pixel matrix as the matrix decoder describes it
+    /*! Pixel indices are x - minX + (y - minY) * nPixelX as with
+     *  EUTelMatrixDecoder. This also forgets the hot pixels.
+     */
+    void configure(int minX, int minY, int nPixelX, int nPixelY);
+
+    //! Whether configure() was called with this matrix
+    bool isConfigured(int minX, int minY, int nPixelX, int nPixelY) const;
+
+    //! Mark the pixel with this index as hot, it is never a seed
+    void setHotPixel(int index);
+
+    //! Set the frame size
+    /*! Cheap if the size does not change, so it may be called every
+     *  event.
+     *  @throw std::invalid_argument unless both sizes are positive and
+     *  odd, the seed is in the center of the frame
+     */
+    void setClusterSize(int xClusterSize, int yClusterSize);
+
+    //! Add a pixel of the current event
+    /*! Pixels outside of the configured matrix are ignored.
+     *  @return false for those
+     */
+    bool addPixel(int x, int y, float signal, std::vector<short> &status,
+                  std::vector<float> const &noise, float seedCut);
+
+    //! Find the clusters of the current event and start a new one
+    /*! @param maxX, maxY the last pixel of the sensor, frames reaching
+     *  beyond it or below 0 are border clusters
+     */
+    void findClusters(std::vector<short> &status,
+                      std::vector<float> const &noise, float clusterCut,
+                      int maxX, int maxY);
+
+    //! Clusters of the last findClusters(), in order of creation
+    const std::vector<Cluster> &getClusters() const { return _clusters; }
+
+    //! Frame charges of all clusters, row by row, xClusterSize x
+    //! yClusterSize per cluster, see Cluster::firstCharge
+    const std::vector<float> &getCharges() const { return _charges; }
+
+    //! Number of seed candidates of the last event
+    std::size_t getNSeedCandidates() const { return _nSeedCandidates; }
+
+  private:
+    struct SeedCandidate {
+      float signal;
+      int order;
+      int index;
+    };
+
+    int _goodPixel;
+    int _hitPixel;
+    int _missingPixel;
+
+    int _minX;
+    int _minY;
+    int _nPixelX;
+    int _nPixelY;
+    int _xClusterSize;
+    int _yClusterSize;
+
+    //! Signal of the fired pixels of the current event, zero elsewhere
+    std::vector<float> _signal;
+    std::vector<int> _fired;
+    std::vector<char> _hot;
+
+    //! Seed candidates of the current event, hot pixels left out
+    std::vector<SeedCandidate> _seeds;
+    //! Candidates of the current event, hot pixels included
+    std::size_t _nCandidates;
+    std::size_t _nSeedCandidates;
+
+    //! Frame buffers, sized by the cluster size
+    std::vector<float> _frameCharges;
+    std::vector<int> _frameIndices;
+
+    std::vector<Cluster> _clusters;
+    std::vector<float> _charges;
+  };
+}
+#endif
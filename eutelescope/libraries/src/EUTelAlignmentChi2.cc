@@ -0,0 +1,110 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAlignmentChi2.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! Hit pairs summed up in one go, also the unit of work for the threads
+  std::size_t const blockSize = 4096;
+
+  //! Fewer blocks are summed in the calling thread, waking the workers
+  //! would take about as long
+  std::size_t const minParallelBlocks = 4;
+}
+
+EUTelAlignmentChi2::EUTelAlignmentChi2(int nThreads)
+    : _measuredX(), _measuredY(), _predictedX(), _predictedY(),
+      _pool(new Utility::WorkerPool(nThreads)), _blockSums() {}
+
+void EUTelAlignmentChi2::setNThreads(int nThreads) {
+  _pool.reset(new Utility::WorkerPool(nThreads));
+}
+
+void EUTelAlignmentChi2::addHitPair(double measuredX, double measuredY,
+                                    double predictedX, double predictedY) {
+  _measuredX.push_back(measuredX);
+  _measuredY.push_back(measuredY);
+  _predictedX.push_back(predictedX);
+  _predictedY.push_back(predictedY);
+}
+
+void EUTelAlignmentChi2::reserve(std::size_t n) {
+  _measuredX.reserve(n);
+  _measuredY.reserve(n);
+  _predictedX.reserve(n);
+  _predictedY.reserve(n);
+}
+
+void EUTelAlignmentChi2::clear() {
+  _measuredX.clear();
+  _measuredY.clear();
+  _predictedX.clear();
+  _predictedY.clear();
+}
+
+double EUTelAlignmentChi2::operator()(double const *par) const {
+  return evaluate(par[0], par[1], par[2], par[3], par[4], par[5]);
+}
+
+double EUTelAlignmentChi2::partialSum(std::size_t begin, std::size_t end,
+                                      double const *rot, double offX,
+                                      double offY, double chi2Cut) const {
+  double const *mx = _measuredX.data();
+  double const *my = _measuredY.data();
+  double const *px = _predictedX.data();
+  double const *py = _predictedY.data();
+
+  double sum = 0.0;
+  for(std::size_t i = begin; i < end; ++i) {
+    double const dx = rot[0] * mx[i] + rot[1] * my[i] + offX - px[i];
+    double const dy = rot[2] * mx[i] + rot[3] * my[i] + offY - py[i];
+    double const distance = (dx * dx + dy * dy) / 100;
+    if(chi2Cut == 0.0 || distance < chi2Cut) sum += distance;
+  }
+  return sum;
+}
+
+double EUTelAlignmentChi2::evaluate(double offX, double offY, double thetaX,
+                                    double thetaY, double thetaZ,
+                                    double chi2Cut) const {
+
+  //the rotation does not depend on the hit, only its 2x2 part in the
+  //plane is needed
+  double const rot[4] = {
+      std::cos(thetaY) * std::cos(thetaZ),
+      -std::sin(thetaX) * std::sin(thetaY) * std::cos(thetaZ) + std::cos(thetaX) * std::sin(thetaZ),
+      -std::cos(thetaY) * std::sin(thetaZ),
+      std::sin(thetaX) * std::sin(thetaY) * std::sin(thetaZ) + std::cos(thetaX) * std::cos(thetaZ)};
+
+  std::size_t const nBlocks = (size() + blockSize - 1) / blockSize;
+  _blockSums.resize(nBlocks);
+
+  auto sumBlocks = [&](std::size_t first, std::size_t last, unsigned int) {
+    for(std::size_t b = first; b < last; ++b) {
+      std::size_t const end = std::min(size(), (b + 1) * blockSize);
+      _blockSums[b] = partialSum(b * blockSize, end, rot, offX, offY, chi2Cut);
+    }
+  };
+  if(nBlocks < minParallelBlocks) {
+    sumBlocks(0, nBlocks, 0);
+  } else {
+    _pool->parallelFor(nBlocks, sumBlocks);
+  }
+
+  double chi2 = 0.0;
+  for(double blockSum : _blockSums) chi2 += blockSum;
+  return chi2;
+}
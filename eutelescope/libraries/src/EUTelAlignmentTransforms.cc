@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAlignmentTransforms.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! c = a b for 3 x 3 matrices, row by row
+  void multiply(const double a[9], const double b[9], double c[9]) {
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        c[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] +
+                       a[3 * i + 2] * b[6 + j];
+      }
+    }
+  }
+}
+
+EUTelAlignmentTransforms::EUTelAlignmentTransforms() : _transforms() {}
+
+void EUTelAlignmentTransforms::clear() { _transforms.clear(); }
+
+void EUTelAlignmentTransforms::set(int sensorID, const double center[3],
+                                   double xOffset, double yOffset,
+                                   double zOffset, double alpha, double beta,
+                                   double gamma) {
+  if (sensorID < 0)
+    return;
+  if (static_cast<std::size_t>(sensorID) >= _transforms.size()) {
+    _transforms.resize(sensorID + 1, Transform{false, {}, {}});
+  }
+
+  const double ca = std::cos(-alpha), sa = std::sin(-alpha);
+  const double cb = std::cos(-beta), sb = std::sin(-beta);
+  const double cg = std::cos(-gamma), sg = std::sin(-gamma);
+  const double rotX[9] = {1., 0., 0., 0., ca, -sa, 0., sa, ca};
+  const double rotY[9] = {cb, 0., sb, 0., 1., 0., -sb, 0., cb};
+  const double rotZ[9] = {cg, -sg, 0., sg, cg, 0., 0., 0., 1.};
+  double rotYX[9];
+  double rot[9];
+  multiply(rotY, rotX, rotYX);
+  multiply(rotZ, rotYX, rot);
+
+  const double offset[3] = {xOffset, yOffset, zOffset};
+  Transform &transform = _transforms[sensorID];
+  transform.valid = true;
+  for (int i = 0; i < 3; ++i) {
+    // t = c - R c - offset
+    double shift = center[i] - offset[i];
+    for (int j = 0; j < 3; ++j) {
+      transform.forward[4 * i + j] = rot[3 * i + j];
+      transform.inverse[4 * i + j] = rot[3 * j + i];
+      shift -= rot[3 * i + j] * center[j];
+    }
+    transform.forward[4 * i + 3] = shift;
+  }
+  for (int i = 0; i < 3; ++i) {
+    // -R^T t
+    transform.inverse[4 * i + 3] = -(rot[i] * transform.forward[3] +
+                                     rot[3 + i] * transform.forward[7] +
+                                     rot[6 + i] * transform.forward[11]);
+  }
+}
+
+bool EUTelAlignmentTransforms::has(int sensorID) const {
+  return sensorID >= 0 &&
+         static_cast<std::size_t>(sensorID) < _transforms.size() &&
+         _transforms[sensorID].valid;
+}
+
+const double *EUTelAlignmentTransforms::getMatrix(int sensorID,
+                                                  bool inverse) const {
+  if (!has(sensorID))
+    return nullptr;
+  return inverse ? _transforms[sensorID].inverse
+                 : _transforms[sensorID].forward;
+}
+
+void EUTelAlignmentTransforms::apply(int sensorID, const double *input,
+                                     double *output, std::size_t n,
+                                     bool inverse) const {
+  const double *m = getMatrix(sensorID, inverse);
+  if (m == nullptr) {
+    if (output != input)
+      std::copy(input, input + 3 * n, output);
+    return;
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    const double x = input[3 * i];
+    const double y = input[3 * i + 1];
+    const double z = input[3 * i + 2];
+    output[3 * i] = m[0] * x + m[1] * y + m[2] * z + m[3];
+    output[3 * i + 1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+    output[3 * i + 2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+  }
+}
@@ -0,0 +1,150 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAsyncLCWriter.h"
+
+// lcio includes <.h>
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCParameters.h>
+#include <IMPL/LCCollectionVec.h>
+#include <LCIOTypes.h>
+#include <lcio.h>
+
+// system includes <>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace eutelescope;
+
+namespace {
+  void copyParameters(EVENT::LCParameters const &from, EVENT::LCParameters &to) {
+    EVENT::StringVec keys;
+    from.getIntKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::IntVec values;
+      to.setValues(key, from.getIntVals(key, values));
+    }
+    keys.clear();
+    from.getFloatKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::FloatVec values;
+      to.setValues(key, from.getFloatVals(key, values));
+    }
+    keys.clear();
+    from.getStringKeys(keys);
+    for(auto const &key : keys) {
+      EVENT::StringVec values;
+      to.setValues(key, from.getStringVals(key, values));
+    }
+  }
+}
+
+EUTelAsyncLCWriter::EUTelAsyncLCWriter(IO::LCWriter *writer, std::size_t capacity)
+    : _writer(writer), _queue(capacity), _errorMutex(), _error(), _errorReported(false), _thread() {
+  _thread = std::thread(&EUTelAsyncLCWriter::run, this);
+}
+
+EUTelAsyncLCWriter::~EUTelAsyncLCWriter() {
+  _queue.close();
+  if(_thread.joinable()) _thread.join();
+}
+
+void EUTelAsyncLCWriter::writeRunHeader(EVENT::LCRunHeader const *header) {
+  Record record;
+  record.runHeader = copyRunHeader(header);
+  push(std::move(record));
+}
+
+void EUTelAsyncLCWriter::writeEvent(std::unique_ptr<IMPL::LCEventImpl> event) {
+  Record record;
+  record.event = std::move(event);
+  push(std::move(record));
+}
+
+void EUTelAsyncLCWriter::finish() {
+  _queue.close();
+  if(_thread.joinable()) _thread.join();
+  rethrow();
+}
+
+std::unique_ptr<IMPL::LCEventImpl> EUTelAsyncLCWriter::takeEvent(EVENT::LCEvent *event) {
+  auto copy = std::make_unique<IMPL::LCEventImpl>();
+  copy->setRunNumber(event->getRunNumber());
+  copy->setEventNumber(event->getEventNumber());
+  copy->setDetectorName(event->getDetectorName());
+  copy->setTimeStamp(event->getTimeStamp());
+  copy->setWeight(event->getWeight());
+  copyParameters(event->getParameters(), copy->parameters());
+
+  for(auto const &name : *event->getCollectionNames()) {
+    if(event->getCollection(name)->isTransient()) continue;
+    //takeCollection() marks the collection transient, so that the
+    //event it came from does not write it any more, the new owner has to
+    auto collection = static_cast<IMPL::LCCollectionVec *>(event->takeCollection(name));
+    collection->setTransient(false);
+    copy->addCollection(collection, name);
+  }
+  return copy;
+}
+
+bool EUTelAsyncLCWriter::hasReentrantSIO() {
+#ifdef LCIO_VERSION_GE
+#if LCIO_VERSION_GE(2, 13)
+  return true;
+#endif
+#endif
+  return false;
+}
+
+std::unique_ptr<IMPL::LCRunHeaderImpl> EUTelAsyncLCWriter::copyRunHeader(EVENT::LCRunHeader const *header) {
+  auto copy = std::make_unique<IMPL::LCRunHeaderImpl>();
+  copy->setRunNumber(header->getRunNumber());
+  copy->setDetectorName(header->getDetectorName());
+  copy->setDescription(header->getDescription());
+  for(auto const &name : *header->getActiveSubdetectors()) copy->addActiveSubdetector(name);
+  copyParameters(header->getParameters(), copy->parameters());
+  return copy;
+}
+
+void EUTelAsyncLCWriter::run() {
+  Record record;
+  while(_queue.pop(record)) {
+    {
+      //after an error the records are only dropped, so that the
+      //event loop does not block on a full queue
+      std::lock_guard<std::mutex> lock(_errorMutex);
+      if(_error) continue;
+    }
+    try {
+      if(record.runHeader) _writer->writeRunHeader(record.runHeader.get());
+      if(record.event) _writer->writeEvent(record.event.get());
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(_errorMutex);
+      _error = std::current_exception();
+    }
+    record = Record();
+  }
+}
+
+void EUTelAsyncLCWriter::push(Record record) {
+  rethrow();
+  _queue.push(std::move(record));
+}
+
+void EUTelAsyncLCWriter::rethrow() {
+  std::lock_guard<std::mutex> lock(_errorMutex);
+  if(_error && !_errorReported) {
+    //the writer is not usable any more, further records are dropped
+    _errorReported = true;
+    _queue.close();
+    std::rethrow_exception(_error);
+  }
+}
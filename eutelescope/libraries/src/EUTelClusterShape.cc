@@ -0,0 +1,98 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterShape.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelClusterShape::EUTelClusterShape()
+    : _nPixels(0), _xMin(0), _xMax(0), _yMin(0), _yMax(0), _stride(0),
+      _emptyMiddle(false), _pixels(), _fired(), _reached(), _stack() {}
+
+void EUTelClusterShape::clear() {
+  _nPixels = 0;
+  _xMin = _xMax = _yMin = _yMax = 0;
+  _stride = 0;
+  _emptyMiddle = false;
+  _pixels.clear();
+}
+
+void EUTelClusterShape::addPixel(int x, int y) {
+  if (_nPixels == 0) {
+    _xMin = _xMax = x;
+    _yMin = _yMax = y;
+  } else {
+    _xMin = std::min(_xMin, x);
+    _xMax = std::max(_xMax, x);
+    _yMin = std::min(_yMin, y);
+    _yMax = std::max(_yMax, y);
+  }
+  _pixels.push_back(x);
+  _pixels.push_back(y);
+  ++_nPixels;
+  _stride = 0;
+}
+
+void EUTelClusterShape::build() {
+  _emptyMiddle = false;
+  if (_nPixels == 0) {
+    _stride = 0;
+    return;
+  }
+
+  _stride = static_cast<std::size_t>(_xMax - _xMin) + 3;
+  const std::size_t height = static_cast<std::size_t>(_yMax - _yMin) + 3;
+  const std::size_t nBits = _stride * height;
+  const std::size_t nWords = (nBits + 63) / 64;
+  _fired.assign(nWords, 0);
+  _reached.assign(nWords, 0);
+
+  std::size_t nFired = 0;
+  for (std::size_t i = 0; i < _pixels.size(); i += 2) {
+    const std::size_t pixel = bit(_pixels[i], _pixels[i + 1]);
+    if (!test(_fired, pixel)) {
+      set(_fired, pixel);
+      ++nFired;
+    }
+  }
+
+  // the corner of the grown box never fires, everything reached from
+  // it is outside of the cluster
+  std::size_t nReached = 1;
+  set(_reached, 0);
+  _stack.assign(1, 0);
+  while (!_stack.empty()) {
+    const std::size_t pixel = _stack.back();
+    _stack.pop_back();
+    const std::size_t column = pixel % _stride;
+    const std::size_t neighbours[4] = {
+        column > 0 ? pixel - 1 : nBits,
+        column + 1 < _stride ? pixel + 1 : nBits,
+        pixel >= _stride ? pixel - _stride : nBits, pixel + _stride};
+    for (std::size_t neighbour : neighbours) {
+      if (neighbour >= nBits || test(_fired, neighbour) ||
+          test(_reached, neighbour))
+        continue;
+      set(_reached, neighbour);
+      ++nReached;
+      _stack.push_back(neighbour);
+    }
+  }
+  _emptyMiddle = nFired + nReached < nBits;
+}
+
+bool EUTelClusterShape::isFired(int x, int y) const {
+  if (_stride == 0 || x < _xMin || x > _xMax || y < _yMin || y > _yMax)
+    return false;
+  return test(_fired, bit(x, y));
+}
@@ -0,0 +1,107 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelDUTHitMatcher.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelDUTHitMatcher::EUTelDUTHitMatcher()
+    : _distMax(0.), _hits(), _fits(), _grid(), _candidates(), _matches(),
+      _hitMatched(), _nMatches(0) {}
+
+void EUTelDUTHitMatcher::reset(double distMax) {
+  _distMax = distMax;
+  _hits.clear();
+  _fits.clear();
+}
+
+void EUTelDUTHitMatcher::addHit(double x, double y) {
+  _hits.push_back(Point{-1, -1, x, y});
+}
+
+void EUTelDUTHitMatcher::addFit(int track, int fit, double x, double y) {
+  _fits.push_back(Point{track, fit, x, y});
+}
+
+bool EUTelDUTHitMatcher::cell(double x, double y, Cell &result) const {
+  double const cellX = std::floor(x / _distMax);
+  double const cellY = std::floor(y / _distMax);
+  //far beyond any sensor, also catches non finite positions
+  if(!(std::fabs(cellX) < 1e15 && std::fabs(cellY) < 1e15)) return false;
+  result = Cell(static_cast<long long>(cellX), static_cast<long long>(cellY));
+  return true;
+}
+
+void EUTelDUTHitMatcher::match(int nTracks, bool greedy) {
+  _matches.assign(static_cast<std::size_t>(std::max(nTracks, 0)), Match{-1, -1, 0.});
+  _hitMatched.assign(_hits.size(), 0);
+  _candidates.clear();
+  _grid.clear();
+  _nMatches = 0;
+
+  if(!(_distMax > 0.) || !std::isfinite(_distMax)) return;
+  double const distMax2 = _distMax * _distMax;
+
+  Cell hitCell(0, 0);
+  for(std::size_t hit = 0; hit < _hits.size(); ++hit) {
+    if(cell(_hits[hit].x, _hits[hit].y, hitCell)) _grid.push_back(std::make_pair(hitCell, static_cast<int>(hit)));
+  }
+  std::sort(_grid.begin(), _grid.end());
+
+  auto const byCell = [](std::pair<Cell, int> const &entry, Cell const &value) { return entry.first < value; };
+
+  //all pairs closer than distMax, they are in the neighbouring cells
+  Cell fitCell(0, 0);
+  for(Point const &fit : _fits) {
+    if(fit.track < 0 || fit.track >= nTracks) continue;
+    if(!cell(fit.x, fit.y, fitCell)) continue;
+    for(long long cellX = fitCell.first - 1; cellX <= fitCell.first + 1; ++cellX) {
+      Cell const last(cellX, fitCell.second + 1);
+      for(auto entry = std::lower_bound(_grid.begin(), _grid.end(), Cell(cellX, fitCell.second - 1), byCell);
+          entry != _grid.end() && !(last < entry->first); ++entry) {
+        Point const &hit = _hits[entry->second];
+        double const dx = hit.x - fit.x;
+        double const dy = hit.y - fit.y;
+        double const distance2 = dx * dx + dy * dy;
+        if(distance2 < distMax2) _candidates.push_back(Candidate{distance2, fit.track, fit.fit, entry->second});
+      }
+    }
+  }
+
+  if(greedy) {
+    //track by track, each one takes its closest free hit
+    std::sort(_candidates.begin(), _candidates.end(), [](Candidate const &a, Candidate const &b) {
+      if(a.track != b.track) return a.track < b.track;
+      if(a.distance2 != b.distance2) return a.distance2 < b.distance2;
+      if(a.fit != b.fit) return a.fit < b.fit;
+      return a.hit < b.hit;
+    });
+  } else {
+    //closest pairs first, whatever their track
+    std::sort(_candidates.begin(), _candidates.end(), [](Candidate const &a, Candidate const &b) {
+      if(a.distance2 != b.distance2) return a.distance2 < b.distance2;
+      if(a.track != b.track) return a.track < b.track;
+      if(a.fit != b.fit) return a.fit < b.fit;
+      return a.hit < b.hit;
+    });
+  }
+
+  for(Candidate const &candidate : _candidates) {
+    Match &match = _matches[candidate.track];
+    if(match.hit != -1 || _hitMatched[candidate.hit]) continue;
+    match = Match{candidate.fit, candidate.hit, candidate.distance2};
+    _hitMatched[candidate.hit] = 1;
+    ++_nMatches;
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelDigitalFixedFrameFinder.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelDigitalFixedFrameFinder::EUTelDigitalFixedFrameFinder()
+    : _minX(0), _minY(0), _maxX(-1), _maxY(-1), _nY(0), _labels(), _fired(),
+      _seeds(), _clusters(), _pixels() {}
+
+void EUTelDigitalFixedFrameFinder::configure(int minX, int minY, int maxX, int maxY) {
+  _minX = minX;
+  _minY = minY;
+  _maxX = std::max(maxX, minX - 1);
+  _maxY = std::max(maxY, minY - 1);
+  _nY = static_cast<std::size_t>(_maxY - _minY + 1);
+  _labels.assign(static_cast<std::size_t>(_maxX - _minX + 1) * _nY, kEmpty);
+  _fired.clear();
+}
+
+bool EUTelDigitalFixedFrameFinder::isConfigured(int minX, int minY, int maxX, int maxY) const {
+  return !_labels.empty() && minX == _minX && minY == _minY && maxX == _maxX && maxY == _maxY;
+}
+
+void EUTelDigitalFixedFrameFinder::setHotPixel(int index) {
+  int const nX = _maxX - _minX + 1;
+  if(index < 0 || nX <= 0 || index / nX > _maxY - _minY) return;
+  _labels[position(index % nX + _minX, index / nX + _minY)] = kHot;
+}
+
+void EUTelDigitalFixedFrameFinder::addPixel(int x, int y) {
+  if(x < _minX || x > _maxX || y < _minY || y > _maxY) return;
+  std::size_t const pos = position(x, y);
+  if(_labels[pos] != kEmpty) return;
+  _labels[pos] = kFired;
+  _fired.push_back(pos);
+}
+
+void EUTelDigitalFixedFrameFinder::findClusters(int xClusterSize, int yClusterSize) {
+  _clusters.clear();
+  _pixels.clear();
+  _seeds.clear();
+
+  int const stepX = xClusterSize / 2;
+  int const stepY = yClusterSize / 2;
+
+  //seed candidates with their neighbour counts, the frame around a
+  //candidate only counts if it lies completely at positive coordinates
+  for(std::size_t pos : _fired) {
+    int const x = static_cast<int>(pos / _nY) + _minX;
+    int const y = static_cast<int>(pos % _nY) + _minY;
+
+    int nPixels = 0;
+    if(x >= stepX && y >= stepY) {
+      for(int ix = std::max(x - stepX, 1); ix <= x + stepX; ++ix) {
+        for(int iy = std::max(y - stepY, 1); iy <= y + stepY; ++iy) {
+          if(label(ix, iy) == kFired) ++nPixels;
+        }
+      }
+    }
+
+    //direct neighbours along x and along y, the pixel itself included
+    int neighbours = 0;
+    if(nPixels > 1) {
+      if(x >= 1) {
+        for(int ix = x - 1; ix <= x + 1; ++ix) {
+          if(label(ix, y) == kFired) ++neighbours;
+        }
+      }
+      if(y >= 1) {
+        for(int iy = y - 1; iy <= y + 1; ++iy) {
+          if(label(x, iy) == kFired) ++neighbours;
+        }
+      }
+    }
+    _seeds.push_back(Seed{x, y, neighbours, nPixels});
+  }
+
+  std::sort(_seeds.begin(), _seeds.end(), [](Seed const &a, Seed const &b) {
+    if(a.neighbours != b.neighbours) return a.neighbours > b.neighbours;
+    if(a.nPixels != b.nPixels) return a.nPixels > b.nPixels;
+    if(a.x != b.x) return a.x > b.x;
+    return a.y > b.y;
+  });
+
+  for(Seed const &seed : _seeds) {
+    if(label(seed.x, seed.y) != kFired) continue;
+    if(seed.x < stepX || seed.y < stepY) continue;
+
+    std::size_t const firstPixel = _pixels.size();
+    for(int ix = seed.x - stepX; ix <= seed.x + stepX; ++ix) {
+      for(int iy = seed.y - stepY; iy <= seed.y + stepY; ++iy) {
+        if(label(ix, iy) != kFired) continue;
+        _labels[position(ix, iy)] = kUsed;
+        _pixels.push_back(Pixel{ix, iy});
+      }
+    }
+    _clusters.push_back(Cluster{seed.x, seed.y, firstPixel, _pixels.size() - firstPixel});
+  }
+
+  //only the pixels of this frame have to be cleared
+  for(std::size_t pos : _fired) _labels[pos] = kEmpty;
+  _fired.clear();
+}
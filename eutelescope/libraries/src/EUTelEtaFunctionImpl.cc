@@ -150,6 +150,10 @@ double EUTelEtaFunctionImpl::getEtaFromCoG(double x) const {
   return *etaLeft + (*etaLeft - *etaRight) / (*xLeft - *xRight) * (x - *xLeft);
 }
 
+EUTelEtaLookup EUTelEtaFunctionImpl::makeLookup(unsigned int nGrid) const {
+  return EUTelEtaLookup(getBinCenterVector(), getEtaValueVector(), nGrid);
+}
+
 vector<double>::const_iterator
 EUTelEtaFunctionImpl::getCoGBeginConstIterator() const {
   return _doubleVec.begin();
@@ -0,0 +1,71 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelEtaLookup.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelEtaLookup::EUTelEtaLookup(std::vector<double> const &binCenters,
+                               std::vector<double> const &etaValues,
+                               unsigned int nGrid)
+    : _xMin(0), _xMax(0), _step(0), _invStep(0), _lastCell(0),
+      _maxCellIncrement(0), _grid() {
+
+  if(binCenters.empty() || binCenters.size() != etaValues.size()) {
+    throw InvalidParameterException("EUTelEtaLookup needs as many eta values as bin centers");
+  }
+
+  _xMin = binCenters.front();
+  _xMax = binCenters.back();
+
+  //a single bin or a degenerate range is a constant function
+  if(binCenters.size() == 1 || !(_xMax > _xMin)) {
+    _grid.assign(2, etaValues.front());
+    _grid.back() = etaValues.back();
+    _xMax = _xMin;
+    return;
+  }
+
+  if(nGrid == 0) nGrid = defaultOversampling * static_cast<unsigned int>(binCenters.size());
+  nGrid = std::max(nGrid, 2u);
+
+  _step = (_xMax - _xMin) / (nGrid - 1);
+  _invStep = 1. / _step;
+  _lastCell = nGrid - 2;
+  _grid.resize(nGrid);
+
+  //walk the grid and the bin centers together, evaluating the same
+  //linear interpolation getEtaFromCoG uses
+  std::size_t right = 1;
+  for(unsigned int i = 0; i < nGrid; ++i) {
+    double const x = (i == nGrid - 1) ? _xMax : _xMin + i * _step;
+    while(right < binCenters.size() - 1 && binCenters[right] < x) ++right;
+    std::size_t const left = right - 1;
+
+    if(x <= binCenters.front()) {
+      _grid[i] = etaValues.front();
+    } else if(x >= binCenters.back()) {
+      _grid[i] = etaValues.back();
+    } else {
+      _grid[i] = etaValues[left] + (etaValues[left] - etaValues[right]) /
+                                       (binCenters[left] - binCenters[right]) *
+                                       (x - binCenters[left]);
+    }
+  }
+
+  for(std::size_t i = 0; i + 1 < _grid.size(); ++i) {
+    _maxCellIncrement = std::max(_maxCellIncrement, std::abs(_grid[i + 1] - _grid[i]));
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelFrameCache.h"
+
+using namespace eutelescope;
+
+EUTelFrameCache::EUTelFrameCache()
+    : _status(kNotConfigured), _memoryBudget(0), _eventSize(0), _nEvents(0),
+      _frameSizes(), _buffers() {}
+
+void EUTelFrameCache::configure(std::vector<std::size_t> const &frameSizes,
+                                std::size_t memoryBudget) {
+  clear();
+  _frameSizes = frameSizes;
+  _memoryBudget = memoryBudget;
+  for(std::size_t size : _frameSizes) _eventSize += size * sizeof(short);
+  _buffers.resize(_frameSizes.size());
+  _status = kValid;
+}
+
+void EUTelFrameCache::clear() {
+  _status = kNotConfigured;
+  _memoryBudget = 0;
+  _eventSize = 0;
+  _nEvents = 0;
+  _frameSizes.clear();
+  //swap with empty vectors to really give the memory back
+  std::vector<std::vector<short>>().swap(_buffers);
+}
+
+bool EUTelFrameCache::beginEvent() {
+  if(!isValid()) {
+    if(_status == kValid) invalidate();
+    return false;
+  }
+  if((_nEvents + 1) * _eventSize > _memoryBudget) {
+    invalidate(kBudgetExceeded);
+    return false;
+  }
+  ++_nEvents;
+  return true;
+}
+
+void EUTelFrameCache::fill(std::size_t iDetector, std::vector<short> const &frame) {
+  if(_status != kValid) return;
+  if(iDetector >= _frameSizes.size() || frame.size() != _frameSizes[iDetector] ||
+     _buffers[iDetector].size() != (_nEvents - 1) * _frameSizes[iDetector]) {
+    //unknown detector, wrong frame size or detector filled twice
+    invalidate();
+    return;
+  }
+  _buffers[iDetector].insert(_buffers[iDetector].end(), frame.begin(), frame.end());
+}
+
+void EUTelFrameCache::invalidate(Status reason) {
+  _status = reason;
+  _nEvents = 0;
+  std::vector<std::vector<short>>(_frameSizes.size()).swap(_buffers);
+}
+
+bool EUTelFrameCache::isValid() const {
+  if(_status != kValid) return false;
+  for(std::size_t i = 0; i < _frameSizes.size(); ++i) {
+    if(_buffers[i].size() != _nEvents * _frameSizes[i]) return false;
+  }
+  return true;
+}
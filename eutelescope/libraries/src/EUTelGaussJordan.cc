@@ -0,0 +1,96 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelGaussJordan.h"
+
+// system includes <>
+#include <cmath>
+#include <utility>
+
+using namespace eutelescope;
+
+EUTelGaussJordan::EUTelGaussJordan()
+    : _n(0), _valid(false), _pivotRow(), _pivotColumn(), _pivotInverse(),
+      _multiplier(), _inverse(), _pivotUsed() {}
+
+bool EUTelGaussJordan::factorise(double *alfa, int n) {
+  _n = n;
+  _valid = false;
+  _pivotRow.assign(n, 0);
+  _pivotColumn.assign(n, 0);
+  _pivotInverse.assign(n, 0.);
+  _multiplier.assign(n * n, 0.);
+  _pivotUsed.assign(n, 0);
+
+  int irow = 0;
+  int icol = 0;
+
+  for(int i = 0; i < n; i++) {
+    double big = 0.;
+    for(int j = 0; j < n; j++) {
+      if(_pivotUsed[j] == 1) continue;
+      for(int k = 0; k < n; k++) {
+        if(_pivotUsed[k] != 0) continue;
+        double const abs = std::fabs(alfa[n * j + k]);
+        if(abs > big) {
+          big = abs;
+          irow = j;
+          icol = k;
+        }
+      }
+    }
+    if(++_pivotUsed[icol] > 1) return false;
+
+    if(irow != icol) {
+      for(int j = 0; j < n; j++) std::swap(alfa[n * irow + j], alfa[n * icol + j]);
+    }
+    _pivotRow[i] = irow;
+    _pivotColumn[i] = icol;
+
+    if(alfa[n * icol + icol] == 0.) return false;
+
+    double const pivinv = 1. / alfa[n * icol + icol];
+    _pivotInverse[i] = pivinv;
+    alfa[n * icol + icol] = 1.;
+    for(int j = 0; j < n; j++) alfa[n * icol + j] *= pivinv;
+
+    for(int j = 0; j < n; j++) {
+      if(j == icol) continue;
+      double const help = alfa[n * j + icol];
+      _multiplier[n * i + j] = help;
+      alfa[n * j + icol] = 0.;
+      for(int k = 0; k < n; k++) alfa[n * j + k] -= alfa[n * icol + k] * help;
+    }
+  }
+
+  //undo the column interchanges
+  for(int i = n - 1; i >= 0; i--) {
+    if(_pivotRow[i] == _pivotColumn[i]) continue;
+    for(int j = 0; j < n; j++) std::swap(alfa[n * j + _pivotRow[i]], alfa[n * j + _pivotColumn[i]]);
+  }
+
+  _inverse.assign(alfa, alfa + n * n);
+  _valid = true;
+  return true;
+}
+
+void EUTelGaussJordan::solve(double *beta) const {
+  for(int i = 0; i < _n; i++) {
+    int const icol = _pivotColumn[i];
+    if(_pivotRow[i] != icol) std::swap(beta[_pivotRow[i]], beta[icol]);
+    beta[icol] *= _pivotInverse[i];
+    double const pivot = beta[icol];
+    double const *multiplier = &_multiplier[_n * i];
+    for(int j = 0; j < _n; j++) {
+      if(j == icol) continue;
+      beta[j] -= pivot * multiplier[j];
+    }
+  }
+}
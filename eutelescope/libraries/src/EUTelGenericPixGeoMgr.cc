@@ -41,6 +41,17 @@ void EUTelGenericPixGeoMgr::addCastedPlane(int planeID, int xPixel, int yPixel,
                                            double xSize, double ySize,
                                            double zSize, double radLength,
                                            std::string planeVolume) {
+  EUTelGenericPixGeoDescr *pixgeodescrptr = loadCastedPlane(
+      planeID, xPixel, yPixel, xSize, ySize, zSize, radLength);
+
+  streamlog_out(MESSAGE3) << "Adding plane: " << planeID << " in volume "
+                          << planeVolume << std::endl;
+  pixgeodescrptr->createRootDescr(planeVolume);
+}
+
+EUTelGenericPixGeoDescr *EUTelGenericPixGeoMgr::loadCastedPlane(
+    int planeID, int xPixel, int yPixel, double xSize, double ySize,
+    double zSize, double radLength) {
   EUTelGenericPixGeoDescr *pixgeodescrptr = nullptr;
   int xSizeMap = static_cast<int>(1000 * xSize + 0.5);
   int ySizeMap = static_cast<int>(1000 * ySize + 0.5);
@@ -69,14 +80,25 @@ void EUTelGenericPixGeoMgr::addCastedPlane(int planeID, int xPixel, int yPixel,
     _castedDescriptions.insert(std::make_pair(name, pixgeodescrptr));
   }
 
+  streamlog_out(MESSAGE3) << "Loaded plane: " << planeID
+                          << " with geoLibName: " << name << std::endl;
+  return pixgeodescrptr;
+}
+
+void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName,
+                                     std::string planeVolume) {
+  EUTelGenericPixGeoDescr *pixgeodescrptr = loadPlane(planeID, geoName);
+
   streamlog_out(MESSAGE3) << "Adding plane: " << planeID
-                          << " with geoLibName: " << name << " in volume "
+                          << " with geoLibName: " << geoName << " in volume "
                           << planeVolume << std::endl;
+
+  // Call the factory method to actually load the geoemtry!
   pixgeodescrptr->createRootDescr(planeVolume);
 }
 
-void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName,
-                                     std::string planeVolume) {
+EUTelGenericPixGeoDescr *EUTelGenericPixGeoMgr::loadPlane(int planeID,
+                                                          std::string geoName) {
   EUTelGenericPixGeoDescr *pixgeodescrptr = nullptr;
   std::map<std::string, EUTelGenericPixGeoDescr *>::iterator it;
 
@@ -129,12 +151,22 @@ void EUTelGenericPixGeoMgr::addPlane(int planeID, std::string geoName,
     }
   }
 
-  streamlog_out(MESSAGE3) << "Adding plane: " << planeID
-                          << " with geoLibName: " << geoName << " in volume "
-                          << planeVolume << std::endl;
+  return pixgeodescrptr;
+}
 
-  // Call the factory method to actually load the geoemtry!
-  pixgeodescrptr->createRootDescr(planeVolume);
+std::string EUTelGenericPixGeoMgr::getLibraryFile(std::string geoName) {
+  // CMake will call shared libraried "lib"+LibraryName.so
+  std::string libName = std::string("lib").append(geoName);
+  void *hndl = dlopen(libName.c_str(), RTLD_NOW);
+  if (hndl == nullptr) {
+    return std::string();
+  }
+  Dl_info info;
+  void *mkr = dlsym(hndl, "maker");
+  if (mkr == nullptr || dladdr(mkr, &info) == 0 || info.dli_fname == nullptr) {
+    return std::string();
+  }
+  return std::string(info.dli_fname);
 }
 
 EUTelGenericPixGeoDescr *EUTelGenericPixGeoMgr::getPixGeoDescr(int planeID) {
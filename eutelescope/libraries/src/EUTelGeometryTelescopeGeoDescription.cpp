@@ -7,10 +7,17 @@
 // C++
 #include <algorithm>
 #include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <iomanip>
 #include <sstream>
 
+// system
+#include <sys/stat.h>
+
 // MARLIN
 #include "marlin/Global.h"
 #include "marlin/VerbosityLevels.h"
@@ -36,6 +43,10 @@
 #include "TVector3.h"
 #include "TMath.h"
 #include "TError.h"
+#include "TFile.h"
+#include "TObjString.h"
+#include "TROOT.h"
+#include "TSystem.h"
 
 using namespace eutelescope;
 using namespace geo;
@@ -406,12 +417,18 @@ _trackerPlanesParameters(nullptr),
 _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _isGeoInitialized(false),
+_geometryCacheDir(),
+_isLoadedFromCache(false),
+_pixelScratchManager(nullptr),
 _geoManager(nullptr)
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
 	gErrorIgnoreLevel =  kError;  
 	//Pixel Geometry manager creation
 	_pixGeoMgr = std::make_unique<EUTelGenericPixGeoMgr>();
+	//The persistent TGeo cache is only used if asked for
+	char const* cacheDir = std::getenv("EUTELESCOPE_GEOMETRY_CACHE");
+	if( cacheDir != nullptr ) _geometryCacheDir = cacheDir;
 }
 
 void EUTelGeometryTelescopeGeoDescription::readGear() {
@@ -446,6 +463,7 @@ void EUTelGeometryTelescopeGeoDescription::readGear() {
 
 EUTelGeometryTelescopeGeoDescription::~EUTelGeometryTelescopeGeoDescription() {
 	_geoManager.release();
+	_pixelScratchManager.release();
 }
 
 /**
@@ -630,11 +648,18 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
 	if( _isGeoInitialized ) {
 		streamlog_out( WARNING3 ) << "EUTelGeometryTelescopeGeoDescription: Geometry already initialized, using old initialization" << std::endl;
 		return;
-	} else {
-    		_geoManager = std::make_unique<TGeoManager>("Telescope", "v0.1");
-			_geoManager->SetBit(kCanDelete);
 	}
 
+	std::string const cacheFile = getGeometryCacheFile();
+	if( !cacheFile.empty() && loadGeometryCache(cacheFile) ) {
+		_isGeoInitialized = true;
+		if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
+		return;
+	}
+
+	_geoManager = std::make_unique<TGeoManager>("Telescope", "v0.1");
+	_geoManager->SetBit(kCanDelete);
+
 	if( !_geoManager ) {
 		streamlog_out( ERROR3 ) << "Can't instantiate ROOT TGeoManager " << std::endl;
 		return;
@@ -682,13 +707,185 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
     // Dump ROOT TGeo object into file
     if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
 
-   for(auto& mapEntry: _planePath) {
+    updateTGeoMatrixMap();
+    if( !cacheFile.empty() ) writeGeometryCache( cacheFile );
+    return;
+}
+
+void EUTelGeometryTelescopeGeoDescription::updateTGeoMatrixMap() {
+	for(auto& mapEntry: _planePath) {
 		auto const & pathName = mapEntry.second;
 		auto sensorID = mapEntry.first;
-    	_geoManager->cd( pathName.c_str() );
-		  _TGeoMatrixMap[sensorID] = _geoManager->GetCurrentNode()->GetMatrix();
-	  } 
-    return;
+		_geoManager->cd( pathName.c_str() );
+		_TGeoMatrixMap[sensorID] = _geoManager->GetCurrentNode()->GetMatrix();
+	}
+}
+
+void EUTelGeometryTelescopeGeoDescription::resetTGeoDescription() {
+	//descriptions first, they point into the geometry managers
+	_pixGeoMgr = std::make_unique<EUTelGenericPixGeoMgr>();
+	_planePath.clear();
+	_TGeoMatrixMap.clear();
+	clearMemoizedValues();
+	_geoManager.reset();
+	_pixelScratchManager.reset();
+	_isGeoInitialized = false;
+	_isLoadedFromCache = false;
+}
+
+/**
+ * The key covers every GEAR value used to build the TGeo description, the
+ * pixel geometry libraries (file, size and modification time) and the ROOT
+ * version. Any change gives a different file name, so stale caches are
+ * never read.
+ */
+std::string EUTelGeometryTelescopeGeoDescription::geometryCacheKey() {
+	std::ostringstream content;
+	content << std::setprecision(17) << "EUTelGeometryCache 1 ROOT " << gROOT->GetVersionInt() << '\n';
+	for( auto sensorID: _sensorIDVec ) {
+		content << sensorID << ' '
+		        << getPlaneXPosition(sensorID) << ' ' << getPlaneYPosition(sensorID) << ' ' << getPlaneZPosition(sensorID) << ' '
+		        << getPlaneXRotationDegrees(sensorID) << ' ' << getPlaneYRotationDegrees(sensorID) << ' ' << getPlaneZRotationDegrees(sensorID) << ' '
+		        << planeFlip1(sensorID) << ' ' << planeFlip2(sensorID) << ' ' << planeFlip3(sensorID) << ' ' << planeFlip4(sensorID) << ' '
+		        << getPlaneXSize(sensorID) << ' ' << getPlaneYSize(sensorID) << ' ' << getPlaneZSize(sensorID) << ' '
+		        << getPlaneRadiationLength(sensorID) << ' '
+		        << geoLibName(sensorID);
+		//the pixel count of library geometries is taken from the library itself
+		if( geoLibName(sensorID) == "CAST" ) {
+			content << ' ' << getPlaneNumberOfPixelsX(sensorID) << ' ' << getPlaneNumberOfPixelsY(sensorID);
+		} else {
+			std::string const libFile = EUTelGenericPixGeoMgr::getLibraryFile( geoLibName(sensorID) );
+			struct stat libStat;
+			content << ' ' << libFile;
+			if( !libFile.empty() && stat(libFile.c_str(), &libStat) == 0 ) {
+				content << ' ' << libStat.st_size << ' ' << libStat.st_mtime;
+			}
+		}
+		content << '\n';
+	}
+
+	//64 bit FNV-1a
+	std::uint64_t hash = 14695981039346656037ULL;
+	for( char c: content.str() ) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	std::ostringstream key;
+	key << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return key.str();
+}
+
+std::string EUTelGeometryTelescopeGeoDescription::getGeometryCacheFile() {
+	if( _geometryCacheDir.empty() ) return std::string();
+	return _geometryCacheDir + "/eutelgeo_" + geometryCacheKey() + ".root";
+}
+
+bool EUTelGeometryTelescopeGeoDescription::loadGeometryCache( std::string const & fileName ) {
+	//AccessPathName returns true if the file can NOT be accessed
+	if( gSystem->AccessPathName( fileName.c_str() ) ) {
+		streamlog_out( MESSAGE5 ) << "No TGeo cache " << fileName << " yet, building the geometry" << std::endl;
+		return false;
+	}
+
+	//pixel description of each plane as stored with the geometry
+	std::map<int, std::string> planeLibraries;
+	{
+		std::unique_ptr<TFile> file( TFile::Open( fileName.c_str(), "READ" ) );
+		if( !file || file->IsZombie() ) {
+			streamlog_out( WARNING3 ) << "Can't read TGeo cache " << fileName << ", building the geometry" << std::endl;
+			return false;
+		}
+		std::unique_ptr<TObject> object( file->Get( "EUTelPixelDescriptions" ) );
+		auto mapping = dynamic_cast<TObjString*>( object.get() );
+		if( mapping == nullptr ) {
+			streamlog_out( WARNING3 ) << "TGeo cache " << fileName << " has no pixel descriptions, building the geometry" << std::endl;
+			return false;
+		}
+		std::istringstream lines( mapping->GetString().Data() );
+		int sensorID;
+		std::string name;
+		while( lines >> sensorID >> name ) planeLibraries[sensorID] = name;
+	}
+	for( auto sensorID: _sensorIDVec ) {
+		auto it = planeLibraries.find( sensorID );
+		if( it == planeLibraries.end() || it->second != geoLibName(sensorID) ) {
+			streamlog_out( WARNING3 ) << "TGeo cache " << fileName << " does not match plane " << sensorID << ", building the geometry" << std::endl;
+			return false;
+		}
+	}
+
+	//The pixel descriptions are only needed for their names and index ranges,
+	//the volumes they create go into a scratch geometry and are never placed.
+	//The cached geometry already holds the pixel volumes of every plane.
+	//A new TGeoManager deletes gGeoManager, so the old one goes first.
+	_geoManager.reset();
+	_geoManager = std::make_unique<TGeoManager>("PixelDescriptions", "v0.1");
+	for( auto sensorID: _sensorIDVec ) {
+		std::string const & name = planeLibraries[sensorID];
+		if( name == "CAST" ) {
+			_pixGeoMgr->loadCastedPlane( sensorID, getPlaneNumberOfPixelsX(sensorID), getPlaneNumberOfPixelsY(sensorID), getPlaneXSize(sensorID), getPlaneYSize(sensorID), getPlaneZSize(sensorID), getPlaneRadiationLength(sensorID) );
+		} else {
+			_pixGeoMgr->loadPlane( sensorID, name );
+			updatePlaneInfo( sensorID );
+		}
+	}
+	_pixelScratchManager = std::move( _geoManager );
+
+	//Import deletes gGeoManager, which is the scratch manager: detach it, it
+	//owns the volumes the pixel descriptions point to. Import makes the
+	//imported manager gGeoManager.
+	gGeoManager = nullptr;
+	_geoManager = std::unique_ptr<TGeoManager>( TGeoManager::Import( fileName.c_str() ) );
+	if( !_geoManager ) {
+		streamlog_out( WARNING3 ) << "Can't import TGeo cache " << fileName << ", building the geometry" << std::endl;
+		resetTGeoDescription();
+		return false;
+	}
+	_geoManager->SetBit(kCanDelete);
+	if( !_geoManager->IsClosed() ) _geoManager->CloseGeometry();
+
+	for( auto sensorID: _sensorIDVec ) {
+		std::stringstream strId;
+		strId << sensorID;
+		_planePath.insert( std::make_pair(sensorID, "/volume_World_1/volume_SensorID:"+strId.str()+"_1") );
+	}
+	updateTGeoMatrixMap();
+
+	_isLoadedFromCache = true;
+	streamlog_out( MESSAGE5 ) << "Loaded TGeo description from cache " << fileName << std::endl;
+	return true;
+}
+
+void EUTelGeometryTelescopeGeoDescription::writeGeometryCache( std::string const & fileName ) {
+	//Parallel jobs must never see a partially written file: write a temporary
+	//file and rename it, which replaces the target atomically
+	std::ostringstream tmpName;
+	tmpName << fileName << '.' << gSystem->GetPid() << ".root";
+
+	if( _geoManager->Export( tmpName.str().c_str() ) == 0 ) {
+		streamlog_out( WARNING3 ) << "Can't write TGeo cache " << tmpName.str() << std::endl;
+		gSystem->Unlink( tmpName.str().c_str() );
+		return;
+	}
+	{
+		std::unique_ptr<TFile> file( TFile::Open( tmpName.str().c_str(), "UPDATE" ) );
+		if( !file || file->IsZombie() ) {
+			streamlog_out( WARNING3 ) << "Can't update TGeo cache " << tmpName.str() << std::endl;
+			gSystem->Unlink( tmpName.str().c_str() );
+			return;
+		}
+		std::ostringstream mapping;
+		for( auto sensorID: _sensorIDVec ) mapping << sensorID << ' ' << geoLibName(sensorID) << '\n';
+		TObjString mappingString( mapping.str().c_str() );
+		file->WriteTObject( &mappingString, "EUTelPixelDescriptions" );
+		file->Close();
+	}
+	if( std::rename( tmpName.str().c_str(), fileName.c_str() ) != 0 ) {
+		streamlog_out( WARNING3 ) << "Can't move TGeo cache to " << fileName << std::endl;
+		gSystem->Unlink( tmpName.str().c_str() );
+		return;
+	}
+	streamlog_out( MESSAGE5 ) << "Stored TGeo description in cache " << fileName << std::endl;
 }
 
 Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::rotationMatrixFromAngles(int sensorID) {
@@ -713,26 +910,30 @@ Eigen::Matrix3i EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
 
 /**
  * Coordinate transformation from local reference frame of sensor with a given sensorID
- * to the global coordinate system
+ * to the global coordinate system.
+ * The geometry is only read, so several threads may call this at the
+ * same time. An unknown sensor throws std::out_of_range.
  * 
  * @param sensorID Id of the sensor (specifies local coordinate system)
  * @param localPos (x,y,z) in local coordinate system
  * @param globalPos (x,y,z) in global coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-	_TGeoMatrixMap[sensorID]->LocalToMaster(localPos, globalPos);
+	_TGeoMatrixMap.at(sensorID)->LocalToMaster(localPos, globalPos);
 }
 
 /**
  * Coordinate transformation from global reference frame to local reference frame.
  * Corresponding volume is determined automatically.
+ * The geometry is only read, so several threads may call this at the
+ * same time. An unknown sensor throws std::out_of_range.
  * 
  * @param sensorID Id of the sensor (specifies local coordinate system)
  * @param globalPos (x,y,z) in global coordinate system
  * @param localPos (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-	_TGeoMatrixMap[sensorID]->MasterToLocal(globalPos, localPos);
+	_TGeoMatrixMap.at(sensorID)->MasterToLocal(globalPos, localPos);
 }
 
 /**
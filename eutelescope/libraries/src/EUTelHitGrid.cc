@@ -0,0 +1,91 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHitGrid.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelHitGrid::EUTelHitGrid()
+    : _limit(0.), _useGrid(false), _hits(), _grid(), _outside() {}
+
+void EUTelHitGrid::reset(double limit) {
+  _limit = limit;
+  _useGrid = limit > 0. && std::isfinite(limit);
+  _hits.clear();
+  _grid.clear();
+  _outside.clear();
+}
+
+void EUTelHitGrid::addHit(int id, double x, double y) {
+  _hits.push_back(Hit{id, x, y});
+}
+
+bool EUTelHitGrid::cell(double x, double y, Cell &result) const {
+  const double cellX = std::floor(x / (2. * _limit));
+  const double cellY = std::floor(y / (2. * _limit));
+  // far beyond any sensor, also catches non finite positions
+  if (!(std::fabs(cellX) < 1e15 && std::fabs(cellY) < 1e15))
+    return false;
+  result = Cell(static_cast<long long>(cellX), static_cast<long long>(cellY));
+  return true;
+}
+
+bool EUTelHitGrid::isInside(const Hit &hit, double x, double y) const {
+  return !(std::fabs(hit.x - x) > _limit || std::fabs(hit.y - y) > _limit);
+}
+
+void EUTelHitGrid::build() {
+  _grid.clear();
+  _outside.clear();
+  Cell hitCell(0, 0);
+  for (std::size_t i = 0; i < _hits.size(); ++i) {
+    if (_useGrid && cell(_hits[i].x, _hits[i].y, hitCell))
+      _grid.push_back(std::make_pair(hitCell, static_cast<int>(i)));
+    else
+      _outside.push_back(static_cast<int>(i));
+  }
+  std::sort(_grid.begin(), _grid.end());
+}
+
+void EUTelHitGrid::find(double x, double y, std::vector<int> &result) const {
+  result.clear();
+  Cell centre(0, 0);
+  if (!_useGrid || !cell(x, y, centre)) {
+    for (const Hit &hit : _hits) {
+      if (isInside(hit, x, y))
+        result.push_back(hit.id);
+    }
+    std::sort(result.begin(), result.end());
+    return;
+  }
+
+  auto const byCell = [](std::pair<Cell, int> const &entry,
+                         Cell const &value) { return entry.first < value; };
+  for (long long cellX = centre.first - 1; cellX <= centre.first + 1;
+       ++cellX) {
+    const Cell last(cellX, centre.second + 1);
+    for (auto entry = std::lower_bound(_grid.begin(), _grid.end(),
+                                       Cell(cellX, centre.second - 1), byCell);
+         entry != _grid.end() && !(last < entry->first); ++entry) {
+      const Hit &hit = _hits[entry->second];
+      if (isInside(hit, x, y))
+        result.push_back(hit.id);
+    }
+  }
+  for (int i : _outside) {
+    if (isInside(_hits[i], x, y))
+      result.push_back(_hits[i].id);
+  }
+  std::sort(result.begin(), result.end());
+}
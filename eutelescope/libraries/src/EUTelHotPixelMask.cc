@@ -0,0 +1,97 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHotPixelMask.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelHotPixelMask::EUTelHotPixelMask() : _sensors(), _nHotPixels(0) {}
+
+void EUTelHotPixelMask::clear() {
+  _sensors.clear();
+  _nHotPixels = 0;
+}
+
+void EUTelHotPixelMask::setHotPixel(int sensorID, int x, int y) {
+  if (sensorID < 0)
+    return;
+  if (static_cast<std::size_t>(sensorID) >= _sensors.size()) {
+    _sensors.resize(sensorID + 1, Sensor{0, 0, 0, 0, {}, {}});
+  }
+  _sensors[sensorID].pixels.push_back(std::make_pair(x, y));
+}
+
+void EUTelHotPixelMask::build() {
+  _nHotPixels = 0;
+  for (Sensor &sensor : _sensors) {
+    sensor.bits.clear();
+    sensor.width = sensor.height = 0;
+    if (sensor.pixels.empty())
+      continue;
+
+    int xMin = sensor.pixels.front().first, xMax = xMin;
+    int yMin = sensor.pixels.front().second, yMax = yMin;
+    for (const auto &pixel : sensor.pixels) {
+      xMin = std::min(xMin, pixel.first);
+      xMax = std::max(xMax, pixel.first);
+      yMin = std::min(yMin, pixel.second);
+      yMax = std::max(yMax, pixel.second);
+    }
+    sensor.xMin = xMin;
+    sensor.yMin = yMin;
+    sensor.width = static_cast<std::size_t>(static_cast<long long>(xMax) - xMin + 1);
+    sensor.height = static_cast<std::size_t>(static_cast<long long>(yMax) - yMin + 1);
+    sensor.bits.assign((sensor.width * sensor.height + 63) / 64, 0);
+
+    for (const auto &pixel : sensor.pixels) {
+      const std::size_t bit =
+          static_cast<std::size_t>(pixel.second - yMin) * sensor.width +
+          static_cast<std::size_t>(pixel.first - xMin);
+      const std::uint64_t mask = std::uint64_t(1) << (bit & 63);
+      if ((sensor.bits[bit >> 6] & mask) == 0) {
+        sensor.bits[bit >> 6] |= mask;
+        ++_nHotPixels;
+      }
+    }
+  }
+}
+
+bool EUTelHotPixelMask::isHot(int sensorID, int x, int y) const {
+  if (sensorID < 0 || static_cast<std::size_t>(sensorID) >= _sensors.size())
+    return false;
+  const Sensor &sensor = _sensors[sensorID];
+  if (sensor.bits.empty())
+    return false;
+  const long long dx = static_cast<long long>(x) - sensor.xMin;
+  const long long dy = static_cast<long long>(y) - sensor.yMin;
+  if (dx < 0 || dy < 0 || static_cast<std::size_t>(dx) >= sensor.width ||
+      static_cast<std::size_t>(dy) >= sensor.height)
+    return false;
+  const std::size_t bit = static_cast<std::size_t>(dy) * sensor.width +
+                          static_cast<std::size_t>(dx);
+  return (sensor.bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+bool EUTelHotPixelMask::containsHotPixel(int sensorID,
+                                         const std::vector<float> &charges,
+                                         std::size_t pixelSize) const {
+  if (pixelSize < 2)
+    return false;
+  for (std::size_t i = 0; i + 1 < charges.size(); i += pixelSize) {
+    // the pixel coordinates are shorts, as in EUTelGenericSparsePixel
+    if (isHot(sensorID, static_cast<short>(charges[i]),
+              static_cast<short>(charges[i + 1])))
+      return true;
+  }
+  return false;
+}
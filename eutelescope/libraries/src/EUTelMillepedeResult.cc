@@ -0,0 +1,135 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMillepedeResult.h"
+
+// system includes <>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+
+using namespace eutelescope;
+
+namespace {
+  //! Split a line into numbers, fails if any token is not a number
+  bool numericTokens(std::string const &line, std::vector<double> &tokens) {
+    tokens.clear();
+    char const *pos = line.c_str();
+    while(true) {
+      while(*pos == ' ' || *pos == '\t' || *pos == '\r') ++pos;
+      if(*pos == '\0') return true;
+      char *end = nullptr;
+      errno = 0;
+      double const value = std::strtod(pos, &end);
+      if(end == pos || errno == ERANGE) return false;
+      if(*end != '\0' && *end != ' ' && *end != '\t' && *end != '\r') return false;
+      tokens.push_back(value);
+      pos = end;
+    }
+  }
+}
+
+std::vector<EUTelMillepedeResult::Quantity>
+EUTelMillepedeResult::layout(unsigned int nParameters) {
+  switch(nParameters) {
+  case 2:
+    return {kXOff, kYOff};
+  case 3:
+    return {kXOff, kYOff, kGamma};
+  case 4:
+    return {kXOff, kYOff, kGamma, kZOff};
+  case 6:
+    return {kXOff, kYOff, kZOff, kAlpha, kBeta, kGamma};
+  default:
+    return {};
+  }
+}
+
+EUTelMillepedeResult::EUTelMillepedeResult()
+    : _sensorIDs(), _table(), _maxParameterNumber(0), _skippedLines(0),
+      _missing() {}
+
+bool EUTelMillepedeResult::read(std::string const &fileName) {
+  std::ifstream input(fileName.c_str());
+  if(!input.is_open() || input.bad()) return false;
+  parse(input);
+  return true;
+}
+
+void EUTelMillepedeResult::parse(std::istream &input) {
+
+  _sensorIDs.clear();
+  _table.clear();
+  _maxParameterNumber = 0;
+  _skippedLines = 0;
+
+  std::vector<std::pair<int, Parameter>> rows;
+  std::vector<double> tokens;
+  std::string line;
+
+  while(std::getline(input, line)) {
+    if(line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    if(!numericTokens(line, tokens) ||
+       (tokens.size() != 3 && tokens.size() != 5 && tokens.size() != 6)) {
+      ++_skippedLines;
+      continue;
+    }
+
+    double const labelValue = tokens[0];
+    int const label = static_cast<int>(labelValue);
+    if(labelValue != std::floor(labelValue) || label <= 0 ||
+       label % 10 == 0 || label % 10 > maxParameters) {
+      ++_skippedLines;
+      continue;
+    }
+
+    Parameter par;
+    par.value = tokens[1];
+    par.presigma = tokens[2];
+    if(tokens.size() >= 5) par.error = tokens[4];
+    par.present = true;
+    rows.emplace_back(label, par);
+  }
+
+  for(auto const &row : rows) {
+    _sensorIDs.push_back(row.first / 10);
+  }
+  std::sort(_sensorIDs.begin(), _sensorIDs.end());
+  _sensorIDs.erase(std::unique(_sensorIDs.begin(), _sensorIDs.end()),
+                   _sensorIDs.end());
+
+  _table.assign(_sensorIDs.size() * maxParameters, Parameter());
+  for(auto const &row : rows) {
+    int const parameter = row.first % 10;
+    _table[sensorIndex(row.first / 10) * maxParameters + parameter - 1] = row.second;
+    _maxParameterNumber = std::max(_maxParameterNumber, parameter);
+  }
+}
+
+int EUTelMillepedeResult::sensorIndex(int sensorID) const {
+  auto const it = std::lower_bound(_sensorIDs.begin(), _sensorIDs.end(), sensorID);
+  if(it == _sensorIDs.end() || *it != sensorID) return -1;
+  return static_cast<int>(it - _sensorIDs.begin());
+}
+
+bool EUTelMillepedeResult::hasSensor(int sensorID) const {
+  return sensorIndex(sensorID) >= 0;
+}
+
+EUTelMillepedeResult::Parameter const &
+EUTelMillepedeResult::getParameter(int sensorID, int parameter) const {
+  int const index = sensorIndex(sensorID);
+  if(index < 0 || parameter < 1 || parameter > maxParameters) return _missing;
+  return _table[index * maxParameters + parameter - 1];
+}
@@ -0,0 +1,234 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPedeRunner.h"
+
+// system includes <>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <poll.h>
+#include <thread>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+namespace {
+  char const *const rejectMarker = "Too many rejects";
+  char const *const chi2Marker = "Sum(Chi^2)/Sum(Ndf) = ";
+
+  //! pede may wrap the chi2/ndf result over a few lines
+  int const chi2MaxLines = 4;
+
+  //! Interval to check whether pede has exited after SIGTERM
+  std::chrono::milliseconds const exitPollInterval(10);
+
+  void closeFd(int &fd) {
+    if(fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+
+  std::string trim(std::string const &str) {
+    auto const first = str.find_first_not_of(" \t\r");
+    if(first == std::string::npos) return std::string();
+    auto const last = str.find_last_not_of(" \t\r");
+    return str.substr(first, last - first + 1);
+  }
+}
+
+EUTelPedeRunner::EUTelPedeRunner(std::string const &command, double timeout)
+    : _command(command), _timeout(timeout), _killGracePeriod(5), _outHandler(), _errHandler(),
+      _startFailed(false), _timedOut(false), _exitStatus(-1),
+      _tooManyRejects(false), _chi2LinesLeft(0), _chi2Ndf(), _errors() {}
+
+void EUTelPedeRunner::parseOutputLine(std::string const &line) {
+
+  if(line.find(rejectMarker) != std::string::npos) {
+    _tooManyRejects = true;
+  }
+
+  std::string::size_type searchFrom = std::string::npos;
+  auto const chi2Pos = line.find(chi2Marker);
+  if(chi2Pos != std::string::npos) {
+    //the result follows the next equal sign after the marker, which
+    //might only come on one of the following lines
+    _chi2LinesLeft = chi2MaxLines;
+    searchFrom = chi2Pos + std::string(chi2Marker).size();
+  } else if(_chi2LinesLeft > 0) {
+    searchFrom = 0;
+  }
+
+  if(searchFrom == std::string::npos) return;
+
+  auto const eqPos = line.find('=', searchFrom);
+  if(eqPos != std::string::npos) {
+    _chi2Ndf = trim(line.substr(eqPos + 1, 15));
+    _chi2LinesLeft = 0;
+  } else {
+    --_chi2LinesLeft;
+  }
+}
+
+void EUTelPedeRunner::flushLines(std::string &pending, bool isError, bool final) {
+
+  std::string::size_type start = 0;
+  std::string::size_type end = 0;
+  while((end = pending.find('\n', start)) != std::string::npos) {
+    std::string const line = pending.substr(start, end - start);
+    if(isError) {
+      if(_errHandler) _errHandler(line);
+    } else {
+      parseOutputLine(line);
+      if(_outHandler) _outHandler(line);
+    }
+    start = end + 1;
+  }
+  pending.erase(0, start);
+
+  //a last line without a trailing newline
+  if(final && !pending.empty()) {
+    if(isError) {
+      if(_errHandler) _errHandler(pending);
+    } else {
+      parseOutputLine(pending);
+      if(_outHandler) _outHandler(pending);
+    }
+    pending.clear();
+  }
+}
+
+bool EUTelPedeRunner::run() {
+
+  int outPipe[2] = {-1, -1};
+  int errPipe[2] = {-1, -1};
+
+  if(::pipe(outPipe) != 0 || ::pipe(errPipe) != 0) {
+    closeFd(outPipe[0]); closeFd(outPipe[1]);
+    closeFd(errPipe[0]); closeFd(errPipe[1]);
+    _startFailed = true;
+    return false;
+  }
+
+  pid_t const pid = ::fork();
+  if(pid < 0) {
+    closeFd(outPipe[0]); closeFd(outPipe[1]);
+    closeFd(errPipe[0]); closeFd(errPipe[1]);
+    _startFailed = true;
+    return false;
+  }
+
+  if(pid == 0) {
+    //child: own process group so a timeout also stops what the shell spawned
+    ::setpgid(0, 0);
+    ::dup2(outPipe[1], STDOUT_FILENO);
+    ::dup2(errPipe[1], STDERR_FILENO);
+    ::close(outPipe[0]); ::close(outPipe[1]);
+    ::close(errPipe[0]); ::close(errPipe[1]);
+    ::execl("/bin/sh", "sh", "-c", _command.c_str(), static_cast<char *>(nullptr));
+    ::_exit(127);
+  }
+
+  closeFd(outPipe[1]);
+  closeFd(errPipe[1]);
+
+  auto const deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(_timeout > 0 ? _timeout : 0));
+
+  int fds[2] = {outPipe[0], errPipe[0]};
+  std::string pending[2];
+  char buf[4096];
+
+  while(fds[0] >= 0 || fds[1] >= 0) {
+    int pollTimeout = -1;
+    if(_timeout > 0) {
+      auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            deadline - std::chrono::steady_clock::now()).count();
+      if(left <= 0) {
+        _timedOut = true;
+        break;
+      }
+      pollTimeout = static_cast<int>(left);
+    }
+
+    struct pollfd pfd[2];
+    nfds_t nfds = 0;
+    int source[2] = {-1, -1};
+    for(int i = 0; i < 2; ++i) {
+      if(fds[i] < 0) continue;
+      pfd[nfds].fd = fds[i];
+      pfd[nfds].events = POLLIN;
+      pfd[nfds].revents = 0;
+      source[nfds] = i;
+      ++nfds;
+    }
+
+    int const ready = ::poll(pfd, nfds, pollTimeout);
+    if(ready < 0) {
+      if(errno == EINTR) continue;
+      break;
+    }
+    //the loop head notices an expired deadline
+    if(ready == 0) continue;
+
+    for(nfds_t j = 0; j < nfds; ++j) {
+      if(pfd[j].revents == 0) continue;
+      int const i = source[j];
+      ssize_t const n = ::read(fds[i], buf, sizeof(buf));
+      if(n > 0) {
+        pending[i].append(buf, static_cast<std::string::size_type>(n));
+        if(i == 1) _errors.append(buf, static_cast<std::string::size_type>(n));
+        flushLines(pending[i], i == 1, false);
+      } else if(n == 0 || errno != EINTR) {
+        closeFd(fds[i]);
+        flushLines(pending[i], i == 1, true);
+      }
+    }
+  }
+
+  closeFd(fds[0]);
+  closeFd(fds[1]);
+  flushLines(pending[0], false, true);
+  flushLines(pending[1], true, true);
+
+  int status = 0;
+  bool reaped = false;
+
+  if(_timedOut) {
+    ::kill(-pid, SIGTERM);
+    ::kill(pid, SIGTERM);
+
+    //the shell might exit right away and leave pede running in its
+    //process group, so the grace period lasts until the whole group
+    //is gone
+    auto const killAt = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(_killGracePeriod > 0 ? _killGracePeriod : 0));
+    while(std::chrono::steady_clock::now() < killAt) {
+      if(!reaped && ::waitpid(pid, &status, WNOHANG) == pid) reaped = true;
+      if(reaped && ::kill(-pid, 0) < 0 && errno == ESRCH) break;
+      std::this_thread::sleep_for(exitPollInterval);
+    }
+
+    //whatever ignored or trapped SIGTERM
+    ::kill(-pid, SIGKILL);
+    if(!reaped) ::kill(pid, SIGKILL);
+  }
+
+  while(!reaped && ::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+  }
+
+  _exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  return !_timedOut && _exitStatus == 0;
+}
@@ -0,0 +1,111 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPipelineDriver.h"
+#include "EUTelAsyncLCWriter.h"
+
+// marlin includes ".h"
+#include "marlin/Exceptions.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/VerbosityLevels.h"
+
+// system includes <>
+#include <iostream>
+
+using namespace eutelescope;
+
+EUTelPipelineDriver::EUTelPipelineDriver(int nThreads, std::size_t maxInFlight)
+    : _processors(), _concurrent(), _nSkipped(), _pipeline(nThreads, maxInFlight) {}
+
+void EUTelPipelineDriver::init(std::vector<std::string> const &activeProcessors,
+                               std::vector<std::string> const &conditions) {
+  marlin::ProcessorMgr *manager = marlin::ProcessorMgr::instance();
+  manager->init();
+
+  //only the leading ones: all before them have seen the event
+  for(std::size_t i = 0; i < activeProcessors.size(); ++i) {
+    if(i < conditions.size() && conditions[i] != "true") break;
+    marlin::Processor *processor = manager->getActiveProcessor(activeProcessors[i]);
+    EUTelThreadSafeProcessor *concurrent = dynamic_cast<EUTelThreadSafeProcessor *>(processor);
+    if(!concurrent || !concurrent->isThreadSafe()) break;
+    manager->removeActiveProcessor(activeProcessors[i]);
+    _processors.push_back(processor);
+    _concurrent.push_back(concurrent);
+  }
+  _nSkipped.assign(_processors.size(), 0);
+
+  for(std::size_t i = 0; i < _concurrent.size(); ++i) {
+    EUTelThreadSafeProcessor *concurrent = _concurrent[i];
+    int const index = static_cast<int>(i);
+    concurrent->prepareThreads(_pipeline.getNThreads());
+    _pipeline.addStage(
+        [concurrent, index](Event &event, unsigned int thread) {
+          if(event.skippedBy >= 0) return;
+          try {
+            concurrent->processEventConcurrently(event.event.get(), thread);
+          } catch(marlin::SkipEventException &) {
+            event.skippedBy = index;
+          }
+        },
+        true);
+  }
+  _pipeline.setFinalStage([this](Event &event, unsigned int) { finalStage(event); });
+
+  streamlog_out(MESSAGE4) << "Running " << _processors.size() << " processors on " << _pipeline.getNThreads()
+                          << " threads with up to " << _pipeline.getMaxInFlight() << " events in flight:";
+  for(auto processor : _processors) streamlog_out(MESSAGE4) << " " << processor->name();
+  streamlog_out(MESSAGE4) << std::endl;
+}
+
+void EUTelPipelineDriver::processRunHeader(EVENT::LCRunHeader *header) {
+  _pipeline.finish();
+  for(auto processor : _processors) processor->processRunHeader(header);
+  marlin::ProcessorMgr::instance()->processRunHeader(header);
+}
+
+void EUTelPipelineDriver::modifyRunHeader(EVENT::LCRunHeader *header) {
+  _pipeline.finish();
+  marlin::ProcessorMgr::instance()->modifyRunHeader(header);
+}
+
+void EUTelPipelineDriver::processEvent(EVENT::LCEvent *event) {
+  //the reader deletes its event once this returns
+  _pipeline.push(Event{EUTelAsyncLCWriter::takeEvent(event), -1});
+}
+
+void EUTelPipelineDriver::modifyEvent(EVENT::LCEvent *event) { marlin::ProcessorMgr::instance()->modifyEvent(event); }
+
+void EUTelPipelineDriver::end() {
+  _pipeline.finish();
+  for(std::size_t i = 0; i < _processors.size(); ++i) {
+    _processors[i]->end();
+    if(_nSkipped[i] > 0) {
+      streamlog_out(MESSAGE4) << _nSkipped[i] << " events skipped by " << _processors[i]->name() << std::endl;
+    }
+  }
+  marlin::ProcessorMgr::instance()->end();
+}
+
+std::vector<std::string> EUTelPipelineDriver::getConcurrentProcessors() const {
+  std::vector<std::string> names;
+  for(auto processor : _processors) names.push_back(processor->name());
+  return names;
+}
+
+void EUTelPipelineDriver::finalStage(Event &event) {
+  //as Marlin, check() is called up to the processor skipping the event
+  std::size_t const nChecked = event.skippedBy >= 0 ? static_cast<std::size_t>(event.skippedBy) : _processors.size();
+  for(std::size_t i = 0; i < nChecked; ++i) _processors[i]->check(event.event.get());
+  if(event.skippedBy >= 0) {
+    ++_nSkipped[static_cast<std::size_t>(event.skippedBy)];
+    return;
+  }
+  marlin::ProcessorMgr::instance()->processEvent(event.event.get());
+}
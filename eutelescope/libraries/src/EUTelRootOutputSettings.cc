@@ -0,0 +1,39 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelRootOutputSettings.h"
+
+// ROOT includes <>
+#include <TFile.h>
+#include <TTree.h>
+
+using namespace eutelescope;
+
+EUTelRootOutputSettings::EUTelRootOutputSettings()
+    : _basketSize(0), _autoFlush(0), _compressionAlgorithm(-1),
+      _compressionLevel(-1) {}
+
+void EUTelRootOutputSettings::apply(TFile *file) const {
+  if (file == nullptr)
+    return;
+  if (_compressionAlgorithm >= 0)
+    file->SetCompressionAlgorithm(_compressionAlgorithm);
+  if (_compressionLevel >= 0)
+    file->SetCompressionLevel(_compressionLevel);
+}
+
+void EUTelRootOutputSettings::apply(TTree *tree) const {
+  if (tree == nullptr)
+    return;
+  if (_basketSize > 0)
+    tree->SetBasketSize("*", _basketSize);
+  if (_autoFlush != 0)
+    tree->SetAutoFlush(_autoFlush);
+}
@@ -0,0 +1,52 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelStripClusterAssembler.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelStripClusterAssembler::EUTelStripClusterAssembler()
+    : _offsets(2, 0), _strips(), _fill() {}
+
+void EUTelStripClusterAssembler::assemble(std::vector<int> const &clusterNumber) {
+  int maxID = 0;
+  for(int id : clusterNumber) maxID = std::max(maxID, id);
+
+  //count the strips of every ID, shifted by one for the prefix sum
+  _offsets.assign(maxID + 2, 0);
+  for(int id : clusterNumber) {
+    if(id > 0) ++_offsets[id + 1];
+  }
+  for(std::size_t i = 1; i < _offsets.size(); ++i) _offsets[i] += _offsets[i - 1];
+
+  _strips.resize(_offsets.back());
+  _fill.assign(_offsets.begin(), _offsets.end() - 1);
+  for(std::size_t strip = 0; strip < clusterNumber.size(); ++strip) {
+    int const id = clusterNumber[strip];
+    if(id > 0) _strips[_fill[id]++] = strip;
+  }
+}
+
+void EUTelStripClusterAssembler::fillCluster(int clusterID, std::vector<float> const &signals,
+                                             bool stripsAlongY,
+                                             EUTelSparseClusterImpl<EUTelGenericSparsePixel> &cluster) const {
+  EUTelGenericSparsePixel pixel;
+  std::size_t const *strips = getStrips(clusterID);
+  for(std::size_t i = 0; i < getClusterSize(clusterID); ++i) {
+    short const strip = static_cast<short>(strips[i]);
+    pixel.setXCoord(stripsAlongY ? 0 : strip);
+    pixel.setYCoord(stripsAlongY ? strip : 0);
+    pixel.setSignal(signals[strips[i]]);
+    cluster.push_back(pixel);
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelStubMatcher.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace eutelescope;
+
+EUTelStubMatcher::EUTelStubMatcher() : _hits(), _sorted(), _sortByX(true) {}
+
+bool EUTelStubMatcher::isStub(Hit const &hit1, Hit const &hit2, float maxResidual) {
+  float const dx = std::fabs(hit1.x - hit2.x);
+  float const dy = std::fabs(hit1.y - hit2.y);
+  return dx < maxResidual && dy < maxResidual;
+}
+
+void EUTelStubMatcher::setSecondPlane(std::vector<Hit> const &hits) {
+  _hits = hits;
+
+  //sort along the axis with the larger spread, the other one is
+  //usually the same for all strips
+  float minX = std::numeric_limits<float>::max(), maxX = std::numeric_limits<float>::lowest();
+  float minY = minX, maxY = maxX;
+  for(auto const &hit : _hits) {
+    minX = std::min(minX, hit.x);
+    maxX = std::max(maxX, hit.x);
+    minY = std::min(minY, hit.y);
+    maxY = std::max(maxY, hit.y);
+  }
+  _sortByX = _hits.empty() || maxX - minX >= maxY - minY;
+
+  _sorted.clear();
+  for(std::size_t i = 0; i < _hits.size(); ++i) {
+    _sorted.emplace_back(_sortByX ? _hits[i].x : _hits[i].y, i);
+  }
+  std::sort(_sorted.begin(), _sorted.end());
+}
+
+void EUTelStubMatcher::findMatches(Hit const &hit1, float maxResidual,
+                                   std::vector<std::size_t> &matches) const {
+  matches.clear();
+  if(!(maxResidual > 0.f)) return;
+
+  //the window is a bit wider than the residual so that rounding in the
+  //difference can not lose a pair, isStub() decides exactly
+  float const key = _sortByX ? hit1.x : hit1.y;
+  float const width = maxResidual + 1e-5f * (std::fabs(key) + maxResidual);
+  auto it = std::lower_bound(_sorted.begin(), _sorted.end(),
+                             std::make_pair(key - width, std::size_t(0)));
+  for(; it != _sorted.end() && it->first <= key + width; ++it) {
+    if(isStub(hit1, _hits[it->second], maxResidual)) matches.push_back(it->second);
+  }
+  std::sort(matches.begin(), matches.end());
+}
@@ -0,0 +1,17 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelThreadSafeProcessor.h"
+
+using namespace eutelescope;
+
+// defined here, so that the type information the driver casts to is
+// the one of the library also for processors loaded by MARLIN_DLL
+EUTelThreadSafeProcessor::~EUTelThreadSafeProcessor() {}
@@ -0,0 +1,109 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelTrackHitAssignment.h"
+
+// system includes <>
+#include <algorithm>
+#include <limits>
+
+using namespace eutelescope;
+
+EUTelTrackHitAssignment::EUTelTrackHitAssignment()
+    : _trackToHit(), _nAssociations(0), _totalDistance(0.), _cost(),
+      _rowPotential(), _columnPotential(), _minSlack(), _columnRow(),
+      _previousColumn(), _visited() {}
+
+void EUTelTrackHitAssignment::solve(std::vector<double> const &distances,
+                                    std::size_t nTracks, std::size_t nHits) {
+  _trackToHit.assign(nTracks, -1);
+  _nAssociations = 0;
+  _totalDistance = 0.;
+  if(nTracks == 0 || nHits == 0) return;
+
+  //any one more pair has to be worth more than the largest possible total
+  //distance, which is below the sum of the largest distance of every track
+  double bonus = 1.;
+  for(std::size_t iT = 0; iT < nTracks; ++iT) {
+    double largest = 0.;
+    for(std::size_t iH = 0; iH < nHits; ++iH) largest = std::max(largest, distances[iT * nHits + iH]);
+    bonus += largest;
+  }
+
+  //1-based rows and columns as usual for this algorithm, index 0 is the
+  //virtual starting point of each augmenting path
+  std::size_t const nRows = nTracks;
+  std::size_t const nColumns = nHits + nTracks;
+  _cost.assign((nRows + 1) * (nColumns + 1), 0.);
+  for(std::size_t iT = 0; iT < nTracks; ++iT) {
+    for(std::size_t iH = 0; iH < nHits; ++iH) {
+      double const distance = distances[iT * nHits + iH];
+      //a forbidden pair is always worse than the not associated column
+      _cost[(iT + 1) * (nColumns + 1) + iH + 1] = distance < 0. ? bonus : distance - bonus;
+    }
+  }
+
+  double const infinity = std::numeric_limits<double>::infinity();
+  _rowPotential.assign(nRows + 1, 0.);
+  _columnPotential.assign(nColumns + 1, 0.);
+  _columnRow.assign(nColumns + 1, 0);
+  _previousColumn.assign(nColumns + 1, 0);
+
+  for(std::size_t row = 1; row <= nRows; ++row) {
+    _columnRow[0] = row;
+    std::size_t column = 0;
+    _minSlack.assign(nColumns + 1, infinity);
+    _visited.assign(nColumns + 1, 0);
+    do {
+      _visited[column] = 1;
+      std::size_t const currentRow = _columnRow[column];
+      double delta = infinity;
+      std::size_t nextColumn = 0;
+      for(std::size_t j = 1; j <= nColumns; ++j) {
+        if(_visited[j]) continue;
+        double const slack = _cost[currentRow * (nColumns + 1) + j] - _rowPotential[currentRow] - _columnPotential[j];
+        if(slack < _minSlack[j]) {
+          _minSlack[j] = slack;
+          _previousColumn[j] = column;
+        }
+        if(_minSlack[j] < delta) {
+          delta = _minSlack[j];
+          nextColumn = j;
+        }
+      }
+      for(std::size_t j = 0; j <= nColumns; ++j) {
+        if(_visited[j]) {
+          _rowPotential[_columnRow[j]] += delta;
+          _columnPotential[j] -= delta;
+        } else {
+          _minSlack[j] -= delta;
+        }
+      }
+      column = nextColumn;
+    } while(_columnRow[column] != 0);
+
+    //flip the augmenting path
+    do {
+      std::size_t const previous = _previousColumn[column];
+      _columnRow[column] = _columnRow[previous];
+      column = previous;
+    } while(column != 0);
+  }
+
+  for(std::size_t iH = 0; iH < nHits; ++iH) {
+    std::size_t const row = _columnRow[iH + 1];
+    if(row == 0) continue;
+    double const distance = distances[(row - 1) * nHits + iH];
+    if(distance < 0.) continue;
+    _trackToHit[row - 1] = static_cast<int>(iH);
+    ++_nAssociations;
+    _totalDistance += distance;
+  }
+}
@@ -0,0 +1,166 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelZSFixedFrameFinder.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace eutelescope;
+
+EUTelZSFixedFrameFinder::EUTelZSFixedFrameFinder(int goodPixel, int hitPixel,
+                                                 int missingPixel)
+    : _goodPixel(goodPixel), _hitPixel(hitPixel), _missingPixel(missingPixel),
+      _minX(0), _minY(0), _nPixelX(0), _nPixelY(0), _xClusterSize(0),
+      _yClusterSize(0), _signal(), _fired(), _hot(), _seeds(),
+      _nCandidates(0), _nSeedCandidates(0), _frameCharges(), _frameIndices(),
+      _clusters(), _charges() {}
+
+void EUTelZSFixedFrameFinder::configure(int minX, int minY, int nPixelX, int nPixelY) {
+  _minX = minX;
+  _minY = minY;
+  _nPixelX = std::max(nPixelX, 0);
+  _nPixelY = std::max(nPixelY, 0);
+  std::size_t const nPixel = static_cast<std::size_t>(_nPixelX) * static_cast<std::size_t>(_nPixelY);
+  _signal.assign(nPixel, 0.f);
+  _hot.assign(nPixel, 0);
+  _fired.clear();
+  _seeds.clear();
+  _nCandidates = 0;
+}
+
+bool EUTelZSFixedFrameFinder::isConfigured(int minX, int minY, int nPixelX, int nPixelY) const {
+  return !_signal.empty() && minX == _minX && minY == _minY && nPixelX == _nPixelX && nPixelY == _nPixelY;
+}
+
+void EUTelZSFixedFrameFinder::setHotPixel(int index) {
+  if(index >= 0 && static_cast<std::size_t>(index) < _hot.size()) _hot[index] = 1;
+}
+
+void EUTelZSFixedFrameFinder::setClusterSize(int xClusterSize, int yClusterSize) {
+  //the seed has to be in the center of the frame
+  if(xClusterSize <= 0 || xClusterSize % 2 == 0 || yClusterSize <= 0 || yClusterSize % 2 == 0) {
+    throw std::invalid_argument("EUTelZSFixedFrameFinder needs a positive and odd cluster size");
+  }
+  if(xClusterSize == _xClusterSize && yClusterSize == _yClusterSize) return;
+
+  _xClusterSize = xClusterSize;
+  _yClusterSize = yClusterSize;
+  std::size_t const frameSize = static_cast<std::size_t>(xClusterSize) * static_cast<std::size_t>(yClusterSize);
+  _frameCharges.assign(frameSize, 0.f);
+  _frameIndices.assign(frameSize, -1);
+}
+
+bool EUTelZSFixedFrameFinder::addPixel(int x, int y, float signal, std::vector<short> &status,
+                                       std::vector<float> const &noise, float seedCut) {
+  if(x < _minX || x >= _minX + _nPixelX || y < _minY || y >= _minY + _nPixelY) return false;
+  int const index = x - _minX + (y - _minY) * _nPixelX;
+
+  _signal[index] = signal;
+  _fired.push_back(index);
+  if(static_cast<int>(status.size()) <= index) status.resize(index + 1);
+
+  if(signal > seedCut * noise[index] && status[index] == _goodPixel) {
+    //hot pixels are counted as candidates, but never become seeds
+    if(!_hot[index]) _seeds.push_back(SeedCandidate{signal, static_cast<int>(_nCandidates), index});
+    ++_nCandidates;
+  }
+  return true;
+}
+
+void EUTelZSFixedFrameFinder::findClusters(std::vector<short> &status, std::vector<float> const &noise,
+                                           float clusterCut, int maxX, int maxY) {
+  _clusters.clear();
+  _charges.clear();
+  _nSeedCandidates = _nCandidates;
+  _nCandidates = 0;
+
+  //highest signal first, equal signals last come first. The seeds are
+  //only taken from a heap as needed: most candidates end up in the
+  //frame of a stronger one, a full sort would order them for nothing.
+  auto const lowerPriority = [](SeedCandidate const &a, SeedCandidate const &b) {
+    if(a.signal != b.signal) return a.signal < b.signal;
+    return a.order < b.order;
+  };
+  std::make_heap(_seeds.begin(), _seeds.end(), lowerPriority);
+
+  int const stepX = _xClusterSize / 2;
+  int const stepY = _yClusterSize / 2;
+
+  while(!_seeds.empty()) {
+    std::pop_heap(_seeds.begin(), _seeds.end(), lowerPriority);
+    SeedCandidate const seed = _seeds.back();
+    _seeds.pop_back();
+    if(status[seed.index] != _goodPixel) continue;
+
+    int const seedX = seed.index % _nPixelX + _minX;
+    int const seedY = seed.index / _nPixelX + _minY;
+
+    double clusterSignal = 0.;
+    double clusterNoise2 = 0.;
+    bool border = false;
+    bool incomplete = false;
+    bool merged = false;
+    std::size_t nIndices = 0;
+    std::size_t nCharges = 0;
+
+    //the seed pixel stays in the center of the frame
+    for(int yPixel = seedY - stepY; yPixel <= seedY + stepY; yPixel++) {
+      if(yPixel < 0 || yPixel > maxY) {
+        border = true;
+        std::fill_n(_frameCharges.begin() + nCharges, _xClusterSize, 0.f);
+        nCharges += _xClusterSize;
+        continue;
+      }
+      int const rowIndex = (yPixel - _minY) * _nPixelX - _minX;
+      for(int xPixel = seedX - stepX; xPixel <= seedX + stepX; xPixel++) {
+        if(xPixel < 0 || xPixel > maxX) {
+          border = true;
+          _frameCharges[nCharges++] = 0.f;
+          continue;
+        }
+        int const index = rowIndex + xPixel;
+        bool const isHit = status[index] == _hitPixel;
+        bool const isGood = status[index] == _goodPixel;
+
+        _frameIndices[nIndices++] = isGood ? index : -1;
+
+        if(isGood) {
+          //a good pixel without signal was not transmitted
+          if(_signal[index] == 0.f) status[index] = static_cast<short>(_missingPixel);
+          clusterSignal += _signal[index];
+          clusterNoise2 += static_cast<double>(noise[index]) * noise[index];
+          _frameCharges[nCharges++] = _signal[index];
+        } else if(isHit) {
+          incomplete = true;
+          merged = true;
+          _frameCharges[nCharges++] = 0.f;
+        } else {
+          incomplete = true;
+          _frameCharges[nCharges++] = 0.f;
+        }
+      }
+    }
+
+    if(!(clusterSignal > clusterCut * std::sqrt(clusterNoise2))) continue;
+
+    for(std::size_t i = 0; i < nIndices; ++i) {
+      if(_frameIndices[i] != -1) status[_frameIndices[i]] = static_cast<short>(_hitPixel);
+    }
+    _clusters.push_back(Cluster{seedX, seedY, border, incomplete, merged, _charges.size()});
+    _charges.insert(_charges.end(), _frameCharges.begin(), _frameCharges.begin() + nCharges);
+  }
+
+  //only the pixels of this event have to be cleared
+  for(int index : _fired) _signal[index] = 0.f;
+  _fired.clear();
+}
@@ -0,0 +1,180 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ""
+#include "EUTelParallel.h"
+#include "EUTelPipelineDriver.h"
+#include "anyoption.h"
+
+// marlin includes ""
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+#include "marlin/ProcessorEventSeeder.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/VerbosityLevels.h"
+#include "marlin/XMLParser.h"
+
+// gear includes ""
+#include "gear/GearMgr.h"
+#include "gearxml/GearXML.h"
+
+// lcio includes <>
+#include <Exceptions.h>
+#include <IO/LCReader.h>
+#include <lcio.h>
+
+// system includes <>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main( int argc, char ** argv ) {
+
+  unique_ptr<AnyOption> option( new AnyOption );
+
+  string usageString =
+    "\n"
+    "This program runs a Marlin steering file reading LCIOInputFiles.\n"
+    "The first active processors, as long as they are thread safe, work\n"
+    "on several events at a time. All other processors run as with Marlin,\n"
+    "on one event after the other in the order of the input.\n"
+    "The processor libraries are loaded from MARLIN_DLL.\n"
+    "\n"
+    "eutelpipeline [option] steering.xml\n"
+    "\n"
+    "-h --help          Print this help\n"
+    "-j --threads N     Number of worker threads, 0 (default) for one per core\n"
+    "-n --in-flight N   Maximum number of events in flight, default 4 per thread\n";
+
+  option->addUsage( usageString.c_str() );
+  option->setFlag( "help", 'h' );
+  option->setOption( "threads", 'j' );
+  option->setOption( "in-flight", 'n' );
+
+  option->processCommandArgs( argc, argv );
+
+  if ( option->getFlag( 'h' ) || option->getFlag( "help" ) ) {
+    option->printUsage();
+    return 0;
+  }
+
+  if ( option->getArgc() != 1 ) {
+    cerr << "Please provide exactly one steering file" << endl;
+    option->printUsage();
+    return 2;
+  }
+  string const steeringFileName = option->getArgv( 0 );
+
+  int nThreads = 0;
+  if ( option->getValue( "threads" ) != nullptr ) nThreads = atoi( option->getValue( "threads" ) );
+  size_t maxInFlight = 4 * eutelescope::Utility::resolveThreadCount( nThreads );
+  if ( option->getValue( "in-flight" ) != nullptr ) maxInFlight = strtoul( option->getValue( "in-flight" ), nullptr, 10 );
+
+  streamlog::out.init( cout, "eutelpipeline" );
+
+  try {
+
+    // the processors register themselves when their library is loaded, as with Marlin
+    if ( char const * libraries = getenv( "MARLIN_DLL" ) ) {
+      stringstream libraryList( libraries );
+      string library;
+      while ( getline( libraryList, library, ':' ) ) {
+        if ( library.empty() ) continue;
+        if ( dlopen( library.c_str(), RTLD_LAZY | RTLD_GLOBAL ) == nullptr ) {
+          cerr << "Cannot load " << library << ": " << dlerror() << endl;
+          return 1;
+        }
+      }
+    }
+
+    marlin::XMLParser parser( steeringFileName );
+    parser.parse();
+    marlin::Global::parameters = parser.getParameters( "Global" );
+    auto globals = marlin::Global::parameters;
+    if ( !globals ) {
+      cerr << "No global section in " << steeringFileName << endl;
+      return 1;
+    }
+
+    streamlog::logscope scope( streamlog::out );
+    string const verbosity = globals->getStringVal( "Verbosity" );
+    if ( !verbosity.empty() ) scope.setLevel( verbosity );
+
+    string const gearFileName = globals->getStringVal( "GearXMLFile" );
+    if ( !gearFileName.empty() ) {
+      gear::GearXML gearXML( gearFileName );
+      marlin::Global::GEAR = gearXML.createGearMgr();
+    }
+    marlin::Global::EVENTSEEDER = new marlin::ProcessorEventSeeder();
+
+    vector< string > activeProcessors, conditions;
+    globals->getStringVals( "ActiveProcessors", activeProcessors );
+    globals->getStringVals( "ProcessorConditions", conditions );
+    if ( conditions.size() != activeProcessors.size() ) conditions.clear();
+
+    for ( size_t iProc = 0; iProc < activeProcessors.size(); ++iProc ) {
+      auto parameters = parser.getParameters( activeProcessors[ iProc ] );
+      if ( !parameters ) {
+        cerr << "No parameters for processor " << activeProcessors[ iProc ] << endl;
+        return 1;
+      }
+      string const type = parameters->getStringVal( "ProcessorType" );
+      bool const added = conditions.empty()
+        ? marlin::ProcessorMgr::instance()->addActiveProcessor( type, activeProcessors[ iProc ], parameters )
+        : marlin::ProcessorMgr::instance()->addActiveProcessor( type, activeProcessors[ iProc ], parameters, conditions[ iProc ] );
+      if ( !added ) {
+        cerr << "Cannot add processor " << activeProcessors[ iProc ] << " of type " << type << endl;
+        return 1;
+      }
+    }
+
+    vector< string > inputFileNames;
+    globals->getStringVals( "LCIOInputFiles", inputFileNames );
+    if ( inputFileNames.empty() ) {
+      cerr << "Please provide LCIOInputFiles, data source processors are not supported" << endl;
+      return 2;
+    }
+    int const maxRecord = globals->getIntVal( "MaxRecordNumber" );
+    int const skipNEvents = globals->getIntVal( "SkipNEvents" );
+
+    eutelescope::EUTelPipelineDriver driver( nThreads, maxInFlight );
+    driver.init( activeProcessors, conditions );
+
+    unique_ptr< lcio::LCReader > lcReader( lcio::LCFactory::getInstance()->createLCReader() );
+    lcReader->registerLCRunListener( &driver );
+    lcReader->registerLCEventListener( &driver );
+    lcReader->open( inputFileNames );
+    if ( skipNEvents > 0 ) lcReader->skipNEvents( skipNEvents );
+
+    try {
+      if ( maxRecord > 0 ) lcReader->readStream( maxRecord );
+      else lcReader->readStream();
+    } catch ( lcio::EndOfDataException & e ) {
+      streamlog_out( WARNING ) << e.what() << endl;
+    } catch ( marlin::StopProcessingException & e ) {
+      streamlog_out( MESSAGE4 ) << "Processing stopped: " << e.what() << endl;
+    }
+
+    lcReader->close();
+    driver.end();
+
+  } catch ( std::exception & e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -3,6 +3,7 @@
 
 // eutelescope includes
 #include "EUTelAlignmentConstant.h"
+#include "EUTelMillepedeResult.h"
 #include "anyoption.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
@@ -197,12 +198,14 @@ int main( int argc, char ** argv ) {
     "\n"
     "Usage: pede2lcio [options] conversion_file lciofile.slcio [old GEAR file] [new GEAR file]\n\n"
     "-h --help       To print this help\n"
-    "-g --gear       To generate GEAR file"
+    "-g --gear       To generate GEAR file\n"
+    "-r --res        The conversion file is a millepede.res file as written by pede"
     "\n";
 
   option->addUsage( usageString.c_str() );
   option->setFlag( "help", 'h');
   option->setFlag( "gear", 'g');
+  option->setFlag( "res", 'r');
 
   // process the command line arguments
   option->processCommandArgs( argc, argv );
@@ -246,6 +249,8 @@ int main( int argc, char ** argv ) {
     
     streamlog_out(MESSAGE4) << " oldGear: " << oldGearFileName << " newGear: " << newGearFileName << std::endl;
   }
+
+  bool isResFile = ( option->getFlag('r') || option->getFlag( "res" ) );
   
   streamlog_out(MESSAGE4) << "Converting " << pedeFileName << " in " << lcioFileName << std::endl;
 
@@ -298,7 +303,52 @@ int main( int argc, char ** argv ) {
 
     int sensorID = 0;
 
-    while ( getline( pedeFile, line ) ) {
+    if( isResFile ) {
+
+      // the parameter numbers are assigned as in EUTelPedeGEAR, the unit
+      // is mm (GBL) and the pede rotations are defined the other way around
+      EUTelMillepedeResult result;
+      result.parse( pedeFile );
+      vector< EUTelMillepedeResult::Quantity > layout = EUTelMillepedeResult::layout( result.maxParameterNumber() );
+
+      if( layout.empty() ) {
+        cerr << "Cannot interpret " << result.maxParameterNumber() << " parameters per sensor in " << pedeFileName << std::endl;
+        lcWriter->close();
+        delete event;
+        delete constantsCollection;
+        return -3;
+      }
+
+      for( int id : result.sensorIDs() ) {
+        EUTelAlignmentConstant * constant = new EUTelAlignmentConstant;
+        constant->setSensorID( id );
+        for( size_t iParam = 0; iParam < layout.size(); ++iParam ) {
+          const EUTelMillepedeResult::Parameter& par = result.getParameter( id, static_cast<int>(iParam) + 1 );
+          if( !par.present ) continue;
+          switch( layout[iParam] ) {
+            case EUTelMillepedeResult::kXOff:
+              constant->setXOffset( par.value ); constant->setXOffsetError( par.error ); break;
+            case EUTelMillepedeResult::kYOff:
+              constant->setYOffset( par.value ); constant->setYOffsetError( par.error ); break;
+            case EUTelMillepedeResult::kZOff:
+              constant->setZOffset( par.value ); constant->setZOffsetError( par.error ); break;
+            case EUTelMillepedeResult::kAlpha:
+              constant->setAlpha( -par.value ); constant->setAlphaError( par.error ); break;
+            case EUTelMillepedeResult::kBeta:
+              constant->setBeta( -par.value ); constant->setBetaError( par.error ); break;
+            case EUTelMillepedeResult::kGamma:
+              constant->setGamma( -par.value ); constant->setGammaError( par.error ); break;
+            default:
+              break;
+          }
+        }
+        constants_map[id] = constant;
+      }
+
+    }
+
+    // legacy conversion file format
+    while ( !isResFile && getline( pedeFile, line ) ) {
 
       bool goodLine = false;
 
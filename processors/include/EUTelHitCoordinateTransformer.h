@@ -14,7 +14,9 @@
 
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
+#include "EUTelThreadSafeProcessor.h"
 #include "EUTelUtility.h"
+#include "CellIDReencoder.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -35,14 +37,26 @@
 #include <AIDA/IBaseHistogram.h>
 #endif
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerHitImpl.h>
 
 // system includes <>
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace eutelescope {
 
-  class EUTelHitCoordinateTransformer : public marlin::Processor {
+  namespace geo {
+    class EUTelGeometryTelescopeGeoDescription;
+  }
+
+  //! Transforms hits from local to global coordinates or back
+  /*! Thread safe: the decoders, buffers and counters are kept per
+   *  thread, see EUTelThreadSafeProcessor.
+   */
+  class EUTelHitCoordinateTransformer : public marlin::Processor, public EUTelThreadSafeProcessor {
 
   private:
     DISALLOW_COPY_AND_ASSIGN(EUTelHitCoordinateTransformer)
@@ -68,13 +82,57 @@ namespace eutelescope {
     // Called at the end of the job
     virtual void end();
 
+    //! Always thread safe
+    virtual bool isThreadSafe() const { return true; }
+
+    //! One set of decoders and buffers per thread
+    virtual void prepareThreads(unsigned int nThreads);
+
+    //! Transform the hits of an event with the state of a thread
+    virtual void processEventConcurrently(LCEvent *event, unsigned int thread);
+
   private:
+    //! Everything changing from event to event, per thread
+    struct ThreadState {
+      ThreadState();
+
+      //! Rebuild decoder and re-encoder if the encoding string changed
+      void setEncoding(std::string const &encoding);
+
+      //! Encoding the decoder and re-encoder have been built for
+      std::string cachedEncoding;
+      std::unique_ptr<lcio::CellIDDecoder<TrackerHitImpl>> hitDecoder;
+      std::unique_ptr<lcio::UTIL::CellIDReencoder<TrackerHitImpl>> cellReencoder;
+      //! Collection the re-encoder has been attached to, its flag is
+      //! copied to every output collection
+      std::unique_ptr<LCCollectionVec> encodingTemplate;
+      std::size_t propertiesIndex;
+      std::size_t sensorIDIndex;
+
+      //! Decoded cellIDs of the current event, all hits are checked
+      //! before the first output hit is created
+      std::vector<int> hitSensorIDs;
+      std::vector<int> hitProperties;
+
+      //! Throughput report at the end of the job
+      long nHits;
+      std::chrono::steady_clock::duration transformTime;
+      //! Reported at the end of the job, nothing is printed per event
+      long nUnknownType;
+      long nMissingInput;
+    };
+
     // Collection names
     std::string _hitCollectionNameInput;
     std::string _hitCollectionNameOutput;
     
     //parameter
     bool _undoAlignment;
+
+    //! Looked up once in init(), gGeometry() counts its calls
+    geo::EUTelGeometryTelescopeGeoDescription *_geometry;
+
+    std::vector<ThreadState> _threads;
   };
 
   //! A global instance of the processor
@@ -11,6 +11,7 @@
 
 #ifdef USE_GEAR
 // eutelescope includes ".h"
+#include "EUTelThreadSafeProcessor.h"
 #include "EUTelUtility.h"
 
 // marlin includes ".h"
@@ -40,6 +41,10 @@
 
 namespace eutelescope {
 
+  namespace geo {
+    class EUTelGeometryTelescopeGeoDescription;
+  }
+
   //! Hit maker processor
   /*! Beyond this cryptic name there is a simple as important
    *  processor. This is the place were clusters found in the
@@ -223,9 +228,11 @@ namespace eutelescope {
    *  amount of memory and consequently slowing down the full
    *  processing.
    *
+   *  Thread safe without PlotHistograms: the counters are kept per
+   *  thread, see EUTelThreadSafeProcessor.
    */
 
-  class EUTelHitMaker : public marlin::Processor {
+  class EUTelHitMaker : public marlin::Processor, public EUTelThreadSafeProcessor {
 
   private:
     DISALLOW_COPY_AND_ASSIGN(EUTelHitMaker)
@@ -285,6 +292,15 @@ namespace eutelescope {
      */
     virtual void end();
 
+    //! Thread safe unless histograms are filled
+    virtual bool isThreadSafe() const { return !_histogramSwitch; }
+
+    //! One set of counters per thread
+    virtual void prepareThreads(unsigned int nThreads);
+
+    //! Make the hits of an event with the counters of a thread
+    virtual void processEventConcurrently(LCEvent *evt, unsigned int thread);
+
     //! Histogram booking
     /*! Some control histograms are filled during this procedure in
      *  order to be able to perform easy check on the quality of the
@@ -320,11 +336,22 @@ namespace eutelescope {
     bool _histogramSwitch;
 
   private:
+    //! Counters of a thread, reported at the end of the job as
+    //! nothing is printed per event
+    struct ThreadState {
+      ThreadState();
+
+      long nUnknownType;
+      long nMissingInput;
+    };
+
     //! Run number
     int _iRun;
 
-    //! Event number
-    int _iEvt;
+    //! Looked up once in init(), gGeometry() counts its calls
+    geo::EUTelGeometryTelescopeGeoDescription *_geometry;
+
+    std::vector<ThreadState> _threads;
 
     //! Set of booked histogram
     /*  This helper set is used by the on-the-fly histogram booking
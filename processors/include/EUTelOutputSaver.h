@@ -12,6 +12,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelAsyncLCWriter.h"
 
 // marlin includes ".h"
 #include "marlin/LCIOOutputProcessor.h"
@@ -20,6 +21,9 @@
 #include <IO/LCWriter.h>
 #include <lcio.h>
 
+// system includes <>
+#include <memory>
+
 namespace eutelescope {
 
   //! EUTelescope specific output processor
@@ -66,8 +70,20 @@ namespace eutelescope {
    *  @see eutelescope::EventType
    *  @see eutelescope::EUTelEventImpl
    *
+   *  Compressing and writing the events can be moved to a separate
+   *  thread by setting WriterQueueSize to the number of events that may
+   *  wait for it. The collections of each event are then moved out of
+   *  the event into the queue, which is why this processor has to be
+   *  the last one. Collections made transient (dropped) stay in the
+   *  event. This is not possible together with FullSubsetCollections,
+   *  and needs LCIO v02-13 or newer, where SIO can be used by the
+   *  reader and the writer thread at the same time; with older
+   *  versions the events are written in the event loop.
+   *
    *  @param All parameters available in LCIOOutputProcessor
    *  @param SkipIntermediateEORE Remove EORE in between following runs.
+   *  @param WriterQueueSize Events queued for the writer thread, 0 to
+   *  write in the event loop.
    *
    */
 
@@ -141,6 +157,15 @@ namespace eutelescope {
      *
      */
     bool _skipIntermediateEORESwitch;
+
+    //! Maximum number of events waiting for the writer thread
+    /*! With 0, the default, there is no writer thread and the events
+     *  are written by processEvent.
+     */
+    int _writerQueueSize;
+
+    //! The writer thread, only with a positive _writerQueueSize
+    std::unique_ptr<EUTelAsyncLCWriter> _asyncWriter;
   };
 
   //! A global instance of EUTelOutputSaver
@@ -97,6 +97,9 @@ namespace eutelescope {
 
 	bool _unitConversion;
 
+    //! Wall-clock limit for the pede execution in seconds, 0 disables it
+    double _pedeTimeout;
+
   private:
     //! Run number
     int _iRun;
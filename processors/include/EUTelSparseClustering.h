@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
+#include "EUTelThreadSafeProcessor.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -79,10 +80,14 @@ namespace eutelescope {
    *
    *  @param PulseCollectionName The name of the output TrackerPulse collection.
    *
+   *  Thread safe without HistogramFilling: the cluster counters are
+   *  kept per thread, the geometry and the sensorIDs parameter of the
+   *  first event are set in check(), see EUTelThreadSafeProcessor.
    */
 
   class EUTelSparseClustering : public marlin::Processor,
-                                public marlin::EventModifier {
+                                public marlin::EventModifier,
+                                public EUTelThreadSafeProcessor {
 
   public:
     //! Returns a new instance of EUTelSparseClustering
@@ -139,13 +144,14 @@ namespace eutelescope {
 
     //! Check event method
     /*! This method is called by the Marlin execution framework as
-     *  soon as the processEvent is over. It can be used to fill check
-     *  plots. For the time being there is nothing to check and do in
-     *  this slot.
+     *  soon as the processEvent is over. Called in the order of the
+     *  events, it initializes the geometry and adds the sensorIDs
+     *  parameter to the pulse collection of the first event, if
+     *  processEvent() has not done so already.
      *
      *  @param evt The LCEvent event as passed by the ProcessMgr
      */
-    virtual void check(LCEvent*){};
+    virtual void check(LCEvent *evt);
 
     //! Called after data processing.
     /*! This method is called when the loop on events is finished. It
@@ -153,6 +159,15 @@ namespace eutelescope {
      */
     virtual void end();
 
+    //! Thread safe unless histograms are filled
+    virtual bool isThreadSafe() const { return !_fillHistos; }
+
+    //! One set of cluster counters per thread
+    virtual void prepareThreads(unsigned int nThreads);
+
+    //! Look for clusters in an event with the counters of a thread
+    virtual void processEventConcurrently(LCEvent *evt, unsigned int thread);
+
     //! Book histograms
     /*! This method is used to prepare the needed directory structure
      *  within the current ITree folder and books all required
@@ -189,10 +204,14 @@ namespace eutelescope {
      *  and groups them together.
      *
      *  @param evt The LCIO event has passed by processEvent(LCEvent*)
+     *  @param zsInput The collection of zero suppressed data
      *  @param pulse The collection of pulses to append the found
      *  clusters.
+     *  @param clusterMap Incremented by the clusters found per sensorID
      */
-    void sparseClustering(LCEvent *evt, LCCollectionVec *pulse);
+    void sparseClustering(LCEvent *evt, LCCollectionVec *zsInput,
+                          LCCollectionVec *pulse,
+                          std::map<int, int> &clusterMap);
 
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
@@ -207,20 +226,11 @@ namespace eutelescope {
      */
     std::string _pulseCollectionName;
 
-    //! Pulse collection size
-    size_t _initialPulseCollectionSize;
-
     //! Current run number.
     /*! This number is used to store the current run number
      */
     int _iRun;
 
-    //! Current event number.
-    /*! This number is used to store the current event number NOTE that
-     *  events are counted from 0 and on a run base
-     */
-    int _iEvt;
-
     //! Fill histogram switch
     /*! This boolean is used to switch on and off the filling of
      *  histograms.
@@ -230,8 +240,25 @@ namespace eutelescope {
   private:
     DISALLOW_COPY_AND_ASSIGN(EUTelSparseClustering)
 
+    //! Everything changing from event to event, per thread
+    struct ThreadState {
+      ThreadState();
+
+      //! Clusters found per sensorID, summed up in end()
+      std::map<int, int> clusterMap;
+      //! Pulse collection size before and after the current event
+      size_t initialPulseCollectionSize;
+      size_t pulseCollectionSize;
+      //! Reported at the end of the job, nothing is printed per event
+      long nUnknownType;
+      long nMissingInput;
+    };
+
     //! read secondary collections
-    void readCollections(LCEvent *evt);
+    LCCollectionVec *readCollections(LCEvent *evt, ThreadState &state);
+
+    //! Geometry and sensorIDs parameter from the first event, in event order
+    void tagSensorIDs(LCEvent *evt);
 
     //! Total cluster found
     /*! This is a map correlating the sensorID number and the
@@ -268,19 +295,21 @@ namespace eutelescope {
      */
     bool _isGeometryReady;
 
+    //! Whether the sensorIDs parameter has been set on a pulse collection
+    bool _areSensorIDsTagged;
+
     //! SensorID vector
     /*! This is a vector of sensorID
      */
     std::vector<int> _sensorIDVec;
 
-    //! Zero Suppressed Data Collection
-    LCCollectionVec *_zsInputDataCollectionVec;
-
     //! pulse Collection
     LCCollectionVec *_pulseCollectionVec;
 
     //! Squared cut value for distance in pixel index count (integer!)
     int _sparseMinDistanceSquared;
+
+    std::vector<ThreadState> _threads;
   };
 
   //! A global instance of the processor
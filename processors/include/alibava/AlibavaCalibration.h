@@ -19,9 +19,11 @@
 
 // ROOT includes <>
 #include "TObject.h"
+#include "TProfile.h"
 
 // system includes <>
 #include <string>
+#include <vector>
 
 
 namespace alibava
@@ -63,6 +65,23 @@ namespace alibava
 
 	    std::map < std::string , TObject * > _rootObjectMap;
 
+	    // index of a channel in the flat per channel arrays
+	    unsigned int getChanIndex ( unsigned int ichip, unsigned int ichan ) const
+	    {
+		return ichip * ALIBAVA::NOOFCHANNELS + ichan;
+	    }
+
+	    // charge and delay calibration profiles, resolved once in bookHistos
+	    // indexed with getChanIndex, null for masked channels
+	    std::vector < TProfile * > _chargeCalHistos;
+	    std::vector < TProfile * > _delayCalHistos;
+
+	    // also fit the profiles with ROOT and compare
+	    bool _rootFitCrossCheck;
+
+	    // number of threads for the loop over channels, 0 uses all cores
+	    int _nThreads;
+
 	};
 
 	AlibavaCalibration gAlibavaCalibration;
@@ -16,16 +16,33 @@
 
 // lcio includes <.h>
 #include <lcio.h>
+#include <IO/LCReader.h>
+#include <IO/LCWriter.h>
 #include <UTIL/LCTOOLS.h>
 #include <IMPL/LCRunHeaderImpl.h>
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
 
 // system includes <>
+#include <map>
+#include <memory>
 #include <string>
 
 namespace alibava
 {
 
+    // The manager keeps an in-memory table with the content of one
+    // AlibavaPedNoiCalFile: for each collection the data vector of each
+    // chip, together with a copy of the run header and of the event
+    // header. Flag and parameters of the collections are kept, as well
+    // as the collections which are not of type TRACKERDATA. The file is
+    // read once into the table, callers can stage as many collections
+    // and chips as they want and everything is written back in one
+    // pass.
+    //
+    // getPedNoiCalForChip and addToFile work on this table as well, so
+    // that one manager reads a file only once for all chips and
+    // collections.
     class AlibavaPedNoiCalIOManager
     {
 	public:
@@ -38,29 +55,57 @@ namespace alibava
 
 	    lcio::FloatVec getPedNoiCalForChip ( std::string filename, std::string collectionName, unsigned int chipnum );
 
-	private:
+	    // reads the whole file into the table, replacing its content
+	    // returns false if the file could not be read
+	    bool readFile ( std::string filename );
+
+	    // stages the data vector of a chip in the table, replacing the existing one
+	    void stageForChip ( std::string collectionName, int chipnum, lcio::FloatVec datavec );
+
+	    // returns the data vector of a chip from the table, empty if it doesn't exist
+	    lcio::FloatVec getStagedForChip ( std::string collectionName, int chipnum ) const;
 
-	    // gets data vector from an event
-	    lcio::FloatVec getDataFromEventForChip ( lcio::LCEvent* evt, std::string collectionName, unsigned int chipnum );
+	    // writes the run header and all collections of the table in one pass
+	    void writeFile ( std::string filename );
 
-	    // returns true if the collection exists in the event
-	    bool doesCollectionExist ( lcio::LCEvent* evt, std::string collectionName );
+	    // empties the table and forgets which file it belongs to
+	    void clearTable ( );
 
-	    // returns the element number of the TrackerData with the chosen chipnum in collection col.
-	    // returns -1 if it doesn't exist.
-	    int getElementNumberOfChip ( lcio::LCCollectionVec* col, int chipnum );
+	    // returns the number of times this manager opened the file, for reading or writing
+	    unsigned int getNumberOfFileOpenings ( std::string filename ) const;
+
+	private:
 
 	    // checks if the file exists
 	    bool doesFileExist ( std::string astring );
 
-	    // to create a file with an empty runheader
-	    void createFile ( std::string filename );
+	    // counts and opens the file for reading
+	    void openForReading ( lcio::LCReader* lcReader, std::string filename );
+
+	    // counts and opens the file for writing
+	    void openForWriting ( lcio::LCWriter* lcWriter, std::string filename );
+
+	    // the file the table belongs to, empty if none
+	    std::string _tableFile;
+
+	    // collection name -> chip number -> data vector
+	    std::map < std::string, std::map < int, lcio::FloatVec > > _table;
+
+	    // copy of the run header of the table file
+	    std::unique_ptr < lcio::LCRunHeaderImpl > _runHeader;
+
+	    // copy of the event header (without collections) of the table file
+	    std::unique_ptr < lcio::LCEventImpl > _eventHeader;
+
+	    // flag and parameters of the TRACKERDATA collections of the table
+	    // file, as collections without elements
+	    std::map < std::string, std::unique_ptr < lcio::LCCollectionVec > > _collectionHeaders;
 
-	    // returns a copy of runHeader of existing AlibavaPedNoiCalFile
-	    lcio::LCRunHeaderImpl* getRunHeader ( std::string filename );
+	    // the collections of the table file of another type, written back unchanged
+	    std::map < std::string, std::unique_ptr < lcio::LCCollectionVec > > _otherCollections;
 
-	    // returns a copy of lcevent of existing AlibavaPedNoiCalFile
-	    lcio::LCEventImpl* getEvent ( std::string filename );
+	    // number of openings per file name
+	    std::map < std::string, unsigned int > _fileOpenings;
 
     };
 }
@@ -22,10 +22,13 @@
 
 // ROOT includes <>
 #include "TObject.h"
+#include "TH1D.h"
+#include "TF1.h"
 
 // system includes <>
 #include <string>
 #include <list>
+#include <vector>
 
 namespace alibava
 {
@@ -86,6 +89,25 @@ namespace alibava
 	    //! Calculates and saves pedestal and noise values
 	    void calculatePedestalNoise ( );
 
+	    //! Index of a channel in the flat per channel arrays
+	    unsigned int getChanIndex ( unsigned int ichip, unsigned int ichan ) const
+	    {
+		return ichip * ALIBAVA::NOOFCHANNELS + ichan;
+	    }
+
+	    //! The channel data histograms, resolved once in bookHistos
+	    /*! Indexed with getChanIndex, null for masked channels and
+	     *  chips which are not selected. The histograms are owned by
+	     *  _rootObjectMap.
+	     */
+	    std::vector < TH1D * > _chanDataHistos;
+
+	    //! The channel fits, indexed as _chanDataHistos
+	    std::vector < TF1 * > _chanDataFits;
+
+	    //! Number of threads for the channel fits, 0 uses all cores
+	    int _nFitThreads;
+
     };
 
     //! A global instance of the processor
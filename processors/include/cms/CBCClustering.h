@@ -11,6 +11,9 @@
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
+// eutelescope includes ".h"
+#include "EUTelStripClusterAssembler.h"
+
 // system includes <>
 #include <string>
 
@@ -68,6 +71,9 @@ namespace eutelescope
 
 	    std::map < std::string, AIDA::IBaseHistogram * > _aidaHistoMap;
 
+	    //! Strip buckets per cluster, reused for every sensor and event
+	    EUTelStripClusterAssembler _clusterAssembler;
+
     };
 
     //! A global instance of the processor
@@ -15,7 +15,12 @@
 #include <gear/SiPlanesParameters.h>
 #include <gear/SiPlanesLayerLayout.h>
 
+// AIDA includes <.h>
+#include <AIDA/IBaseHistogram.h>
+#include <AIDA/IHistogram1D.h>
+
 // system includes <>
+#include <Eigen/Core>
 #include <string>
 #include <map>
 
@@ -49,11 +54,6 @@ namespace eutelescope
 
             void fillHistos();
 
-            void vector_set_length(double *& vec, double length);
-            double vector_get_length(const double *vec);
-            double cos_alpha(const double *vec1,const double *vec2);
-            double* hit_pos(const double track[],const double normal[],const double virtual_hit[], double distance);
-
             virtual void end();
 
             std::string _InputTrackCollectionName;
@@ -68,21 +68,28 @@ namespace eutelescope
 
             std::vector<int> _cbcRealDUTsVec;
 
-            double *_VirtualDutNormal_zplus;
-            double *_VirtualDutNormal_zminus;
-            double *_VirtualDutPos;
+            Eigen::Vector3d _VirtualDutNormal_zplus;
+            Eigen::Vector3d _VirtualDutNormal_zminus;
+            Eigen::Vector3d _VirtualDutPos;
 
             gear::SiPlanesParameters * _siPlanesParameters;
             gear::SiPlanesLayerLayout * _siPlanesLayerLayout;
 
             // map of the vectors
-            std::map < int, double* > _dutPosMap;
-            std::map < int, double* > _dutNormalMap;
+            std::map < int, Eigen::Vector3d > _dutPosMap;
+            std::map < int, Eigen::Vector3d > _dutNormalMap;
 
         protected:
 
             std::map < std::string, AIDA::IBaseHistogram * > _aidaHistoMap;
 
+            // histograms filled for every track, resolved in bookHistos
+            AIDA::IHistogram1D * _virtualHitPosHisto[3];
+            AIDA::IHistogram1D * _cosPhiHisto;
+            AIDA::IHistogram1D * _fitHitPosHisto[2][3];
+            AIDA::IHistogram1D * _virtualResidualXHisto;
+            AIDA::IHistogram1D * _residualXHisto[2];
+
     };
 
     //! A global instance of the processor
@@ -10,6 +10,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelStubMatcher.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -76,8 +77,13 @@ namespace eutelescope
 
 	    int _totalpl2;
 
+	    bool _fillPairHistos;
+
 	    TrackerHitImpl* cloneHit ( TrackerHitImpl *inputHit );
 
+	    //! Centre of gravity and charge of the cluster of a DUT hit
+	    EUTelStubMatcher::Hit decodeCluster ( TrackerHitImpl *inputHit );
+
 	private:
 
     };
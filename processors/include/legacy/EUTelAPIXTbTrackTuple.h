@@ -97,6 +97,19 @@ namespace eutelescope {
 
     TTree *_versionTree;
     std::vector<double> *_versionNo;
+
+    //! Whether a sensor is a DUT, indexed by the sensor ID
+    std::vector<bool> _isDUT;
+    bool isDUT(int sensorID) const {
+      return sensorID >= 0 && static_cast<size_t>(sensorID) < _isDUT.size() &&
+             _isDUT[sensorID];
+    }
+
+    //! Output tree settings, see EUTelRootOutputSettings
+    int _basketSize;
+    int _autoFlush;
+    int _compressionAlgorithm;
+    int _compressionLevel;
   };
 
   //! A global instance of the processor.
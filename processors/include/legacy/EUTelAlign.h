@@ -14,6 +14,7 @@
 // built only if GEAR is available
 #ifdef USE_GEAR
 // eutelescope includes ".h"
+#include "EUTelAlignmentChi2.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -35,19 +36,11 @@
 #include <string>
 #include <vector>
 
-#if defined(USE_ROOT) || defined(MARLIN_USE_ROOT)
-#include "TMinuit.h"
-class TMinuit;
-#endif
-
 namespace eutelescope {
 
   class EUTelAlign : public marlin::Processor {
 
   public:
-    static void Chi2Function(Int_t &npar, Double_t *gin, Double_t &f,
-                             Double_t *par, Int_t iflag);
-
     //! Variables for hit parameters
     class HitsForFit {
     public:
@@ -134,7 +127,8 @@ namespace eutelescope {
     void bookHistos();
 
   protected:
-    static std::vector<HitsForFit> _hitsForFit;
+    //! Hit pairs and chi2 objective of this instance
+    EUTelAlignmentChi2 _alignmentChi2;
 
     //! TrackerHit collection name
     /*! Input collection with measured hits.
@@ -158,6 +152,9 @@ namespace eutelescope {
 
     std::vector<float> _startValuesForAlignment;
 
+    //! Number of threads used to evaluate the chi2, 0 for all cores
+    int _nThreads;
+
   private:
     //! Run number
     int _iRun;
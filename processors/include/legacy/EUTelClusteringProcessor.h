@@ -15,6 +15,8 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelDigitalFixedFrameFinder.h"
+#include "EUTelZSFixedFrameFinder.h"
 #include "EUTelExceptions.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
@@ -856,6 +858,16 @@ namespace eutelescope {
 
     std::vector<std::map<int, int>> _hitIndexMapVec;
 
+    //! Pixel maps of the digital fixed frame clustering, by sensor ID
+    /*! Allocated at the first event of each sensor with the hot pixels
+     *  of _hitIndexMapVec already masked.
+     */
+    std::map<int, EUTelDigitalFixedFrameFinder> _digitalFrameFinders;
+
+    //! Signal maps and seed buffers of the zs fixed frame clustering,
+    //! by sensor ID
+    std::map<int, EUTelZSFixedFrameFinder> _zsFrameFinders;
+
     int ID;
   };
 
@@ -13,6 +13,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelDUTHitMatcher.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -226,6 +227,10 @@ namespace eutelescope {
     int _trackNCluXCut;
     int _trackNCluYCut;
 
+    //! Match tracks in order instead of by increasing distance
+    bool _greedyMatching;
+    EUTelDUTHitMatcher _hitMatcher;
+
     std::vector<double> _measuredX;
     std::vector<double> _measuredY;
 
@@ -15,6 +15,7 @@
 // eutelescope includes
 #include "EUTelAlignmentConstant.h"
 #include "EUTelDafTrackerSystem.h"
+#include "EUTelPlaneIndexLookup.h"
 #include "EUTelUtility.h"
 
 // marlin includes ".h"
@@ -125,7 +126,7 @@ namespace eutelescope {
     virtual void dafEnd() { ; }
     virtual void dafParams() { ; }
 
-    size_t getPlaneIndex(float zPos);
+    int getPlaneIndex(int sensorID, float zPos);
     float getScatterThetaVar(float radLength);
     void readHitCollection(LCEvent *event);
     void bookHistos();
@@ -144,8 +145,8 @@ namespace eutelescope {
     void getPlaneNorm(daffitter::FitPlane<float> &pl);
 
     daffitter::TrackerSystem<float, 4> _system;
-    std::map<float, int> _zSort;
-    std::map<int, int> _indexIDMap;
+    //! Plane index by sensor ID, with z position fallback
+    EUTelPlaneIndexLookup _planeLookup;
     std::vector<float> _radLength;
     std::vector<float> _sigmaX, _sigmaY;
 
@@ -13,6 +13,7 @@
 // built only if GEAR is available
 #ifdef USE_GEAR
 // eutelescope includes ".h"
+#include "EUTelHotPixelMask.h"
 #include "EUTelUtility.h"
 
 //#include "TrackerHitImpl2.h"
@@ -275,8 +276,8 @@ namespace eutelescope {
     virtual void processRunHeader(LCRunHeader *run);
 
     //! Called for first event per run
-    /*! Reads hotpixel information from hotPixelCollection into hotPixelMap
-     * to be used in the sensor exclusion area logic
+    /*! Reads hotpixel information from hotPixelCollection into the
+     * hot pixel mask to be used in the sensor exclusion area logic
      */
     virtual void FillHotPixelMap(LCEvent *event);
 
@@ -353,16 +354,8 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! Vector of map arrays, keeps record of hit pixels
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created.
-     *  first level key   sensor unique
-     *              value sensor map
-     *  sensor map key    unique row number
-     *             value  vector of column numbers.
-     */
-
-    std::map<std::string, bool> _hotPixelMap;
+    //! Hot pixels of all sensors, one bitset per sensor
+    EUTelHotPixelMask _hotPixelMask;
 
     //! Sensor ID vector
     IntVec _sensorIDVec;
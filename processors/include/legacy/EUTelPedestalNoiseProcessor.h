@@ -10,6 +10,7 @@
 #define EUTELPEDESTALNOISEPROCESSOR_H 1
 
 // eutelescope includes ".h"
+#include "EUTelFrameCache.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -171,6 +172,12 @@ namespace eutelescope {
    *  @param OutputPedeFile Name of the output pedestal file
    *  @param ASCIIOutputSwitch To enable/disable the generation of
    *  ASCII output files
+   *  @param FrameCacheSize Memory budget in MB to keep the raw
+   *  frames of the first loop in memory; all the following loops
+   *  then run on these frames instead of rewinding the input files.
+   *  0 (default) always rewinds.
+   *  @param HistogramFilling Switch off to neither book nor fill any
+   *  histogram, for example when there is no AIDAProcessor.
    *
    *  Note that you don't need a LCIOOutputProcessor or an
    *  EUTelOutputProcessor at the end since
@@ -372,6 +379,52 @@ namespace eutelescope {
      */
     void additionalMaskingLoop(LCEvent *evt);
 
+    //! Common mode and pedestal update of one detector
+    /*! This is the detector part of
+     *  EUTelPedestalNoiseProcessor::otherLoop(LCEvent*), shared with
+     *  the replay of the cached frames.
+     *
+     *  @param iDetector The detector index within its collection
+     *  @param detectorOffset The index of the first detector of the
+     *  collection
+     *  @param adcValues The raw frame of the detector
+     */
+    void otherLoopDetector(size_t iDetector, size_t detectorOffset,
+                           const short *adcValues);
+
+    //! Hit counting of one detector for the additional masking loop
+    /*! @see EUTelPedestalNoiseProcessor::otherLoopDetector
+     */
+    void maskingLoopDetector(size_t iDetector, size_t detectorOffset,
+                             const short *adcValues, size_t nPixel);
+
+    //! Configure the frame cache
+    /*! Called with the first event of the first loop, when the number
+     *  of detectors and their sizes are known. Does nothing if
+     *  EUTelPedestalNoiseProcessor::_frameCacheSize is 0.
+     */
+    void initFrameCache();
+
+    //! Copy the raw frames of the current event into the frame cache
+    /*! If the cache would exceed its memory budget or if the event
+     *  does not have the same detectors as the first one, the cache
+     *  is dropped and the processor goes back to rewinding the input
+     *  files.
+     *
+     *  @param evt The LCEvent containing all the input collections.
+     */
+    void cacheFrames(LCEvent *evt);
+
+    //! Run the next loop on the cached frames
+    /*! Called by finalizeProcessor(bool) instead of throwing a
+     *  RewindDataFilesException when all the events of the first
+     *  loop are in the frame cache. The event counting is the same
+     *  as when the input files are read again, so that the skipped
+     *  event list and the pre-loop positions stay valid. At the end
+     *  of the loop finalizeProcessor(bool) is called again.
+     */
+    void replayFrameCache();
+
     //! Book histograms
     /*! This method is used to prepare the needed directory structure
      *  within the current ITree folder and books all required
@@ -995,6 +1048,16 @@ namespace eutelescope {
 
     //! Additional bad masking loop
     bool _additionalMaskingLoop;
+
+    //! Memory budget in MB for the frame cache, 0 to disable it
+    int _frameCacheSize;
+
+    //! Raw frames of the first loop
+    /*! Used for all the following loops instead of rewinding the
+     *  input files, as long as it stays within
+     *  EUTelPedestalNoiseProcessor::_frameCacheSize.
+     */
+    EUTelFrameCache _frameCache;
   };
 
   //! A global instance of the processor
@@ -19,6 +19,9 @@
 #include <IMPL/TrackerDataImpl.h>
 
 #include "CrossSection.hpp"
+#include "EUTelClusterShape.h"
+#include "EUTelHitGrid.h"
+#include "EUTelTrackHitAssignment.h"
 #include "TH1.h"
 #include "TH2.h"
 #include "TProfile2D.h"
@@ -46,7 +49,6 @@ public:
   void bookHistos();
 #endif
   virtual void end();
-  bool emptyMiddle(std::vector<std::vector<int>> pixVector);
   bool RemoveAlign(LCCollectionVec *preAlignmentCollectionVec,
                    LCCollectionVec *alignmentCollectionVec,
                    LCCollectionVec *alignmentPAlpideCollectionVec,
@@ -114,6 +116,30 @@ protected:
   int _chipVersion;
   bool _showFake;
   bool _realAssociation;
+  //! Solver for the tracks with more than one hit candidate
+  eutelescope::EUTelTrackHitAssignment _trackHitAssignment;
+
+  //! A hit in the frame of the DUT
+  struct DUTFrameHit {
+    bool inDUT;
+    double x;
+    double y;
+    double z;
+  };
+  //! Transform a hit into the DUT frame, inDUT is false for hits on
+  //! other planes
+  DUTFrameHit _toDUTFrame(const double *position);
+
+  //! Bounding box and occupancy of the cluster of an associated hit
+  eutelescope::EUTelClusterShape _clusterShape;
+  //! Hits of the event in the DUT frame, transformed once for all tracks
+  std::vector<DUTFrameHit> _dutFrameHits;
+  //! The same for the hits of the former event used for the fake rate
+  std::vector<DUTFrameHit> _fakeFrameHits;
+  //! Neighbour search for the DUT hits around a track
+  eutelescope::EUTelHitGrid _dutHitGrid;
+  eutelescope::EUTelHitGrid _fakeHitGrid;
+  std::vector<int> _neighbourHits;
 
 private:
   bool _isFirstEvent;
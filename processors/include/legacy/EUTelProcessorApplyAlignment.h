@@ -12,6 +12,7 @@
 #define EUTELPROCESSORAPPLYALIGNMENT_H
 
 // eutelescope includes ".h"
+#include "EUTelAlignmentTransforms.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -30,8 +31,8 @@
 
 // system includes <>
 #include <iostream>
-#include <map>
 #include <string>
+#include <vector>
 
 namespace eutelescope {
 
@@ -68,6 +69,9 @@ namespace eutelescope {
    *     2. <b>Translation first</b> The hits are first shifted and
    *  then rotated.
    *
+   *  @param UndoAlignment Apply the inverse of the alignment
+   *  correction, to go back from aligned to not aligned hits.
+   *
    * This is a port of EUTelAPIXApplyAlignment processor
    *
    *  @author Contact: antonio.bulgheroni@gmail.com
@@ -165,8 +169,21 @@ namespace eutelescope {
      */
     int _iEvt;
 
-    //! Look Up Table for the sensor ID
-    std::map<int, int> _lookUpTable;
+    //! Undo the alignment correction instead of applying it
+    bool _undoAlignment;
+
+    //! Alignment corrections by sensor ID
+    /*! Built at the first event of each run from the alignment
+     *  constant collection.
+     */
+    EUTelAlignmentTransforms _alignmentTransforms;
+    bool _transformsReady;
+
+    //! Buffers for the hits grouped by sensor
+    std::vector<int> _hitSensorIDs;
+    std::vector<size_t> _hitOrder;
+    std::vector<double> _sortedPositions;
+    std::vector<double> _transformedPositions;
   };
 
   //! A global instance of the processor
@@ -15,6 +15,7 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelAlignmentConstant.h"
+#include "EUTelGaussJordan.h"
 
 #include "marlin/Processor.h"
 
@@ -409,7 +410,15 @@ namespace eutelescope {
 
     //! Fit particle track in one plane (XZ or YZ), taking into
     //! account beam slope
-    int DoAnalFit(double *pos, double *err, double slope = 0.);
+    /*! With nominalErrors set the errors are the nominal plane
+     *  resolutions, the fit matrix then only depends on the planes
+     *  used and is factorised once for each such pattern.
+     */
+    int DoAnalFit(double *pos, double *err, double slope = 0.,
+                  bool nominalErrors = false);
+
+    //! Fill the fit matrix for the given position weights
+    void FillFitArray(const double *weight);
 
     //! Calculate \f$ \chi^{2} \f$ of the fit
     /*! Calculate \f$ \chi^{2} \f$ of the fit taking into account measured
@@ -419,9 +428,6 @@ namespace eutelescope {
      */
     double GetFitChi2();
 
-    //! Solve matrix equation
-    int GaussjSolve(double *alfa, double *beta, int n);
-
     //! Silicon planes parameters as described in GEAR
     /*! This structure actually contains the following:
      *  @li A reference to the telescope geoemtry and layout
@@ -580,6 +586,12 @@ namespace eutelescope {
     double *_nominalFitArrayY;
     double *_nominalErrorY;
 
+    //! Fit matrices factorised for each pattern of planes in the fit
+    /*! Only used with nominal resolution, the key has one bit per plane.
+     */
+    std::map<unsigned long long, EUTelGaussJordan> _fitMatrixCache;
+    EUTelGaussJordan _fitSolver;
+
     // few counter to show the final summary
 
     //! Number of event w/o input hit
@@ -637,6 +649,12 @@ namespace eutelescope {
     float _SlopeDistanceMax;
     // --------------------------------------------
 
+    //! Maximum hit distance from the line through the first two hits
+    /*! Used to reject hit combinations while they are decoded, 0 to
+     *  switch it off
+     */
+    float _predictionWindow;
+
     // 21 january 2011, libov@mail.desy.de ------
     // corrected for non-normal sensors
     std::vector<double> _fittedXcorr;
@@ -25,13 +25,15 @@
 #include <UTIL/CellIDDecoder.h>
 
 // system includes <>
+#include <string>
 #include <vector>
 
 using namespace eutelescope;
 
 EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
   :Processor("EUTelHitCoordinateTransformer"),
-   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false) {
+   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false),
+   _geometry(nullptr), _threads() {
 
   _description = "EUTelHitCoordinateTransformer is responsible to change local "
                  "coordinates to global using the EUTelGeometryClass.";
@@ -54,24 +56,44 @@ EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
 			    false);
 }
 
+EUTelHitCoordinateTransformer::ThreadState::ThreadState()
+  :cachedEncoding(), hitDecoder(), cellReencoder(), encodingTemplate(),
+   propertiesIndex(0), sensorIDIndex(0), hitSensorIDs(), hitProperties(),
+   nHits(0), transformTime(std::chrono::steady_clock::duration::zero()),
+   nUnknownType(0), nMissingInput(0) {
+}
+
 void EUTelHitCoordinateTransformer::init() {
   //initialize geometry	
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME, 
 					     EUTELESCOPE::DUMPGEOROOT);
+  _geometry = &geo::gGeometry();
+  prepareThreads(1);
+}
+
+void EUTelHitCoordinateTransformer::prepareThreads(unsigned int nThreads)
+{
+  _threads.clear();
+  _threads.resize(nThreads);
 }
 
 void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
 {
-  //check event type and if it is the last event
+  processEventConcurrently(event, 0);
+}
+
+void EUTelHitCoordinateTransformer::processEventConcurrently(LCEvent* event, unsigned int thread)
+{
+  ThreadState& state = _threads[thread];
+
+  //check event type and if it is the last event, nothing is printed
+  //here as this may run on a worker thread
   EUTelEventImpl* evt	= static_cast<EUTelEventImpl*>(event);				
   if( evt->getEventType() == kEORE ) {
-    streamlog_out( MESSAGE5 ) << "EORE found: nothing else to do." << std::endl;
     return;
   } else if( evt->getEventType() == kUNKNOWN) {
-    streamlog_out( WARNING2 ) << "Event number " << evt->getEventNumber() << " in run " 
-			      << evt->getRunNumber() << " is of unknown type." 
-			      << " Continue considering it as a normal Data Event." 
-			      << std::endl;
+    //considered as a normal data event
+    ++state.nUnknownType;
   }
 
   //opens collection for input
@@ -79,67 +101,69 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
   try {
     inputCollection = evt->getCollection(_hitCollectionNameInput);
   } catch(DataNotAvailableException& e) {
-    streamlog_out( WARNING2 ) << _hitCollectionNameInput 
-			      << " collection not available" << std::endl;
+    ++state.nMissingInput;
     return;
   }
 
-  //opens collection for output
-  LCCollectionVec* outputCollection = nullptr;
-  try {
-    outputCollection = static_cast<LCCollectionVec*> (event->getCollection(_hitCollectionNameOutput));
-  } catch(...) {
-    outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
-  }
-
   //get encoding from input
   std::string encoding = inputCollection->getParameters().getStringVal( LCIO::CellIDEncoding );
   if(encoding.empty()) {
     encoding = EUTELESCOPE::HITENCODING;
   }
-
-  //get decoder
-  lcio::CellIDDecoder<TrackerHitImpl> hitDecoder(encoding);
-  lcio::UTIL::CellIDReencoder<TrackerHitImpl> cellReencoder(encoding, outputCollection);
-  
-  //[START] loop over hits
-  for(int iHit = 0; iHit < inputCollection->getNumberOfElements(); ++iHit) {  
-    
-    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(iHit));
-    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl(); 
-    
-    //get some basic information
-    int properties = hitDecoder(inputHit)["properties"];
-    int sensorID = hitDecoder(inputHit)["sensorID"];
-				
-    //use local2masterHit/master2localHit function in EUTelGeometryTelescopeDescription
-    //to translate input/output position		
-    const double* inputPos = inputHit->getPosition();
-    double outputPos[3];
-    
-    //transform local->global
-    if(!(properties & kHitInGlobalCoord) && !_undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from local to global!" << std::endl;
-      geo::gGeometry().local2Master(sensorID, inputPos, outputPos);
-    } 
-    //transform global->local
-    else if((properties & kHitInGlobalCoord) && _undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from global to local!" << std::endl;
-      geo::gGeometry().master2Local(sensorID, inputPos, outputPos);
-    } 
-    //error case
-    else {
-      std::cout << "Properties: " << properties << std::endl;
+  state.setEncoding(encoding);
+
+  auto const startTime = std::chrono::steady_clock::now();
+  std::size_t const nHits = static_cast<std::size_t>(inputCollection->getNumberOfElements());
+
+  //decode every cellID once and check the direction of the transformation
+  state.hitSensorIDs.resize(nHits);
+  state.hitProperties.resize(nHits);
+  for(std::size_t iHit = 0; iHit < nHits; ++iHit) {
+    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(static_cast<int>(iHit)));
+    lcio::BitField64 const& bits = (*state.hitDecoder)(inputHit);
+    int const properties = bits[state.propertiesIndex];
+    state.hitProperties[iHit] = properties;
+    state.hitSensorIDs[iHit] = bits[state.sensorIDIndex];
+
+    if(static_cast<bool>(properties & kHitInGlobalCoord) != _undoAlignment) {
       std::string errMsg;
       if(!_undoAlignment) {
 	errMsg = "Provided global hit, but trying to transform into global. Something is wrong!";
       } else {
 	errMsg = "Provided local hit, but trying to transform into local. Something is wrong!";
       }
-      throw InvalidGeometryException(errMsg);
+      throw InvalidGeometryException(errMsg + " Properties: " + std::to_string(properties));
+    }
+  }
+
+  //opens collection for output
+  LCCollectionVec* outputCollection = nullptr;
+  bool newCollection = false;
+  try {
+    outputCollection = static_cast<LCCollectionVec*> (event->getCollection(_hitCollectionNameOutput));
+  } catch(...) {
+    outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+    newCollection = true;
+  }
+  //same encoding parameter and flag as a CellIDEncoder would set
+  outputCollection->parameters().setValue(LCIO::CellIDEncoding, encoding);
+  outputCollection->setFlag(outputCollection->getFlag() | state.encodingTemplate->getFlag());
+
+  //[START] loop over hits
+  for(std::size_t iHit = 0; iHit < nHits; ++iHit) {
+
+    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(static_cast<int>(iHit)));
+
+    //use local2Master/master2Local of EUTelGeometryTelescopeDescription
+    double outputPos[3];
+    if(!_undoAlignment) {
+      _geometry->local2Master(state.hitSensorIDs[iHit], inputHit->getPosition(), outputPos);
+    } else {
+      _geometry->master2Local(state.hitSensorIDs[iHit], inputHit->getPosition(), outputPos);
     }
-	
+
     //fill new outputHit with information
+    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl();
     outputHit->setPosition(outputPos);
     outputHit->setCovMatrix( inputHit->getCovMatrix());
     outputHit->setType( inputHit->getType() );
@@ -148,26 +172,59 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
     outputHit->setCellID1( inputHit->getCellID1() );
     outputHit->setQuality( inputHit->getQuality() );
     outputHit->rawHits() = inputHit->getRawHits();
-    
+
     //and reencode hit
-    cellReencoder.readValues(outputHit);
-    //^= is a bitwise XOR i.e. will switch the coordinate system
-    cellReencoder["properties"] = properties ^= kHitInGlobalCoord;
-    cellReencoder.setCellID(outputHit);
+    state.cellReencoder->readValues(outputHit);
+    //^ is a bitwise XOR i.e. will switch the coordinate system
+    (*state.cellReencoder)[state.propertiesIndex] = state.hitProperties[iHit] ^ kHitInGlobalCoord;
+    state.cellReencoder->setCellID(outputHit);
     //finally store it in collection
     outputCollection->push_back(outputHit);
 
   }//[END] loop over hits
-	
+
+  state.nHits += static_cast<long>(nHits);
+  state.transformTime += std::chrono::steady_clock::now() - startTime;
+
   //push the hit for this event onto the collection
-  try {	
+  if(newCollection) {
     event->addCollection(outputCollection, _hitCollectionNameOutput );
-  } catch(...) {
-    streamlog_out ( WARNING5 )  << "Problem with pushing collection onto event" << std::endl;
   }
 }
 
+void EUTelHitCoordinateTransformer::ThreadState::setEncoding(std::string const &encoding)
+{
+  if(hitDecoder && encoding == cachedEncoding) return;
+
+  cachedEncoding = encoding;
+  hitDecoder.reset(new lcio::CellIDDecoder<TrackerHitImpl>(encoding));
+  encodingTemplate.reset(new LCCollectionVec(LCIO::TRACKERHIT));
+  cellReencoder.reset(new lcio::UTIL::CellIDReencoder<TrackerHitImpl>(encoding, encodingTemplate.get()));
+  propertiesIndex = cellReencoder->index("properties");
+  sensorIDIndex = cellReencoder->index("sensorID");
+}
+
 void EUTelHitCoordinateTransformer::end()
 {
+  long nHits = 0, nUnknownType = 0, nMissingInput = 0;
+  std::chrono::steady_clock::duration transformTime = std::chrono::steady_clock::duration::zero();
+  for(auto const& state : _threads) {
+    nHits += state.nHits;
+    nUnknownType += state.nUnknownType;
+    nMissingInput += state.nMissingInput;
+    transformTime += state.transformTime;
+  }
+
+  if(nUnknownType > 0) {
+    streamlog_out( WARNING2 ) << nUnknownType << " events of unknown type, considered as normal data events" << std::endl;
+  }
+  if(nMissingInput > 0) {
+    streamlog_out( WARNING2 ) << _hitCollectionNameInput << " collection not available in "
+			      << nMissingInput << " events" << std::endl;
+  }
+  double const seconds = std::chrono::duration<double>(transformTime).count();
+  streamlog_out(MESSAGE4) << "Transformed " << nHits << " hits in " << seconds << " s";
+  if(seconds > 0.) streamlog_out(MESSAGE4) << " (" << nHits/seconds << " hits/s)";
+  streamlog_out(MESSAGE4) << std::endl;
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
 }
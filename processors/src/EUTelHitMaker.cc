@@ -59,7 +59,7 @@ using namespace eutelescope;
 EUTelHitMaker::EUTelHitMaker()
     : Processor("EUTelHitMaker"), _pulseCollectionName(),
       _hitCollectionName(), _switchLocalCoordinates(false), _histogramSwitch(true),
-      _iRun(0), _iEvt(0), _alreadyBookedSensorID() {
+      _iRun(0), _geometry(nullptr), _threads(), _alreadyBookedSensorID() {
  
   _description = "EUTelHitMaker is responsible to translate cluster "
                  "centers from the local frame of reference \n to the external "
@@ -88,19 +88,29 @@ EUTelHitMaker::EUTelHitMaker()
 			    true);
 }
 
+EUTelHitMaker::ThreadState::ThreadState() : nUnknownType(0), nMissingInput(0) {}
+
 void EUTelHitMaker::init() {
 
   //good to do this
   printParameters();
 
-  //reset run and event counters
+  //reset run counter
   _iRun = 0;
-  _iEvt = 0;
 
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                              EUTELESCOPE::DUMPGEOROOT);
+  _geometry = &geo::gGeometry();
+
+#if !defined(USE_AIDA) && !defined(MARLIN_USE_AIDA)
+  _histogramSwitch = false;
+#endif
+  prepareThreads(1);
+}
 
-  _histogramSwitch = true;
+void EUTelHitMaker::prepareThreads(unsigned int nThreads) {
+  _threads.clear();
+  _threads.resize(nThreads);
 }
 
 void EUTelHitMaker::processRunHeader(LCRunHeader *rdr) {
@@ -125,20 +135,21 @@ void EUTelHitMaker::processRunHeader(LCRunHeader *rdr) {
 }
 
 void EUTelHitMaker::processEvent(LCEvent *event) {
+  processEventConcurrently(event, 0);
+}
+
+void EUTelHitMaker::processEventConcurrently(LCEvent *event, unsigned int thread) {
 
-  ++_iEvt;
+  ThreadState &state = _threads[thread];
 
+  //nothing is printed here as this may run on a worker thread
   EUTelEventImpl *evt = static_cast<EUTelEventImpl *>(event);
 
   if(evt->getEventType() == kEORE) {
-    streamlog_out(DEBUG4) << "EORE found: nothing else to do." << std::endl;
     return;
   } else if(evt->getEventType() == kUNKNOWN) {
-    streamlog_out(WARNING2) << "Event number " << evt->getEventNumber()
-                            << " in run " << evt->getRunNumber()
-                            << " is of unknown type. Continue considering it "
-                               "as a normal Data Event."
-                            << std::endl;
+    //considered as a normal data event
+    ++state.nUnknownType;
   }
 
   LCCollectionVec *pulseCollection = nullptr;
@@ -148,9 +159,7 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     pulseCollection = static_cast<LCCollectionVec *>(
         event->getCollection(_pulseCollectionName));
   } catch(DataNotAvailableException &e) {
-    streamlog_out(MESSAGE2) << "No input collection " << _pulseCollectionName
-                            << " found on event " << event->getEventNumber()
-                            << " in run " << event->getRunNumber() << std::endl;
+    ++state.nMissingInput;
     return;
   }
 
@@ -194,17 +203,17 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     if(sensorID != oldDetectorID) {
       oldDetectorID = sensorID;
       //check if the histos for this sensor ID have been booked already.
-      if (_alreadyBookedSensorID.find(sensorID) == _alreadyBookedSensorID.end()) {
+      if (_histogramSwitch && _alreadyBookedSensorID.find(sensorID) == _alreadyBookedSensorID.end()) {
         bookHistos(sensorID);
       }
 
       //all values given in mm
-      resolutionX = geo::gGeometry().getPlaneXResolution(sensorID);
-      resolutionY = geo::gGeometry().getPlaneYResolution(sensorID);
-      xSize = geo::gGeometry().getPlaneXSize(sensorID);
-      ySize = geo::gGeometry().getPlaneYSize(sensorID);
-      xPitch = geo::gGeometry().getPlaneXPitch(sensorID);
-      yPitch = geo::gGeometry().getPlaneYPitch(sensorID);
+      resolutionX = _geometry->getPlaneXResolution(sensorID);
+      resolutionY = _geometry->getPlaneYResolution(sensorID);
+      xSize = _geometry->getPlaneXSize(sensorID);
+      ySize = _geometry->getPlaneYSize(sensorID);
+      xPitch = _geometry->getPlaneXPitch(sensorID);
+      yPitch = _geometry->getPlaneYPitch(sensorID);
     }
 
     //LOCAL coordinate system!
@@ -231,11 +240,9 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
         cluster.getGeometricCenterOfGravity(xPos, yPos);
       
       } else {
-        streamlog_out(ERROR4) << "We do not support pixel type: " << pixelType
-                              << " for kEUTelGenericSparseClusterImpl"
-                              << std::endl;
         throw UnknownDataTypeException(
-            "Pixel type not supported for kEUTelGenericSparseClusterImpl");
+            "Pixel type " + std::to_string(pixelType) +
+            " not supported for kEUTelGenericSparseClusterImpl");
       }
 
       telPos[0] = xPos;
@@ -270,7 +277,6 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       if(clusterType == kEUTelBrickedClusterImpl) {
         p_tmpBrickedCluster = dynamic_cast<EUTelBrickedClusterImpl *>(cluster);
         if(p_tmpBrickedCluster == nullptr) {
-          streamlog_out(ERROR4) << " .COULD NOT CREATE EUTelBrickedClusterImpl* !!!" << std::endl;
           throw UnknownDataTypeException(
               "COULD NOT CREATE EUTelBrickedClusterImpl* !!!");
         }
@@ -294,13 +300,6 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       xDet = (xCoG + 0.5) * xPitch;
       yDet = (yCoG + 0.5) * yPitch;
 
-      streamlog_out(DEBUG1)
-          << "cluster[" << setw(4) << iCluster << "] on sensor[" << setw(3)
-          << sensorID << "] at [" << setw(8) << setprecision(3) << xCoG << ":"
-          << setw(8) << setprecision(3) << yCoG << "]"
-          << " ->  [" << setw(8) << setprecision(3) << xDet << ":" << setw(8)
-          << setprecision(3) << yDet << "]" << std::endl;
-
       //We have calculated the cluster hit position in terms of distance along
       //the X and Y axis.
       //However we still do not have the sensor centre as the origin of the
@@ -337,7 +336,7 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       // NOW !!
       // GLOBAL coordinate system !!!
       const double localPos[3] = {telPos[0], telPos[1], telPos[2]};
-      geo::gGeometry().local2Master(sensorID, localPos, telPos);
+      _geometry->local2Master(sensorID, localPos, telPos);
     }
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -393,11 +392,22 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
   } catch(...) {
     event->addCollection(hitCollection, _hitCollectionName);
   }
-
-  if(isFirstEvent()) _isFirstEvent = false;
 }
 
 void EUTelHitMaker::end() {
+  long nUnknownType = 0, nMissingInput = 0;
+  for(auto const &state : _threads) {
+    nUnknownType += state.nUnknownType;
+    nMissingInput += state.nMissingInput;
+  }
+
+  if(nUnknownType > 0) {
+    streamlog_out(WARNING2) << nUnknownType << " events of unknown type, considered as normal data events" << endl;
+  }
+  if(nMissingInput > 0) {
+    streamlog_out(MESSAGE2) << "No input collection " << _pulseCollectionName
+                            << " found in " << nMissingInput << " events" << endl;
+  }
   streamlog_out(MESSAGE4) << "Successfully finished" << endl;
 }
 
@@ -11,6 +11,7 @@
 #include "EUTelOutputSaver.h"
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
+#include "EUTelExceptions.h"
 #include "EUTelRunHeaderImpl.h"
 
 // marlin includes ".h"
@@ -27,7 +28,8 @@ using namespace marlin;
 using namespace eutelescope;
 
 EUTelOutputSaver::EUTelOutputSaver()
-    : LCIOOutputProcessor("EUTelOutputSaver") {
+    : LCIOOutputProcessor("EUTelOutputSaver"), _eventType(kUNKNOWN),
+      _skipIntermediateEORESwitch(true), _writerQueueSize(0), _asyncWriter() {
 
   _description = "EUTelOutputSaver writes the current event to the specified LCIO outputfile. "
                  "Eventually it adds a EORE at the of the file if it was missing. "
@@ -76,12 +78,37 @@ EUTelOutputSaver::EUTelOutputSaver()
 			     "Set it to true to remove intermediate EORE in merged runs",
 			     _skipIntermediateEORESwitch,
 			     true);
+
+  registerOptionalParameter("WriterQueueSize",
+                            "Number of events queued for a separate writer thread, "
+                            "0 writes in the event loop",
+                            _writerQueueSize, 0);
 }
 
 void EUTelOutputSaver::init() {
 
   //needs to be reimplemented since it is virtual in LCIOOutputProcessor
   LCIOOutputProcessor::init();
+
+  if(_writerQueueSize > 0 && !_fullSubsetCollections.empty()) {
+    //the subset flags are cleared by dropCollections and restored by
+    //LCIOOutputProcessor::processEvent after writing, which does not
+    //work once the collections are queued
+    streamlog_out(ERROR5) << "WriterQueueSize cannot be used together with FullSubsetCollections" << std::endl;
+    throw InvalidParameterException("WriterQueueSize");
+  }
+
+  if(_writerQueueSize > 0 && !EUTelAsyncLCWriter::hasReentrantSIO()) {
+    //the reader of Marlin uses SIO in the event loop at the same time
+    streamlog_out(WARNING5) << "WriterQueueSize needs LCIO v02-13 or newer, the events are written in the event loop" << std::endl;
+    _writerQueueSize = 0;
+  }
+
+  if(_writerQueueSize > 0) {
+    //the writer may be a split writer, the file size is then
+    //checked in the writer thread
+    _asyncWriter = std::make_unique<EUTelAsyncLCWriter>(_lcWrt, _writerQueueSize);
+  }
 }
 
 void EUTelOutputSaver::processRunHeader(LCRunHeader *run) {
@@ -89,7 +116,11 @@ void EUTelOutputSaver::processRunHeader(LCRunHeader *run) {
   std::unique_ptr<EUTelRunHeaderImpl> runHeader =
       std::make_unique<EUTelRunHeaderImpl>(run);
   runHeader->addProcessor(type());
-  LCIOOutputProcessor::processRunHeader(run);
+  if(_asyncWriter) {
+    _asyncWriter->writeRunHeader(run);
+  } else {
+    LCIOOutputProcessor::processRunHeader(run);
+  }
 }
 
 void EUTelOutputSaver::processEvent(LCEvent *evt) {
@@ -106,12 +137,24 @@ void EUTelOutputSaver::processEvent(LCEvent *evt) {
     return;
   }
 
-  LCIOOutputProcessor::processEvent(evt);
   _eventType = eutelEvt->getEventType();
+  if(_asyncWriter) {
+    dropCollections(evt);
+    _asyncWriter->writeEvent(EUTelAsyncLCWriter::takeEvent(evt));
+    ++_nEvt;
+  } else {
+    LCIOOutputProcessor::processEvent(evt);
+  }
 }
 
 void EUTelOutputSaver::end() {
 
+  //everything queued has to be on disk before the EORE
+  if(_asyncWriter) {
+    _asyncWriter->finish();
+    _asyncWriter.reset();
+  }
+
   if(_eventType != kEORE) {
     streamlog_out(WARNING4) << "Adding a EORE because was missing" 
 			    << std::endl;
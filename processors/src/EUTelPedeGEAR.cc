@@ -11,7 +11,8 @@
 #include "EUTelPedeGEAR.h"
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
-#include "EUTelPStream.h"
+#include "EUTelMillepedeResult.h"
+#include "EUTelPedeRunner.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelUtility.h"
@@ -66,6 +67,11 @@ EUTelPedeGEAR::EUTelPedeGEAR() : Processor("EUTelPedeGEAR") {
   registerOptionalParameter("UnitConversion",
                             "Conversion from um to mm. Not needed by GBL (set to 0), but needed by EUTelMille (set to 1).",
                             _unitConversion, false);
+
+  registerOptionalParameter("PedeTimeout",
+                            "Wall-clock limit in seconds for the pede execution, "
+                            "pede is terminated when it is exceeded. 0 means no limit.",
+                            _pedeTimeout, 0.0);
 }
 
 void EUTelPedeGEAR::init() {
@@ -127,93 +133,54 @@ void EUTelPedeGEAR::end() {
   streamlog_out(MESSAGE5) << "Starting pede with " << _pedeSteerfileName.c_str() 
 			  << std::endl;
 
-  //run pede and create a streambuf that reads its stdout and stderr
-  redi::ipstream pede(command.c_str(), redi::pstreams::pstdout | redi::pstreams::pstderr);
-  bool encounteredError = false;
+  //run pede and parse its stdout and stderr line by line as they come in
+  EUTelPedeRunner pede(command, _pedeTimeout);
+  pede.setStdoutHandler([](std::string const &line) {
+    streamlog_out(MESSAGE4) << line << std::endl;
+  });
+  pede.setStderrHandler([](std::string const &line) {
+    streamlog_out(ERROR5) << line << std::endl;
+  });
+
+  bool encounteredError = !pede.run();
 
-  if(!pede.is_open()) {
+  if(pede.startFailed() || pede.exitStatus() == 127) {
     streamlog_out(ERROR5) << "Pede cannot be executed: command not found in the path." 
                           << std::endl;
     encounteredError = true;
   } else {
-    //output multiplexing: parse pede output in both stdout and stderr and echo
-    //messages accordingly
-    char buf[1024];
-    std::streamsize n;
-    std::stringstream pedeoutput; //store stdout to parse later
-    std::stringstream pedeerrors;
-    bool finished[2] = {false, false};
-
-    while(!finished[0] || !finished[1]) {
-      if(!finished[0]) {
-        while((n = pede.err().readsome(buf, sizeof(buf))) > 0) {
-          streamlog_out(ERROR5).write(buf, n).flush();
-          std::string error(buf, n);
-          pedeerrors << error;
-          encounteredError = true;
-        }
-        if(pede.eof()) {
-          finished[0] = true;
-          if(!finished[1])
-            pede.clear();
-        }
-      }
+    if(pede.timedOut()) {
+      streamlog_out(ERROR5) << "Pede did not finish within " << _pedeTimeout
+                            << " s and has been terminated." << std::endl;
+    }
 
-      if(!finished[1]) {
-        while((n = pede.out().readsome(buf, sizeof(buf))) > 0) {
-          streamlog_out(MESSAGE4).write(buf, n).flush();
-          std::string output(buf, n);
-          pedeoutput << output;
-        }
-        if(pede.eof()) {
-          finished[1] = true;
-          if(!finished[0])
-            pede.clear();
-        }
-      }
+    //any output on stderr is treated as an error
+    if(!pede.errors().empty()) {
+      encounteredError = true;
     }
 
     //pede does not return exit codes on some errors (in V03-04-00)
     //check for some of those here by parsing the output
-    const char *pch = strstr(pedeoutput.str().data(), "Too many rejects");
-    if(pch) {
+    if(pede.tooManyRejects()) {
       streamlog_out(ERROR5) << "Pede stopped due to the large number of rejects. "
 			    << std::endl;
       encounteredError = true;
     }
 
-    const char *pch0 = strstr(pedeoutput.str().data(), "Sum(Chi^2)/Sum(Ndf) = ");
-    if(pch0 != nullptr) {
-      streamlog_out(DEBUG5) << " Parsing pede output for final chi2/ndf result.. "
-			    << std::endl;
-      //search for the equal sign after which the result for chi2/ndf is stated
-      //within the next 80 chars
-      //(with offset of 22 chars since pch points to beginning of "Sum(..."
-      //string just found)
-      const char *pch = static_cast<const char*>(memchr(pch0 + 22, '=', 180));
-
-      if(pch != nullptr) {
-        char str[16];
-        //now copy the numbers after the equal sign
-        strncpy(str, pch + 1, 15);
-        str[15] = '\0'; /* null character manually added */
-        streamlog_out(MESSAGE6) << "Final Sum(Chi^2)/Sum(Ndf) = " << str
-				<< std::endl;
-      }
+    if(pede.hasChi2Ndf()) {
+      streamlog_out(MESSAGE6) << "Final Sum(Chi^2)/Sum(Ndf) = " << pede.chi2Ndf()
+                              << std::endl;
     }
 
-    //wait for the pede execution to finish
-    pede.close();
-
     //check the exit value of pede / react to previous errors
-    if (pede.rdbuf()->status() == 0 && !encounteredError) {
+    if(!encounteredError) {
       streamlog_out(MESSAGE7) << "Pede successfully finished" << std::endl;
     } else {
       streamlog_out(ERROR5)
           << "Problem during Pede execution, exit status: "
-          << pede.rdbuf()->status()
+          << pede.exitStatus()
           << ", error messages (repeated here): " << std::endl;
-      streamlog_out(ERROR5) << pedeerrors.str() << std::endl;
+      streamlog_out(ERROR5) << pede.errors() << std::endl;
       //FIXME: decide what to do now; exit? and if, how?
       streamlog_out(ERROR5) << "Will exit now" << std::endl;
       return;
@@ -225,165 +192,104 @@ void EUTelPedeGEAR::end() {
     streamlog_out(MESSAGE6) << "Reading back the " << millepedeResFileName
                             << std::endl;
 
-    //open the millepede ASCII output file
-    std::ifstream millepede(millepedeResFileName.c_str());
-
-    if(millepede.bad() || !millepede.is_open()) {
+    EUTelMillepedeResult millepede;
+    if(!millepede.read(millepedeResFileName)) {
       streamlog_out(ERROR4) << "Error opening the " << millepedeResFileName
                             << std::endl;
     } else {
-      std::vector<double> tokens;
-      std::stringstream tokenizer;
-      std::string line;
-
-      //get the first line and throw it away since it is a comment!
-      std::getline(millepede, line);
-
-      while (!millepede.eof()) {
-        bool goodLine = true;
-        unsigned int numpars = 0;
-
-        if (_alignMode == Utility::alignMode::XYShifts) {
-          numpars = 2;
-        } else if (_alignMode == Utility::alignMode::XYShiftsRotZ) {
-          numpars = 3;
-        } else if (_alignMode == Utility::alignMode::XYZShiftsRotZ) {
-          numpars = 4;
-        } else if  (_alignMode == Utility::alignMode::XYZShiftsRotXYZ || _alignMode == Utility::alignMode::XYShiftsAllRot){
-          numpars = 6;
-        }
-        
-        int sensorID = 0; //FIXME: should be done better
-        double xOff = 0;
-        double yOff = 0;
-        double zOff = 0;
-        double xOffErr = 0;
-        double yOffErr = 0;
-        double zOffErr = 0; 
-        double alpha = 0;
-        double beta = 0;
-        double gamma = 0;
-        double alphaErr = 0;
-        double betaErr = 0;
-        double gammaErr = 0;
-
-        for(unsigned int iParam = 0; iParam < numpars; ++iParam) {
-          std::getline(millepede, line);
-
-          if(line.empty()) {
-            goodLine = false;
-            continue;
-          }
-
-          tokens.clear();
-          tokenizer.clear();
-          tokenizer.str(line);
-
-          double buffer;
-          //check that all parts of the line are non zero
-          while(tokenizer >> buffer) {
-            tokens.push_back(buffer);
-          }
-
-          if((tokens.size() == 3) || (tokens.size() == 6) || (tokens.size() == 5)) {
-            goodLine = true;
-          } else {
-            goodLine = false;
-          }
+      if(millepede.skippedLines() > 1) {
+        //the first line is a comment, anything beyond is unexpected
+        streamlog_out(WARNING2) << millepede.skippedLines() - 1 << " lines of "
+                                << millepedeResFileName << " could not be interpreted"
+                                << std::endl;
+      }
+
+      unsigned int numpars = 0;
+      if(_alignMode == Utility::alignMode::XYShifts) {
+        numpars = 2;
+      } else if(_alignMode == Utility::alignMode::XYShiftsRotZ) {
+        numpars = 3;
+      } else if(_alignMode == Utility::alignMode::XYZShiftsRotZ) {
+        numpars = 4;
+      } else if(_alignMode == Utility::alignMode::XYZShiftsRotXYZ || _alignMode == Utility::alignMode::XYShiftsAllRot) {
+        numpars = 6;
+      }
+      auto const layout = EUTelMillepedeResult::layout(numpars);
 
       // Gear uses mm, as well as GBL. However, EUTelMille uses um.
       double ConversionFactor = 1.;
       if(_unitConversion) ConversionFactor = 1000.;
-      
-	  //parameter 0
-	  if(iParam == 0) {
-	    sensorID = (tokens[0] - 1) / 10; //FIXME: should be done better                                                                                                                               
-	    xOff = tokens[1]/ConversionFactor;
-	    if(tokens[2] == 0) xOffErr = tokens[4]/ConversionFactor;
-	  }
-	  //parameter 1
-	  else if(iParam == 1) {
-	    yOff = tokens[1]/ConversionFactor;
-	    if(tokens[2] == 0) yOffErr = tokens[4]/ConversionFactor;
-	  }
-	  //parameter 2
-	  else if(iParam == 2) {
-	    if(_alignMode == Utility::alignMode::XYShiftsRotZ) {
-	      gamma = -tokens[1];
-	      if(tokens[2] == 0) gammaErr = tokens[4];
-	    }
-	    else if(_alignMode == Utility::alignMode::XYZShiftsRotZ) {
-	      gamma = -tokens[1];
-              if(tokens[2] == 0) gammaErr = tokens[4];
-	    }
-	    else if(_alignMode == Utility::alignMode::XYZShiftsRotXYZ || _alignMode == Utility::alignMode::XYShiftsAllRot) {
-	      zOff = tokens[1]/ConversionFactor;
-              if(tokens[2] == 0) zOffErr = tokens[4]/ConversionFactor;
-	    }
-	  }
-	  //parameter 3
-          else if(iParam == 3) {
-	    if(_alignMode == Utility::alignMode::XYZShiftsRotZ) {
-	      zOff = tokens[1]/ConversionFactor;
-              if(tokens[2] == 0) zOffErr = tokens[4]/ConversionFactor;
-	    }
-	    else if(_alignMode == Utility::alignMode::XYZShiftsRotXYZ || _alignMode == Utility::alignMode::XYShiftsAllRot) {
-	      alpha = -tokens[1];
-              if(tokens[2] == 0) alphaErr = tokens[4];
-	    }
-	  }
-	  //parameter 4 (only for XYZShiftsRotXYZ)
-	  else if(iParam == 4) {
-	    beta = -tokens[1];
-	    if(tokens[2] == 0) betaErr = tokens[4];
-	  }
-	  //parameter 5 (only for XYZShiftsRotXYZ)
-	  else if (iParam == 5) {
-              gamma = -tokens[1];
-              if(tokens[2] == 0) gammaErr = tokens[4];
-	  }
-	}
+
+      auto const geoSensorIDs = geo::gGeometry().sensorIDsVec();
+
+      for(int sensorID : millepede.sensorIDs()) {
+        if(std::find(geoSensorIDs.begin(), geoSensorIDs.end(), sensorID) == geoSensorIDs.end()) {
+          streamlog_out(WARNING2) << "Sensor " << sensorID << " found in " << millepedeResFileName
+                                  << " is not part of the geometry, ignoring it" << std::endl;
+          continue;
+        }
+
+        //shifts in x, y, z followed by the rotations alpha, beta, gamma
+        double values[6] = {0, 0, 0, 0, 0, 0};
+        double errors[6] = {0, 0, 0, 0, 0, 0};
+
+        for(unsigned int iParam = 0; iParam < layout.size(); ++iParam) {
+          auto const &par = millepede.getParameter(sensorID, iParam + 1);
+          if(!par.present) continue;
+
+          auto const quantity = layout[iParam];
+          //pede rotations are defined the other way around
+          double const scale = (quantity == EUTelMillepedeResult::kAlpha ||
+                                quantity == EUTelMillepedeResult::kBeta ||
+                                quantity == EUTelMillepedeResult::kGamma) ? -1. : 1./ConversionFactor;
+          values[quantity] = par.value * scale;
+          if(par.presigma == 0) errors[quantity] = std::abs(par.error * scale);
+        }
+
+        double const xOff = values[EUTelMillepedeResult::kXOff];
+        double const yOff = values[EUTelMillepedeResult::kYOff];
+        double const zOff = values[EUTelMillepedeResult::kZOff];
+        double const alpha = values[EUTelMillepedeResult::kAlpha];
+        double const beta = values[EUTelMillepedeResult::kBeta];
+        double const gamma = values[EUTelMillepedeResult::kGamma];
 
         //add the constant to the collection, errors added to the output
-        if(goodLine) {
-          streamlog_out(MESSAGE6) << "Alignment on sensor " << sensorID << " determined to be: " << std::endl
-				  << "xOff: "  << xOff  << " +- " << xOffErr  << std::endl
-				  << "yOff: "  << yOff  << " +- " << yOffErr  << std::endl
-				  << "zOff: "  << zOff  << " +- " << zOffErr  << std::endl
-				  << "alpha: " << alpha << " +- " << alphaErr << std::endl
-				  << "beta: "  << beta  << " +- " << betaErr  << std::endl
-				  << "gamma: " << gamma << " +- " << gammaErr << std::endl;
-
-          //get old rotation matrix from GEAR file
-          Eigen::Matrix3d rotOld = geo::gGeometry().rotationMatrixFromAngles(sensorID);
-          //get new rotation matrix via the alpha, beta, gamma from MillepedeII
-          Eigen::Matrix3d rotAlign = Utility::rotationMatrixFromAngles(alpha, beta, gamma);
-          //get corrected rotation by multiplying rotAlign*rotOld and extract updated alpha', beta' and gamma'
-          Eigen::Vector3d newCoeff = Utility::getRotationAnglesFromMatrix(rotAlign * rotOld);
-
-	  //output of results
-	  streamlog_out(DEBUG5) << "Old rotation matrix: " << rotOld << std::endl;
-	  streamlog_out(DEBUG5) << "Align rotation matrix: " << rotAlign << std::endl;
-	  streamlog_out(MESSAGE6) << "Updated rotations (alpha', beta', gamma'): "
-                    << newCoeff[0] << ", " << newCoeff[1] << ", " << newCoeff[2]
-                    << std::endl;
-
-      Eigen::Vector3d oldOffset;
+        streamlog_out(MESSAGE6) << "Alignment on sensor " << sensorID << " determined to be: " << std::endl
+                                << "xOff: "  << xOff  << " +- " << errors[EUTelMillepedeResult::kXOff]  << std::endl
+                                << "yOff: "  << yOff  << " +- " << errors[EUTelMillepedeResult::kYOff]  << std::endl
+                                << "zOff: "  << zOff  << " +- " << errors[EUTelMillepedeResult::kZOff]  << std::endl
+                                << "alpha: " << alpha << " +- " << errors[EUTelMillepedeResult::kAlpha] << std::endl
+                                << "beta: "  << beta  << " +- " << errors[EUTelMillepedeResult::kBeta]  << std::endl
+                                << "gamma: " << gamma << " +- " << errors[EUTelMillepedeResult::kGamma] << std::endl;
+
+        //get old rotation matrix from GEAR file
+        Eigen::Matrix3d rotOld = geo::gGeometry().rotationMatrixFromAngles(sensorID);
+        //get new rotation matrix via the alpha, beta, gamma from MillepedeII
+        Eigen::Matrix3d rotAlign = Utility::rotationMatrixFromAngles(alpha, beta, gamma);
+        //get corrected rotation by multiplying rotAlign*rotOld and extract updated alpha', beta' and gamma'
+        Eigen::Vector3d newCoeff = Utility::getRotationAnglesFromMatrix(rotAlign * rotOld);
+
+        //output of results
+        streamlog_out(DEBUG5) << "Old rotation matrix: " << rotOld << std::endl;
+        streamlog_out(DEBUG5) << "Align rotation matrix: " << rotAlign << std::endl;
+        streamlog_out(MESSAGE6) << "Updated rotations (alpha', beta', gamma'): "
+                                << newCoeff[0] << ", " << newCoeff[1] << ", " << newCoeff[2]
+                                << std::endl;
+
+        Eigen::Vector3d oldOffset;
         oldOffset << geo::gGeometry().getPlaneXPosition(sensorID),
-        geo::gGeometry().getPlaneYPosition(sensorID),
-        geo::gGeometry().getPlaneZPosition(sensorID);
-          
-      oldOffset = rotAlign * oldOffset;
-	  //transfer alignment to geometry
-	  geo::gGeometry().alignGlobalPos(sensorID, 
-                      oldOffset[0] - xOff,
-                      oldOffset[1] - yOff,
-                      oldOffset[2] - zOff);
-          geo::gGeometry().alignGlobalRot(sensorID, rotAlign * rotOld);
-        }
+          geo::gGeometry().getPlaneYPosition(sensorID),
+          geo::gGeometry().getPlaneZPosition(sensorID);
+
+        oldOffset = rotAlign * oldOffset;
+        //transfer alignment to geometry
+        geo::gGeometry().alignGlobalPos(sensorID,
+                                        oldOffset[0] - xOff,
+                                        oldOffset[1] - yOff,
+                                        oldOffset[2] - zOff);
+        geo::gGeometry().alignGlobalRot(sensorID, rotAlign * rotOld);
       }
     }
-    millepede.close();
   }
 
   //create new GEAR file with new alignment constants
@@ -59,10 +59,10 @@ using namespace eutelescope;
 
 EUTelSparseClustering::EUTelSparseClustering()
     : Processor("EUTelSparseClustering"), _zsDataCollectionName(""),
-      _pulseCollectionName(""), _initialPulseCollectionSize(0), _iRun(0),
-      _iEvt(0), _fillHistos(false), _totalClusterMap(), _noOfDetector(0), 
-      _excludedPlanes(), _isGeometryReady(false), _sensorIDVec(), _zsInputDataCollectionVec(nullptr),
-      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2) {
+      _pulseCollectionName(""), _iRun(0), _fillHistos(false),
+      _totalClusterMap(), _noOfDetector(0), _excludedPlanes(),
+      _isGeometryReady(false), _areSensorIDsTagged(false), _sensorIDVec(),
+      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2), _threads() {
 
   _description = "EUTelSparseClustering is looking for clusters into "
                  "a calibrated pixel matrix.";
@@ -97,6 +97,10 @@ EUTelSparseClustering::EUTelSparseClustering()
   _isFirstEvent = true;
 }
 
+EUTelSparseClustering::ThreadState::ThreadState()
+    : clusterMap(), initialPulseCollectionSize(0), pulseCollectionSize(0),
+      nUnknownType(0), nMissingInput(0) {}
+
 void EUTelSparseClustering::init() {
 
   //usually a good idea to do
@@ -106,12 +110,19 @@ void EUTelSparseClustering::init() {
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                              EUTELESCOPE::DUMPGEOROOT);
 
-  //reset the run and event counters
+  //reset the run counter
   _iRun = 0;
-  _iEvt = 0;
 
   //the geometry is not yet initialized, set switch to false
   _isGeometryReady = false;
+  _areSensorIDsTagged = false;
+  _totalClusterMap.clear();
+  prepareThreads(1);
+}
+
+void EUTelSparseClustering::prepareThreads(unsigned int nThreads) {
+  _threads.clear();
+  _threads.resize(nThreads);
 }
 
 void EUTelSparseClustering::processRunHeader(LCRunHeader *rdr) {
@@ -131,13 +142,13 @@ void EUTelSparseClustering::initializeGeometry(LCEvent *event){
   streamlog_out(DEBUG5) << "Initializing geometry" << std::endl;
 
   try {
-    _zsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+    auto zsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
         event->getCollection(_zsDataCollectionName));
-    _noOfDetector += _zsInputDataCollectionVec->getNumberOfElements();
-    CellIDDecoder<TrackerDataImpl> cellDecoder(_zsInputDataCollectionVec);
+    _noOfDetector += zsInputDataCollectionVec->getNumberOfElements();
+    CellIDDecoder<TrackerDataImpl> cellDecoder(zsInputDataCollectionVec);
 
-    for(size_t icoll = 0; icoll < _zsInputDataCollectionVec->size(); ++icoll) {
-      auto data = dynamic_cast<TrackerDataImpl*>(_zsInputDataCollectionVec->getElementAt(icoll));
+    for(size_t icoll = 0; icoll < zsInputDataCollectionVec->size(); ++icoll) {
+      auto data = dynamic_cast<TrackerDataImpl*>(zsInputDataCollectionVec->getElementAt(icoll));
       _sensorIDVec.push_back(cellDecoder(data)["sensorID"]);
       _totalClusterMap.insert(std::make_pair(cellDecoder(data)["sensorID"], 0));
     }
@@ -149,93 +160,113 @@ void EUTelSparseClustering::initializeGeometry(LCEvent *event){
   _isGeometryReady = true;
 }
 
-void EUTelSparseClustering::readCollections(LCEvent *event) {
+LCCollectionVec *EUTelSparseClustering::readCollections(LCEvent *event,
+                                                        ThreadState &state) {
 
   try {
-    _zsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+    return dynamic_cast<LCCollectionVec *>(
         event->getCollection(_zsDataCollectionName));
-    streamlog_out(DEBUG4) << "_zsInputDataCollectionVec: "
-                          << _zsDataCollectionName.c_str() << " found "
-                          << std::endl;
   } catch(lcio::DataNotAvailableException &e) {
-    streamlog_out(ERROR4) << "_zsInputDataCollectionVec: "
-                          << _zsDataCollectionName.c_str()
-                          << " not found in event " << event->getEventNumber()
-                          << ". This shouldn't happen! Check your input data!"
-                          << std::endl;
+    //reported in end(), this may run on a worker thread
+    ++state.nMissingInput;
     throw SkipEventException(this);
   }
 }
 
 void EUTelSparseClustering::processEvent(LCEvent *event) {
 
-  //increment event counter
-  ++_iEvt;
+  processEventConcurrently(event, 0);
+  tagSensorIDs(event);
+
+  if(_fillHistos) {
+    if(isFirstEvent()) {
+      bookHistos();
+    }
+    //fill histos if the pulse collection increased
+    ThreadState const &state = _threads[0];
+    if(state.pulseCollectionSize != state.initialPulseCollectionSize) {
+      fillHistos(event);
+    }
+  }
+  _isFirstEvent = false;
+}
+
+void EUTelSparseClustering::check(LCEvent *event) {
+  tagSensorIDs(event);
+}
+
+void EUTelSparseClustering::tagSensorIDs(LCEvent *event) {
 
   if(!_isGeometryReady) {
     initializeGeometry(event);
   }
-  readCollections(event);
+  if(!_isGeometryReady || _areSensorIDsTagged) return;
 
-  if(_fillHistos && isFirstEvent()) {
-    bookHistos();
+  auto evt = static_cast<EUTelEventImpl*>(event);
+  if(evt->getEventType() == kEORE) return;
+
+  try {
+    auto& pulseCollectionParameters = event->getCollection(_pulseCollectionName)->parameters();
+    std::vector<int> sensorIDVec;
+    pulseCollectionParameters.getIntVals("sensorIDs", sensorIDVec ); 
+    sensorIDVec.insert( sensorIDVec.end(), _sensorIDVec.begin(), _sensorIDVec.end());
+    pulseCollectionParameters.setValues("sensorIDs", sensorIDVec );
+    _areSensorIDsTagged = true;
+  } catch(lcio::DataNotAvailableException &e) {
+    //the event was skipped
   }
+}
+
+void EUTelSparseClustering::processEventConcurrently(LCEvent *event, unsigned int thread) {
+
+  ThreadState &state = _threads[thread];
+  state.initialPulseCollectionSize = 0;
+  state.pulseCollectionSize = 0;
+
+  LCCollectionVec *zsInputDataCollectionVec = readCollections(event, state);
 
+  //nothing is printed here as this may run on a worker thread
   auto evt = static_cast<EUTelEventImpl*>(event);
   if(evt->getEventType() == kEORE) {
-    streamlog_out(DEBUG4) << "EORE found: nothing else to do." << std::endl;
     return;
   } else if(evt->getEventType() == kUNKNOWN) {
-    streamlog_out(WARNING2) << "Event number " << evt->getEventNumber()
-                            << " is of unknown type. Continue considering it "
-                               "as a normal Data Event."
-                            << std::endl;
+    //considered as a normal data event
+    ++state.nUnknownType;
   }
 
   //prepare a pulse collection to add all clusters found; this can be either a
   //new collection or an already existing in the event
   LCCollectionVec* pulseCollection = nullptr;
   bool pulseCollectionExists = false;
-  _initialPulseCollectionSize = 0;
   try {
     pulseCollection = dynamic_cast<LCCollectionVec *>(evt->getCollection(_pulseCollectionName));
     pulseCollectionExists = true;
-    _initialPulseCollectionSize = pulseCollection->size();
+    state.initialPulseCollectionSize = pulseCollection->size();
   } catch (lcio::DataNotAvailableException &e) {
     pulseCollection = new LCCollectionVec(LCIO::TRACKERPULSE);
   }
-  if(isFirstEvent()) {
-    auto& pulseCollectionParameters = pulseCollection->parameters();
-    std::vector<int> sensorIDVec;
-    pulseCollectionParameters.getIntVals("sensorIDs", sensorIDVec ); 
-    sensorIDVec.insert( sensorIDVec.end(), _sensorIDVec.begin(), _sensorIDVec.end());
-    pulseCollectionParameters.setValues("sensorIDs", sensorIDVec );
-  }  
 
-  sparseClustering(evt, pulseCollection);
+  sparseClustering(evt, zsInputDataCollectionVec, pulseCollection, state.clusterMap);
+  state.pulseCollectionSize = pulseCollection->size();
 
   //if the pulseCollection is not empty, add it to the event
   if(!pulseCollectionExists &&
-	((pulseCollection->size() != _initialPulseCollectionSize) || _initialPulseCollectionSize == 0)) {  
+	((state.pulseCollectionSize != state.initialPulseCollectionSize) || state.initialPulseCollectionSize == 0)) {  
     evt->addCollection(pulseCollection, _pulseCollectionName);
   }
 
-  //fill histos if flag set and pulse collection increased
-  if((pulseCollection->size() != _initialPulseCollectionSize) && (_fillHistos)) {
-    fillHistos(event);
-  }
-
   if(!pulseCollectionExists &&
-	(pulseCollection->size() == _initialPulseCollectionSize) && _initialPulseCollectionSize != 0) { 
+	(state.pulseCollectionSize == state.initialPulseCollectionSize) && state.initialPulseCollectionSize != 0) { 
    delete pulseCollection;
   }
-  _isFirstEvent = false;
 }
 
-void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *pulseCollection) {
+void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *zsInputDataCollectionVec,
+                                             LCCollectionVec *pulseCollection,
+                                             std::map<int, int> &clusterMap) {
 
   //prepare some decoders
-  CellIDDecoder<TrackerDataImpl> cellDecoder(_zsInputDataCollectionVec);
+  CellIDDecoder<TrackerDataImpl> cellDecoder(zsInputDataCollectionVec);
 
   bool isDummyAlreadyExisting = false;
   LCCollectionVec *sparseClusterCollectionVec = nullptr;
@@ -258,10 +289,10 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
 
   //in the zsInputDataCollectionVec we should have one TrackerData for each detector working in ZS mode
   //[START] loop over ZS detectors
-  for(size_t iDetector = 0; iDetector < _zsInputDataCollectionVec->size(); iDetector++) {
+  for(size_t iDetector = 0; iDetector < zsInputDataCollectionVec->size(); iDetector++) {
     // get the TrackerData and guess which kind of sparsified data it contains
     TrackerDataImpl *zsData = dynamic_cast<TrackerDataImpl *>(
-        _zsInputDataCollectionVec->getElementAt(iDetector));
+        zsInputDataCollectionVec->getElementAt(iDetector));
     SparsePixelType type = static_cast<SparsePixelType>(
         static_cast<int>(cellDecoder(zsData)["sparsePixelType"]));
     int sensorID = static_cast<int>(cellDecoder(zsData)["sensorID"]);
@@ -349,8 +380,8 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
         zsPulse->setTrackerData(zsCluster.release());
         pulseCollection->push_back(zsPulse.release());
 
-        //increment the totalClusterMap
-        _totalClusterMap[sensorID] += 1;
+        //increment the cluster counter of this thread
+        clusterMap[sensorID] += 1;
       } else {
         //cluster candidate is not passing the threshold... forget about them, 
         //the memory should be automatically cleaned by smart ptr's
@@ -370,6 +401,21 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
 
 void EUTelSparseClustering::end() {
 
+  long nUnknownType = 0, nMissingInput = 0;
+  for(auto const &state : _threads) {
+    for(auto const &clusters : state.clusterMap) _totalClusterMap[clusters.first] += clusters.second;
+    nUnknownType += state.nUnknownType;
+    nMissingInput += state.nMissingInput;
+  }
+
+  if(nUnknownType > 0) {
+    streamlog_out(WARNING2) << nUnknownType << " events of unknown type, considered as normal data events" << std::endl;
+  }
+  if(nMissingInput > 0) {
+    streamlog_out(ERROR4) << _zsDataCollectionName << " not found in " << nMissingInput
+                          << " events. This shouldn't happen! Check your input data!" << std::endl;
+  }
+
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
 
   std::map<int, int>::iterator iter = _totalClusterMap.begin();
@@ -403,7 +449,7 @@ void EUTelSparseClustering::fillHistos(LCEvent *evt) {
 
     std::map<int, int> eventCounterMap;
 
-    for(int iPulse = _initialPulseCollectionSize;
+    for(int iPulse = _threads[0].initialPulseCollectionSize;
          iPulse < _pulseCollectionVec->getNumberOfElements(); iPulse++) {
       TrackerPulseImpl *pulse = dynamic_cast<TrackerPulseImpl *>(
           _pulseCollectionVec->getElementAt(iPulse));
@@ -11,6 +11,10 @@
 #include "AlibavaEventImpl.h"
 #include "ALIBAVA.h"
 
+// eutelescope includes ".h"
+#include "EUTelLinearRegression.h"
+#include "EUTelParallel.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -43,6 +47,7 @@
 #include <stdlib.h>
 #include <memory>
 #include <fstream>
+#include <cmath>
 
 using namespace std;
 using namespace lcio;
@@ -50,13 +55,21 @@ using namespace marlin;
 using namespace alibava;
 
 
-AlibavaCalibration::AlibavaCalibration ( ) : AlibavaBaseProcessor ( "AlibavaCalibration" )
+AlibavaCalibration::AlibavaCalibration ( ) : AlibavaBaseProcessor ( "AlibavaCalibration" ),
+_chargeCalHistos ( ),
+_delayCalHistos ( ),
+_rootFitCrossCheck ( false ),
+_nThreads ( 1 )
 {
 
     _description = "AlibavaCalibration analyses calibration files.";
 
     registerInputCollection ( LCIO::TRACKERDATA, "InputCollectionName", "Input Collection Name", _inputCollectionName, string ( "rawdata" ) );
 
+    registerOptionalParameter ( "ROOTFitCrossCheck", "Also fit the charge calibration profiles with ROOT and report differences to the closed form fit", _rootFitCrossCheck, false );
+
+    registerOptionalParameter ( "NumberOfThreads", "Number of threads for the charge calibration fits, 0 uses all available cores", _nThreads, 1 );
+
 }
 
 
@@ -159,6 +172,40 @@ void AlibavaCalibration::end ( )
 
 	AIDAProcessor::tree ( this ) -> cd ( this -> name ( ) );
 
+	// the straight lines are solved in closed form from the charge
+	// calibration profiles, with the points the pol1 fits of the
+	// profiles used: bin centres and means weighted by 1 / error^2,
+	// bins without error left out, centres above 0 for the positive
+	// and below 0 for the negative fit. The slope stays 0 for a
+	// channel without data as for a failed fit
+	vector < double > slopes ( 2 * _chargeCalHistos.size ( ), 0.0 );
+	eutelescope::Utility::parallelFor ( _chargeCalHistos.size ( ), eutelescope::Utility::resolveThreadCount ( _nThreads ), [&] ( size_t first, size_t last, unsigned int )
+	{
+	    for ( size_t i = first; i < last; i++ )
+	    {
+		TProfile const * histo = _chargeCalHistos[i];
+		if ( !histo )
+		{
+		    continue;
+		}
+		eutelescope::EUTelLinearRegression positive;
+		eutelescope::EUTelLinearRegression negative;
+		for ( int bin = 1; bin <= histo -> GetNbinsX ( ); bin++ )
+		{
+		    double const error = histo -> GetBinError ( bin );
+		    if ( !( error > 0.0 ) )
+		    {
+			continue;
+		    }
+		    double const x = histo -> GetBinCenter ( bin );
+		    ( x > 0.0 ? positive : negative ).add ( x, histo -> GetBinContent ( bin ), 1.0 / ( error * error ) );
+		}
+		double offset = 0.0;
+		positive.solve ( offset, slopes[2 * i] );
+		negative.solve ( offset, slopes[2 * i + 1] );
+	    }
+	} );
+
 	for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
 	{
 	    unsigned int ichip = chipSelection[i];
@@ -172,23 +219,34 @@ void AlibavaCalibration::end ( )
 		}
 
 		// seperate fit for positive and negative signals...
-		sprintf ( tmpchar, "Charge Calibration Chip %d, Channel %d", ichip, ichan );
-		TProfile * histo = dynamic_cast < TProfile* > ( _rootObjectMap[tmpchar] );
-		sprintf ( tmpchar, "Charge Calibration Positive Fit Chip %d, Channel %d", ichip, ichan );
-		TF1 * posfit = dynamic_cast < TF1* > ( _rootObjectMap[tmpchar] );
-		posfit -> SetRange ( 0.0, 1E5 );
-		sprintf ( tmpchar, "Charge Calibration Negative Fit Chip %d, Channel %d", ichip, ichan );
-		TF1 * negfit = dynamic_cast < TF1* > ( _rootObjectMap[tmpchar] );
-		negfit -> SetRange ( -1.0 * 1E5, 0.0 );
-
-		histo -> Fit ( posfit, "QR+" );
-		histo -> Fit ( negfit, "QR+" );
+		double posslope = slopes[2 * getChanIndex ( ichip, ichan )];
+		double negslope = slopes[2 * getChanIndex ( ichip, ichan ) + 1];
+
+		if ( _rootFitCrossCheck )
+		{
+		    TProfile * histo = _chargeCalHistos[getChanIndex ( ichip, ichan )];
+		    sprintf ( tmpchar, "Charge Calibration Positive Fit Chip %d, Channel %d", ichip, ichan );
+		    TF1 * posfit = dynamic_cast < TF1* > ( _rootObjectMap[tmpchar] );
+		    posfit -> SetRange ( 0.0, 1E5 );
+		    sprintf ( tmpchar, "Charge Calibration Negative Fit Chip %d, Channel %d", ichip, ichan );
+		    TF1 * negfit = dynamic_cast < TF1* > ( _rootObjectMap[tmpchar] );
+		    negfit -> SetRange ( -1.0 * 1E5, 0.0 );
+
+		    histo -> Fit ( posfit, "QR+" );
+		    histo -> Fit ( negfit, "QR+" );
+
+		    // both solve the same weighted least squares problem
+		    if ( std::abs ( posfit -> GetParameter ( 1 ) - posslope ) > 1E-6 * std::abs ( posslope ) || std::abs ( negfit -> GetParameter ( 1 ) - negslope ) > 1E-6 * std::abs ( negslope ) )
+		    {
+			streamlog_out ( WARNING2 ) << "Chip " << ichip << " channel " << ichan << ": ROOT fit slopes " << posfit -> GetParameter ( 1 ) << " | " << negfit -> GetParameter ( 1 ) << " differ from the closed form fit " << posslope << " | " << negslope << endl;
+		    }
+		}
 
 		double pos = 0.0;
 		double neg = 0.0;
 
-		pos = 1.0 / ( posfit -> GetParameter ( 1 ) );
-		neg = 1.0 / ( negfit -> GetParameter ( 1 ) );
+		pos = 1.0 / posslope;
+		neg = 1.0 / negslope;
 
 		sprintf ( tmpchar, "Charge Calibration, Chip %d, Positive", ichip );
 		TH1D * poshisto = dynamic_cast < TH1D* > ( _rootObjectMap[tmpchar] );
@@ -213,15 +271,17 @@ void AlibavaCalibration::end ( )
 void AlibavaCalibration::fillhisto ( int chip, int chan, double calc, double cald, double q )
 {
 
-    char tmpchar[100];
-    sprintf ( tmpchar, "Charge Calibration Chip %d, Channel %d", chip, chan );
+    if ( chip < 0 || chip >= ALIBAVA::NOOFCHIPS || chan < 0 || chan >= ALIBAVA::NOOFCHANNELS )
+    {
+	return;
+    }
 
-    if ( TProfile * histo = dynamic_cast < TProfile* > ( _rootObjectMap[tmpchar] ) )
+    unsigned int index = getChanIndex ( chip, chan );
+    if ( TProfile * histo = _chargeCalHistos[index] )
     {
 	histo -> Fill ( calc, q );
     }
-    sprintf ( tmpchar, "Delay Calibration Chip %d, Channel %d", chip, chan );
-    if ( TProfile * histo = dynamic_cast < TProfile* > ( _rootObjectMap[tmpchar] ) )
+    if ( TProfile * histo = _delayCalHistos[index] )
     {
 	histo -> Fill ( cald, q );
     }
@@ -237,6 +297,9 @@ void AlibavaCalibration::bookHistos ( )
     AIDAProcessor::tree ( this ) -> cd ( this -> name ( ) );
     //AIDAProcessor::tree ( this ) -> mkdir ( "ChannelData" );
 
+    _chargeCalHistos.assign ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS, nullptr );
+    _delayCalHistos.assign ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS, nullptr );
+
     for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
     {
 	unsigned int ichip = chipSelection[i];
@@ -257,6 +320,13 @@ void AlibavaCalibration::bookHistos ( )
 	    calchisto -> SetTitle ( tmpchar );
 	    calchisto -> SetXTitle ( "Injected Charge in e" );
 	    calchisto -> SetYTitle ( "Signal in ADCs" );
+	    _chargeCalHistos[getChanIndex ( ichip, ichan )] = calchisto;
+
+	    // the fit functions are only needed for the cross check
+	    if ( !_rootFitCrossCheck )
+	    {
+		continue;
+	    }
 
 	    sprintf ( tmpchar, "Charge Calibration Positive Fit Chip %d, Channel %d", ichip, ichan );
 	    TF1 *calposFit = new TF1 ( tmpchar, "pol1" );
@@ -282,6 +352,7 @@ void AlibavaCalibration::bookHistos ( )
 	    caldhisto -> SetTitle ( tmpchar );
 	    caldhisto -> SetXTitle ( "Delay in ns" );
 	    caldhisto -> SetYTitle ( "Signal in ADCs" );
+	    _delayCalHistos[getChanIndex ( ichip, ichan )] = caldhisto;
 
 	}
 
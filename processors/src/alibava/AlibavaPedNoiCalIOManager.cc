@@ -26,6 +26,7 @@
 #include <IMPL/TrackerDataImpl.h>
 
 // system includes <>
+#include <memory>
 #include <string>
 #include <sys/stat.h>
 
@@ -33,273 +34,337 @@ using namespace std;
 using namespace lcio;
 using namespace alibava;
 
-AlibavaPedNoiCalIOManager::AlibavaPedNoiCalIOManager ( )
+namespace
 {
+    // copies all int, float and string parameters
+    void copyParameters ( const LCParameters& from, LCParameters& to )
+    {
+	StringVec keys;
+	from.getIntKeys ( keys );
+	for ( size_t i = 0; i < keys.size ( ); i++ )
+	{
+	    IntVec values;
+	    from.getIntVals ( keys[i], values );
+	    to.setValues ( keys[i], values );
+	}
+	keys.clear ( );
+	from.getFloatKeys ( keys );
+	for ( size_t i = 0; i < keys.size ( ); i++ )
+	{
+	    FloatVec values;
+	    from.getFloatVals ( keys[i], values );
+	    to.setValues ( keys[i], values );
+	}
+	keys.clear ( );
+	from.getStringKeys ( keys );
+	for ( size_t i = 0; i < keys.size ( ); i++ )
+	{
+	    StringVec values;
+	    from.getStringVals ( keys[i], values );
+	    to.setValues ( keys[i], values );
+	}
+    }
 
-}
+    LCRunHeaderImpl* copyRunHeader ( const LCRunHeader* runHeader )
+    {
+	LCRunHeaderImpl* newRunHeader = new LCRunHeaderImpl ( );
+	newRunHeader -> setRunNumber ( runHeader -> getRunNumber ( ) );
+	newRunHeader -> setDetectorName ( runHeader -> getDetectorName ( ) );
+	newRunHeader -> setDescription ( runHeader -> getDescription ( ) );
+	const StringVec * subdetectors = runHeader -> getActiveSubdetectors ( );
+	for ( size_t i = 0; i < subdetectors -> size ( ); i++ )
+	{
+	    newRunHeader -> addActiveSubdetector ( subdetectors -> at ( i ) );
+	}
+	copyParameters ( runHeader -> getParameters ( ), newRunHeader -> parameters ( ) );
+	return newRunHeader;
+    }
 
-AlibavaPedNoiCalIOManager::~AlibavaPedNoiCalIOManager ( )
-{
+    // copies everything but the collections
+    LCEventImpl* copyEventHeader ( const LCEvent* evt )
+    {
+	LCEventImpl* newEvent = new LCEventImpl ( );
+	newEvent -> setRunNumber ( evt -> getRunNumber ( ) );
+	newEvent -> setEventNumber ( evt -> getEventNumber ( ) );
+	newEvent -> setDetectorName ( evt -> getDetectorName ( ) );
+	newEvent -> setTimeStamp ( evt -> getTimeStamp ( ) );
+	copyParameters ( evt -> getParameters ( ), newEvent -> parameters ( ) );
+	return newEvent;
+    }
 
+    // copies flag and parameters of a collection, without the elements
+    LCCollectionVec* copyCollectionHeader ( const LCCollection* col )
+    {
+	LCCollectionVec* newCol = new LCCollectionVec ( col -> getTypeName ( ) );
+	newCol -> setFlag ( col -> getFlag ( ) );
+	// the elements of the copy are its own
+	newCol -> setSubset ( false );
+	newCol -> setTransient ( false );
+	copyParameters ( col -> getParameters ( ), newCol -> parameters ( ) );
+	return newCol;
+    }
 }
 
-EVENT::FloatVec AlibavaPedNoiCalIOManager::getDataFromEventForChip ( LCEvent* evt, string collectionName, unsigned int chipnum )
+AlibavaPedNoiCalIOManager::AlibavaPedNoiCalIOManager ( ) :
+    _tableFile ( ),
+    _table ( ),
+    _runHeader ( ),
+    _eventHeader ( ),
+    _collectionHeaders ( ),
+    _otherCollections ( ),
+    _fileOpenings ( )
 {
 
-    EVENT::FloatVec tmp_vec;
-    tmp_vec.clear ( );
-
-    LCCollectionVec* col = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( collectionName ) ) ;
+}
 
-    int ielement = getElementNumberOfChip ( col, chipnum );
-    if ( ielement != -1 )
-    {
-	TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( col -> getElementAt ( ielement ) ) ;
-	tmp_vec = trkdata -> getChargeValues ( );
-    }
+AlibavaPedNoiCalIOManager::~AlibavaPedNoiCalIOManager ( )
+{
 
-    return tmp_vec;
 }
 
-int AlibavaPedNoiCalIOManager::getElementNumberOfChip ( LCCollectionVec* col, int chipnum )
+EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip ( string filename, string collectionName, unsigned int chipnum )
 {
-    int ielement = -1;
-    CellIDDecoder < TrackerDataImpl > chipIDDecoder ( col );
-    unsigned int noOfChips = col -> getNumberOfElements ( );
-    for ( size_t i = 0; i < noOfChips; ++i )
+    // the file is read only once, all other chips and collections come from the table
+    if ( _tableFile != filename )
     {
-	TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( col -> getElementAt ( i ) ) ;
-	// check chip number
-	const int ichip = static_cast < int > ( chipIDDecoder ( trkdata ) [ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] );
+	readFile ( filename );
+    }
 
-	if ( chipnum == ichip )
-	{
-	    ielement=i;
-	}
+    EVENT::FloatVec tmp_vec = getStagedForChip ( collectionName, chipnum );
+    // if datavec is empty
+    if ( tmp_vec.size ( ) == 0 )
+    {
+	streamlog_out ( ERROR5 ) << "Trying to access" << collectionName << " for non existing chip (" << chipnum << ")." << endl;
     }
-    return ielement;
+    return tmp_vec;
 }
 
-EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip ( string filename, string collectionName, unsigned int chipnum )
+bool AlibavaPedNoiCalIOManager::readFile ( string filename )
 {
-    // open pedestal file
-    LCReader* lcReader = LCFactory::getInstance ( ) -> createLCReader ( );
+    clearTable ( );
+    _tableFile = filename;
 
-    EVENT::FloatVec tmp_vec;
-    tmp_vec.clear ( );
+    LCReader* lcReader = LCFactory::getInstance ( ) -> createLCReader ( );
+    bool success = true;
 
     try
     {
-	lcReader -> open ( filename );
+	openForReading ( lcReader, filename );
+
 	// check if there is only one run and only one event as it is supposed to
 	if ( lcReader -> getNumberOfRuns ( ) != 1 )
 	{
-	    streamlog_out ( ERROR5 ) << " There is more than one run in AlibavaPedNoiCalFile: " << filename << endl;
+	    streamlog_out ( ERROR5 ) << " There is not exactly one run in AlibavaPedNoiCalFile: " << filename << endl;
+	    streamlog_out ( ERROR5 ) << " Using only the first one! Might cause problems!" << endl;
 	}
-	if ( lcReader -> getNumberOfEvents ( ) !=1 )
+	if ( lcReader -> getNumberOfEvents ( ) > 1 )
 	{
-	    streamlog_out( ERROR5 ) << " There is more than one event in AlibavaPedNoiCalFile: " << filename << endl ;
+	    streamlog_out ( ERROR5 ) << " There is more than one event in AlibavaPedNoiCalFile: " << filename << endl;
+	    streamlog_out ( ERROR5 ) << " Using only the first one! Might cause problems!" << endl;
 	}
-	LCEvent*  evt = lcReader -> readNextEvent ( );
-	tmp_vec = getDataFromEventForChip ( evt, collectionName, chipnum );
-	// if datavec is empty
-	if ( tmp_vec.size ( ) == 0 )
+
+	LCRunHeader* runHeader = lcReader -> readNextRunHeader ( );
+	if ( runHeader != nullptr )
 	{
-	    streamlog_out ( ERROR5 ) << "Trying to access" << collectionName << " for non existing chip (" << chipnum << ")." << endl;
+	    _runHeader.reset ( copyRunHeader ( runHeader ) );
 	}
 
-	lcReader -> close ( ) ;
+	// the collections which are not ours are taken over as they are
+	LCEvent* evt = lcReader -> readNextEvent ( LCIO::UPDATE );
+	if ( evt != nullptr )
+	{
+	    _eventHeader.reset ( copyEventHeader ( evt ) );
+
+	    const StringVec * colnames = evt -> getCollectionNames ( );
+	    for ( size_t icol = 0; icol < colnames -> size ( ); icol++ )
+	    {
+		LCCollection* col = evt -> getCollection ( colnames -> at ( icol ) );
+		if ( col -> getTypeName ( ) != LCIO::TRACKERDATA )
+		{
+		    streamlog_out ( DEBUG5 ) << " Collection " << colnames -> at ( icol ) << " in AlibavaPedNoiCalFile: " << filename << " is not of type " << LCIO::TRACKERDATA << " and is kept unchanged." << endl;
+		    // takeCollection marks it transient, it has to be written again
+		    LCCollectionVec* other = static_cast < LCCollectionVec * > ( evt -> takeCollection ( colnames -> at ( icol ) ) );
+		    other -> setTransient ( false );
+		    _otherCollections[colnames -> at ( icol )].reset ( other );
+		    continue;
+		}
+
+		_collectionHeaders[colnames -> at ( icol )].reset ( copyCollectionHeader ( col ) );
+		map < int, FloatVec > & chips = _table[colnames -> at ( icol )];
+		CellIDDecoder < TrackerDataImpl > chipIDDecoder ( col );
+		for ( int i = 0; i < col -> getNumberOfElements ( ); i++ )
+		{
+		    TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( col -> getElementAt ( i ) );
+		    const int ichip = static_cast < int > ( chipIDDecoder ( trkdata ) [ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] );
+		    // as before, the last element of a chip wins
+		    chips[ichip] = trkdata -> getChargeValues ( );
+		}
+	    }
+	}
+	lcReader -> close ( );
     }
     catch ( IOException& e )
     {
-	streamlog_out ( ERROR5 ) << " Unable to read the AlibavaPedNoiCal file - " << filename << e.what ( ) << endl ;
+	streamlog_out ( ERROR5 ) << " Unable to read the AlibavaPedNoiCal file - " << filename << e.what ( ) << endl;
+	success = false;
     }
 
-    //delete lcReader;
-    return tmp_vec;
+    delete lcReader;
+    return success;
 }
 
-void AlibavaPedNoiCalIOManager::createFile ( string filename, IMPL::LCRunHeaderImpl* runHeader )
+void AlibavaPedNoiCalIOManager::stageForChip ( string collectionName, int chipnum, EVENT::FloatVec datavec )
 {
-    LCWriter * lcWriter = LCFactory::getInstance ( ) -> createLCWriter ( );
-    try
+    if ( _otherCollections.erase ( collectionName ) > 0 )
     {
-	lcWriter -> open ( filename, LCIO::WRITE_NEW );
+	streamlog_out ( WARNING5 ) << " Collection " << collectionName << " of another type is replaced by a " << LCIO::TRACKERDATA << " collection." << endl;
     }
-    catch ( IOException& e )
+    _table[collectionName][chipnum] = datavec;
+}
+
+EVENT::FloatVec AlibavaPedNoiCalIOManager::getStagedForChip ( string collectionName, int chipnum ) const
+{
+    map < string, map < int, FloatVec > >::const_iterator col = _table.find ( collectionName );
+    if ( col != _table.end ( ) )
     {
-	cerr << e.what ( ) << endl;
-	return;
+	map < int, FloatVec >::const_iterator chip = col -> second.find ( chipnum );
+	if ( chip != col -> second.end ( ) )
+	{
+	    return chip -> second;
+	}
     }
-
-    lcWriter -> writeRunHeader ( runHeader );
-    lcWriter -> close ( );
+    return EVENT::FloatVec ( );
 }
 
-void AlibavaPedNoiCalIOManager::addToFile ( string filename, string collectionName, int chipnum, EVENT::FloatVec datavec )
+void AlibavaPedNoiCalIOManager::writeFile ( string filename )
 {
-    // if file doesn't exist
-    if ( !doesFileExist ( filename ) )
+    // a file without run header gets an empty one
+    if ( !_runHeader )
     {
-	streamlog_out ( WARNING5 ) << " The AlibavaPedNoiCalFile: " << filename << " doesn't exist." << endl ;
-	streamlog_out ( WARNING5 ) << " Creating new AlibavaPedNoiCalFile" << endl;
-	createFile ( filename );
+	_runHeader.reset ( new LCRunHeaderImpl ( ) );
+	_runHeader -> setRunNumber ( 0 );
+	streamlog_out ( WARNING5 ) << " AlibavaPedNoiCalFile: " << filename << " is written with empty header." << endl;
     }
 
-    LCRunHeaderImpl* runHeader = getRunHeader ( filename );
-    LCEventImpl*  evt = getEvent ( filename );
-
-    FloatVec tmp_vec;
-    tmp_vec.clear ( );
     LCWriter * lcWriter = LCFactory::getInstance ( ) -> createLCWriter ( );
-    // we will write a new lcio file with the copied run header and event
     try
     {
-	lcWriter -> open ( filename, LCIO::WRITE_NEW );
-	// first write runheader
-	lcWriter -> writeRunHeader ( runHeader );
-	// check if the collection exists
-	LCCollectionVec* newCol = new LCCollectionVec ( LCIO::TRACKERDATA );
+	openForWriting ( lcWriter, filename );
+	lcWriter -> writeRunHeader ( _runHeader.get ( ) );
 
-	if ( doesCollectionExist ( evt, collectionName ) )
+	if ( !_table.empty ( ) || !_otherCollections.empty ( ) )
 	{
-	    LCCollectionVec* col = dynamic_cast < LCCollectionVec * > ( evt -> getCollection ( collectionName ) );
-	    *newCol = *col;
-	    evt -> removeCollection ( collectionName );
-	}
+	    LCEventImpl* evt = _eventHeader ? copyEventHeader ( _eventHeader.get ( ) ) : new LCEventImpl ( );
 
-	// check if the data exists for this chip in this event
-	// if exists remove it
-	int ielement = 0;
-	do
-	{
-	    ielement = getElementNumberOfChip ( newCol, chipnum );
-	    if ( ielement != -1 )
+	    map < string, map < int, FloatVec > >::const_iterator icol;
+	    for ( icol = _table.begin ( ); icol != _table.end ( ); ++icol )
+	    {
+		// flag and parameters as read from the file
+		map < string, unique_ptr < LCCollectionVec > >::const_iterator header = _collectionHeaders.find ( icol -> first );
+		LCCollectionVec* newCol = ( header != _collectionHeaders.end ( ) ) ? copyCollectionHeader ( header -> second.get ( ) ) : new LCCollectionVec ( LCIO::TRACKERDATA );
+		CellIDEncoder < TrackerDataImpl > chipIDEncoder ( ALIBAVA::ALIBAVADATA_ENCODE, newCol );
+
+		map < int, FloatVec >::const_iterator ichip;
+		for ( ichip = icol -> second.begin ( ); ichip != icol -> second.end ( ); ++ichip )
+		{
+		    TrackerDataImpl * tmp_data = new TrackerDataImpl ( );
+		    tmp_data -> setChargeValues ( ichip -> second );
+		    chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = ichip -> first;
+		    chipIDEncoder.setCellID ( tmp_data );
+		    newCol -> push_back ( tmp_data );
+		}
+		evt -> addCollection ( newCol, icol -> first );
+	    }
+
+	    map < string, unique_ptr < LCCollectionVec > >::const_iterator iother;
+	    for ( iother = _otherCollections.begin ( ); iother != _otherCollections.end ( ); ++iother )
+	    {
+		evt -> addCollection ( iother -> second.get ( ), iother -> first );
+	    }
+	    lcWriter -> writeEvent ( evt );
+
+	    // the other collections stay owned by the table, taking them only
+	    // after writing as takeCollection marks them transient
+	    for ( iother = _otherCollections.begin ( ); iother != _otherCollections.end ( ); ++iother )
 	    {
-		newCol -> removeElementAt ( ielement );
+		evt -> takeCollection ( iother -> first );
+		iother -> second -> setTransient ( false );
 	    }
+	    delete evt;
 	}
-	while ( ielement != -1 );
-
-	// now, add data vector to the collecton
-	TrackerDataImpl * tmp_data = new TrackerDataImpl ( );
-	tmp_data -> setChargeValues ( datavec );
-	// set Cell ID encode
-	CellIDEncoder < TrackerDataImpl > chipIDEncoder ( ALIBAVA::ALIBAVADATA_ENCODE, newCol );
-	chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
-	chipIDEncoder.setCellID ( tmp_data );
-
-	newCol -> push_back ( tmp_data );
-	evt -> addCollection ( newCol, collectionName );
-	lcWriter -> writeEvent ( evt );
 	lcWriter -> close ( );
     }
     catch ( IOException& e )
     {
 	cerr << e.what ( ) << endl;
     }
-    //delete lcWriter;
+    delete lcWriter;
+
+    // the table is now the content of this file
+    _tableFile = filename;
 }
 
-bool AlibavaPedNoiCalIOManager::doesCollectionExist ( LCEvent* evt, string collectionName )
+void AlibavaPedNoiCalIOManager::clearTable ( )
 {
-
-    bool it_exists = false;
-    StringVec * colnames = const_cast < StringVec * > ( evt -> getCollectionNames ( ) );
-
-    for ( unsigned int i = 0; i < colnames -> size ( ); i++ )
-    {
-	if ( colnames -> at ( i ) == collectionName )
-	{
-	    it_exists = true;
-	}
-    }
-    return it_exists;
+    _tableFile.clear ( );
+    _table.clear ( );
+    _runHeader.reset ( );
+    _eventHeader.reset ( );
+    _collectionHeaders.clear ( );
+    _otherCollections.clear ( );
 }
 
-bool AlibavaPedNoiCalIOManager::doesFileExist ( string astring )
+unsigned int AlibavaPedNoiCalIOManager::getNumberOfFileOpenings ( string filename ) const
 {
-    struct stat buffer;
-    return ( stat ( astring.c_str ( ), &buffer ) == 0 );
+    map < string, unsigned int >::const_iterator it = _fileOpenings.find ( filename );
+    return ( it != _fileOpenings.end ( ) ) ? it -> second : 0;
 }
 
-void AlibavaPedNoiCalIOManager::createFile ( string filename )
+void AlibavaPedNoiCalIOManager::createFile ( string filename, IMPL::LCRunHeaderImpl* runHeader )
 {
-    LCRunHeaderImpl* runHeader = new LCRunHeaderImpl ( );
-    int runnumber = 0;
-    runHeader -> setRunNumber ( runnumber );
-    createFile ( filename, runHeader );
-    streamlog_out ( WARNING5 ) << " New AlibavaPedNoiCalFile is created with empty header. File is: " << filename << endl;
+    // the new file has no event yet
+    clearTable ( );
+    _runHeader.reset ( copyRunHeader ( runHeader ) );
+    writeFile ( filename );
 }
 
-LCRunHeaderImpl* AlibavaPedNoiCalIOManager::getRunHeader ( string filename )
+void AlibavaPedNoiCalIOManager::addToFile ( string filename, string collectionName, int chipnum, EVENT::FloatVec datavec )
 {
-    LCRunHeaderImpl* newRunHeader = new LCRunHeaderImpl ( );
-
-    // first try to access file and get run header and the event
-    LCReader* lcReader = LCFactory::getInstance ( ) -> createLCReader ( );
-
-    try
+    if ( _tableFile != filename )
     {
-	// first try to access file
-	lcReader -> open ( filename ) ;
-
-	// read run header
-	if ( ( lcReader -> getNumberOfRuns ( ) ) > 0 )
+	// if file doesn't exist
+	if ( !doesFileExist ( filename ) )
 	{
-	    if ( ( lcReader -> getNumberOfRuns ( ) ) > 1 )
-	    {
-		streamlog_out ( ERROR5 ) << " There are more than one run in AlibavaPedNoiCalFile: " << filename << endl;
-		streamlog_out ( ERROR5 ) << " Using only one of them (probably first one)! Might cause problems!" << endl ;
-	    }
-	    newRunHeader = dynamic_cast < LCRunHeaderImpl* > ( lcReader -> readNextRunHeader ( LCIO::UPDATE ) );
+	    streamlog_out ( WARNING5 ) << " The AlibavaPedNoiCalFile: " << filename << " doesn't exist." << endl ;
+	    streamlog_out ( WARNING5 ) << " Creating new AlibavaPedNoiCalFile" << endl;
+	    clearTable ( );
 	}
-	else if ( ( lcReader -> getNumberOfRuns ( ) ) == 0 )
+	else
 	{
-	    streamlog_out ( ERROR5 ) << " There is no run header in AlibavaPedNoiCalFile: " << filename << endl;
+	    readFile ( filename );
 	}
-	lcReader -> close ( );
     }
-    catch ( IOException& e )
-    {
-	cerr << e.what ( ) << endl;
-    }
-    //delete lcReader;
-    return newRunHeader;
+
+    // the file is rewritten with the new data for this chip, to stage
+    // several chips and collections use stageForChip and writeFile
+    stageForChip ( collectionName, chipnum, datavec );
+    writeFile ( filename );
 }
 
-LCEventImpl* AlibavaPedNoiCalIOManager::getEvent ( string filename )
+bool AlibavaPedNoiCalIOManager::doesFileExist ( string astring )
 {
-    LCEventImpl* newEvent = new LCEventImpl ( );
+    struct stat buffer;
+    return ( stat ( astring.c_str ( ), &buffer ) == 0 );
+}
 
-    // first try to access file and get run header and the event
-    LCReader* lcReader = LCFactory::getInstance ( ) -> createLCReader ( );
+void AlibavaPedNoiCalIOManager::openForReading ( LCReader* lcReader, string filename )
+{
+    _fileOpenings[filename]++;
+    lcReader -> open ( filename );
+}
 
-    try
-    {
-	// first try to access file
-	lcReader -> open ( filename );
-	// read the event
-	if ( lcReader -> getNumberOfEvents ( ) > 0 )
-	{
-	    if ( lcReader -> getNumberOfEvents ( ) > 1 )
-	    {
-		streamlog_out ( ERROR5 ) << " There are more than one event in AlibavaPedNoiCalFile: " << filename << endl;
-		streamlog_out ( ERROR5 ) << " Using only one of them (probably first one)! Might cause problems!" << endl;
-	    }
-	    newEvent = dynamic_cast < LCEventImpl* > ( lcReader -> readNextEvent ( LCIO::UPDATE ) );
-	}
-	else if ( lcReader -> getNumberOfEvents ( ) == 0 )
-	{
-	    streamlog_out ( MESSAGE5 ) << " New event created in AlibavaPedNoiCalFile: " << filename << endl ;
-	}
-	lcReader -> close ( );
-    }
-    catch ( IOException& e )
-    {
-	cerr << e.what ( ) << endl;
-    }
-    // clean up
-    //delete lcReader;
-    return newEvent;
+void AlibavaPedNoiCalIOManager::openForWriting ( LCWriter* lcWriter, string filename )
+{
+    _fileOpenings[filename]++;
+    lcWriter -> open ( filename, LCIO::WRITE_NEW );
 }
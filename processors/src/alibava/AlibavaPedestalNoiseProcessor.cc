@@ -14,6 +14,9 @@
 #include "ALIBAVA.h"
 #include "AlibavaPedNoiCalIOManager.h"
 
+// eutelescope includes ".h"
+#include "EUTelParallel.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -40,6 +43,7 @@
 #include "TROOT.h"
 #include "TCanvas.h"
 #include "TSystem.h"
+#include "Math/MinimizerOptions.h"
 
 // system includes <>
 #include <string>
@@ -57,7 +61,10 @@ _pedestalHistoName ( "hpedestal" ),
 _noiseHistoName ( "hnoise" ),
 _temperatureHistoName ( "htemperature" ),
 _chanDataHistoName ( "Data_chan" ),
-_chanDataFitName ( "Fit_chan" )
+_chanDataFitName ( "Fit_chan" ),
+_chanDataHistos ( ),
+_chanDataFits ( ),
+_nFitThreads ( 1 )
 {
 
     // modify processor description
@@ -73,6 +80,8 @@ _chanDataFitName ( "Fit_chan" )
 
     registerOptionalParameter ( "NoiseCollectionName", "Noise collection name, better not to change", _noiseCollectionName, string ( "noise" ) );
 
+    registerOptionalParameter ( "NumberOfFitThreads", "Number of threads for the channel fits at the end, 0 uses all available cores", _nFitThreads, 1 );
+
 }
 
 void AlibavaPedestalNoiseProcessor::init ( )
@@ -97,6 +106,12 @@ void AlibavaPedestalNoiseProcessor::init ( )
 	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::SKIPMASKEDEVENTS << " is not set! Masked events will be used!" << endl;
     }
 
+    // ROOT has to be told before the fits run in several threads
+    if ( eutelescope::Utility::resolveThreadCount ( _nFitThreads ) > 1 )
+    {
+	ROOT::EnableThreadSafety ( );
+    }
+
     printParameters ( );
 
 }
@@ -172,10 +187,55 @@ void AlibavaPedestalNoiseProcessor::end ( )
 
 void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 {
-    string tempHistoName,tempFitName;
     TCanvas *cc = new TCanvas ( "cc", "cc", 800, 600 );
 
     EVENT::IntVec chipSelection = getChipSelection ( );
+
+    // collect the channel fits, each channel has its own histogram and
+    // fit function so that they can be done in parallel
+    vector < unsigned int > fitIndices;
+    for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
+    {
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    unsigned int index = getChanIndex ( chipSelection[i], ichan );
+	    if ( _chanDataHistos[index] != nullptr )
+	    {
+		fitIndices.push_back ( index );
+	    }
+	}
+    }
+
+    // the same minimizer and options whatever the number of threads,
+    // so that the result does not depend on it. TMinuit, the default
+    // minimizer, is a global object; Minuit2 has no shared state.
+    // Nothing is drawn from the worker threads, the fit functions are
+    // shown with their histograms afterwards as with option Q alone
+    unsigned int nThreads = eutelescope::Utility::resolveThreadCount ( _nFitThreads );
+    string defaultMinimizer = ROOT::Math::MinimizerOptions::DefaultMinimizerType ( );
+    ROOT::Math::MinimizerOptions::SetDefaultMinimizer ( "Minuit2" );
+    eutelescope::Utility::parallelFor ( fitIndices.size ( ), nThreads, [&] ( size_t first, size_t last, unsigned int )
+    {
+	for ( size_t i = first; i < last; i++ )
+	{
+	    _chanDataHistos[fitIndices[i]] -> Fit ( _chanDataFits[fitIndices[i]], "Q0" );
+	}
+    } );
+    ROOT::Math::MinimizerOptions::SetDefaultMinimizer ( defaultMinimizer.c_str ( ) );
+
+    for ( size_t i = 0; i < fitIndices.size ( ); i++ )
+    {
+	if ( TF1 * fitted = _chanDataHistos[fitIndices[i]] -> GetFunction ( _chanDataFits[fitIndices[i]] -> GetName ( ) ) )
+	{
+	    fitted -> ResetBit ( TF1::kNotDraw );
+	}
+    }
+
+    // the file has been created in processRunHeader, all chips are
+    // staged and written in one go at the end
+    AlibavaPedNoiCalIOManager man;
+    man.readFile ( _pedestalFile );
+
     for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
     {
 	unsigned int ichip = chipSelection[i];
@@ -186,18 +246,14 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 	{
 	    double ped, noi;
 	    // if channel is masked, set pedestal and noise to 0
-	    if ( isMasked ( ichip, ichan ) )
+	    TF1 * tempfit = _chanDataFits[getChanIndex ( ichip, ichan )];
+	    if ( tempfit == nullptr )
 	    {
 		ped=0;
 		noi=0;
 	    }
 	    else
 	    {
-		tempFitName = getChanDataFitName ( ichip, ichan );
-		tempHistoName = getChanDataHistoName ( ichip, ichan );
-		TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap[tempHistoName] );
-		TF1 * tempfit = dynamic_cast < TF1* > ( _rootObjectMap[tempFitName] );
-		histo -> Fit ( tempfit, "Q" );
 		ped = tempfit -> GetParameter ( 1 );
 		noi = tempfit -> GetParameter ( 2 );
 		hped -> SetBinContent ( ichan + 1, ped );
@@ -206,10 +262,10 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 	    pedestalVec.push_back ( ped );
 	    noiseVec.push_back ( noi );
 	}
-	AlibavaPedNoiCalIOManager man;
-	man.addToFile ( _pedestalFile, _pedestalCollectionName, ichip, pedestalVec );
-	man.addToFile ( _pedestalFile, _noiseCollectionName, ichip, noiseVec );
+	man.stageForChip ( _pedestalCollectionName, ichip, pedestalVec );
+	man.stageForChip ( _noiseCollectionName, ichip, noiseVec );
     }
+    man.writeFile ( _pedestalFile );
     delete cc;
 }
 
@@ -243,22 +299,22 @@ string AlibavaPedestalNoiseProcessor::getNoiseHistoName ( unsigned int ichip )
 
 void AlibavaPedestalNoiseProcessor::fillHistos ( TrackerDataImpl * trkdata )
 {
-    FloatVec datavec;
-    datavec = trkdata -> getChargeValues ( );
+    const FloatVec & datavec = trkdata -> getChargeValues ( );
 
     int chipnum = getChipNum ( trkdata );
-
-    for ( size_t ichan = 0; ichan < datavec.size ( ); ichan++ )
+    if ( chipnum < 0 || chipnum >= ALIBAVA::NOOFCHIPS )
     {
-	if ( isMasked ( chipnum, ichan ) )
-	{
-	    continue;
-	}
+	return;
+    }
 
-	string tempHistoName = getChanDataHistoName ( chipnum, ichan );
-	if ( TH1D * histo = dynamic_cast < TH1D* > ( _rootObjectMap[tempHistoName] ) )
+    // masked channels and chips which are not selected have no histogram
+    TH1D ** histos = &_chanDataHistos[getChanIndex ( chipnum, 0 )];
+    size_t noOfChannels = min ( datavec.size ( ), static_cast < size_t > ( ALIBAVA::NOOFCHANNELS ) );
+    for ( size_t ichan = 0; ichan < noOfChannels; ichan++ )
+    {
+	if ( histos[ichan] != nullptr )
 	{
-	    histo -> Fill ( datavec[ichan] );
+	    histos[ichan] -> Fill ( datavec[ichan] );
 	}
     }
 }
@@ -301,6 +357,9 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
     AIDAProcessor::tree ( this ) -> cd ( getInputCollectionName ( ) .c_str ( ) );
 
     // here are the histograms used to calculate pedestal and noise for each channel
+    // they are also kept in flat arrays indexed by chip and channel
+    _chanDataHistos.assign ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS, nullptr );
+    _chanDataFits.assign ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS, nullptr );
     string tempHistoName, tempFitName;
     for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
     {
@@ -324,6 +383,9 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
 
 	    TF1 *chanDataFit = new TF1 ( tempFitName.c_str ( ), "gaus" );
 	    _rootObjectMap.insert ( make_pair ( tempFitName, chanDataFit ) );
+
+	    _chanDataHistos[getChanIndex ( ichip, ichan )] = chanDataHisto;
+	    _chanDataFits[getChanIndex ( ichip, ichan )] = chanDataFit;
 	}
     }
 
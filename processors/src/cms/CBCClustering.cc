@@ -71,7 +71,8 @@ using namespace eutelescope;
 
 
 CBCClustering::CBCClustering ( ) : Processor ( "CBCClustering" ),
-_aidaHistoMap ( )
+_aidaHistoMap ( ),
+_clusterAssembler ( )
 {
 
     _description = "CBCClustering clusters the CBC data stream.";
@@ -397,52 +398,20 @@ void CBCClustering::processEvent ( LCEvent * anEvent )
 		    CellIDEncoder < TrackerPulseImpl > zsDataEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
 		    CellIDEncoder < TrackerDataImpl > idClusterEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
 
-		    // decode datavec into pixelvec, each chan goes into a pixel
-		    //std::vector < eutelescope::EUTelGenericSparsePixel* > PixelVec;
-		    std::vector<EUTelGenericSparsePixel> PixelVec;
-		    eutelescope::EUTelGenericSparsePixel Pixel;
-		    std::unique_ptr < EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > > pixelData = std::make_unique < EUTelTrackerDataInterfacerImpl < EUTelGenericSparsePixel > > ( trkdata );
-		    for ( unsigned int iPixel = 0; iPixel < datavec.size ( ); iPixel++ )
-		    {
-			if ( _nonsensitiveaxis == "x" )
-			{
-			    Pixel.setXCoord ( 0.0 );
-			    Pixel.setYCoord ( iPixel );
-			}
-			else
-			{
-			    Pixel.setXCoord ( iPixel );
-			    Pixel.setYCoord ( 0.0 );
-			}
-			Pixel.setSignal ( datavec[iPixel] * 1.0 );
-			PixelVec.push_back ( Pixel );
-			streamlog_out ( DEBUG0 ) << "Decoded pixel with coordinates: ( " << Pixel.getXCoord ( ) << " , " << Pixel.getYCoord ( ) << " ) and charge: " << datavec[iPixel] << " !" << endl;
-			streamlog_out ( DEBUG0 ) << "Input was: " << PixelVec.at ( iPixel ) << endl;
-		    }
+		    // group the strips by cluster number in one pass, each chan goes into a pixel of its cluster
+		    _clusterAssembler.assemble ( clusterNumber );
 
-		    std::vector < int > ::iterator it;
-		    for ( it = clusterNumber.begin ( ); it != clusterNumber.end ( ); ++it )
+		    for ( int iCluster = 1; iCluster <= _clusterAssembler.getMaxClusterID ( ); iCluster++ )
 		    {
 			lcio::TrackerPulseImpl * pulseFrame = new lcio::TrackerPulseImpl ( );
 			lcio::TrackerDataImpl * clusterFrame = new lcio::TrackerDataImpl ( );
 			eutelescope::EUTelSparseClusterImpl < eutelescope::EUTelGenericSparsePixel > *pixelCluster = new eutelescope::EUTelSparseClusterImpl < eutelescope::EUTelGenericSparsePixel > ( clusterFrame );
-			
-			for ( size_t j = 0; j < datavec.size ( ); j++ )
+
+			// put only these pixels in that ClusterCollection that belong to that cluster
+			_clusterAssembler.fillCluster ( iCluster, datavec, _nonsensitiveaxis == "x", *pixelCluster );
+			for ( size_t j = 0; j < _clusterAssembler.getClusterSize ( iCluster ); j++ )
 			{
-			    if ( clusterNumber.at ( j ) == *it ) 
-			    {
-				if ( clusterNumber.at ( j ) > 0 )
-				{
-				    // put only these pixels in that ClusterCollection that belong to that cluster
-				    auto temppix = PixelVec.at(i);
-				    pixelCluster -> push_back ( temppix );
-				    streamlog_out ( DEBUG1 ) << "Evt " << anEvent -> getEventNumber ( )<<" Adding channel " << j << " to cluster " << clusterNumber.at ( j ) << endl;
-				    if ( it != clusterNumber.end ( ) - 1 )
-				    {
-					++it;
-				    }
-				}
-			    }
+			    streamlog_out ( DEBUG1 ) << "Evt " << anEvent -> getEventNumber ( ) << " Adding channel " << _clusterAssembler.getStrips ( iCluster )[j] << " to cluster " << iCluster << endl;
 			}
 
 			// now we have pixelClusters with the corresponding pixels (which have the xy and q info) in them
@@ -461,7 +430,7 @@ void CBCClustering::processEvent ( LCEvent * anEvent )
 			    pixelCluster -> getCenterOfGravity ( x, y );
 			    pixelCluster -> getClusterSize ( xsize, ysize );
 
-			    streamlog_out( DEBUG1 ) << "Cluster: " << *it << ", Q: " << charge << " , x: " << x << " , y: " << y << " , dx: " << xsize << " , dy: " << ysize << " in event: " << anEvent -> getEventNumber ( ) << endl;
+			    streamlog_out( DEBUG1 ) << "Cluster: " << iCluster << ", Q: " << charge << " , x: " << x << " , y: " << y << " , dx: " << xsize << " , dy: " << ysize << " in event: " << anEvent -> getEventNumber ( ) << endl;
 
 			    dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ClusterCharge_" + to_string ( _outputSensorID + i ) ] ) -> fill ( charge );
 			    if ( _nonsensitiveaxis == "x" )
@@ -498,7 +467,7 @@ void CBCClustering::processEvent ( LCEvent * anEvent )
 
 			delete pixelCluster;
 
-		    } // done clusterNumber iteration
+		    } // done cluster iteration
 
 		}
 	    }
@@ -55,6 +55,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelVirtualDUT.h"
 
 // processor include
 #include "CBCHitRecovery.h"
@@ -69,7 +70,17 @@ using namespace eutelescope;
 
 
 CBCHitRecovery::CBCHitRecovery ( ) : Processor ( "CBCHitRecovery" ),
-_aidaHistoMap ( )
+_VirtualDutNormal_zplus ( Eigen::Vector3d::Zero ( ) ),
+_VirtualDutNormal_zminus ( Eigen::Vector3d::Zero ( ) ),
+_VirtualDutPos ( Eigen::Vector3d::Zero ( ) ),
+_dutPosMap ( ),
+_dutNormalMap ( ),
+_aidaHistoMap ( ),
+_virtualHitPosHisto ( ),
+_cosPhiHisto ( nullptr ),
+_fitHitPosHisto ( ),
+_virtualResidualXHisto ( nullptr ),
+_residualXHisto ( )
 {
 
     _description = "CBCHitRecovery recovers the real hit positions from the virtual dut and track.";
@@ -106,7 +117,7 @@ void CBCHitRecovery::init ( )
                         double beta  = _siPlanesLayerLayout -> getLayerRotationZX ( i );
 
                         // we need to calculate the normal vectors 
-                        double *normalvector = new double[3];
+                        Eigen::Vector3d normalvector;
                         normalvector[0] = sin ( beta * PI / 180.0 );
                         normalvector[1] = -sin ( alpha * PI / 180.0 );
                         normalvector[2] = cos ( alpha * PI / 180.0 ) * cos ( beta * PI / 180.0 );
@@ -115,7 +126,7 @@ void CBCHitRecovery::init ( )
                         _dutNormalMap.insert ( make_pair ( cPlaneID, normalvector ) );
 
                         // we need to calculate the normal vectors 
-                        double *posvector = new double[3];
+                        Eigen::Vector3d posvector;
                         posvector[0] = _siPlanesLayerLayout -> getLayerPositionX( i );
                         posvector[1] = _siPlanesLayerLayout -> getLayerPositionY( i );
                         posvector[2] = _siPlanesLayerLayout -> getLayerPositionZ( i ) + 0.5 *_siPlanesLayerLayout -> getSensitiveThickness( i );
@@ -124,9 +135,9 @@ void CBCHitRecovery::init ( )
                         _dutPosMap.insert ( make_pair ( cPlaneID, posvector ) );
 
                         // test if it was saved properly
-                        double *pos_test = _dutPosMap.at(cPlaneID);
+                        Eigen::Vector3d const & pos_test = _dutPosMap.at(cPlaneID);
                         streamlog_out ( MESSAGE2 ) << "The position vector of the DUT" << cPlaneID << " is: X = " << pos_test[0] << ", Y = " << pos_test[1] << ", Z = " << pos_test[2] << endl;
-                        double *normal_test = _dutNormalMap.at(cPlaneID);
+                        Eigen::Vector3d const & normal_test = _dutNormalMap.at(cPlaneID);
                         streamlog_out ( MESSAGE2 ) << "The normal vector of the DUT" << cPlaneID << " is: X = " << normal_test[0] << ", Y = " << normal_test[1] << ", Z = " << normal_test[2] << endl;
                 }               
         }
@@ -185,11 +196,6 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                         // get object
                         LCGenericObjectImpl* dutnormalvec = dynamic_cast < LCGenericObjectImpl * > (dutnormalvec_collection->at(0));
 
-                        // allocare
-                        _VirtualDutNormal_zplus = new double[3];
-                        _VirtualDutNormal_zminus = new double[3];
-                        _VirtualDutPos = new double[3];
-
                         // dut normal vec                       
                         for(int i = 0; i < 3; i++) {
                                 _VirtualDutNormal_zplus[i] = dutnormalvec->getDoubleVal(i+3);   
@@ -221,22 +227,22 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                 const double *cVirtualHitPos = nullptr;
                 const double *cTelescope3Pos = nullptr;
 
+                // sensor id decoders, one per collection
+                CellIDDecoder < TrackerHitImpl > fitPointCellIDDecoder ( inputFitPointVec );
+                CellIDDecoder < TrackerHitImpl > hitCellIDDecoder ( inputHitsVec );
+
                 // find the fit hit points of the track (needed to calculate the fir hits in the dut
                 int nEntries = inputFitPointVec -> getNumberOfElements ( );
                 for ( int i = 0; i < nEntries; ++i ) 
                 {
                     TrackerHitImpl * hit = dynamic_cast < TrackerHitImpl * > ( inputFitPointVec -> getElementAt ( i ) );
 
-                    // sensor id decoder
-                    CellIDDecoder < TrackerHitImpl > inputCellIDDecoder ( inputFitPointVec );
-                    int sensorID = inputCellIDDecoder ( hit ) ["sensorID"];
+                    int sensorID = fitPointCellIDDecoder ( hit ) ["sensorID"];
                     // check that we are on the virtual cbc hit
                     if (sensorID == _cbcVirtualDUTId) {
                         cVirtualHitPos = hit->getPosition();
                         
-                        dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["VirtualHitPosX"] ) -> fill (cVirtualHitPos[0]);
-                        dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["VirtualHitPosY"] ) -> fill (cVirtualHitPos[1]);
-                        dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["VirtualHitPosZ"] ) -> fill (cVirtualHitPos[2]);
+                        for(int j = 0; j < 3; j++) _virtualHitPosHisto[j] -> fill (cVirtualHitPos[j]);
                     } else if (sensorID == 2) {
                         cTelescope2Pos = hit->getPosition();
                     } else if (sensorID == 3) {
@@ -253,43 +259,29 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                                 streamlog_out ( WARNING ) << "No fit hit for some of the planes in the event " <<  anEvent -> getEventNumber ( ) << endl;
                         } else {
                                 // track from upstream (it pointed from dut to the telescope plane 2, then we will reconstruct sensor 60 hit)
-                                double cTrackVecUpstream[3];
-                                for(int i = 0; i < 3; i++) cTrackVecUpstream[i] = cTelescope2Pos[i] - cVirtualHitPos[i];
+                                Eigen::Map < const Eigen::Vector3d > cVirtualHit ( cVirtualHitPos );
+                                Eigen::Vector3d cTrackVecUpstream = Eigen::Map < const Eigen::Vector3d > ( cTelescope2Pos ) - cVirtualHit;
 
                                 // track to downstream
-                                double cTrackVecDownstream[3];
-                                for(int i = 0; i < 3; i++) cTrackVecDownstream[i] = cTelescope3Pos[i] - cVirtualHitPos[i];
-
-                                // print more for debugging
-                                /*if (anEvent->getEventNumber() < 50) {
-                                        streamlog_out (DEBUG1) << "vec up: " << cTrackVecUpstream[0] << ", " << cTrackVecUpstream[1] << ", " << cTrackVecUpstream[2] << endl;
-                                        streamlog_out (DEBUG1) << "vec down: " << cTrackVecDownstream[0] << ", " << cTrackVecDownstream[1] << ", " << cTrackVecDownstream[2] << endl;
-                                }*/
+                                Eigen::Vector3d cTrackVecDownstream = Eigen::Map < const Eigen::Vector3d > ( cTelescope3Pos ) - cVirtualHit;
 
                                 // cos phi between the vectors
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["cosPhi"] ) -> fill (cos_alpha(cTrackVecUpstream,cTrackVecDownstream));
+                                _cosPhiHisto -> fill (VirtualDUT::cosAlpha(cTrackVecUpstream,cTrackVecDownstream));
 
                                 // fit hit pos in dut 0
-                                double *fit_hit_pos_dut0 = this->hit_pos(cTrackVecUpstream, _VirtualDutNormal_zminus, cVirtualHitPos, -2.0);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosX_DUT0"] ) -> fill (fit_hit_pos_dut0[0]);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosY_DUT0"] ) -> fill (fit_hit_pos_dut0[1]);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosZ_DUT0"] ) -> fill (fit_hit_pos_dut0[2]);
-
+                                Eigen::Vector3d fit_hit_pos_dut0 = VirtualDUT::hitPosition(cTrackVecUpstream, _VirtualDutNormal_zminus, cVirtualHit, -2.0);
+                                for(int j = 0; j < 3; j++) _fitHitPosHisto[0][j] -> fill (fit_hit_pos_dut0[j]);
 
                                 // fit hit pos in dut 1
-                                double *fit_hit_pos_dut1 = this->hit_pos(cTrackVecDownstream, _VirtualDutNormal_zplus, cVirtualHitPos, 2.0);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosX_DUT1"] ) -> fill (fit_hit_pos_dut1[0]);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosY_DUT1"] ) -> fill (fit_hit_pos_dut1[1]);
-                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["FitHitPosZ_DUT1"] ) -> fill (fit_hit_pos_dut1[2]);
+                                Eigen::Vector3d fit_hit_pos_dut1 = VirtualDUT::hitPosition(cTrackVecDownstream, _VirtualDutNormal_zplus, cVirtualHit, 2.0);
+                                for(int j = 0; j < 3; j++) _fitHitPosHisto[1][j] -> fill (fit_hit_pos_dut1[j]);
 
                                 // now calculate the residuals
                                 int nHits = inputHitsVec -> getNumberOfElements ( );
                                 for ( int iHit = 0; iHit < nHits; ++iHit ) {
                                         TrackerHitImpl * hit = dynamic_cast < TrackerHitImpl * > ( inputHitsVec -> getElementAt ( iHit ) );
 
-                                        // sensor id decoder
-                                        CellIDDecoder < TrackerHitImpl > inputCellIDDecoder ( inputFitPointVec );
-                                        int sensorID = inputCellIDDecoder ( hit ) ["sensorID"];
+                                        int sensorID = hitCellIDDecoder ( hit ) ["sensorID"];
 
                                         // virtual
                                         if (sensorID == _cbcVirtualDUTId) {
@@ -298,7 +290,7 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                                                 //double resY = (cVirtualHitPos[1] - pos[1])*1000;
                                                 //double resZ = (cVirtualHitPos[2] - pos[2])*1000;
 
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["VirtualResidualX"] ) -> fill (resX);
+                                                _virtualResidualXHisto -> fill (resX);
                                         }
 
                                         // first sensor
@@ -308,7 +300,7 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                                                 //double resY = (fit_hit_pos_dut0[1] - pos[1])*1000;
                                                 //double resZ = (fit_hit_pos_dut0[2] - pos[2])*1000;
 
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ResidualX_DUT0"] ) -> fill (resX);
+                                                _residualXHisto[0] -> fill (resX);
                                         }
 
                                         // second sensor
@@ -318,14 +310,10 @@ void CBCHitRecovery::processEvent ( LCEvent * anEvent )
                                                 //double resY = (fit_hit_pos_dut1[1] - pos[1])*1000;
                                                 //double resZ = (fit_hit_pos_dut1[2] - pos[2])*1000;
 
-                                                dynamic_cast < AIDA::IHistogram1D* > ( _aidaHistoMap["ResidualX_DUT1"] ) -> fill (resX);
+                                                _residualXHisto[1] -> fill (resX);
                                         }
                                 }
 
-                                // delete the hist positions
-                                delete fit_hit_pos_dut0;
-                                delete fit_hit_pos_dut1;
-
                                 // clear pos vectors
                                 //delete cTelescope2Pos;
                                 //delete cVirtualHitPos;
@@ -371,18 +359,22 @@ void CBCHitRecovery::bookHistos ( )
 
         AIDA::IHistogram1D * cVirtualHitXHist = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePath + "VirtualHitPosX" ).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "VirtualHitPosX", cVirtualHitXHist ) );
+        _virtualHitPosHisto[0] = cVirtualHitXHist;
         cVirtualHitXHist -> setTitle ( "Virtual Hit Position X;X [mm];Entries" );
 
         AIDA::IHistogram1D * cVirtualHitYHist = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePath + "VirtualHitPosY" ).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "VirtualHitPosY", cVirtualHitYHist ) );
+        _virtualHitPosHisto[1] = cVirtualHitYHist;
         cVirtualHitYHist -> setTitle ( "Virtual Hit Position Y;Y [mm];Entries" );
 
         AIDA::IHistogram1D * cVirtualHitZHist = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePath + "VirtualHitPosZ" ).c_str ( ), 100, 365, 375 );
         _aidaHistoMap.insert ( make_pair ( "VirtualHitPosZ", cVirtualHitZHist ) );
+        _virtualHitPosHisto[2] = cVirtualHitZHist;
         cVirtualHitZHist -> setTitle ( "Virtual Hit Position Z;Z [mm];Entries" );
 
         AIDA::IHistogram1D * cCosPhiHist = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePath + "cosPhi" ).c_str ( ), 500, -1.000001, -0.99999 );
         _aidaHistoMap.insert ( make_pair ( "cosPhi", cCosPhiHist ) );
+        _cosPhiHisto = cCosPhiHist;
         cCosPhiHist -> setTitle ( "cos between inbound and outbound track vectors;cos(phi);Entries" );
 
         string basePathOut = "Output";
@@ -391,87 +383,47 @@ void CBCHitRecovery::bookHistos ( )
 
         AIDA::IHistogram1D * cDUT0FitHitPosX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosX_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosX_DUT0", cDUT0FitHitPosX ) );
+        _fitHitPosHisto[0][0] = cDUT0FitHitPosX;
         cDUT0FitHitPosX -> setTitle ( "Fit Hit Pos X - DUT " + to_string(_cbcRealDUTsVec.at(0)) + ";X [mm];Entries" );
 
         AIDA::IHistogram1D * cDUT0FitHitPosY = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosY_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosY_DUT0", cDUT0FitHitPosY ) );
+        _fitHitPosHisto[0][1] = cDUT0FitHitPosY;
         cDUT0FitHitPosY -> setTitle ( "Fit Hit Pos Y - DUT " + to_string(_cbcRealDUTsVec.at(0)) + ";Y [mm];Entries" );
 
         AIDA::IHistogram1D * cDUT0FitHitPosZ = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosZ_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 100, 365, 375 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosZ_DUT0", cDUT0FitHitPosZ ) );
+        _fitHitPosHisto[0][2] = cDUT0FitHitPosZ;
         cDUT0FitHitPosX -> setTitle ( "Fit Hit Pos Z - DUT " + to_string(_cbcRealDUTsVec.at(0)) + ";Z [mm];Entries" );
 
         AIDA::IHistogram1D * cDUT1FitHitPosX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosX_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosX_DUT1", cDUT1FitHitPosX ) );
+        _fitHitPosHisto[1][0] = cDUT1FitHitPosX;
         cDUT1FitHitPosX -> setTitle ( "Fit Hit Pos X - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";X [mm];Entries" );
 
         AIDA::IHistogram1D * cDUT1FitHitPosY = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosY_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 100, -100, 100 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosY_DUT1", cDUT1FitHitPosY ) );
+        _fitHitPosHisto[1][1] = cDUT1FitHitPosY;
         cDUT1FitHitPosY -> setTitle ( "Fit Hit Pos Y - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";Y [mm];Entries" );
 
         AIDA::IHistogram1D * cDUT1FitHitPosZ = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "FitHitPosZ_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 100, 365, 375 );
         _aidaHistoMap.insert ( make_pair ( "FitHitPosZ_DUT1", cDUT1FitHitPosZ ) );
+        _fitHitPosHisto[1][2] = cDUT1FitHitPosZ;
         cDUT1FitHitPosX -> setTitle ( "Fit Hit Pos Z - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";Z [mm];Entries" );
 
         AIDA::IHistogram1D * cVirtualResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "VirtualResidualX" ).c_str ( ), 100, -500, 500 );
         _aidaHistoMap.insert ( make_pair ( "VirtualResidualX", cVirtualResidualX ) );
+        _virtualResidualXHisto = cVirtualResidualX;
         cVirtualResidualX -> setTitle ( "Residual X - Virtual DUT;X [um];Entries" );
 
         AIDA::IHistogram1D * cDUT0ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(0))).c_str ( ), 600, -1500, 1500 );
         _aidaHistoMap.insert ( make_pair ( "ResidualX_DUT0", cDUT0ResidualX ) );
+        _residualXHisto[0] = cDUT0ResidualX;
         cDUT0ResidualX -> setTitle ( "Residual X - DUT " + to_string(_cbcRealDUTsVec.at(0)) + ";X [um];Entries" );
 
         AIDA::IHistogram1D * cDUT1ResidualX = AIDAProcessor::histogramFactory ( this ) -> createHistogram1D ( ( basePathOut + "ResidualX_DUT" + to_string(_cbcRealDUTsVec.at(1))).c_str ( ), 600, -1500, 1500 );
         _aidaHistoMap.insert ( make_pair ( "ResidualX_DUT1", cDUT1ResidualX ) );
+        _residualXHisto[1] = cDUT1ResidualX;
         cDUT1ResidualX -> setTitle ( "Residual X - DUT " + to_string(_cbcRealDUTsVec.at(1)) + ";X [um];Entries" );
 
 }
-
-// get the module of vector
-double CBCHitRecovery::vector_get_length(const double *vec) {
-        double length = 0;
-        for(int i = 0; i < 3; i++) length += vec[i]*vec[i];
-        return sqrt(length);
-}
-
-// set certain length of the vector
-void CBCHitRecovery::vector_set_length(double *& vec, double length) {
-        // we also need to normalize it
-        double current_length = vector_get_length(vec);
-        // now set the new length
-        for(int i = 0; i < 3; i++) vec[i] = vec[i]*length/current_length;
-}
-
-// angle between two vector
-double CBCHitRecovery::cos_alpha(const double *vec1, const double *vec2) {
-        // variable 
-        double angle = 0;
-        // calculate the scalar
-        for(int i = 0; i < 3; i++) angle += vec1[i]*vec2[i];
-        // now divide by modules
-        angle = angle/(vector_get_length(vec1)*vector_get_length(vec2));
-        // return
-        return angle;   
-}
-
-// finds the position of fithit in real plane
-double* CBCHitRecovery::hit_pos(const double track[],const double normal[],const double virtual_hit[], double distance) {
-        // init vector
-        double *pos = new double[3];
-        // module of distance
-        double abs_distance = distance;
-        if(abs_distance < 0) abs_distance = -abs_distance;
-        // create copies of the vectors to modify them
-        double *track1 = new double[3];
-        for(int i = 0; i < 3; i++) {
-                track1[i] = track[i];
-        }
-        // set the length of the track vector to distance/cos(alpha), alpha - angle between normal and track
-        vector_set_length(track1, abs_distance/cos_alpha(track, normal));
-        // add two to get the position
-        for(int i = 0; i < 3; i++) pos[i] = track1[i] + virtual_hit[i];
-        // clear
-        delete track1;
-        // return
-        return pos;
-}
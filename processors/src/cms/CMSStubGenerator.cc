@@ -19,6 +19,7 @@
 #include "EUTelGenericSparseClusterImpl.h"
 #include "EUTelSimpleVirtualCluster.h"
 #include "EUTelVirtualCluster.h"
+#include "EUTelStubMatcher.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -91,6 +92,8 @@ CMSStubGenerator::CMSStubGenerator ( ) : Processor ( "CMSStubGenerator" )
 
     registerProcessorParameter ( "RequireStub", "Do we require an event to have the stub flag set to create an offline stub? 1 for on, 0 for off.", _requirestubflag, 1 );
 
+    registerOptionalParameter ( "FillPairHistograms", "Fill the correlation and failed distance histograms for every pair of DUT hits? This compares all pairs and is slow for busy events.", _fillPairHistos, true );
+
 }
 
 
@@ -215,112 +218,120 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 
     if ( _runMode == 0)
     {
+	// decode the cluster of every DUT hit once
+	vector < EUTelStubMatcher::Hit > plane1Clusters;
+	vector < EUTelStubMatcher::Hit > plane2Clusters;
+	for ( unsigned int iHitPlane1 = 0; iHitPlane1 < dutPlane1Hits.size ( ); iHitPlane1++ )
+	{
+	    plane1Clusters.push_back ( decodeCluster ( dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane1Hits[iHitPlane1] ) ) ) );
+	}
+	for ( unsigned int iHitPlane2 = 0; iHitPlane2 < dutPlane2Hits.size ( ); iHitPlane2++ )
+	{
+	    plane2Clusters.push_back ( decodeCluster ( dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane2Hits[iHitPlane2] ) ) ) );
+	}
+
+	// the plane 2 hits get sorted, so only the ones within the residual are compared
+	EUTelStubMatcher stubMatcher;
+	stubMatcher.setSecondPlane ( plane2Clusters );
+	vector < size_t > matches;
+
 	for ( unsigned int iHitPlane1 = 0; iHitPlane1 < dutPlane1Hits.size ( ); iHitPlane1++ )
 	{
 	    TrackerHitImpl * Hit1 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane1Hits[iHitPlane1] ) );
-	    float x1 = -1.0;
-	    float y1 = -1.0;
-	    float q1 = -1.0;
 	    const double* pos1 = Hit1 -> getPosition ( );
 	    TrackerDataImpl* clusterVector1 = static_cast < TrackerDataImpl* > ( Hit1 -> getRawHits ( ) [0] );
-	    EUTelSimpleVirtualCluster * cluster1 = nullptr;
-	    cluster1 = new EUTelSparseClusterImpl < EUTelGenericSparsePixel > ( clusterVector1 );
-	    if ( cluster1 != nullptr )
+	    float x1 = plane1Clusters[iHitPlane1].x;
+	    float y1 = plane1Clusters[iHitPlane1].y;
+
+	    if ( _fillPairHistos )
 	    {
-		cluster1 -> getCenterOfGravity ( x1, y1 );
-		q1 = cluster1 -> getTotalCharge ( );
+		for ( unsigned int iHitPlane2 = 0; iHitPlane2 < dutPlane2Hits.size ( ); iHitPlane2++ )
+		{
+		    float x2 = plane2Clusters[iHitPlane2].x;
+		    float y2 = plane2Clusters[iHitPlane2].y;
+		    streamlog_out ( DEBUG0 ) << " x1 " << x1 << " y1 " << y1 << " q1 " << plane1Clusters[iHitPlane1].q << " x2 " << x2 << " y2 " << y2 << " q2 " << plane2Clusters[iHitPlane2].q << " evt " << evt -> getRunNumber ( ) << endl;
+
+		    correx -> fill ( x1, x2 );
+		    correy -> fill ( y1, y2 );
+
+		    if ( !EUTelStubMatcher::isStub ( plane1Clusters[iHitPlane1], plane2Clusters[iHitPlane2], _maxResidual ) )
+		    {
+			faildistx -> fill ( x1 - x2 );
+			faildisty -> fill ( y1 - y2 );
+		    }
+		}
 	    }
 
-	    for ( unsigned int iHitPlane2 = 0; iHitPlane2 < dutPlane2Hits.size ( ); iHitPlane2++ )
+	    stubMatcher.findMatches ( plane1Clusters[iHitPlane1], _maxResidual, matches );
+	    for ( size_t iMatch = 0; iMatch < matches.size ( ); iMatch++ )
 	    {
+		unsigned int iHitPlane2 = matches[iMatch];
 		TrackerHitImpl * Hit2 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlane2Hits[iHitPlane2] ) );
-		float x2 = -1.0;
-		float y2 = -1.0;
-		float q2 = -1.0;
 		const double* pos2 = Hit2 -> getPosition ( );
 		TrackerDataImpl* clusterVector2 = static_cast < TrackerDataImpl* > ( Hit2 -> getRawHits ( ) [0] );
-		EUTelSimpleVirtualCluster * cluster2 = nullptr;
-		cluster2 = new EUTelSparseClusterImpl < EUTelGenericSparsePixel > ( clusterVector2 );
-		if ( cluster2 != nullptr )
-		{
-		    cluster2 -> getCenterOfGravity ( x2, y2 );
-		    q2 = cluster2 -> getTotalCharge ( );
-		}
-		streamlog_out ( DEBUG0 ) << " x1 " << x1 << " y1 " << y1 << " q1 " << q1 << " x2 " << x2 << " y2 " << y2 << " q2 " << q2 << " evt " << evt -> getRunNumber ( ) << endl;
-
-		correx -> fill ( x1, x2 );
-		correy -> fill ( y1, y2 );
+		float x2 = plane2Clusters[iHitPlane2].x;
+		float y2 = plane2Clusters[iHitPlane2].y;
 
-		float dx = -1.0;
-		float dy = -1.0;
-		dx = fabs ( x1 - x2 );
-		dy = fabs ( y1 - y2 );
+		double newPos[3];
+		newPos[0] = ( pos1[0] + pos2[0] ) / 2.0;
+		newPos[1] = ( pos1[1] + pos2[1] ) / 2.0;
+		newPos[2] = ( pos1[2] + pos2[2] ) / 2.0;
 
-		if ( dx < _maxResidual && dy < _maxResidual )
-		{
-		    double newPos[3];
-		    newPos[0] = ( pos1[0] + pos2[0] ) / 2.0;
-		    newPos[1] = ( pos1[1] + pos2[1] ) / 2.0;
-		    newPos[2] = ( pos1[2] + pos2[2] ) / 2.0;
-
-		    const double* hitpos = newPos;
-		    CellIDEncoder < TrackerHitImpl > idHitEncoder ( EUTELESCOPE::HITENCODING, outputHitCollection );
-		    TrackerHitImpl* hit = new TrackerHitImpl;
-		    hit -> setPosition ( &hitpos[0] );
-		    float cov[TRKHITNCOVMATRIX] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
-		    hit -> setCovMatrix ( cov );
-		    hit -> setType ( kEUTelGenericSparseClusterImpl );
-		    // assume all times are equal
-		    hit -> setTime ( Hit1 -> getTime ( ) );
+		const double* hitpos = newPos;
+		CellIDEncoder < TrackerHitImpl > idHitEncoder ( EUTELESCOPE::HITENCODING, outputHitCollection );
+		TrackerHitImpl* hit = new TrackerHitImpl;
+		hit -> setPosition ( &hitpos[0] );
+		float cov[TRKHITNCOVMATRIX] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+		hit -> setCovMatrix ( cov );
+		hit -> setType ( kEUTelGenericSparseClusterImpl );
+		// assume all times are equal
+		hit -> setTime ( Hit1 -> getTime ( ) );
 
-		    LCObjectVec clusterVec;
-		    clusterVec.push_back ( clusterVector1 );
-		    clusterVec.push_back ( clusterVector2 );
+		LCObjectVec clusterVec;
+		clusterVec.push_back ( clusterVector1 );
+		clusterVec.push_back ( clusterVector2 );
 
-		    hit -> rawHits ( ) = clusterVec;
+		hit -> rawHits ( ) = clusterVec;
 
-		    idHitEncoder["sensorID"] =  _outputSensorID ;
-		    idHitEncoder["properties"] = 0;
+		idHitEncoder["sensorID"] =  _outputSensorID ;
+		idHitEncoder["properties"] = 0;
 
-		    idHitEncoder.setCellID ( hit );
+		idHitEncoder.setCellID ( hit );
 
-		    stubdistx -> fill ( x1 - x2 );
-		    stubdisty -> fill ( y1 - y2 );
+		stubdistx -> fill ( x1 - x2 );
+		stubdisty -> fill ( y1 - y2 );
 
-		    bool bitpresent = false;
-		    bool writeoutput = true;
+		bool bitpresent = false;
+		bool writeoutput = true;
 
-		    if ( stub1 == "1" || stub2 == "1" || stub3 == "1" )
-		    {
-			stubdistx_bit -> fill ( x1 - x2 );
-			stubdisty_bit -> fill ( y1 - y2 );
+		if ( stub1 == "1" || stub2 == "1" || stub3 == "1" )
+		{
+		    stubdistx_bit -> fill ( x1 - x2 );
+		    stubdisty_bit -> fill ( y1 - y2 );
 
-			bitpresent = true;
+		    bitpresent = true;
 
 
-		    }
-
-		    if ( _requirestubflag == 1 && bitpresent == false )
-		    {
-			writeoutput = false;
-		    }
+		}
 
-		    if ( writeoutput == true )
-		    {
-			outputHitCollection -> push_back ( hit );
-			_totalstubs++;
-			stubsinthisevent++;
-			stubmap_top_x -> fill ( x1 );
-			stubmap_bot_x -> fill ( x2 );
-			stubmap_top_y -> fill ( y1 );
-			stubmap_bot_y -> fill ( y2 );
-		    }
+		if ( _requirestubflag == 1 && bitpresent == false )
+		{
+		    writeoutput = false;
+		}
 
+		if ( writeoutput == true )
+		{
+		    outputHitCollection -> push_back ( hit );
+		    _totalstubs++;
+		    stubsinthisevent++;
+		    stubmap_top_x -> fill ( x1 );
+		    stubmap_bot_x -> fill ( x2 );
+		    stubmap_top_y -> fill ( y1 );
+		    stubmap_bot_y -> fill ( y2 );
 		}
 		else
 		{
-		    faildistx -> fill ( x1 - x2 );
-		    faildisty -> fill ( y1 - y2 );
+		    delete hit;
 		}
 	    }
 	}
@@ -344,6 +355,17 @@ void CMSStubGenerator::processEvent ( LCEvent * event )
 }
 
 
+EUTelStubMatcher::Hit CMSStubGenerator::decodeCluster ( TrackerHitImpl * inputHit )
+{
+    EUTelStubMatcher::Hit cluster = { -1.0, -1.0, -1.0 };
+    TrackerDataImpl* clusterVector = static_cast < TrackerDataImpl* > ( inputHit -> getRawHits ( ) [0] );
+    EUTelSparseClusterImpl < EUTelGenericSparsePixel > sparseCluster ( clusterVector );
+    sparseCluster.getCenterOfGravity ( cluster.x, cluster.y );
+    cluster.q = sparseCluster.getTotalCharge ( );
+    return cluster;
+}
+
+
 TrackerHitImpl* CMSStubGenerator::cloneHit ( TrackerHitImpl *inputHit )
 {
     TrackerHitImpl * newHit = new TrackerHitImpl;
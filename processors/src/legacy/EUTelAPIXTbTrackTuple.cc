@@ -16,6 +16,7 @@
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelGenericPixGeoDescr.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelRootOutputSettings.h"
 
 // lcio includes <.h>
 #include <EVENT/LCCollection.h>
@@ -26,7 +27,8 @@
 #include <UTIL/CellIDDecoder.h>
 
 // system includes <>
-#include <algorithm>
+#include <memory>
+#include <vector>
 
 using namespace eutelescope;
 
@@ -40,7 +42,8 @@ EUTelAPIXTbTrackTuple::EUTelAPIXTbTrackTuple()
       _zstree(nullptr), _nPixHits(0), p_col(nullptr), p_row(nullptr), p_tot(nullptr),
       p_iden(nullptr), p_lv1(nullptr), p_hitTime(nullptr), p_frameTime(nullptr),
       _euhits(nullptr), _nHits(0), _hitXPos(nullptr), _hitYPos(nullptr), _hitZPos(nullptr),
-      _hitSensorId(nullptr) {
+      _hitSensorId(nullptr), _isDUT(), _basketSize(0), _autoFlush(0),
+      _compressionAlgorithm(-1), _compressionLevel(-1) {
       
   // processor description
   _description = "EUTelAPIXTbTrackTuple prepares tbtrack style n-tuple with track fit results.";
@@ -71,6 +74,27 @@ EUTelAPIXTbTrackTuple::EUTelAPIXTbTrackTuple()
                              "IDs of the DUTs",
                              _DUTIDs,
 			     std::vector<int>());
+
+  registerOptionalParameter("BasketSize",
+                            "Basket size in bytes of all branches, 0 keeps "
+                            "the ROOT default",
+                            _basketSize, 0);
+
+  registerOptionalParameter("AutoFlush",
+                            "Auto flush of the trees, entries if positive, "
+                            "bytes if negative, 0 keeps the ROOT default",
+                            _autoFlush, 0);
+
+  registerOptionalParameter("CompressionAlgorithm",
+                            "Compression algorithm of the output file "
+                            "(1 zlib, 2 lzma, 4 lz4, 5 zstd), -1 keeps the "
+                            "ROOT default",
+                            _compressionAlgorithm, -1);
+
+  registerOptionalParameter("CompressionLevel",
+                            "Compression level 0-9 of the output file, -1 "
+                            "keeps the ROOT default",
+                            _compressionLevel, -1);
 }
 
 void EUTelAPIXTbTrackTuple::init() {
@@ -82,6 +106,16 @@ void EUTelAPIXTbTrackTuple::init() {
   _nRun = 0;
   _nEvt = 0;
 
+  // the DUTs as a bitset indexed by the sensor ID
+  _isDUT.clear();
+  for (auto dutID : _DUTIDs) {
+    if (dutID < 0)
+      continue;
+    if (static_cast<size_t>(dutID) >= _isDUT.size())
+      _isDUT.resize(dutID + 1, false);
+    _isDUT[dutID] = true;
+  }
+
   prepareTree();
 
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
@@ -172,17 +206,24 @@ bool EUTelAPIXTbTrackTuple::readHits(std::string hitColName, LCEvent *event) {
   int nHit = hitCollection->getNumberOfElements();
   _nHits = nHit;
 
+  // the branch vectors keep their capacity when cleared, so they only
+  // grow up to the largest event
+  _hitXPos->reserve(nHit);
+  _hitYPos->reserve(nHit);
+  _hitZPos->reserve(nHit);
+  _hitSensorId->reserve(nHit);
+
+  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
+
   for (int ihit = 0; ihit < nHit; ihit++) {
     TrackerHitImpl *meshit =
         dynamic_cast<TrackerHitImpl *>(hitCollection->getElementAt(ihit));
     const double *pos = meshit->getPosition();
-    LCObjectVec clusterVec = (meshit->getRawHits());
 
-    UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
     int sensorID = hitDecoder(meshit)["sensorID"];
 
     // Only dump DUT hits
-    if (std::find(_DUTIDs.begin(), _DUTIDs.end(), sensorID) == _DUTIDs.end()) {
+    if (!isDUT(sensorID)) {
       continue;
     }
 
@@ -217,12 +258,26 @@ bool EUTelAPIXTbTrackTuple::readTracks(LCEvent *event) {
   // setup cellIdDecoder to decode the hit properties
   UTIL::CellIDDecoder<TrackerHitImpl> hitCellDecoder(EUTELESCOPE::HITENCODING);
 
+  // at most all hits of all tracks are dumped
+  size_t nTrackHits = 0;
+  for (int itrack = 0; itrack < trackCol->getNumberOfElements(); itrack++) {
+    nTrackHits += dynamic_cast<lcio::Track *>(trackCol->getElementAt(itrack))
+                      ->getTrackerHits()
+                      .size();
+  }
+  for (auto branch : {_xPos, _yPos, _dxdz, _dydz, _chi2, _ndof}) {
+    branch->reserve(nTrackHits);
+  }
+  _trackIden->reserve(nTrackHits);
+  _trackNum->reserve(nTrackHits);
+
   int nTrackParams = 0;
   for (int itrack = 0; itrack < trackCol->getNumberOfElements(); itrack++) {
     lcio::Track *fittrack =
         dynamic_cast<lcio::Track *>(trackCol->getElementAt(itrack));
 
-    std::vector<EVENT::TrackerHit *> trackhits = fittrack->getTrackerHits();
+    const std::vector<EVENT::TrackerHit *> &trackhits =
+        fittrack->getTrackerHits();
     double chi2 = fittrack->getChi2();
     double ndof = fittrack->getNdf();
     double dxdz = fittrack->getOmega();
@@ -234,16 +289,15 @@ bool EUTelAPIXTbTrackTuple::readTracks(LCEvent *event) {
       TrackerHitImpl *fittedHit =
           dynamic_cast<TrackerHitImpl *>(trackhits.at(ihit));
       const double *pos = fittedHit->getPosition();
-      if ((hitCellDecoder(fittedHit)["properties"] & kFittedHit) == 0) {
+      lcio::BitField64 const &cellID = hitCellDecoder(fittedHit);
+      if ((cellID["properties"] & kFittedHit) == 0) {
         continue;
       }
 
-      UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
-      int sensorID = hitDecoder(fittedHit)["sensorID"];
+      int sensorID = cellID["sensorID"];
 
       // Dump the (fitted) hits for the DUTs
-      if (std::find(_DUTIDs.begin(), _DUTIDs.end(), sensorID) ==
-          _DUTIDs.end()) {
+      if (!isDUT(sensorID)) {
         continue;
       }
 
@@ -297,6 +351,9 @@ bool EUTelAPIXTbTrackTuple::readZsHits(std::string colName, LCEvent *event) {
     if (type == kEUTelGenericSparsePixel) {
       auto sparseData = std::make_unique<
           EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
+      for (auto branch : {p_iden, p_row, p_col, p_tot, p_lv1}) {
+        branch->reserve(branch->size() + sparseData->size());
+      }
 
       for (auto &apixPixel : *sparseData) {
         _nPixHits++;
@@ -311,6 +368,10 @@ bool EUTelAPIXTbTrackTuple::readZsHits(std::string colName, LCEvent *event) {
       auto sparseData =
           std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelMuPixel>>(
               zsData);
+      for (auto branch : {p_iden, p_row, p_col, p_hitTime}) {
+        branch->reserve(branch->size() + sparseData->size());
+      }
+      p_frameTime->reserve(p_frameTime->size() + sparseData->size());
       for (auto &binaryPixel : *sparseData) {
         _nPixHits++;
         p_iden->push_back(sensorID);
@@ -355,6 +416,14 @@ void EUTelAPIXTbTrackTuple::clear() {
 void EUTelAPIXTbTrackTuple::prepareTree() {
   _file = new TFile(_path2file.c_str(), "RECREATE");
 
+  // the compression is taken by the branches when they are created
+  EUTelRootOutputSettings outputSettings;
+  outputSettings.setBasketSize(_basketSize);
+  outputSettings.setAutoFlush(_autoFlush);
+  outputSettings.setCompressionAlgorithm(_compressionAlgorithm);
+  outputSettings.setCompressionLevel(_compressionLevel);
+  outputSettings.apply(_file);
+
   _xPos = new std::vector<double>();
   _yPos = new std::vector<double>();
   _dxdz = new std::vector<double>();
@@ -416,6 +485,10 @@ void EUTelAPIXTbTrackTuple::prepareTree() {
   _eutracks->Branch("chi2", &_chi2);
   _eutracks->Branch("ndof", &_ndof);
 
+  outputSettings.apply(_euhits);
+  outputSettings.apply(_zstree);
+  outputSettings.apply(_eutracks);
+
   _euhits->AddFriend(_zstree);
   _euhits->AddFriend(_eutracks);
 }
@@ -52,14 +52,16 @@
 #include <IMPL/TrackerHitImpl.h>
 
 // ROOT includes
-#include <TMinuit.h>
-#include <TSystem.h>
+#include <Math/Factory.h>
+#include <Math/Functor.h>
+#include <Math/Minimizer.h>
 
 // system includes <>
 #include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace std;
@@ -67,6 +69,25 @@ using namespace marlin;
 using namespace gear;
 using namespace eutelescope;
 
+namespace {
+  //! MINOS errors of the free parameters
+  /*! As the MINOS command the old TMinuit fit ran after every MIGRAD,
+   *  it can also move the minimum. Fixed parameters get zero errors.
+   */
+  std::vector<std::pair<double, double>> runMinos(ROOT::Math::Minimizer &minimizer) {
+    std::vector<std::pair<double, double>> errors(minimizer.NDim(), std::make_pair(0.0, 0.0));
+    for (unsigned int i = 0; i < minimizer.NDim(); ++i) {
+      if (minimizer.IsFixedVariable(i))
+        continue;
+      if (!minimizer.GetMinosError(i, errors[i].first, errors[i].second)) {
+        streamlog_out(WARNING2) << "MINOS failed for "
+                                << minimizer.VariableName(i) << endl;
+      }
+    }
+    return errors;
+  }
+}
+
 // definition of static members mainly used to name histograms
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 std::string EUTelAlign::_distanceLocalname = "Distance";
@@ -76,14 +97,7 @@ std::string EUTelAlign::_residualXLocalname = "ResidualX";
 std::string EUTelAlign::_residualYLocalname = "ResidualY";
 #endif
 
-void fitFunctionWrapper(Int_t &npar, Double_t *gin, Double_t &f, Double_t *par,
-                        Int_t iflag) {
-  EUTelAlign::Chi2Function(npar, gin, f, par, iflag);
-}
-
-vector<EUTelAlign::HitsForFit> EUTelAlign::_hitsForFit;
-
-EUTelAlign::EUTelAlign() : Processor("EUTelAlign") {
+EUTelAlign::EUTelAlign() : Processor("EUTelAlign"), _alignmentChi2() {
 
   // modify processor description
   _description = "EUTelAlign makes alignment of 2 planes using predicted "
@@ -140,6 +154,11 @@ EUTelAlign::EUTelAlign() : Processor("EUTelAlign") {
   registerOptionalParameter("NHitsMax", "Maximal number of Hits per plane.",
                             _nHitsMax, static_cast<int>(100));
 
+  registerOptionalParameter("NumberOfThreads",
+                            "Number of threads used to evaluate the chi2 during "
+                            "the minimisation, 0 uses all available cores.",
+                            _nThreads, static_cast<int>(1));
+
   FloatVec constantsSecondLayer;
   constantsSecondLayer.push_back(0.0);
   constantsSecondLayer.push_back(0.0);
@@ -175,6 +194,9 @@ void EUTelAlign::init() {
   _iRun = 0;
   _iEvt = 0;
 
+  // the hit pairs of this instance, evaluated with the requested threads
+  _alignmentChi2.setNThreads(_nThreads);
+
 // check if Marlin was built with GEAR support or not
 #ifndef USE_GEAR
 
@@ -795,7 +817,10 @@ void EUTelAlign::processEvent(LCEvent *event) {
             hitsForFit.secondLayerResolution =
                 allHitsSecondLayerResolution[take];
 
-            _hitsForFit.push_back(hitsForFit);
+            _alignmentChi2.addHitPair(hitsForFit.secondLayerMeasuredX,
+                                      hitsForFit.secondLayerMeasuredY,
+                                      hitsForFit.secondLayerPredictedX,
+                                      hitsForFit.secondLayerPredictedY);
           }
 
         } // end loop over hits in first plane
@@ -858,7 +883,10 @@ void EUTelAlign::processEvent(LCEvent *event) {
             hitsForFit.secondLayerResolution =
                 allHitsSecondLayerResolution[take];
 
-            _hitsForFit.push_back(hitsForFit);
+            _alignmentChi2.addHitPair(hitsForFit.secondLayerMeasuredX,
+                                      hitsForFit.secondLayerMeasuredY,
+                                      hitsForFit.secondLayerPredictedX,
+                                      hitsForFit.secondLayerPredictedY);
           }
 
         } // end loop over hits in first plane
@@ -867,8 +895,6 @@ void EUTelAlign::processEvent(LCEvent *event) {
 
     } // end if check number of hits
 
-    // _hitsForFit.push_back(hitsForFit);
-
   } catch (DataNotAvailableException &e) {
     streamlog_out(WARNING2) << "No input collection found on event "
                             << event->getEventNumber() << " in run "
@@ -887,100 +913,43 @@ void EUTelAlign::processEvent(LCEvent *event) {
                           << nHitsFirstPlane << endl;
   streamlog_out(MESSAGE2) << "Number of hits in the last plane: "
                           << nHitsSecondPlane << endl;
-  streamlog_out(MESSAGE2) << "Hit pairs found so far: " << _hitsForFit.size()
+  streamlog_out(MESSAGE2) << "Hit pairs found so far: " << _alignmentChi2.size()
                           << endl;
 }
 
-void EUTelAlign::Chi2Function(Int_t &npar, Double_t *gin, Double_t &f,
-                              Double_t *par, Int_t iflag) {
-
-  // Chi2 function for Minuit
-  // ------------------------
-  //
-  // Parameters:
-  // par[0]:       off_x
-  // par[1]:       off_y
-  // par[2]:       theta_x
-  // par[3]:       theta_y
-  // par[4]:       theta_z
-
-  double x, y, distance;
-  double chi2 = 0.0;
-  int usedevents = 0;
-
-  // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
-
-    // just to be sure
-    distance = 0.0;
-
-    x = (cos(par[3]) * cos(par[4])) * _hitsForFit[i].secondLayerMeasuredX +
-        ((-1) * sin(par[2]) * sin(par[3]) * cos(par[4]) +
-         cos(par[2]) * sin(par[4])) *
-            _hitsForFit[i].secondLayerMeasuredY +
-        par[0];
-    y = ((-1) * cos(par[3]) * sin(par[4])) *
-            _hitsForFit[i].secondLayerMeasuredX +
-        (sin(par[2]) * sin(par[3]) * sin(par[4]) + cos(par[2]) * cos(par[4])) *
-            _hitsForFit[i].secondLayerMeasuredY +
-        par[1];
-
-    distance = ((x - _hitsForFit[i].secondLayerPredictedX) *
-                    (x - _hitsForFit[i].secondLayerPredictedX) +
-                (y - _hitsForFit[i].secondLayerPredictedY) *
-                    (y - _hitsForFit[i].secondLayerPredictedY)) /
-               100;
-
-    // add chi2 cut here later?
-    if (par[5] == 0.0) {
-
-      chi2 = chi2 + distance;
-      usedevents++;
-
-    } else if (distance < par[5]) {
-
-      chi2 = chi2 + distance;
-      usedevents++;
-    }
-
-  } // end loop over all events
-
-  // streamlog_out ( MESSAGE2) << usedevents << " ";
-
-  f = chi2;
-}
-
 void EUTelAlign::end() {
 
   streamlog_out(MESSAGE2) << "Number of Events used in the fit: "
-                          << _hitsForFit.size() << endl;
+                          << _alignmentChi2.size() << endl;
 
   streamlog_out(MESSAGE2) << "Minuit will soon be started" << endl;
 
   // run MINUIT
   // ----------
 
-  gSystem->Load("libMinuit");
-
-  // init Minuit for 6 parameters
-  TMinuit *gMinuit = new TMinuit(6);
-
-  // set print level (-1 = quiet, 0 = normal, 1 = verbose)
-  gMinuit->SetPrintLevel(0);
+  // the objective is bound to this instance, so several alignments can
+  // run in the same process; Minuit2 keeps its state in the minimizer
+  // object, unlike TMinuit
+  ROOT::Math::Functor chi2Functor(&_alignmentChi2, &EUTelAlignmentChi2::operator(),
+                                  EUTelAlignmentChi2::nParameters);
 
-  // set function
-  gMinuit->SetFCN(fitFunctionWrapper);
+  std::unique_ptr<ROOT::Math::Minimizer> minimizer(
+      ROOT::Math::Factory::CreateMinimizer("Minuit2", "Migrad"));
 
-  double arglist[10];
-  int ierflag = 0;
+  // set print level (0 = quiet, 1 = normal, 2 = verbose)
+  minimizer->SetPrintLevel(1);
 
   // minimization strategy (1 = standard, 2 = slower)
-  arglist[0] = 1;
-  gMinuit->mnexcm("SET STR", arglist, 2, ierflag);
+  minimizer->SetStrategy(1);
 
   // set error definition (1 = for chi square)
-  arglist[0] = 1;
-  gMinuit->mnexcm("SET ERR", arglist, 1, ierflag);
+  minimizer->SetErrorDef(1);
+
+  // 2000 iterations, 0.1 = tolerance
+  minimizer->SetMaxFunctionCalls(2000);
+  minimizer->SetTolerance(0.1);
+
+  minimizer->SetFunction(chi2Functor);
 
   double start_off_x = _startValuesForAlignment[0];
   double start_off_y = _startValuesForAlignment[1];
@@ -989,18 +958,13 @@ void EUTelAlign::end() {
   double start_theta_z = _startValuesForAlignment[4];
   double start_chi2 = _chi2Cut;
 
-  // set starting values and step sizes
-  gMinuit->mnparm(0, "off_x", start_off_x, 1, 0, 0, ierflag);
-  gMinuit->mnparm(1, "off_y", start_off_y, 1, 0, 0, ierflag);
-  gMinuit->mnparm(2, "theta_x", start_theta_x, 0.001, 0, 0, ierflag);
-  gMinuit->mnparm(3, "theta_y", start_theta_y, 0.001, 0, 0, ierflag);
-  gMinuit->mnparm(4, "theta_z", start_theta_z, 0.001, 0, 0, ierflag);
-  gMinuit->mnparm(5, "chi2", 0.0, 1, 0, 0, ierflag);
-
-  gMinuit->FixParameter(2);
-  gMinuit->FixParameter(3);
-  gMinuit->FixParameter(4);
-  gMinuit->FixParameter(5);
+  // set starting values and step sizes, angles and chi2 cut fixed for now
+  minimizer->SetVariable(0, "off_x", start_off_x, 1);
+  minimizer->SetVariable(1, "off_y", start_off_y, 1);
+  minimizer->SetFixedVariable(2, "theta_x", start_theta_x);
+  minimizer->SetFixedVariable(3, "theta_y", start_theta_y);
+  minimizer->SetFixedVariable(4, "theta_z", start_theta_z);
+  minimizer->SetFixedVariable(5, "chi2", 0.0);
 
   streamlog_out(MESSAGE2) << endl
                           << "First iteration of alignment: only offsets"
@@ -1009,37 +973,29 @@ void EUTelAlign::end() {
                           << endl
                           << endl;
 
-  // call migrad (2000 iterations, 0.1 = tolerance)
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MIGRAD", arglist, 1, ierflag);
-
-  // calculate errors using MINOS
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MINOS", arglist, 1, ierflag);
-
-  double off_x_simple = 0.0;
-  double off_y_simple = 0.0;
-
-  double off_x_simple_error = 0.0;
-  double off_y_simple_error = 0.0;
+  // call migrad and calculate errors using MINOS
+  minimizer->Minimize();
+  minimizer->Hesse();
+  runMinos(*minimizer);
 
   // get results from migrad
-  gMinuit->GetParameter(0, off_x_simple, off_x_simple_error);
-  gMinuit->GetParameter(1, off_y_simple, off_y_simple_error);
+  double off_x_simple = minimizer->X()[0];
+  double off_y_simple = minimizer->X()[1];
 
   // fill histograms
   double residual_x_simple = 1000.0;
   double residual_y_simple = 1000.0;
 
+  std::vector<double> const &measuredX = _alignmentChi2.measuredX();
+  std::vector<double> const &measuredY = _alignmentChi2.measuredY();
+  std::vector<double> const &predictedX = _alignmentChi2.predictedX();
+  std::vector<double> const &predictedY = _alignmentChi2.predictedY();
+
   // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
+  for (size_t i = 0; i < _alignmentChi2.size(); i++) {
 
-    residual_x_simple = off_x_simple + _hitsForFit[i].secondLayerMeasuredX -
-                        _hitsForFit[i].secondLayerPredictedX;
-    residual_y_simple = off_y_simple + _hitsForFit[i].secondLayerMeasuredY -
-                        _hitsForFit[i].secondLayerPredictedY;
+    residual_x_simple = off_x_simple + measuredX[i] - predictedX[i];
+    residual_y_simple = off_y_simple + measuredY[i] - predictedY[i];
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
@@ -1065,14 +1021,10 @@ void EUTelAlign::end() {
 
   } // end loop over all events
 
-  // get results from migrad
-  gMinuit->GetParameter(0, off_x_simple, off_x_simple_error);
-  gMinuit->GetParameter(1, off_y_simple, off_y_simple_error);
-
   // release angles
-  gMinuit->Release(2);
-  gMinuit->Release(3);
-  gMinuit->Release(4);
+  minimizer->ReleaseVariable(2);
+  minimizer->ReleaseVariable(3);
+  minimizer->ReleaseVariable(4);
 
   streamlog_out(MESSAGE2) << endl
                           << "Second iteration of alignment: include angles"
@@ -1081,15 +1033,9 @@ void EUTelAlign::end() {
                           << endl
                           << endl;
 
-  // call migrad (2000 iterations, 0.1 = tolerance)
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MIGRAD", arglist, 1, ierflag);
-
-  // calculate errors using MINOS
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MINOS", arglist, 1, ierflag);
+  minimizer->Minimize();
+  minimizer->Hesse();
+  runMinos(*minimizer);
 
   streamlog_out(MESSAGE2) << endl
                           << "Third iteration of alignment: include chi^2 cut"
@@ -1099,38 +1045,29 @@ void EUTelAlign::end() {
                           << endl;
 
   // release chi2
-  gMinuit->mnparm(5, "chi2", start_chi2, 1, 0, 0, ierflag);
+  minimizer->SetVariableValue(5, start_chi2);
+  minimizer->SetVariableStepSize(5, 1);
+  minimizer->ReleaseVariable(5);
 
-  // call migrad (2000 iterations, 0.1 = tolerance)
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MIGRAD", arglist, 1, ierflag);
-
-  // calculate errors using MINOS
-  arglist[0] = 2000;
-  arglist[1] = 0.1;
-  gMinuit->mnexcm("MINOS", arglist, 1, ierflag);
+  minimizer->Minimize();
+  minimizer->Hesse();
+  std::vector<std::pair<double, double>> const minosErrors =
+      runMinos(*minimizer);
 
   streamlog_out(MESSAGE2) << endl;
 
-  double off_x = 0.0;
-  double off_y = 0.0;
-  double theta_x = 0.0;
-  double theta_y = 0.0;
-  double theta_z = 0.0;
-
-  double off_x_error = 0.0;
-  double off_y_error = 0.0;
-  double theta_x_error = 0.0;
-  double theta_y_error = 0.0;
-  double theta_z_error = 0.0;
-
   // get results from migrad
-  gMinuit->GetParameter(0, off_x, off_x_error);
-  gMinuit->GetParameter(1, off_y, off_y_error);
-  gMinuit->GetParameter(2, theta_x, theta_x_error);
-  gMinuit->GetParameter(3, theta_y, theta_y_error);
-  gMinuit->GetParameter(4, theta_z, theta_z_error);
+  double off_x = minimizer->X()[0];
+  double off_y = minimizer->X()[1];
+  double theta_x = minimizer->X()[2];
+  double theta_y = minimizer->X()[3];
+  double theta_z = minimizer->X()[4];
+
+  double off_x_error = minimizer->Errors()[0];
+  double off_y_error = minimizer->Errors()[1];
+  double theta_x_error = minimizer->Errors()[2];
+  double theta_y_error = minimizer->Errors()[3];
+  double theta_z_error = minimizer->Errors()[4];
 
   streamlog_out(MESSAGE2) << endl
                           << "Alignment constants from the fit:" << endl;
@@ -1148,6 +1085,12 @@ void EUTelAlign::end() {
   streamlog_out(MESSAGE2) << "For copy and paste to line fit xml-file: "
                           << off_x << " " << off_y << " " << theta_x << " "
                           << theta_y << " " << theta_z << endl;
+  streamlog_out(MESSAGE2) << "MINOS errors (lower, upper):" << endl;
+  for (unsigned int i = 0; i < 5; ++i) {
+    streamlog_out(MESSAGE2) << minimizer->VariableName(i) << ": "
+                            << minosErrors[i].first << " "
+                            << minosErrors[i].second << endl;
+  }
 
   // fill histograms
   // ---------------
@@ -1157,22 +1100,21 @@ void EUTelAlign::end() {
   double residual_y = 1000.0;
 
   // loop over all events
-  for (size_t i = 0; i < _hitsForFit.size(); i++) {
+  for (size_t i = 0; i < _alignmentChi2.size(); i++) {
 
-    x = (cos(theta_y) * cos(theta_z)) * _hitsForFit[i].secondLayerMeasuredX +
+    x = (cos(theta_y) * cos(theta_z)) * measuredX[i] +
         ((-1) * sin(theta_x) * sin(theta_y) * cos(theta_z) +
          cos(theta_x) * sin(theta_z)) *
-            _hitsForFit[i].secondLayerMeasuredY +
+            measuredY[i] +
         off_x;
-    y = ((-1) * cos(theta_y) * sin(theta_z)) *
-            _hitsForFit[i].secondLayerMeasuredX +
+    y = ((-1) * cos(theta_y) * sin(theta_z)) * measuredX[i] +
         (sin(theta_x) * sin(theta_y) * sin(theta_z) +
          cos(theta_x) * cos(theta_z)) *
-            _hitsForFit[i].secondLayerMeasuredY +
+            measuredY[i] +
         off_y;
 
-    residual_x = x - _hitsForFit[i].secondLayerPredictedX;
-    residual_y = y - _hitsForFit[i].secondLayerPredictedY;
+    residual_x = x - predictedX[i];
+    residual_y = y - predictedY[i];
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
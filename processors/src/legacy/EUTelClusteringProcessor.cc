@@ -91,7 +91,7 @@ EUTelClusteringProcessor::EUTelClusteringProcessor()
       nzsInputDataCollectionVec(nullptr), pulseCollectionVec(nullptr),
       noiseCollectionVec(nullptr), statusCollectionVec(nullptr),
       hotPixelCollectionVec(nullptr), hasNZSData(false), hasZSData(false),
-      _hitIndexMapVec() {
+      _hitIndexMapVec(), _digitalFrameFinders(), _zsFrameFinders() {
 
   // modify processor description
   _description = "EUTelClusteringProcessor is looking for clusters into a "
@@ -277,6 +277,8 @@ void EUTelClusteringProcessor::init() {
 
   // reset hotpixel map vectors
   _hitIndexMapVec.clear();
+  _digitalFrameFinders.clear();
+  _zsFrameFinders.clear();
 
   // set to zero the run and event counters
   _iRun = 0;
@@ -603,6 +605,8 @@ void EUTelClusteringProcessor::readCollections(LCEvent *event) {
       hotPixelCollectionVec = static_cast<LCCollectionVec *>(
           event->getCollection(_hotPixelCollectionName));
       initializeHotPixelMapVec();
+      _digitalFrameFinders.clear();
+      _zsFrameFinders.clear();
       streamlog_out(DEBUG5)
           << "hotPixelCollectionName: " << _hotPixelCollectionName.c_str()
           << " found " << endl;
@@ -844,38 +848,29 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
 
     getMaxPixels(sensorID, _maxX, _maxY);
 
-    // todo: declare a vector of sensormatrizes as a class member in
-    // order to not allocate a new object for each loop iteration.
-    // sensormatrix.push_back(dim2array<bool>((unsigned int)(_maxX+1 - _minX),
-    // (unsigned int)(_maxY+1 - _minY), false));
-    //    dim2array<bool> sensormatrix((unsigned int)(_maxX+1 - _minX),
-    //    (unsigned int)(_maxY+1 - _minY), false);
-
-    std::map<unsigned int, std::map<unsigned int, bool>> sensormatrix;
-
     // prepare the matrix decoder
     EUTelMatrixDecoder matrixDecoder(noiseDecoder, noise);
 
-    // insert some noise pixel by hand. was only used for debugging.
-    // for(int i = 0; i < 250; i++)
-    //       {
-    //         int   index  = matrixDecoder.getIndexFromXY( i,i );
-    //         status->adcValues()[index] = EUTELESCOPE::HITPIXEL;
-    //       }
-
-    // prepare a data vector mimicking the TrackerData data of the
-    // standard digitalFixedFrameClustering. Initialize all the entries to zero.
-    //    vector<float > dataVec( status->getADCValues().size(), 0. );
-    vector<float> dataVec(noise->getChargeValues().size(), 0.);
-
-    // seed candidates
-    list<seed> seedcandidates;
+    // the fired pixels are collected in a pixel map of the whole
+    // sensor, which is kept from event to event. The hot pixels are
+    // masked in there once.
+    EUTelDigitalFixedFrameFinder &frameFinder = _digitalFrameFinders[sensorID];
+    if (!frameFinder.isConfigured(matrixDecoder.getMinX(),
+                                  matrixDecoder.getMinY(),
+                                  matrixDecoder.getMaxX(),
+                                  matrixDecoder.getMaxY())) {
+      frameFinder.configure(matrixDecoder.getMinX(), matrixDecoder.getMinY(),
+                            matrixDecoder.getMaxX(), matrixDecoder.getMaxY());
+      if (static_cast<int>(_hitIndexMapVec.size()) > sensorID) {
+        for (auto const &hotPixel : _hitIndexMapVec[sensorID]) {
+          frameFinder.setHotPixel(hotPixel.first);
+        }
+      }
+    }
 
     const int xoffset = _minX;
     const int yoffset = _minY;
 
-    //    bool firstfoundhitpixel = true;
-
     if (type == kEUTelGenericSparsePixel) {
       // now prepare the EUTelescope interface to sparsified data.
       auto sparseData = std::make_unique<
@@ -887,346 +882,168 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
                             << " pixels " << endl;
 
       for (auto &sparsePixel : pixelVec) {
-        int index = matrixDecoder.getIndexFromXY(sparsePixel.getXCoord(),
-                                                 sparsePixel.getYCoord());
-
-        if (static_cast<int>(_hitIndexMapVec.size()) > sensorID) {
-          if (_hitIndexMapVec[sensorID].find(index) !=
-              _hitIndexMapVec[sensorID].end()) {
-            streamlog_out(DEBUG1) << " iDetector " << sensorID
-                                  << " unique index " << index
-                                  << " at x = " << sparsePixel.getXCoord()
-                                  << " y= " << sparsePixel.getYCoord() << endl;
-            continue;
-          }
-        }
-        sensormatrix[sparsePixel.getXCoord()][sparsePixel.getYCoord()] = true;
+        frameFinder.addPixel(sparsePixel.getXCoord(), sparsePixel.getYCoord());
       }
     } else {
       throw UnknownDataTypeException("Unknown sparsified pixel");
     }
 
     // ------------------------------------------------------------------------------------------------------------------
-    // now the seed pixel finding !!
+    // now the seed pixel finding and the cluster building !!
     //
-
-    // RIA:
-    // this is neibhours counting only!
+    // the seed candidates are sorted according to the number of
+    // neighbours without diagonal neighbours and then to the total
+    // number of neighbours. each seed not yet used in a cluster
+    // collects the pixels around it, that were not used before in a
+    // different cluster.
     //
     const int stepx = _ffXClusterSize / 2;
     const int stepy = _ffYClusterSize / 2;
 
-    ///    const int stepx = 1; wrong or OK ?? could skipp this counting for
-    ///    reeeally sparse data
-    ///    i.e. when one knows that there are mostly 1-2 pixels per clusters
-    ///    expected.
-    ///    const int stepy = 1;
-
-    std::map<unsigned int, std::map<unsigned int, bool>>::iterator pos;
-    for (pos = sensormatrix.begin(); pos != sensormatrix.end(); ++pos) {
-      std::map<unsigned int, bool>::iterator sec;
-      for (sec = sensormatrix[(*pos).first].begin();
-           sec != sensormatrix[(*pos).first].end(); ++sec) {
-        //              if(sensormatrix.at(i,j))
-        if (sensormatrix[pos->first][sec->first]) {
-          const unsigned int i = pos->first;
-          const unsigned int j = sec->first;
-
-          // number of neighbours
-          int nb = 0;
-
-          // total number of pixels in a cluster around the seed candidate
-          // (also diagonal elements are counted)
-          int npixel_cl = 0;
-
-          // first npixel_cl will be determined
-          for (unsigned int index_x = i - stepx; index_x <= (i + stepx);
-               index_x++) {
-            for (unsigned int index_y = j - stepy; index_y <= (j + stepy);
-                 index_y++) {
-
-              if (index_x > 0 && index_y > 0) {
-                std::map<unsigned int,
-                         std::map<unsigned int, bool>>::const_iterator z =
-                    sensormatrix.find(index_x);
-                if (z != sensormatrix.end() &&
-                    z->second.find(index_y) != z->second.end()) {
-                  if (sensormatrix[index_x][index_y]) {
-                    npixel_cl++;
-                  }
-                }
-              }
-            }
-          }
+    frameFinder.findClusters(_ffXClusterSize, _ffYClusterSize);
 
-          if (npixel_cl > 1) {
-            if (i >= 1)
-              for (int index_x = static_cast<int>(i - 1);
-                   index_x <= static_cast<int>(i + 1); index_x++) {
-                if (index_x >= 0) {
-                  std::map<unsigned int,
-                           std::map<unsigned int, bool>>::const_iterator z =
-                      sensormatrix.find(index_x);
-                  if (z != sensormatrix.end() &&
-                      z->second.find(j) != z->second.end()) {
-                    if (sensormatrix[index_x][j])
-                      nb++;
-                  }
-                }
-              }
+    for (auto const &foundCluster : frameFinder.getClusters()) {
+      const EUTelDigitalFixedFrameFinder::Pixel *pix =
+          &frameFinder.getPixels()[foundCluster.firstPixel];
 
-            if (j >= 1)
-              for (int index_y = static_cast<int>(j - 1);
-                   index_y <= static_cast<int>(j + 1); index_y++) {
-                if (index_y >= 0) {
-                  std::map<unsigned int,
-                           std::map<unsigned int, bool>>::const_iterator z =
-                      sensormatrix.find(i);
-                  if (z != sensormatrix.end() &&
-                      z->second.find(index_y) != z->second.end()) {
-                    if (sensormatrix[i][index_y])
-                      nb++;
-                  }
-                }
-              }
-          } // could all this passage be skipped ?
+      // we found a cluster ...
 
-          // fill this pixel into the list of found seed pixel candidates
-          seedcandidates.push_back(seed(i, j, nb, npixel_cl));
-        }
-      }
-    }
-    // sort the list of seed pixel candidates. the first criteria is
-    // the number of neighbours without diagonal neighbours. then the
-    // second criteria is the total number of neighbours
-
-    // sorts the seed list according to the "operator<" definition in the seed
-    // class
-    seedcandidates.sort();
-
-    // end of seed pixel finding!
-
-    // if at least one seed pixel candidate was found, then ...
-    if (!seedcandidates.empty()) {
-      list<seed>::iterator i;
-      // loop over all found seed pixel candidates
-      for (i = seedcandidates.begin(); i != seedcandidates.end(); ++i) {
-        // check that this pixel was not used before.
-
-        std::map<unsigned int, std::map<unsigned int, bool>>::const_iterator z =
-            sensormatrix.find(i->x);
-        if (z != sensormatrix.end() &&
-            z->second.find(i->y) != z->second.end()) {
-          if (sensormatrix[i->x][i->y]) {
-            std::vector<pixel> pix;
-            // select pixels around the seed pixel
-
-            if (i->x >= static_cast<unsigned int>(stepx) &&
-                i->y >= static_cast<unsigned int>(stepy)) {
-              for (int index_x = static_cast<int>(i->x - stepx);
-                   index_x <= static_cast<int>(i->x + stepx); index_x++) {
-                for (int index_y = static_cast<int>(i->y - stepy);
-                     index_y <= static_cast<int>(i->y + stepy); index_y++) {
-                  if (index_x >= 0 && index_y >= 0) {
-                    std::map<unsigned int,
-                             std::map<unsigned int, bool>>::const_iterator z =
-                        sensormatrix.find(index_x);
-                    if (z != sensormatrix.end() &&
-                        z->second.find(index_y) != z->second.end()) {
-                      if (sensormatrix[index_x][index_y]) {
-                        pix.push_back(pixel(index_x, index_y));
-                      }
-                    }
-                  }
-                }
-              }
-            }
+      IntVec clusterCandidateIndeces;
+      FloatVec clusterCandidateCharges;
+      ClusterQuality cluQuality = kGoodCluster;
 
-            // pix is a vector with all found "good" pixel, that
-            // were not used before in a different cluster.
-
-            // cut on the number of pixel. dont
-            // apply this cut here, use it in the
-            // filtering processor?
-
-            if (!pix.empty()) {
-              // we found a cluster ...
-
-              IntVec clusterCandidateIndeces;
-              FloatVec clusterCandidateCharges;
-              ClusterQuality cluQuality = kGoodCluster;
-
-              // the pixel coordinates of the seed pixels are
-              // needed later
-              int seedX = -1;
-              int seedY = -1;
-
-              // reset the pixel matrix
-              // a matrix of pixel for this cluster. it is needed
-              // for decoding issues.
-              pixelmatrix.pad(false);
-
-              // loop over all hit pixels inside this cluster
-              for (unsigned int j = 0; j < pix.size(); j++) {
-                // remove pixels, that were assigned to this
-                // cluster from the dummy sensor map. this
-                // pixel will then not be used then in other clusters
-                // sensormatrix.set(pix[j].x,pix[j].y,false);
-
-                std::map<unsigned int,
-                         std::map<unsigned int, bool>>::const_iterator z =
-                    sensormatrix.find(pix[j].x);
-                if (z != sensormatrix.end() &&
-                    z->second.find(pix[j].y) != z->second.end()) {
-                  sensormatrix[pix[j].x][pix[j].y] = false;
-                }
+      // the pixel coordinates of the seed pixels are
+      // needed later
+      int seedX = foundCluster.seedX + xoffset;
+      int seedY = foundCluster.seedY + yoffset;
 
-                // dont forget to apply the offset correction!
-                //                            int index =
-                //                            matrixDecoder.getIndexFromXY(pix[j].x
-                //                            + xoffset, pix[j].y + yoffset);
-
-                if (pix[j].x == i->x && pix[j].y == i->y) {
-                  // this is the seed pixel!
-                  seedX = pix[j].x + xoffset;
-                  seedY = pix[j].y + yoffset;
-                } else {
-                  // this is a neighbour pixel!
-                  // nothing to do?
-                }
+      // reset the pixel matrix
+      // a matrix of pixel for this cluster. it is needed
+      // for decoding issues.
+      pixelmatrix.pad(false);
 
-                clusterCandidateIndeces.push_back(-1);
-                cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
-              }
+      // loop over all hit pixels inside this cluster. they are
+      // already removed from the sensor map and will not be used in
+      // other clusters
+      for (std::size_t j = 0; j < foundCluster.nPixels; j++) {
+        clusterCandidateIndeces.push_back(-1);
+        cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
+      }
 
-              // sanity check
-              if (seedX == -1 || seedY == -1) {
-                streamlog_out(DEBUG5)
-                    << "a cluster was found but no seed pixel coordinates!"
-                    << endl;
-                streamlog_out(DEBUG5) << pix.size() << " " << i->x << " "
-                                      << i->y << endl;
-                exit(-1);
-              }
+      // now lets fill the cluster pixel matrix, which is required
+      // by the decoding of the cluster into a 1d array
+      // (clusterCandidateCharges).
+      for (std::size_t j = 0; j < foundCluster.nPixels; j++) {
+        // set the hits. all other pixels are by
+        // default false. the seed pixel is in the
+        // center of this matrix.
+
+        pixelmatrix.set(pix[j].x + xoffset - seedX +
+                            _ffXClusterSize / 2,
+                        pix[j].y + yoffset - seedY +
+                            _ffYClusterSize / 2,
+                        true);
+      }
 
-              // now lets fill the cluster pixel matrix, which is required
-              // by the decoding of the cluster into a 1d array
-              // (clusterCandidateCharges).
-              for (unsigned int j = 0; j < pix.size(); j++) {
-                // set the hits. all other pixels are by
-                // default false. the seed pixel is in the
-                // center of this matrix.
-
-                pixelmatrix.set(pix[j].x + xoffset - seedX +
-                                    _ffXClusterSize / 2,
-                                pix[j].y + yoffset - seedY +
-                                    _ffYClusterSize / 2,
-                                true);
-              }
+      // loop over the cluster pixels and fill them into
+      // the 1d array. The ordering of the two loops is
+      // copied from the CoG shift method of the class
+      // EUTelDFFClusterImpl
 
-              // loop over the cluster pixels and fill them into
-              // the 1d array. The ordering of the two loops is
-              // copied from the CoG shift method of the class
-              // EUTelDFFClusterImpl
-
-              for (int yPixel = 0; yPixel < _ffYClusterSize; yPixel++) {
-                for (int xPixel = 0; xPixel < _ffXClusterSize; xPixel++) {
-                  if (pixelmatrix.at(xPixel, yPixel)) {
-                    clusterCandidateCharges.push_back(1.0);
-                  } else {
-                    clusterCandidateCharges.push_back(0.0);
-                  }
-                }
-              }
+      for (int yPixel = 0; yPixel < _ffYClusterSize; yPixel++) {
+        for (int xPixel = 0; xPixel < _ffXClusterSize; xPixel++) {
+          if (pixelmatrix.at(xPixel, yPixel)) {
+            clusterCandidateCharges.push_back(1.0);
+          } else {
+            clusterCandidateCharges.push_back(0.0);
+          }
+        }
+      }
 
-              // check whether this cluster is partly outside
-              // the sensor matrix
-              if ((seedX - stepx) < _minX || (seedX + stepx) > _maxX ||
-                  (seedY - stepy) < _minY || (seedY + stepy) > _maxY) {
-                cluQuality = cluQuality | kBorderCluster;
-              }
+      // check whether this cluster is partly outside
+      // the sensor matrix
+      if ((seedX - stepx) < _minX || (seedX + stepx) > _maxX ||
+          (seedY - stepy) < _minY || (seedY + stepy) > _maxY) {
+        cluQuality = cluQuality | kBorderCluster;
+      }
 
-              // the final cluster creation
-
-              // the final result of the clustering will enter in a
-              // TrackerPulseImpl in order to be algorithm independent
-
-              TrackerPulseImpl *pulse = new TrackerPulseImpl;
-              CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
-                  EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
-              idPulseEncoder["sensorID"] = _sensorID;
-              idPulseEncoder["xSeed"] = seedX;
-              idPulseEncoder["ySeed"] = seedY;
-              idPulseEncoder["xCluSize"] = _ffXClusterSize;
-              idPulseEncoder["yCluSize"] = _ffYClusterSize;
-              idPulseEncoder["type"] = static_cast<int>(kEUTelDFFClusterImpl);
-              idPulseEncoder.setCellID(pulse);
-
-              TrackerDataImpl *cluster = new TrackerDataImpl;
-              CellIDEncoder<TrackerDataImpl> idClusterEncoder(
-                  EUTELESCOPE::CLUSTERDEFAULTENCODING,
-                  sparseClusterCollectionVec);
-              idClusterEncoder["sensorID"] = _sensorID;
-              idClusterEncoder["xSeed"] = seedX;
-              idClusterEncoder["ySeed"] = seedY;
-              idClusterEncoder["xCluSize"] = _ffXClusterSize;
-              idClusterEncoder["yCluSize"] = _ffYClusterSize;
-              idClusterEncoder["quality"] = static_cast<int>(cluQuality);
-              idClusterEncoder.setCellID(cluster);
-
-              streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
-                                    << seedX << " seedY " << seedY << endl;
-              /*
-                IntVec::iterator indexIter = clusterCandidateIndeces.begin();
-                while ( indexIter != clusterCandidateIndeces.end() )
-                {
-                if((*indexIter) != -1)
-                {
-                if( _dataFormatType == EUTELESCOPE::BINARY )
-                {
-                status->adcValues()[ _indexMap[(*indexIter)] ] =
-                EUTELESCOPE::HITPIXEL;
-                }else{
-                status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
-                }
-                }
-                ++indexIter;
-                }
-              */
-
-              // copy the candidate charges inside the cluster
-              cluster->setChargeValues(clusterCandidateCharges);
-              sparseClusterCollectionVec->push_back(cluster);
-
-              // continue;
-
-              EUTelDFFClusterImpl *eutelCluster =
-                  new EUTelDFFClusterImpl(cluster);
-              pulse->setCharge(eutelCluster->getTotalCharge());
-
-              delete eutelCluster;
-
-              pulse->setQuality(static_cast<int>(cluQuality));
-              pulse->setTrackerData(cluster);
-              pulseCollection->push_back(pulse);
-
-              // increment the cluster counters
-              _totClusterMap[sensorID] += 1;
-              ++clusterID;
-              if (clusterID >= MAXCLUSTERSIZE) {
-                ++limitExceed;
-                --clusterID;
-                streamlog_out(WARNING2)
-                    << "Event " << evt->getEventNumber() << " in run "
-                    << evt->getRunNumber() << " on detector " << _sensorID
-                    << " contains more than " << MAXCLUSTERSIZE << " cluster ("
-                    << clusterID + limitExceed << ")" << endl;
-              }
-            }
-          }
+      // the final cluster creation
+
+      // the final result of the clustering will enter in a
+      // TrackerPulseImpl in order to be algorithm independent
+
+      TrackerPulseImpl *pulse = new TrackerPulseImpl;
+      CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
+          EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
+      idPulseEncoder["sensorID"] = _sensorID;
+      idPulseEncoder["xSeed"] = seedX;
+      idPulseEncoder["ySeed"] = seedY;
+      idPulseEncoder["xCluSize"] = _ffXClusterSize;
+      idPulseEncoder["yCluSize"] = _ffYClusterSize;
+      idPulseEncoder["type"] = static_cast<int>(kEUTelDFFClusterImpl);
+      idPulseEncoder.setCellID(pulse);
+
+      TrackerDataImpl *cluster = new TrackerDataImpl;
+      CellIDEncoder<TrackerDataImpl> idClusterEncoder(
+          EUTELESCOPE::CLUSTERDEFAULTENCODING,
+          sparseClusterCollectionVec);
+      idClusterEncoder["sensorID"] = _sensorID;
+      idClusterEncoder["xSeed"] = seedX;
+      idClusterEncoder["ySeed"] = seedY;
+      idClusterEncoder["xCluSize"] = _ffXClusterSize;
+      idClusterEncoder["yCluSize"] = _ffYClusterSize;
+      idClusterEncoder["quality"] = static_cast<int>(cluQuality);
+      idClusterEncoder.setCellID(cluster);
+
+      streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
+                            << seedX << " seedY " << seedY << endl;
+      /*
+        IntVec::iterator indexIter = clusterCandidateIndeces.begin();
+        while ( indexIter != clusterCandidateIndeces.end() )
+        {
+        if((*indexIter) != -1)
+        {
+        if( _dataFormatType == EUTELESCOPE::BINARY )
+        {
+        status->adcValues()[ _indexMap[(*indexIter)] ] =
+        EUTELESCOPE::HITPIXEL;
+        }else{
+        status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
+        }
+        }
+        ++indexIter;
         }
-      } // loop over all found seed pixel candidates :: END
-    }   // LOOP over all seedcandidates :: END
+      */
+
+      // copy the candidate charges inside the cluster
+      cluster->setChargeValues(clusterCandidateCharges);
+      sparseClusterCollectionVec->push_back(cluster);
+
+      // continue;
+
+      EUTelDFFClusterImpl *eutelCluster =
+          new EUTelDFFClusterImpl(cluster);
+      pulse->setCharge(eutelCluster->getTotalCharge());
+
+      delete eutelCluster;
+
+      pulse->setQuality(static_cast<int>(cluQuality));
+      pulse->setTrackerData(cluster);
+      pulseCollection->push_back(pulse);
+
+      // increment the cluster counters
+      _totClusterMap[sensorID] += 1;
+      ++clusterID;
+      if (clusterID >= MAXCLUSTERSIZE) {
+        ++limitExceed;
+        --clusterID;
+        streamlog_out(WARNING2)
+            << "Event " << evt->getEventNumber() << " in run "
+            << evt->getRunNumber() << " on detector " << _sensorID
+            << " contains more than " << MAXCLUSTERSIZE << " cluster ("
+            << clusterID + limitExceed << ")" << endl;
+      }
+    } // loop over all found clusters :: END
   } // for ( unsigned int i = 0 ; i < zsInputDataCollectionVec->size(); i++ ) ::
     // END
 
@@ -1313,11 +1130,9 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(
     if (foundexcludedsensor)
       continue;
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int minX, minY, maxX, maxY;
-    minX = 0;
-    minY = 0;
-
+    // which are the maxX and maxY. Frames reaching beyond them or
+    // below 0 give border clusters.
+    int maxX, maxY;
     getMaxPixels(sensorID, maxX, maxY);
 
     // reset the cluster counter for the clusterID
@@ -1335,12 +1150,32 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(
     // prepare the matrix decoder
     EUTelMatrixDecoder matrixDecoder(noiseDecoder, noise);
 
-    // prepare a data vector mimicking the TrackerData data of the
-    // standard FixedFrameClustering. Initialize all the entries to zero.
-    vector<float> dataVec(noise->getChargeValues().size(), 0.);
+    // the signals are collected in a pixel map of the whole sensor
+    // and the seed candidates in a vector, both kept from event to
+    // event. The hot pixels are masked in there once.
+    EUTelZSFixedFrameFinder &frameFinder =
+        _zsFrameFinders
+            .emplace(sensorID,
+                     EUTelZSFixedFrameFinder(EUTELESCOPE::GOODPIXEL,
+                                             EUTELESCOPE::HITPIXEL,
+                                             EUTELESCOPE::MISSINGPIXEL))
+            .first->second;
+    const int nPixelX = matrixDecoder.getMaxX() - matrixDecoder.getMinX() + 1;
+    const int nPixelY = matrixDecoder.getMaxY() - matrixDecoder.getMinY() + 1;
+    if (!frameFinder.isConfigured(matrixDecoder.getMinX(),
+                                  matrixDecoder.getMinY(), nPixelX, nPixelY)) {
+      frameFinder.configure(matrixDecoder.getMinX(), matrixDecoder.getMinY(),
+                            nPixelX, nPixelY);
+      if (_hitIndexMapVec.size() > static_cast<unsigned int>(sensorID)) {
+        for (auto const &hotPixel : _hitIndexMapVec[sensorID]) {
+          frameFinder.setHotPixel(hotPixel.first);
+        }
+      }
+    }
+    frameFinder.setClusterSize(_ffXClusterSize, _ffYClusterSize);
 
-    // prepare a multimap for the seed candidates
-    multimap<float, int> seedCandidateMap;
+    const FloatVec &noiseVec = noise->getChargeValues();
+    ShortVec &statusVec = status->adcValues();
 
     if (type == kEUTelGenericSparsePixel) {
 
@@ -1354,179 +1189,87 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(
                             << endl;
 
       for (auto &sparsePixel : pixelVec) {
-        int index = matrixDecoder.getIndexFromXY(sparsePixel.getXCoord(),
-                                                 sparsePixel.getYCoord());
-        float signal = sparsePixel.getSignal();
-        dataVec[index] = signal;
-        if (static_cast<int>(status->getADCValues().size()) < index) {
-          status->adcValues().resize(index + 1);
-        }
-        if ((signal > _ffSeedCut * noise->getChargeValues()[index]) &&
-            (status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL)) {
-          seedCandidateMap.insert(make_pair(signal, index));
-          streamlog_out(DEBUG1) << "Added pixel " << sparsePixel.getXCoord()
-                                << ", " << sparsePixel.getYCoord()
-                                << " with signal " << signal
-                                << " to the seedCandidateMap" << endl;
-        }
+        frameFinder.addPixel(sparsePixel.getXCoord(), sparsePixel.getYCoord(),
+                             sparsePixel.getSignal(), statusVec, noiseVec,
+                             _ffSeedCut);
       }
     } else {
       throw UnknownDataTypeException("Unknown sparsified pixel");
     }
 
-    if (!seedCandidateMap.empty()) {
-
-      streamlog_out(DEBUG0) << "There are " << seedCandidateMap.size()
-                            << " seed candidates." << endl;
-
-      // now build up a cluster for each seed candidate
-      multimap<float, int>::reverse_iterator rMapIter =
-          seedCandidateMap.rbegin();
-      while (rMapIter != seedCandidateMap.rend()) {
-
-        // Remove hot pixel:
-        if (_hitIndexMapVec.size() > static_cast<unsigned int>(sensorID)) {
-          if (_hitIndexMapVec[sensorID].find((*rMapIter).second) !=
-              _hitIndexMapVec[sensorID].end()) {
-            int seedX, seedY;
-            matrixDecoder.getXYFromIndex((*rMapIter).second, seedX, seedY);
-            streamlog_out(DEBUG5) << "Detector " << sensorID << " Pixel "
-                                  << seedX << " " << seedY
-                                  << " -- HOTPIXEL, skipping... " << endl;
-            ++rMapIter;
-            continue;
-          }
-        }
-        if (status->adcValues()[(*rMapIter).second] == EUTELESCOPE::GOODPIXEL) {
-          // if we enter here, this means that at least the seed pixel
-          // wasn't added yet to another cluster.  Note that now we need
-          // to build a candidate cluster that has to pass the
-          // clusterCut to be considered a good cluster
-          double clusterCandidateSignal = 0.;
-          double clusterCandidateNoise2 = 0.;
-          FloatVec clusterCandidateCharges;
-          IntVec clusterCandidateIndeces;
-          int seedX, seedY;
-          matrixDecoder.getXYFromIndex((*rMapIter).second, seedX, seedY);
-
-          // start looping around the seed pixel. Remember that the seed
-          // pixel has to stay in the center of cluster
-          ClusterQuality cluQuality = kGoodCluster;
-          for (int yPixel = seedY - (_ffYClusterSize / 2);
-               yPixel <= seedY + (_ffYClusterSize / 2); yPixel++) {
-            for (int xPixel = seedX - (_ffXClusterSize / 2);
-                 xPixel <= seedX + (_ffXClusterSize / 2); xPixel++) {
-              // always check we are still within the sensor!!!
-              if ((xPixel >= minX) && (xPixel <= maxX) && (yPixel >= minY) &&
-                  (yPixel <= maxY)) {
-                int index = matrixDecoder.getIndexFromXY(xPixel, yPixel);
-
-                bool isHit =
-                    (status->getADCValues()[index] == EUTELESCOPE::HITPIXEL);
-                bool isGood =
-                    (status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL);
-
-                if (isGood)
-                  clusterCandidateIndeces.push_back(index);
-                else
-                  clusterCandidateIndeces.push_back(-1);
-
-                if (isGood && !isHit) {
-                  // if the pixel wasn't selected, then its signal
-                  // will be 0.0. Mark it in the status
-                  if (dataVec[index] == 0.0)
-                    status->adcValues()[index] = EUTELESCOPE::MISSINGPIXEL;
-                  clusterCandidateSignal += dataVec[index];
-                  clusterCandidateNoise2 +=
-                      pow(noise->getChargeValues()[index], 2);
-                  clusterCandidateCharges.push_back(dataVec[index]);
-                } else if (isHit) {
-                  // this can be a good place to flag the current
-                  // cluster as kMergedCluster, but it would introduce
-                  // a bias since the at least another cluster (the
-                  // one which this pixel belong to) is not flagged.
-                  //
-                  // In order to flag all merged clusters and possibly
-                  // try to separate the different contributions use
-                  // the EUTelSeparateClusterProcessor. In this
-                  // processor not all the merged clusters will be
-                  // flagged as kMergedCluster | kIncompleteCluster
-                  cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
-                  clusterCandidateCharges.push_back(0.);
-                } else if (!isGood) {
-                  cluQuality = cluQuality | kIncompleteCluster;
-                  clusterCandidateCharges.push_back(0.);
-                }
-              } else {
-                cluQuality = cluQuality | kBorderCluster;
-                clusterCandidateCharges.push_back(0.);
-              }
-            }
-          }
-          // at this point we have built the cluster candidate,
-          // we need to validate it
-          if (clusterCandidateSignal >
-              _ffClusterCut * sqrt(clusterCandidateNoise2)) {
-            // the cluster candidate is a good cluster
-            // mark all pixels belonging to the cluster as hit
-            IntVec::iterator indexIter = clusterCandidateIndeces.begin();
-
-            // the final result of the clustering will enter in a
-            // TrackerPulseImpl in order to be algorithm independent
-            TrackerPulseImpl *pulse = new TrackerPulseImpl;
-            idPulseEncoder["sensorID"] = sensorID;
-            idPulseEncoder["xSeed"] = seedX;
-            idPulseEncoder["ySeed"] = seedY;
-            idPulseEncoder["xCluSize"] = _ffXClusterSize;
-            idPulseEncoder["yCluSize"] = _ffYClusterSize;
-            idPulseEncoder["type"] = static_cast<int>(kEUTelFFClusterImpl);
-            idPulseEncoder.setCellID(pulse);
-
-            TrackerDataImpl *cluster = new TrackerDataImpl;
-            idClusterEncoder["sensorID"] = sensorID;
-            idClusterEncoder["xSeed"] = seedX;
-            idClusterEncoder["ySeed"] = seedY;
-            idClusterEncoder["xCluSize"] = _ffXClusterSize;
-            idClusterEncoder["yCluSize"] = _ffYClusterSize;
-            idClusterEncoder["quality"] = static_cast<int>(cluQuality);
-            idClusterEncoder.setCellID(cluster);
-
-            streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
-                                  << seedX << " seedY " << seedY << endl;
-
-            while (indexIter != clusterCandidateIndeces.end()) {
-              if ((*indexIter) != -1)
-                status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
-              ++indexIter;
-            }
-
-            // copy the candidate charges inside the cluster
-            cluster->setChargeValues(clusterCandidateCharges);
-            sparseClusterCollectionVec->push_back(cluster);
-
-            EUTelFFClusterImpl *eutelCluster = new EUTelFFClusterImpl(cluster);
-            pulse->setCharge(eutelCluster->getTotalCharge());
-            delete eutelCluster;
-
-            pulse->setQuality(static_cast<int>(cluQuality));
-            pulse->setTrackerData(cluster);
-            pulseCollection->push_back(pulse);
-
-            // increment the cluster counters
-            _totClusterMap[sensorID] += 1;
-            ++clusterID;
-            if (clusterID >= MAXCLUSTERSIZE) {
-              ++limitExceed;
-              --clusterID;
-              streamlog_out(WARNING2)
-                  << "Event " << evt->getEventNumber() << " in run "
-                  << evt->getRunNumber() << " on detector " << sensorID
-                  << " contains more than " << MAXCLUSTERSIZE << " cluster ("
-                  << clusterID + limitExceed << ")" << endl;
-            }
-          }
-        }
-        ++rMapIter;
+    // now build up a cluster for each seed candidate, by decreasing
+    // signal. Seeds on hot pixels or already added to another
+    // cluster are skipped, the cluster candidates have to pass the
+    // clusterCut. Pixels already in another cluster flag the cluster
+    // as kIncompleteCluster | kMergedCluster; in order to flag all
+    // merged clusters use the EUTelSeparateClusterProcessor.
+    frameFinder.findClusters(statusVec, noiseVec, _ffClusterCut, maxX, maxY);
+
+    streamlog_out(DEBUG0) << "There are "
+                          << frameFinder.getNSeedCandidates()
+                          << " seed candidates." << endl;
+
+    const int frameSize = _ffXClusterSize * _ffYClusterSize;
+    for (auto const &foundCluster : frameFinder.getClusters()) {
+      const int seedX = foundCluster.seedX;
+      const int seedY = foundCluster.seedY;
+
+      ClusterQuality cluQuality = kGoodCluster;
+      if (foundCluster.border)
+        cluQuality = cluQuality | kBorderCluster;
+      if (foundCluster.incomplete)
+        cluQuality = cluQuality | kIncompleteCluster;
+      if (foundCluster.merged)
+        cluQuality = cluQuality | kMergedCluster;
+
+      // the final result of the clustering will enter in a
+      // TrackerPulseImpl in order to be algorithm independent
+      TrackerPulseImpl *pulse = new TrackerPulseImpl;
+      idPulseEncoder["sensorID"] = sensorID;
+      idPulseEncoder["xSeed"] = seedX;
+      idPulseEncoder["ySeed"] = seedY;
+      idPulseEncoder["xCluSize"] = _ffXClusterSize;
+      idPulseEncoder["yCluSize"] = _ffYClusterSize;
+      idPulseEncoder["type"] = static_cast<int>(kEUTelFFClusterImpl);
+      idPulseEncoder.setCellID(pulse);
+
+      TrackerDataImpl *cluster = new TrackerDataImpl;
+      idClusterEncoder["sensorID"] = sensorID;
+      idClusterEncoder["xSeed"] = seedX;
+      idClusterEncoder["ySeed"] = seedY;
+      idClusterEncoder["xCluSize"] = _ffXClusterSize;
+      idClusterEncoder["yCluSize"] = _ffYClusterSize;
+      idClusterEncoder["quality"] = static_cast<int>(cluQuality);
+      idClusterEncoder.setCellID(cluster);
+
+      streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
+                            << seedX << " seedY " << seedY << endl;
+
+      // copy the frame charges inside the cluster
+      auto firstCharge =
+          frameFinder.getCharges().begin() + foundCluster.firstCharge;
+      cluster->setChargeValues(FloatVec(firstCharge, firstCharge + frameSize));
+      sparseClusterCollectionVec->push_back(cluster);
+
+      EUTelFFClusterImpl *eutelCluster = new EUTelFFClusterImpl(cluster);
+      pulse->setCharge(eutelCluster->getTotalCharge());
+      delete eutelCluster;
+
+      pulse->setQuality(static_cast<int>(cluQuality));
+      pulse->setTrackerData(cluster);
+      pulseCollection->push_back(pulse);
+
+      // increment the cluster counters
+      _totClusterMap[sensorID] += 1;
+      ++clusterID;
+      if (clusterID >= MAXCLUSTERSIZE) {
+        ++limitExceed;
+        --clusterID;
+        streamlog_out(WARNING2)
+            << "Event " << evt->getEventNumber() << " in run "
+            << evt->getRunNumber() << " on detector " << sensorID
+            << " contains more than " << MAXCLUSTERSIZE << " cluster ("
+            << clusterID + limitExceed << ")" << endl;
       }
     }
   }
@@ -88,7 +88,7 @@ EUTelDUTHistograms::EUTelDUTHistograms()
       _clusterSizeY(), _subMatrix(), _maptrackid(0), _trackhitposX(),
       _trackhitposY(), _trackhitsizeX(), _trackhitsizeY(), _trackhitsubM(),
       _trackhitsensorID(), _cluSizeXCut(0), _cluSizeYCut(0), _trackNCluXCut(0),
-      _trackNCluYCut(0), _measuredX(), _measuredY(), _bgmeasuredX(),
+      _trackNCluYCut(0), _greedyMatching(false), _hitMatcher(), _measuredX(), _measuredY(), _bgmeasuredX(),
       _bgmeasuredY(), _localX(), _localY(), _fittedX(), _fittedY(),
       _bgfittedX(), _bgfittedY(), _DUTalign(), _ClusterSizeHistos(),
       _ShiftHistos(), _MeasuredHistos(), _MatchedHistos(), _UnMatchedHistos(),
@@ -172,6 +172,12 @@ EUTelDUTHistograms::EUTelDUTHistograms()
   registerOptionalParameter(
       "trackNCluYCut", "number of hit on a track with _cluSizeY cluster size ",
       _trackNCluYCut, 0);
+
+  registerOptionalParameter(
+      "GreedyMatching",
+      "Match the tracks in order, each to its closest free DUT hit, instead "
+      "of taking all track hit pairs by increasing distance",
+      _greedyMatching, false);
 }
 
 void EUTelDUTHistograms::init() {
@@ -288,56 +294,51 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
   }
 #endif
 
-  // Match measured and fitted positions
-
-  int nMatch = 0;
-  double distmin;
+  // Match measured and fitted positions: the measured hits are sorted
+  // into a grid of DistMax cells, so that each fitted position is only
+  // compared to the hits around it. Each hit is matched to one track
+  // at most.
 
+  _hitMatcher.reset(_distMax);
+  for (int ihit = 0; ihit < static_cast<int>(_measuredX.size()); ihit++) {
+    _hitMatcher.addHit(_measuredX[ihit], _measuredY[ihit]);
+  }
   for (int itrack = 0; itrack < _maptrackid; itrack++) {
-    int bestfit = -1;
-    int besthit = -1;
-
-    distmin = _distMax * _distMax + 10.;
-
-    if (static_cast<int>(_fittedX[itrack].size()) < 1)
-      continue;
-
     for (int ifit = 0; ifit < static_cast<int>(_fittedX[itrack].size());
          ifit++) {
-      if (_measuredX.empty())
-        continue;
+      _hitMatcher.addFit(itrack, ifit, _fittedX[itrack][ifit],
+                         _fittedY[itrack][ifit]);
+    }
+  }
+  _hitMatcher.match(_maptrackid, _greedyMatching);
 
-      for (int ihit = 0; ihit < static_cast<int>(_measuredX.size()); ihit++) {
+  int nMatch = 0;
 
-        double dist2rd = (_measuredX[ihit] - _fittedX[itrack][ifit]) *
-                             (_measuredX[ihit] - _fittedX[itrack][ifit]) +
-                         (_measuredY[ihit] - _fittedY[itrack][ifit]) *
-                             (_measuredY[ihit] - _fittedY[itrack][ifit]);
+  for (int itrack = 0; itrack < _maptrackid; itrack++) {
+    const int bestfit = _hitMatcher.getMatch(itrack).fit;
+    const int besthit = _hitMatcher.getMatch(itrack).hit;
 
-        if (streamlog_level(DEBUG5)) {
-          message<DEBUG5>(log() << "Fit [" << itrack << ":" << _maptrackid
-                                << "], ifit= " << ifit << " ["
-                                << _fittedX[itrack][ifit] << ":"
-                                << _fittedY[itrack][ifit] << "]" << endl);
-          message<DEBUG5>(log() << "rec " << ihit << " [" << _measuredX[ihit]
-                                << ":" << _measuredY[ihit] << "]" << endl);
-          message<DEBUG5>(log() << "distance : " << TMath::Sqrt(dist2rd)
-                                << endl);
-        }
-        if (dist2rd < distmin) {
-          distmin = dist2rd;
-          besthit = ihit;
-          bestfit = ifit;
-        }
-      }
-    }
+    if (static_cast<int>(_fittedX[itrack].size()) < 1)
+      continue;
 
     // Match found:
 
-    if (distmin < _distMax * _distMax) {
+    if (besthit >= 0) {
 
       nMatch++;
 
+      if (streamlog_level(DEBUG5)) {
+        message<DEBUG5>(log() << "Fit [" << itrack << ":" << _maptrackid
+                              << "], ifit= " << bestfit << " ["
+                              << _fittedX[itrack][bestfit] << ":"
+                              << _fittedY[itrack][bestfit] << "] matched to rec "
+                              << besthit << " [" << _measuredX[besthit] << ":"
+                              << _measuredY[besthit] << "], distance : "
+                              << TMath::Sqrt(
+                                     _hitMatcher.getMatch(itrack).distance2)
+                              << endl);
+      }
+
 // Matched hits positions
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -536,15 +537,13 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
 
 #endif
 
-      // Remove matched entries from the list (so the next matching pair
-      // can be looked for)
+      // Remove the matched fitted position from the list, the remaining
+      // ones are filled as unmatched below. The measured hits keep their
+      // index, so that they stay aligned with the cluster sizes.
 
       _fittedX[itrack].erase(_fittedX[itrack].begin() + bestfit);
       _fittedY[itrack].erase(_fittedY[itrack].begin() + bestfit);
 
-      _measuredX.erase(_measuredX.begin() + besthit);
-      _measuredY.erase(_measuredY.begin() + besthit);
-
       _localX[itrack].erase(_localX[itrack].begin() + bestfit);
       _localY[itrack].erase(_localY[itrack].begin() + bestfit);
     }
@@ -553,7 +552,7 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
 
     if (streamlog_level(DEBUG5)) {
       message<DEBUG5>(log() << nMatch << " DUT hits matched to fitted tracks ");
-      message<DEBUG5>(log() << _measuredX.size()
+      message<DEBUG5>(log() << _measuredX.size() - nMatch
                             << " DUT hits not matched to any track ");
       message<DEBUG5>(
           log() << "track " << itrack << " has " << _fittedX[itrack].size()
@@ -587,6 +586,9 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
   // Noise plots - unmatched hits
 
   for (int ihit = 0; ihit < static_cast<int>(_measuredX.size()); ihit++) {
+    if (_hitMatcher.isHitMatched(ihit))
+      continue;
+
     (dynamic_cast<AIDA::IProfile1D *>(_NoiseHistos.at(projX)))
         ->fill(_measuredX[ihit], 1.);
     (dynamic_cast<AIDA::IProfile1D *>(_NoiseHistos.at(projY)))
@@ -463,13 +463,11 @@ void EUTelDafBase::init() {
                              _clusterFinderName + "does not exist");
   }
 
-  // Use map to sort planes by z
-  _zSort.clear();
-  int plane = 0;
+  // Plane index lookup by sensor ID, z in um for the fallback
+  _planeLookup.clear();
   for (int sensorID : geo::gGeometry().sensorIDsVec()) {
-    _zSort[geo::gGeometry().getPlaneZPosition(sensorID) * 1000.0] = plane;
-    _indexIDMap[sensorID] = plane;
-    plane++;
+    _planeLookup.addPlane(sensorID,
+                          geo::gGeometry().getPlaneZPosition(sensorID) * 1000.0);
   }
 
   size_t index = 0;
@@ -599,21 +597,22 @@ float EUTelDafBase::getScatterThetaVar(float radLength) {
   return (scatterTheta * scatterTheta);
 }
 
-size_t EUTelDafBase::getPlaneIndex(float zPos) {
-  // Get plane index from z-position of hit
-  map<float, int>::iterator it = _zSort.begin();
-  size_t index(0);
-  bool foundIt(false);
-  for (; it != _zSort.end(); index++, it++) {
-    if (fabs((*it).first - zPos) < 30000.0) {
-      foundIt = true;
-      break;
-    }
+int EUTelDafBase::getPlaneIndex(int sensorID, float zPos) {
+  // Get plane index from the sensor ID of the hit
+  int index = _planeLookup.getPlaneIndex(sensorID);
+  if (index >= 0) {
+    return (index);
   }
-  if (not foundIt) {
-    streamlog_out(ERROR5) << "Found hit at z=" << zPos
+  // Fall back to the z-position of the hit (in um) for unknown IDs
+  index = _planeLookup.getPlaneIndexFromZ(zPos, 30000.0);
+  if (index < 0) {
+    streamlog_out(ERROR5) << "Found hit with sensor ID " << sensorID
+                          << " at z=" << zPos
                           << " , not able to assign to any plane!" << endl;
-    return (-1);
+  } else {
+    streamlog_out(DEBUG5) << "Hit with unknown sensor ID " << sensorID
+                          << " at z=" << zPos << " assigned to plane " << index
+                          << " by its z position" << endl;
   }
   return (index);
 }
@@ -638,6 +637,11 @@ void EUTelDafBase::readHitCollection(LCEvent *event) {
     streamlog_out(DEBUG5) << " hit collection size : "
                           << _hitCollection->getNumberOfElements() << std::endl;
 
+    // Decoders are built once per collection, not per hit
+    UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
+    std::unique_ptr<UTIL::CellIDDecoder<SimTrackerHitImpl>> simHitDecoder;
+    LCCollection *simDecoderCollection = nullptr;
+
     for (int iHit = 0; iHit < _hitCollection->getNumberOfElements(); iHit++) {
       TrackerHitImpl *hit =
           static_cast<TrackerHitImpl *>(_hitCollection->getElementAt(iHit));
@@ -653,13 +657,17 @@ void EUTelDafBase::readHitCollection(LCEvent *event) {
           simhit = static_cast<SimTrackerHitImpl *>(
               _mcCollection->getElementAt(iHit));
         if (simhit != nullptr) {
-          UTIL::CellIDDecoder<SimTrackerHitImpl> simHitDecoder(_mcCollection);
+          if (!simHitDecoder || simDecoderCollection != _mcCollection) {
+            simHitDecoder.reset(
+                new UTIL::CellIDDecoder<SimTrackerHitImpl>(_mcCollection));
+            simDecoderCollection = _mcCollection;
+          }
           const double *simpos = simhit->getPosition();
           pos[0] = simpos[0];
           pos[1] = simpos[1];
           pos[2] = simpos[2];
-          int planeID = simHitDecoder(simhit)["sensorID"];
-          planeIndex = _indexIDMap[planeID];
+          int planeID = (*simHitDecoder)(simhit)["sensorID"];
+          planeIndex = getPlaneIndex(planeID, static_cast<float>(pos[2]) * 1000.0f);
         }
         streamlog_out(DEBUG5) << " SIM: simhit=" << (simhit != nullptr)
                               << " add point [" << planeIndex << "] "
@@ -671,10 +679,8 @@ void EUTelDafBase::readHitCollection(LCEvent *event) {
         pos[0] = hitpos[0];
         pos[1] = hitpos[1];
         pos[2] = hitpos[2];
-        UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(
-            EUTELESCOPE::HITENCODING);
         int planeID = hitDecoder(hit)["sensorID"];
-        planeIndex = _indexIDMap[planeID];
+        planeIndex = getPlaneIndex(planeID, static_cast<float>(pos[2]) * 1000.0f);
         streamlog_out(DEBUG5) << " REAL: add point [" << planeIndex << "] "
                               << static_cast<float>(pos[0]) * 1000.0f << " "
                               << static_cast<float>(pos[1]) * 1000.0f << " "
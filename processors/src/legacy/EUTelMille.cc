@@ -1128,6 +1128,7 @@ void EUTelMille::FillHotPixelMap(LCEvent *event) {
 
   CellIDDecoder<TrackerDataImpl> cellDecoder(hotPixelCollectionVec);
 
+  _hotPixelMask.clear();
   for (int i = 0; i < hotPixelCollectionVec->getNumberOfElements(); i++) {
     TrackerDataImpl *hotPixelData =
         dynamic_cast<TrackerDataImpl *>(hotPixelCollectionVec->getElementAt(i));
@@ -1137,30 +1138,19 @@ void EUTelMille::FillHotPixelMap(LCEvent *event) {
     int sensorID = static_cast<int>(cellDecoder(hotPixelData)["sensorID"]);
 
     if (type == kEUTelGenericSparsePixel) {
-
-      auto m26Data =
-          std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(
-              hotPixelData);
-      auto &pixelVec = m26Data->getPixels();
-
-      for (auto &m26Pixel : pixelVec) {
-        streamlog_out(DEBUG3) << "Size: " << m26Data->size()
-                              << " HotPixelInfo:  " << m26Pixel.getXCoord()
-                              << " " << m26Pixel.getYCoord() << " "
-                              << m26Pixel.getSignal() << endl;
-        try {
-          char ix[100];
-          sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(),
-                  m26Pixel.getYCoord());
-          _hotPixelMap[ix] = true;
-        } catch (...) {
-          std::cout << "can not add pixel " << std::endl;
-          std::cout << sensorID << " " << m26Pixel.getXCoord() << " "
-                    << m26Pixel.getYCoord() << " " << std::endl;
-        }
+      // x, y, signal and time of every pixel
+      const FloatVec &charges = hotPixelData->getChargeValues();
+      for (size_t iPixel = 0; iPixel + 3 < charges.size(); iPixel += 4) {
+        const short x = static_cast<short>(charges[iPixel]);
+        const short y = static_cast<short>(charges[iPixel + 1]);
+        streamlog_out(DEBUG3) << "Size: " << charges.size() / 4
+                              << " HotPixelInfo:  " << x << " " << y << " "
+                              << charges[iPixel + 2] << endl;
+        _hotPixelMask.setHotPixel(sensorID, x, y);
       }
     }
   }
+  _hotPixelMask.build();
 }
 
 void EUTelMille::findMatchedHits(int &_ntrack, Track *TrackHere) {
@@ -2528,28 +2518,16 @@ bool EUTelMille::hitContainsHotPixels(TrackerHitImpl *hit) {
               "Invalid hit found in method hitContainsHotPixels()");
         }
 
-        auto cluster =
-            std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(
-                clusterFrame);
-        auto &pixelVec = cluster->getPixels();
-        int sensorID = cluster->getDetectorID();
-
-        for (auto &m26Pixel : pixelVec) {
-          int pixelX, pixelY;
-          pixelX = m26Pixel.getXCoord();
-          pixelY = m26Pixel.getYCoord();
-          {
-            char ix[100];
-            sprintf(ix, "%d,%d,%d", sensorID, pixelX, pixelY);
-            std::map<std::string, bool>::const_iterator z =
-                _hotPixelMap.find(ix);
-            if (z != _hotPixelMap.end() && _hotPixelMap[ix] == true) {
-              streamlog_out(DEBUG3)
-                  << "Skipping hit as it was found in the hot pixel map."
-                  << endl;
-              return true; // if TRUE  this hit will be skipped
-            }
-          }
+        // the pixels are checked on the charge values of the cluster,
+        // without decoding them into a cluster object
+        CellIDDecoder<TrackerDataImpl> cellDecoder(
+            EUTELESCOPE::ZSCLUSTERDEFAULTENCODING);
+        int sensorID = static_cast<int>(cellDecoder(clusterFrame)["sensorID"]);
+        if (_hotPixelMask.containsHotPixel(sensorID,
+                                           clusterFrame->getChargeValues())) {
+          streamlog_out(DEBUG3)
+              << "Skipping hit as it was found in the hot pixel map." << endl;
+          return true; // if TRUE  this hit will be skipped
         }
 
       } else if (hit->getType() == kEUTelBrickedClusterImpl) {
@@ -14,6 +14,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
+#include "EUTelFrameCache.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelRunHeaderImpl.h"
 
@@ -172,6 +173,12 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor()
       "HitRejectionPreLoop",
       "Perform a fast first loop to improve the efficiency of hit rejection",
       _preLoopSwitch, true);
+  registerOptionalParameter(
+      "FrameCacheSize",
+      "Memory budget in MB to keep the raw frames of the first loop in memory "
+      "and to run the following loops without rewinding the input files. "
+      "Set to 0 to always rewind",
+      _frameCacheSize, 0);
 
   registerProcessorParameter("FirstEvent",
                              "First event for pedestal calculation",
@@ -200,7 +207,9 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor()
   registerOptionalParameter("StatusCollectionName", "Status collection name",
                             _statusCollectionName, string("statusDB"));
 
-  _histogramSwitch = true;
+  registerOptionalParameter("HistogramFilling",
+                            "Switch on or off the histogram booking and filling",
+                            _histogramSwitch, true);
 }
 
 void EUTelPedestalNoiseProcessor::init() {
@@ -260,6 +269,9 @@ void EUTelPedestalNoiseProcessor::init() {
   // reset the skip event list
   _skippedEventList.clear();
   _nextEventToSkip = _skippedEventList.begin();
+
+  // the frame cache is configured with the first event
+  _frameCache.clear();
 }
 
 void EUTelPedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
@@ -1045,6 +1057,8 @@ void EUTelPedestalNoiseProcessor::firstLoop(LCEvent *event) {
 
     bookHistos();
 
+    initFrameCache();
+
     _isFirstEvent = false;
 
   } else {
@@ -1162,6 +1176,9 @@ void EUTelPedestalNoiseProcessor::firstLoop(LCEvent *event) {
     // increment the event number
     ++_iEvt;
   } // end elif firstEvent
+
+  // keep a copy of the raw frames for the following loops
+  cacheFrames(evt);
 }
 
 void EUTelPedestalNoiseProcessor::otherLoop(LCEvent *event) {
@@ -1202,265 +1219,274 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent *event) {
         // get the TrackerRawData object from the collection for this detector
         TrackerRawData *trackerRawData = dynamic_cast<TrackerRawData *>(
             collectionVec->getElementAt(iDetector));
-        ShortVec adcValues = trackerRawData->getADCValues();
 
-        // new approach for a better common mode calculation. The idea
-        // is that instead of using, as before, a single value of
-        // common mode per matrix, we will have a vector of floats
-        // containing the common mode correction for each pixel
-        vector<float> commonModeCorVec;
-        commonModeCorVec.clear();
+        size_t detectorOffset = (iCol == 0) ? 0 : _noOfDetectorVec.at(iCol - 1);
+        otherLoopDetector(iDetector, detectorOffset,
+                          trackerRawData->getADCValues().data());
+      }
+    } catch (DataNotAvailableException &e) {
+      streamlog_out(WARNING2)
+          << "No input collection " << _rawDataCollectionNameVec.at(iCol)
+          << " is not available in the current event" << endl;
+    }
+  }
+  ++_iEvt;
+}
 
-        bool isEventValid = true;
-        int skippedPixel = 0;
-        int skippedRow = 0;
+void EUTelPedestalNoiseProcessor::otherLoopDetector(size_t iDetector,
+                                                    size_t detectorOffset,
+                                                    const short *adcValues) {
 
-        size_t detectorOffset = (iCol == 0) ? 0 : _noOfDetectorVec.at(iCol - 1);
+  // new approach for a better common mode calculation. The idea
+  // is that instead of using, as before, a single value of
+  // common mode per matrix, we will have a vector of floats
+  // containing the common mode correction for each pixel
+  vector<float> commonModeCorVec;
+  commonModeCorVec.clear();
 
-        if (_commonModeAlgo == EUTELESCOPE::FULLFRAME) {
-
-          double pixelSum = 0.;
-          double commonMode = 0.;
-          int goodPixel = 0;
-          int iPixel = 0;
-
-          // start looping on all pixels for hit rejection
-          for (int yPixel = _minY[iDetector + detectorOffset];
-               yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-            for (int xPixel = _minX[iDetector + detectorOffset];
-                 xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              bool isHit = ((adcValues[iPixel] -
-                             _pedestal[iDetector + detectorOffset][iPixel]) >
-                            _hitRejectionCut *
-                                _noise[iDetector + detectorOffset][iPixel]);
-              bool isGood = (_status[iDetector + detectorOffset][iPixel] ==
-                             EUTELESCOPE::GOODPIXEL);
-              if (!isHit && isGood) {
-                pixelSum += adcValues[iPixel] -
-                            _pedestal[iDetector + detectorOffset][iPixel];
-                ++goodPixel;
-              } else if (isHit) {
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-          }
+  bool isEventValid = true;
+  int skippedPixel = 0;
+  int skippedRow = 0;
 
-          if ((skippedPixel < _maxNoOfRejectedPixels) && (goodPixel != 0)) {
+  if (_commonModeAlgo == EUTELESCOPE::FULLFRAME) {
 
-            commonMode = pixelSum / goodPixel;
-            commonModeCorVec.insert(commonModeCorVec.begin(), iPixel + 1,
-                                    commonMode);
-            isEventValid = true;
+    double pixelSum = 0.;
+    double commonMode = 0.;
+    int goodPixel = 0;
+    int iPixel = 0;
+
+    // start looping on all pixels for hit rejection
+    for (int yPixel = _minY[iDetector + detectorOffset];
+         yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
+      for (int xPixel = _minX[iDetector + detectorOffset];
+           xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
+        bool isHit = ((adcValues[iPixel] -
+                       _pedestal[iDetector + detectorOffset][iPixel]) >
+                      _hitRejectionCut *
+                          _noise[iDetector + detectorOffset][iPixel]);
+        bool isGood = (_status[iDetector + detectorOffset][iPixel] ==
+                       EUTELESCOPE::GOODPIXEL);
+        if (!isHit && isGood) {
+          pixelSum += adcValues[iPixel] -
+                      _pedestal[iDetector + detectorOffset][iPixel];
+          ++goodPixel;
+        } else if (isHit) {
+          ++skippedPixel;
+        }
+        ++iPixel;
+      }
+    }
+
+    if ((skippedPixel < _maxNoOfRejectedPixels) && (goodPixel != 0)) {
+
+      commonMode = pixelSum / goodPixel;
+      commonModeCorVec.insert(commonModeCorVec.begin(), iPixel + 1,
+                              commonMode);
+      isEventValid = true;
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-            string histoname =
-                _commonModeHistoName + "_d" +
-                to_string(_orderedSensorIDVec.at(iDetector + detectorOffset)) +
-                "_l" + to_string(_iLoop);
-            AIDA::IHistogram1D *histo =
-                (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[histoname]));
-            if (histo) {
-              histo->fill(commonMode);
-            }
+      string histoname =
+          _commonModeHistoName + "_d" +
+          to_string(_orderedSensorIDVec.at(iDetector + detectorOffset)) +
+          "_l" + to_string(_iLoop);
+      AIDA::IHistogram1D *histo =
+          (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[histoname]));
+      if (histo) {
+        histo->fill(commonMode);
+      }
 #endif
 
-          } else {
+    } else {
 
-            isEventValid = false;
-          }
+      isEventValid = false;
+    }
 
-        } else if (_commonModeAlgo == EUTELESCOPE::ROWWISE) {
-
-          int iPixel = 0;
-          int colCounter = 0;
-          int rowLength = _maxX[iDetector + detectorOffset] -
-                          _minX[iDetector + detectorOffset] + 1;
-
-          for (int yPixel = _minY[iDetector + detectorOffset];
-               yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-
-            double pixelSum = 0.;
-            double commonMode = 0.;
-            int goodPixel = 0;
-            int skippedPixelPerRow = 0;
-
-            for (int xPixel = _minX[iDetector + detectorOffset];
-                 xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              bool isHit = ((adcValues[iPixel] -
-                             _pedestal[iDetector + detectorOffset][iPixel]) >
-                            _hitRejectionCut *
-                                _noise[iDetector + detectorOffset][iPixel]);
-              bool isGood = (_status[iDetector + detectorOffset][iPixel] ==
-                             EUTELESCOPE::GOODPIXEL);
-              if (!isHit && isGood) {
-                pixelSum += adcValues[iPixel] -
-                            _pedestal[iDetector + detectorOffset][iPixel];
-                ++goodPixel;
-              } else if (isHit) {
-                ++skippedPixelPerRow;
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
+  } else if (_commonModeAlgo == EUTELESCOPE::ROWWISE) {
+
+    int iPixel = 0;
+    int colCounter = 0;
+    int rowLength = _maxX[iDetector + detectorOffset] -
+                    _minX[iDetector + detectorOffset] + 1;
+
+    for (int yPixel = _minY[iDetector + detectorOffset];
+         yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
+
+      double pixelSum = 0.;
+      double commonMode = 0.;
+      int goodPixel = 0;
+      int skippedPixelPerRow = 0;
+
+      for (int xPixel = _minX[iDetector + detectorOffset];
+           xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
+        bool isHit = ((adcValues[iPixel] -
+                       _pedestal[iDetector + detectorOffset][iPixel]) >
+                      _hitRejectionCut *
+                          _noise[iDetector + detectorOffset][iPixel]);
+        bool isGood = (_status[iDetector + detectorOffset][iPixel] ==
+                       EUTELESCOPE::GOODPIXEL);
+        if (!isHit && isGood) {
+          pixelSum += adcValues[iPixel] -
+                      _pedestal[iDetector + detectorOffset][iPixel];
+          ++goodPixel;
+        } else if (isHit) {
+          ++skippedPixelPerRow;
+          ++skippedPixel;
+        }
+        ++iPixel;
+      }
 
-            // we are now at the end of the row, so let's calculate the
-            // common mode
-            if ((skippedPixelPerRow < _maxNoOfRejectedPixelPerRow) &&
-                (goodPixel != 0)) {
-              commonMode = pixelSum / goodPixel;
-              commonModeCorVec.insert(commonModeCorVec.begin() +
-                                          colCounter * rowLength,
-                                      rowLength, commonMode);
+      // we are now at the end of the row, so let's calculate the
+      // common mode
+      if ((skippedPixelPerRow < _maxNoOfRejectedPixelPerRow) &&
+          (goodPixel != 0)) {
+        commonMode = pixelSum / goodPixel;
+        commonModeCorVec.insert(commonModeCorVec.begin() +
+                                    colCounter * rowLength,
+                                rowLength, commonMode);
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" +
-                                 to_string(_orderedSensorIDVec.at(
-                                     iDetector + detectorOffset)) +
-                                 "_l" + to_string(_iLoop);
-              AIDA::IHistogram1D *histo = (dynamic_cast<AIDA::IHistogram1D *>(
-                  _aidaHistoMap[histoname]));
-              if (histo) {
-                histo->fill(commonMode);
-              }
+        string histoname = _commonModeHistoName + "_d" +
+                           to_string(_orderedSensorIDVec.at(
+                               iDetector + detectorOffset)) +
+                           "_l" + to_string(_iLoop);
+        AIDA::IHistogram1D *histo = (dynamic_cast<AIDA::IHistogram1D *>(
+            _aidaHistoMap[histoname]));
+        if (histo) {
+          histo->fill(commonMode);
+        }
 #endif
 
-            } else {
-              commonModeCorVec.insert(commonModeCorVec.begin() +
-                                          colCounter * rowLength,
-                                      rowLength, 0.);
-              ++skippedRow;
-            }
+      } else {
+        commonModeCorVec.insert(commonModeCorVec.begin() +
+                                    colCounter * rowLength,
+                                rowLength, 0.);
+        ++skippedRow;
+      }
 
-            ++colCounter;
-          }
+      ++colCounter;
+    }
 
-          if (skippedRow < _maxNoOfSkippedRow) {
+    if (skippedRow < _maxNoOfSkippedRow) {
 
-            isEventValid = true;
+      isEventValid = true;
 
-          } else {
+    } else {
 
-            isEventValid = false;
-          }
+      isEventValid = false;
+    }
 
-        } else {
-          streamlog_out(ERROR4)
-              << "Unknown common mode algorithm. Using flat null correction"
-              << endl;
-          commonModeCorVec.insert(commonModeCorVec.begin(),
-                                  (_maxY[iDetector + detectorOffset] -
-                                   _minY[iDetector + detectorOffset] + 1) *
-                                      (_maxX[iDetector + detectorOffset] -
-                                       _minX[iDetector + detectorOffset] + 1),
-                                  0.);
-          isEventValid = true;
-        }
+  } else {
+    streamlog_out(ERROR4)
+        << "Unknown common mode algorithm. Using flat null correction"
+        << endl;
+    commonModeCorVec.insert(commonModeCorVec.begin(),
+                            (_maxY[iDetector + detectorOffset] -
+                             _minY[iDetector + detectorOffset] + 1) *
+                                (_maxX[iDetector + detectorOffset] -
+                                 _minX[iDetector + detectorOffset] + 1),
+                            0.);
+    isEventValid = true;
+  }
+
+  if (isEventValid) {
 
-        if (isEventValid) {
-
-          int iPixel = 0;
-          for (int yPixel = _minY[iDetector + detectorOffset];
-               yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-            for (int xPixel = _minX[iDetector + detectorOffset];
-                 xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              if (_status[iDetector + detectorOffset][iPixel] ==
-                  EUTELESCOPE::GOODPIXEL) {
-                double pedeCorrected =
-                    adcValues[iPixel] - commonModeCorVec[iPixel];
-                if (std::abs(pedeCorrected -
-                             _pedestal[iDetector + detectorOffset][iPixel]) <
-                    _hitRejectionCut *
-                        _noise[iDetector + detectorOffset][iPixel]) {
-                  if (_pedestalAlgo == EUTELESCOPE::MEANRMS) {
-
-                    bool use = true;
-                    if (_preLoopSwitch &&
-                        ((_iEvt ==
-                          _maxValuePos[iDetector + detectorOffset][iPixel]) ||
-                         (_iEvt ==
-                          _minValuePos[iDetector + detectorOffset][iPixel]))) {
-                      use = false;
-                    }
-                    if (use) {
-                      _tempEntries[iDetector + detectorOffset][iPixel] =
-                          _tempEntries[iDetector + detectorOffset][iPixel] + 1;
-                      _tempPede[iDetector + detectorOffset][iPixel] =
-                          ((_tempEntries[iDetector + detectorOffset][iPixel] -
-                            1) *
-                               _tempPede[iDetector + detectorOffset][iPixel] +
-                           pedeCorrected) /
-                          _tempEntries[iDetector + detectorOffset][iPixel];
-                      _tempNoise[iDetector + detectorOffset][iPixel] = sqrt(
-                          ((_tempEntries[iDetector + detectorOffset][iPixel] -
-                            1) *
-                               pow(_tempNoise[iDetector + detectorOffset]
-                                             [iPixel],
-                                   2) +
-                           pow(pedeCorrected -
-                                   _tempPede[iDetector + detectorOffset]
-                                            [iPixel],
-                               2)) /
-                          _tempEntries[iDetector + detectorOffset][iPixel]);
-                    }
-                  } else if (_pedestalAlgo == EUTELESCOPE::AIDAPROFILE) {
+    int iPixel = 0;
+    for (int yPixel = _minY[iDetector + detectorOffset];
+         yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
+      for (int xPixel = _minX[iDetector + detectorOffset];
+           xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
+        if (_status[iDetector + detectorOffset][iPixel] ==
+            EUTELESCOPE::GOODPIXEL) {
+          double pedeCorrected =
+              adcValues[iPixel] - commonModeCorVec[iPixel];
+          if (std::abs(pedeCorrected -
+                       _pedestal[iDetector + detectorOffset][iPixel]) <
+              _hitRejectionCut *
+                  _noise[iDetector + detectorOffset][iPixel]) {
+            if (_pedestalAlgo == EUTELESCOPE::MEANRMS) {
+
+              bool use = true;
+              if (_preLoopSwitch &&
+                  ((_iEvt ==
+                    _maxValuePos[iDetector + detectorOffset][iPixel]) ||
+                   (_iEvt ==
+                    _minValuePos[iDetector + detectorOffset][iPixel]))) {
+                use = false;
+              }
+              if (use) {
+                _tempEntries[iDetector + detectorOffset][iPixel] =
+                    _tempEntries[iDetector + detectorOffset][iPixel] + 1;
+                _tempPede[iDetector + detectorOffset][iPixel] =
+                    ((_tempEntries[iDetector + detectorOffset][iPixel] -
+                      1) *
+                         _tempPede[iDetector + detectorOffset][iPixel] +
+                     pedeCorrected) /
+                    _tempEntries[iDetector + detectorOffset][iPixel];
+                _tempNoise[iDetector + detectorOffset][iPixel] = sqrt(
+                    ((_tempEntries[iDetector + detectorOffset][iPixel] -
+                      1) *
+                         pow(_tempNoise[iDetector + detectorOffset]
+                                       [iPixel],
+                             2) +
+                     pow(pedeCorrected -
+                             _tempPede[iDetector + detectorOffset]
+                                      [iPixel],
+                         2)) /
+                    _tempEntries[iDetector + detectorOffset][iPixel]);
+              }
+            } else if (_pedestalAlgo == EUTELESCOPE::AIDAPROFILE) {
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-                    bool use = true;
-                    if (_preLoopSwitch &&
-                        ((_iEvt ==
-                          _maxValuePos[iDetector + detectorOffset][iPixel]) ||
-                         (_iEvt ==
-                          _minValuePos[iDetector + detectorOffset][iPixel]))) {
-                      use = false;
-                    }
-                    if (use) {
-                      stringstream ss;
-                      ss << _tempProfile2DName << "_d"
-                         << _orderedSensorIDVec.at(iDetector + detectorOffset);
-                      (dynamic_cast<AIDA::IProfile2D *>(
-                           _aidaHistoMap[ss.str()]))
-                          ->fill(static_cast<double>(xPixel),
-                                 static_cast<double>(yPixel), pedeCorrected);
-                    }
-#endif
-                  }
-                }
+              bool use = true;
+              if (_preLoopSwitch &&
+                  ((_iEvt ==
+                    _maxValuePos[iDetector + detectorOffset][iPixel]) ||
+                   (_iEvt ==
+                    _minValuePos[iDetector + detectorOffset][iPixel]))) {
+                use = false;
+              }
+              if (use) {
+                stringstream ss;
+                ss << _tempProfile2DName << "_d"
+                   << _orderedSensorIDVec.at(iDetector + detectorOffset);
+                (dynamic_cast<AIDA::IProfile2D *>(
+                     _aidaHistoMap[ss.str()]))
+                    ->fill(static_cast<double>(xPixel),
+                           static_cast<double>(yPixel), pedeCorrected);
               }
-              ++iPixel;
+#endif
             }
           }
-        } else {
-          if (_commonModeAlgo == EUTELESCOPE::FULLFRAME) {
-            streamlog_out(WARNING2)
-                << "Skipping event " << _iEvt
-                << " because of max number of rejected pixels exceeded. ("
-                << skippedPixel << ") on detector "
-                << _orderedSensorIDVec.at(iDetector) << endl;
-          } else if (_commonModeAlgo == EUTELESCOPE::ROWWISE) {
-            streamlog_out(WARNING2)
-                << "Skipping event " << _iEvt
-                << " because of max number of skipped rows is reached. ("
-                << skippedRow << ") on detector "
-                << _orderedSensorIDVec.at(iDetector) << endl;
-          }
-
-          // the event has been skipped, so add this event number to the
-          // skipped list
-          _skippedEventList.push_back(_iEvt);
         }
+        ++iPixel;
       }
-    } catch (DataNotAvailableException &e) {
+    }
+  } else {
+    if (_commonModeAlgo == EUTELESCOPE::FULLFRAME) {
       streamlog_out(WARNING2)
-          << "No input collection " << _rawDataCollectionNameVec.at(iCol)
-          << " is not available in the current event" << endl;
+          << "Skipping event " << _iEvt
+          << " because of max number of rejected pixels exceeded. ("
+          << skippedPixel << ") on detector "
+          << _orderedSensorIDVec.at(iDetector) << endl;
+    } else if (_commonModeAlgo == EUTELESCOPE::ROWWISE) {
+      streamlog_out(WARNING2)
+          << "Skipping event " << _iEvt
+          << " because of max number of skipped rows is reached. ("
+          << skippedRow << ") on detector "
+          << _orderedSensorIDVec.at(iDetector) << endl;
     }
+
+    // the event has been skipped, so add this event number to the
+    // skipped list
+    _skippedEventList.push_back(_iEvt);
   }
-  ++_iEvt;
 }
 
 void EUTelPedestalNoiseProcessor::bookHistos() {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  if (!_histogramSwitch)
+    return;
+
   // histograms are grouped in loops and detectors
   streamlog_out(MESSAGE2) << "Booking histograms " << endl;
 
@@ -2038,6 +2064,9 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
 
     lcWriter->close();
 
+    // the cached frames are not needed anymore
+    _frameCache.clear();
+
     throw StopProcessingException(this);
     setReturnValue("IsPedestalFinished", true);
 
@@ -2080,6 +2109,10 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
 #endif
     }
     setReturnValue("IsPedestalFinished", false);
+    if (_frameCache.isValid()) {
+      replayFrameCache();
+      return;
+    }
     throw RewindDataFilesException(this);
   } else if ((_additionalMaskingLoop) && (_iLoop == _noOfCMIterations + 1)) {
     // additional loop!
@@ -2087,6 +2120,10 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
     // so reset the event counter
     _iEvt = 0;
     setReturnValue("IsPedestalFinished", false);
+    if (_frameCache.isValid()) {
+      replayFrameCache();
+      return;
+    }
     throw RewindDataFilesException(this);
   }
 }
@@ -2104,7 +2141,8 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent *event) {
     throw SkipEventException(this);
   }
 
-  if (*_nextEventToSkip == _iEvt) {
+  if ((_nextEventToSkip != _skippedEventList.end()) &&
+      (*_nextEventToSkip == _iEvt)) {
     streamlog_out(MESSAGE4)
         << "Event " << _iEvt
         << " is skipped because labelled bad by the common mode procedure."
@@ -2129,38 +2167,9 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent *event) {
         // get the TrackerRawData object from the collection for this detector
         TrackerRawData *trackerRawData = dynamic_cast<TrackerRawData *>(
             collectionVec->getElementAt(iDetector));
-        ShortVec adcValues = trackerRawData->getADCValues();
-        for (unsigned int iPixel = 0; iPixel < adcValues.size(); iPixel++) {
-          if (_status[iDetector + detectorOffset][iPixel] ==
-              EUTELESCOPE::GOODPIXEL) {
-            float correctedValue =
-                adcValues[iPixel] -
-                _pedestal[iDetector + detectorOffset][iPixel];
-            float threshold = _noise[iDetector + detectorOffset][iPixel] * 3.0;
-#if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
-            if (_histogramSwitch && iPixel == 1 + (adcValues.size() / 10)) {
-              string tempHistoName = _aPixelHistoName + "_d" +
-                                     to_string(_orderedSensorIDVec.at(
-                                         iDetector + detectorOffset)) +
-                                     "_l" + to_string(_iLoop);
-              if (AIDA::IHistogram1D *histo =
-                      dynamic_cast<AIDA::IHistogram1D *>(
-                          _aidaHistoMap[tempHistoName]))
-                histo->fill(correctedValue);
-              else {
-                streamlog_out(ERROR1)
-                    << "Not able to retrieve histogram pointer for "
-                    << tempHistoName
-                    << ".\nDisabling histogramming from now on " << endl;
-                _histogramSwitch = false;
-              }
-            }
-#endif
-            if (correctedValue > threshold) {
-              _hitCounter[iDetector + detectorOffset][iPixel]++;
-            }
-          }
-        }
+        const ShortVec &adcValues = trackerRawData->getADCValues();
+        maskingLoopDetector(iDetector, detectorOffset, adcValues.data(),
+                            adcValues.size());
       }
     } catch (DataNotAvailableException &e) {
       streamlog_out(WARNING2)
@@ -2171,6 +2180,156 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent *event) {
   }
 }
 
+void EUTelPedestalNoiseProcessor::maskingLoopDetector(size_t iDetector,
+                                                      size_t detectorOffset,
+                                                      const short *adcValues,
+                                                      size_t nPixel) {
+
+  for (unsigned int iPixel = 0; iPixel < nPixel; iPixel++) {
+    if (_status[iDetector + detectorOffset][iPixel] ==
+        EUTELESCOPE::GOODPIXEL) {
+      float correctedValue =
+          adcValues[iPixel] -
+          _pedestal[iDetector + detectorOffset][iPixel];
+      float threshold = _noise[iDetector + detectorOffset][iPixel] * 3.0;
+#if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
+      if (_histogramSwitch && iPixel == 1 + (nPixel / 10)) {
+        string tempHistoName = _aPixelHistoName + "_d" +
+                               to_string(_orderedSensorIDVec.at(
+                                   iDetector + detectorOffset)) +
+                               "_l" + to_string(_iLoop);
+        if (AIDA::IHistogram1D *histo =
+                dynamic_cast<AIDA::IHistogram1D *>(
+                    _aidaHistoMap[tempHistoName]))
+          histo->fill(correctedValue);
+        else {
+          streamlog_out(ERROR1)
+              << "Not able to retrieve histogram pointer for "
+              << tempHistoName
+              << ".\nDisabling histogramming from now on " << endl;
+          _histogramSwitch = false;
+        }
+      }
+#endif
+      if (correctedValue > threshold) {
+        _hitCounter[iDetector + detectorOffset][iPixel]++;
+      }
+    }
+  }
+}
+
+void EUTelPedestalNoiseProcessor::initFrameCache() {
+
+  _frameCache.clear();
+  if (_frameCacheSize <= 0)
+    return;
+
+  vector<size_t> frameSizes;
+  for (size_t iDetector = 0; iDetector < _status.size(); ++iDetector) {
+    frameSizes.push_back(_status[iDetector].size());
+  }
+  _frameCache.configure(frameSizes, static_cast<size_t>(_frameCacheSize)
+                                        << 20);
+
+  streamlog_out(MESSAGE4) << "Caching up to " << _frameCacheSize
+                          << " MB of raw frames ("
+                          << _frameCache.getEventSize() << " bytes per event)"
+                          << endl;
+}
+
+void EUTelPedestalNoiseProcessor::cacheFrames(LCEvent *evt) {
+
+  if (_frameCache.getStatus() != EUTelFrameCache::kValid)
+    return;
+
+  size_t noOfCachedEvents = _frameCache.getNEvents();
+  if (!_frameCache.beginEvent()) {
+    streamlog_out(WARNING2)
+        << "The raw frames exceed the FrameCacheSize of " << _frameCacheSize
+        << " MB after " << noOfCachedEvents << " events.\n"
+        << "Falling back to rewinding the input files." << endl;
+    return;
+  }
+
+  for (size_t iCol = 0; iCol < _rawDataCollectionNameVec.size(); ++iCol) {
+    try {
+      LCCollectionVec *collectionVec = dynamic_cast<LCCollectionVec *>(
+          evt->getCollection(_rawDataCollectionNameVec.at(iCol)));
+      size_t detectorOffset = (iCol == 0) ? 0 : _noOfDetectorVec.at(iCol - 1);
+      for (size_t iDetector = 0; iDetector < collectionVec->size();
+           ++iDetector) {
+        TrackerRawData *trackerRawData = dynamic_cast<TrackerRawData *>(
+            collectionVec->getElementAt(iDetector));
+        _frameCache.fill(iDetector + detectorOffset,
+                         trackerRawData->getADCValues());
+      }
+    } catch (DataNotAvailableException &e) {
+      _frameCache.invalidate();
+    }
+  }
+
+  if (!_frameCache.isValid()) {
+    _frameCache.invalidate();
+    streamlog_out(WARNING2)
+        << "The raw frames of event " << evt->getEventNumber()
+        << " do not match the first event and cannot be cached.\n"
+        << "Falling back to rewinding the input files." << endl;
+  }
+}
+
+void EUTelPedestalNoiseProcessor::replayFrameCache() {
+
+  bool fromMaskingLoop =
+      (_additionalMaskingLoop) && (_iLoop == _noOfCMIterations + 1);
+
+  streamlog_out(MESSAGE4) << "Loop " << _iLoop << " on "
+                          << _frameCache.getNEvents() << " cached events"
+                          << endl;
+
+  // this is what happens in processRunHeader and with the events
+  // before FirstEvent when the input files are rewound
+  ++_iRun;
+  _iEvt = max(_firstEvent, 0);
+
+  for (size_t iEvent = 0; iEvent < _frameCache.getNEvents(); ++iEvent) {
+
+    if ((_lastEvent != -1) && (_iEvt >= _lastEvent))
+      break;
+
+    if (fromMaskingLoop && (_nextEventToSkip != _skippedEventList.end()) &&
+        (*_nextEventToSkip == _iEvt)) {
+      streamlog_out(MESSAGE4)
+          << "Event " << _iEvt
+          << " is skipped because labelled bad by the common mode procedure."
+          << endl;
+      ++_nextEventToSkip;
+      continue;
+    }
+
+    for (size_t iCol = 0; iCol < _rawDataCollectionNameVec.size(); ++iCol) {
+      size_t detectorOffset = (iCol == 0) ? 0 : _noOfDetectorVec.at(iCol - 1);
+      for (size_t iDetector = 0; iDetector < _noOfDetectorVec.at(iCol);
+           ++iDetector) {
+        size_t iPlane = iDetector + detectorOffset;
+        if (fromMaskingLoop)
+          maskingLoopDetector(iDetector, detectorOffset,
+                              _frameCache.getFrame(iPlane, iEvent),
+                              _frameCache.getFrameSize(iPlane));
+        else
+          otherLoopDetector(iDetector, detectorOffset,
+                            _frameCache.getFrame(iPlane, iEvent));
+      }
+      // the masking loop counts the collections, not the events
+      if (fromMaskingLoop)
+        ++_iEvt;
+    }
+    if (!fromMaskingLoop)
+      ++_iEvt;
+  }
+
+  finalizeProcessor(fromMaskingLoop);
+}
+
 void EUTelPedestalNoiseProcessor::setBadPixelAlgoSwitches() {
 
   if (find(_badPixelAlgoVec.begin(), _badPixelAlgoVec.end(),
@@ -50,6 +50,8 @@ EUTelProcessorAnalysisPALPIDEfs::EUTelProcessorAnalysisPALPIDEfs()
       _noiseMaskAvailable(true), _deadColumnAvailable(true), chi2Max(1),
       _nEvents(0), _nEventsFake(5), _nEventsWithTrack(0), _minTimeStamp(0),
       _nSectors(8), _chipVersion(3), _showFake(true), _realAssociation(false),
+      _trackHitAssignment(), _clusterShape(), _dutFrameHits(),
+      _fakeFrameHits(), _dutHitGrid(), _fakeHitGrid(), _neighbourHits(),
       nTracks(8), nTracksFake(8), nTracksPAlpide(8), nTracksPAlpideFake(8),
       nTracksAssociation(8), nTracksPAlpideAssociation(8), nFakeWithTrack(8, 0),
       nFakeWithoutTrack(8, 0), nFake(8, 0), nFakeWithTrackCorrected(8, 0),
@@ -577,6 +579,35 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
     }
   }
 
+  // Hits in the DUT frame
+  // ========================================================================
+  // Transformed once here instead of for every track, and sorted into grids
+  // to find the hits close to a track without looping over all of them.
+  _dutFrameHits.clear();
+  _dutHitGrid.reset(limit);
+  for (int ihit = 0; ihit < col->getNumberOfElements(); ihit++) {
+    TrackerHit *hit = dynamic_cast<TrackerHit *>(col->getElementAt(ihit));
+    DUTFrameHit frameHit = {false, 0., 0., 0.};
+    if (hit != nullptr)
+      frameHit = _toDUTFrame(hit->getPosition());
+    _dutFrameHits.push_back(frameHit);
+    if (frameHit.inDUT)
+      _dutHitGrid.addHit(ihit, frameHit.x, frameHit.y);
+  }
+  _dutHitGrid.build();
+
+  if (_showFake) {
+    _fakeFrameHits.clear();
+    _fakeHitGrid.reset(limit);
+    for (size_t ihit = 0; ihit < posFakeTemp.size(); ihit++) {
+      DUTFrameHit frameHit = _toDUTFrame(posFakeTemp[ihit].data());
+      _fakeFrameHits.push_back(frameHit);
+      if (frameHit.inDUT)
+        _fakeHitGrid.addHit(static_cast<int>(ihit), frameHit.x, frameHit.y);
+    }
+    _fakeHitGrid.build();
+  }
+
   // FITTED HIT LOOP
   // ===============================================================================
   bool firstTrack = true;
@@ -797,25 +828,16 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
           TrackerHit *hit = dynamic_cast<TrackerHit *>(col->getElementAt(ihit));
           double pos[3] = {0., 0., 0.};
           if (hit != nullptr) {
-            const double *pos0 = hit->getPosition();
-            pos[0] = pos0[0];
-            pos[1] = pos0[1];
-            pos[2] = pos0[2];
-
             // Hit in the DUT?
-            if (pos[2] >= dutZ - zDistance && pos[2] <= dutZ + zDistance) {
+            if (_dutFrameHits[ihit].inDUT) {
               pAlpideHit = true;
               nPAlpideHits++;
               stats->Fill(kHitInDUT);
 
-              // Determine position of the hit on the DUT
-              pos[0] -= xZero;
-              pos[1] -= yZero;
-              _EulerRotationBack(pos, gRotation);
-
-              double xpos = 0.;
-              double ypos = 0.;
-              _LayerRotationBack(pos, xpos, ypos);
+              // Position of the hit on the DUT
+              double xpos = _dutFrameHits[ihit].x;
+              double ypos = _dutFrameHits[ihit].y;
+              pos[2] = _dutFrameHits[ihit].z;
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
               if (!hitmapFilled)
@@ -839,42 +861,25 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
               if (abs(xpos - xposfit) < limit && abs(ypos - yposfit) < limit) {
                 nAssociatedhits++;
                 stats->Fill(kAssociatedHitInDUT);
-                for (int jhit = ihit + 1; jhit < nHit; jhit++) {
-                  TrackerHit *hitNext =
-                      dynamic_cast<TrackerHit *>(col->getElementAt(jhit));
-                  double posNext[3] = {0., 0., 0.};
-                  if (hitNext != nullptr) {
-                    const double *pos0Next = hitNext->getPosition();
-                    posNext[0] = pos0Next[0];
-                    posNext[1] = pos0Next[1];
-                    posNext[2] = pos0Next[2];
-                    if (posNext[2] < dutZ - zDistance ||
-                        posNext[2] > dutZ + zDistance)
-                      continue;
-                    posNext[0] -= xZero;
-                    posNext[1] -= yZero;
-
-                    _EulerRotationBack(posNext, gRotation);
-
-                    double xposNext, yposNext;
-                    _LayerRotationBack(posNext, xposNext, yposNext);
-
-                    if (abs(xposNext - xposfit) > limit ||
-                        abs(yposNext - yposfit) > limit)
-                      continue;
-                    nAssociatedhits++;
-                    if ((xpos - xposfit) * (xpos - xposfit) +
-                            (ypos - yposfit) * (ypos - yposfit) <
-                        (xposNext - xposfit) * (xposNext - xposfit) +
-                            (yposNext - yposfit) * (yposNext - yposfit)) {
-                      ihit = jhit;
-                    } else {
-                      xpos = xposNext;
-                      ypos = yposNext;
-                      pos[2] = posNext[2];
-                      hit = hitNext;
-                      ihit = jhit;
-                    }
+                // all following DUT hits close to the track, the closest
+                // one is taken, the hit loop goes on behind the last one
+                _dutHitGrid.find(xposfit, yposfit, _neighbourHits);
+                for (int jhit : _neighbourHits) {
+                  if (jhit <= ihit)
+                    continue;
+                  const DUTFrameHit &next = _dutFrameHits[jhit];
+                  nAssociatedhits++;
+                  if ((xpos - xposfit) * (xpos - xposfit) +
+                          (ypos - yposfit) * (ypos - yposfit) <
+                      (next.x - xposfit) * (next.x - xposfit) +
+                          (next.y - yposfit) * (next.y - yposfit)) {
+                    ihit = jhit;
+                  } else {
+                    xpos = next.x;
+                    ypos = next.y;
+                    pos[2] = next.z;
+                    hit = dynamic_cast<TrackerHit *>(col->getElementAt(jhit));
+                    ihit = jhit;
                   }
                 }
                 if (nDUThitsEvent > 1 && nAssociatedhits == 1) {
@@ -909,7 +914,7 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
                       vector<int> Y(clusterSize);
                       Cluster cluster;
                       if (type == kEUTelGenericSparsePixel) {
-                        vector<vector<int>> pixVector;
+                        _clusterShape.clear();
                         auto sparseData = EUTelTrackerDataInterfacerImpl<
                             EUTelGenericSparsePixel>(zsData);
                         for (size_t iPixel = 0; iPixel < sparseData.size();
@@ -917,31 +922,25 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
                           auto &pixel = sparseData.at(iPixel);
                           X[iPixel] = pixel.getXCoord();
                           Y[iPixel] = pixel.getYCoord();
-                          vector<int> pix;
-                          pix.push_back(X[iPixel]);
-                          pix.push_back(Y[iPixel]);
-                          pixVector.push_back(pix);
+                          _clusterShape.addPixel(X[iPixel], Y[iPixel]);
                         }
+                        _clusterShape.build();
                         cluster.set_values(clusterSize, X, Y);
                         clusterSizeHisto[index]->Fill(clusterSize);
-                        int xMin = *min_element(X.begin(), X.end());
-                        int xMax = *max_element(X.begin(), X.end());
-                        int yMin = *min_element(Y.begin(), Y.end());
-                        int yMax = *max_element(Y.begin(), Y.end());
-                        int clusterWidthX = xMax - xMin + 1;
-                        int clusterWidthY = yMax - yMin + 1;
+                        int xMin = _clusterShape.getXMin();
+                        int yMin = _clusterShape.getYMin();
+                        int clusterWidthX = _clusterShape.getWidthX();
+                        int clusterWidthY = _clusterShape.getWidthY();
 
                         if ((clusterWidthX > 3 || clusterWidthY > 3) &&
-                            !emptyMiddle(pixVector))
-                          for (size_t iPixel = 0; iPixel < pixVector.size();
+                            !_clusterShape.hasEmptyMiddle())
+                          for (size_t iPixel = 0; iPixel < sparseData.size();
                                iPixel++)
-                            largeClusterHistos->Fill(pixVector[iPixel][0],
-                                                     pixVector[iPixel][1]);
-                        if (emptyMiddle(pixVector)) {
-                          for (size_t iPixel = 0; iPixel < pixVector.size();
+                            largeClusterHistos->Fill(X[iPixel], Y[iPixel]);
+                        if (_clusterShape.hasEmptyMiddle()) {
+                          for (size_t iPixel = 0; iPixel < sparseData.size();
                                iPixel++)
-                            circularClusterHistos->Fill(pixVector[iPixel][0],
-                                                        pixVector[iPixel][1]);
+                            circularClusterHistos->Fill(X[iPixel], Y[iPixel]);
                         }
 
                         clusterWidthXHisto[index]->Fill(clusterWidthX);
@@ -1137,7 +1136,6 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
 
             for (int ihit = 0; ihit < nHitFake; ihit++) {
               bool hitOnSamePlane = false;
-              double pos[3] = {0., 0., 0.};
               for (int j = ihit;
                    j < nHitFake && firstHitFake &&
                    nPlanesWithMoreHitsFake <= _nPlanesWithMoreHits;
@@ -1172,62 +1170,17 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
                 break;
               }
 
-              double pos0[3] = {0., 0., 0.};
-              pos0[0] = posFakeTemp.at(ihit).at(0);
-              pos0[1] = posFakeTemp.at(ihit).at(1);
-              pos0[2] = posFakeTemp.at(ihit).at(2);
-              pos[0] = pos0[0];
-              pos[1] = pos0[1];
-              pos[2] = pos0[2];
-
-              if (pos[2] >= dutZ - zDistance && pos[2] <= dutZ + zDistance) {
-                pos[0] -= xZero;
-                pos[1] -= yZero;
-                _EulerRotationBack(pos, gRotation);
-
-                double xpos, ypos;
-                _LayerRotationBack(pos, xpos, ypos);
+              if (_fakeFrameHits[ihit].inDUT) {
+                double xpos = _fakeFrameHits[ihit].x;
+                double ypos = _fakeFrameHits[ihit].y;
 
                 if (abs(xpos - xposfit) < limit &&
                     abs(ypos - yposfit) < limit) {
-                  for (int jhit = ihit + 1; jhit < nHitFake; jhit++) {
-                    double posNext[3] = {0., 0., 0.};
-                    double pos0Next[3] = {0., 0., 0.};
-                    pos0Next[0] = posFakeTemp.at(jhit).at(0);
-                    pos0Next[1] = posFakeTemp.at(jhit).at(1);
-                    pos0Next[2] = posFakeTemp.at(jhit).at(2);
-                    posNext[0] = pos0Next[0];
-                    posNext[1] = pos0Next[1];
-                    posNext[2] = pos0Next[2];
-                    if (posNext[2] < dutZ - zDistance ||
-                        posNext[2] > dutZ + zDistance)
-                      continue;
-                    posNext[0] -= xZero;
-                    posNext[1] -= yZero;
-
-                    _EulerRotationBack(posNext, gRotation);
-
-                    double xposNext, yposNext;
-                    _LayerRotationBack(posNext, xposNext, yposNext);
-
-                    if (abs(xposNext - xposfit) > limit ||
-                        abs(yposNext - yposfit) > limit)
-                      continue;
-                    if ((xpos - xposfit) * (xpos - xposfit) +
-                            (ypos - yposfit) * (ypos - yposfit) <
-                        (xposNext - xposfit) * (xposNext - xposfit) +
-                            (yposNext - yposfit) * (yposNext - yposfit)) {
-                      ihit = jhit;
-                    } else {
-                      xpos = xposNext;
-                      ypos = yposNext;
-                      pos[2] = posNext[2];
-                      pos0[0] = pos0Next[0];
-                      pos0[1] = pos0Next[1];
-                      pos0[2] = pos0Next[2];
-                      ihit = jhit;
-                    }
-                  }
+                  // the hit loop goes on behind the last following hit
+                  // close to the track
+                  _fakeHitGrid.find(xposfit, yposfit, _neighbourHits);
+                  if (!_neighbourHits.empty() && _neighbourHits.back() > ihit)
+                    ihit = _neighbourHits.back();
                   nTracksPAlpideFake[index]++;
                 }
               } else
@@ -1349,7 +1302,6 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
           int clusterSize = zsData->getChargeValues().size() / 4;
           vector<int> X(clusterSize);
           vector<int> Y(clusterSize);
-          vector<vector<int>> pixVector;
           auto sparseData =
               EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(zsData);
           for (size_t iPixel = 0; iPixel < sparseData.size(); iPixel++) {
@@ -1446,75 +1398,39 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
         }
       }
     }
-    std::vector<int> aTFinal(nT);
-    std::vector<int> aHFinal(nH);
+    std::vector<int> aTFinal(aT);
     std::vector<int> order;
     for (int iT = 0; iT < nT; iT++) {
       if (aT[iT] == -1)
         order.push_back(iT);
     }
     if (order.size() > 0) {
-      unsigned int maxAssociations = 0;
-      double minDistance = 1e10;
-      bool run1 = true;
-      do {
-        double totaldistance = 0;
-        unsigned int associations = 0;
-        std::vector<int> aTTemp(nT);
-        std::vector<int> aHTemp(nH);
-        for (int iT = 0; iT < nT; iT++)
-          aTTemp[iT] = aT[iT];
-        for (int iH = 0; iH < nH; iH++)
-          aHTemp[iH] = aH[iH];
-        bool run2 = true;
-        for (unsigned int i = 0; i < order.size() && run2; i++) {
-          int iT = order[i];
-          double min = 1e10;
-          bool associated = false;
-          for (int iH = 0; iH < nH; iH++) {
-            if (aHTemp[iH] == -1) {
-              if (abs(pH.at(iH).at(0) - pT.at(iT).at(0)) < limit &&
-                  abs(pH.at(iH).at(1) - pT.at(iT).at(1)) < limit) {
-                double dist =
-                    sqrt(pow(abs(pH.at(iH).at(0) - pT.at(iT).at(0)), 2) +
-                         pow(abs(pH.at(iH).at(1) - pT.at(iT).at(1)), 2));
-                if (dist < min) {
-                  min = dist;
-                  temp = iH;
-                  associated = true;
-                }
-              }
-            }
-          }
-          if (associated) {
-            associations++;
-            aHTemp[temp] = iT;
-            aTTemp[iT] = temp;
-            totaldistance += min;
-          }
-          if (totaldistance > minDistance)
-            run2 = false;
-          if ((i - associations + 1) > (order.size() - maxAssociations))
-            run2 = false;
-        }
-        if (associations == order.size())
-          run1 = false;
-        if (associations >= maxAssociations) {
-          if (totaldistance < minDistance) {
-            for (int iT = 0; iT < nT; iT++)
-              aTFinal[iT] = aTTemp[iT];
-            for (int iH = 0; iH < nH; iH++)
-              aHFinal[iH] = aHTemp[iH];
-            maxAssociations = associations;
-            minDistance = totaldistance;
+      // The remaining tracks compete for the free hits: take the association
+      // with the most pairs and, among those, the smallest total distance
+      std::vector<int> freeHits;
+      for (int iH = 0; iH < nH; iH++) {
+        if (aH[iH] == -1)
+          freeHits.push_back(iH);
+      }
+      std::vector<double> distances(order.size() * freeHits.size(), -1.);
+      for (size_t i = 0; i < order.size(); i++) {
+        int iT = order[i];
+        for (size_t j = 0; j < freeHits.size(); j++) {
+          int iH = freeHits[j];
+          if (abs(pH.at(iH).at(0) - pT.at(iT).at(0)) < limit &&
+              abs(pH.at(iH).at(1) - pT.at(iT).at(1)) < limit) {
+            distances[i * freeHits.size() + j] =
+                sqrt(pow(abs(pH.at(iH).at(0) - pT.at(iT).at(0)), 2) +
+                     pow(abs(pH.at(iH).at(1) - pT.at(iT).at(1)), 2));
           }
         }
-      } while (std::next_permutation(order.begin(), order.end()) && run1);
-    } else {
-      for (int iT = 0; iT < nT; iT++)
-        aTFinal[iT] = aT[iT];
-      for (int iH = 0; iH < nH; iH++)
-        aHFinal[iH] = aH[iH];
+      }
+      _trackHitAssignment.solve(distances, order.size(), freeHits.size());
+      for (size_t i = 0; i < order.size(); i++) {
+        int hit = _trackHitAssignment.getHit(i);
+        if (hit >= 0)
+          aTFinal[order[i]] = freeHits[hit];
+      }
     }
     for (int iT = 0; iT < nT; iT++) {
       int index = -1;
@@ -2404,121 +2320,18 @@ int EUTelProcessorAnalysisPALPIDEfs::AddressToRow(int AAddress) {
   return Row;
 }
 
-bool EUTelProcessorAnalysisPALPIDEfs::emptyMiddle(
-    vector<vector<int>> pixVector) {
-
-  // In this step we use an invers clustering process:
-  // - First, we create a rectangle, which is bigger than the cluster in every
-  // direction.
-  // - Second, we fill the hitPixelVec with pixels in this rectangle, which did
-  // not fired.
-  // - Third, we run the clustering process with this hitPixelVec.
-  // - Fourth, when this process finds one whole cluster and hitPixelVec is
-  // still not empty, the original cluster has to have an empty middle, since at
-  // least two cluster could be made from the empty part (one on the outside and
-  // at least one in the middle of the cluster).
-
-  std::vector<EUTelGenericSparsePixel> hitPixelVec;
-
-  std::vector<EUTelGenericSparsePixel> newlyAdded;
-
-  int xMax = 0, yMax = 0, xMin = 1000000, yMin = 1000000;
-
-  for (size_t i = 0; i < pixVector.size(); i++) {
-    if (pixVector[i][0] > xMax)
-      xMax = pixVector[i][0];
-    if (pixVector[i][0] < xMin)
-      xMin = pixVector[i][0];
-    if (pixVector[i][1] > yMax)
-      yMax = pixVector[i][1];
-    if (pixVector[i][1] < yMin)
-      yMin = pixVector[i][1];
-  }
-  for (int n = xMin - 1; n <= xMax + 1; n++) {
-    for (int m = yMin - 1; m <= yMax + 1; m++) {
-      bool empty_pixel = true;
-      for (size_t i = 0; i < pixVector.size(); i++) {
-        if (n == pixVector[i][0] && m == pixVector[i][1]) {
-          empty_pixel = false;
-          break;
-        }
-      }
-      if (empty_pixel) {
-        EUTelGenericSparsePixel pixel;
-        pixel.setXCoord(n);
-        pixel.setYCoord(m);
-        hitPixelVec.push_back(pixel);
-      }
-    }
-  }
-
-  // We now cluster those hits together
-  // while( !hitPixelVec.empty() )
-  {
-
-    std::vector<EUTelGenericSparsePixel> cluCandidate;
-
-    // First we need to take any pixel, so let's take the first one
-    // Add it to the cluster as well as the newly added pixels
-    newlyAdded.push_back(hitPixelVec.front());
-    // sparseCluster->push_back( &(hitPixelVec.front()) );
-    cluCandidate.push_back(hitPixelVec.front());
-    // And remove it from the original collection
-    hitPixelVec.erase(hitPixelVec.begin());
-
-    // Now process all newly added pixels, initially this is the just previously
-    // added one
-    // but in the process of neighbour finding we continue to add new pixels
-    while (!newlyAdded.empty()) {
-      bool newlyDone = true;
-      int x1, x2, y1, y2, dX, dY;
-
-      // check against all pixels in the hitPixelVec
-      for (std::vector<EUTelGenericSparsePixel>::iterator hitVec =
-               hitPixelVec.begin();
-           hitVec != hitPixelVec.end(); ++hitVec) {
-        // get the relevant infos from the newly added pixel
-        x1 = newlyAdded.front().getXCoord();
-        y1 = newlyAdded.front().getYCoord();
-
-        // and the pixel we test against
-        x2 = hitVec->getXCoord();
-        y2 = hitVec->getYCoord();
-
-        dX = x1 - x2;
-        dY = y1 - y2;
-        int distance = dX * dX + dY * dY;
-        // if they pass the spatial and temporal cuts, we add them
-
-        int _sparseMinDistanceSquaredComparison = 1;
-        if (distance <= _sparseMinDistanceSquaredComparison) {
-          // add them to the cluster as well as to the newly added ones
-          newlyAdded.push_back(*hitVec);
-          cluCandidate.push_back(*hitVec);
-          //	sparseCluster->push_back( &(*hitVec) );
-          hitPixelVec.erase(hitVec);
-          // for the pixel we test there might be other neighbours, we still
-          // have to check
-          newlyDone = false;
-          break;
-        }
-      }
-      // if no neighbours are found, we can delete the pixel from the newly
-      // added
-      // we tested against _ALL_ non cluster pixels, there are no other pixels
-      // which could be neighbours
-      if (newlyDone) {
-        newlyAdded.erase(newlyAdded.begin());
-      }
-    }
-  }
-  // If the hitPixelVec is not empty there is a empty middle cluster, because
-  // there must be an area inside the cluster, which is not connected to the
-  // area outside the cluster.
-  if (!hitPixelVec.empty())
-    return true;
-  else
-    return false;
+EUTelProcessorAnalysisPALPIDEfs::DUTFrameHit
+EUTelProcessorAnalysisPALPIDEfs::_toDUTFrame(const double *position) {
+  DUTFrameHit frameHit = {false, 0., 0., 0.};
+  if (!(position[2] >= dutZ - zDistance && position[2] <= dutZ + zDistance))
+    return frameHit;
+
+  double pos[3] = {position[0] - xZero, position[1] - yZero, position[2]};
+  _EulerRotationBack(pos, gRotation);
+  _LayerRotationBack(pos, frameHit.x, frameHit.y);
+  frameHit.z = pos[2];
+  frameHit.inDUT = true;
+  return frameHit;
 }
 
 bool EUTelProcessorAnalysisPALPIDEfs::RemoveAlign(
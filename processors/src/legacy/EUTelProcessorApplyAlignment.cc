@@ -64,7 +64,9 @@ EUTelProcessorApplyAlign::EUTelProcessorApplyAlign()
     : Processor("EUTelProcessorApplyAlignment"), _inputHitCollectionName("hit"),
       _alignmentCollectionName("alignment"),
       _outputHitCollectionName("correctedHit"), _correctionMethod(0), _iRun(0),
-      _iEvt(0), _lookUpTable() {
+      _iEvt(0), _undoAlignment(false), _alignmentTransforms(),
+      _transformsReady(false), _hitSensorIDs(), _hitOrder(),
+      _sortedPositions(), _transformedPositions() {
   _description = "Apply alignment constants to hit collection";
 
   registerInputCollection(LCIO::TRACKERHIT, "InputHitCollectionName",
@@ -76,6 +78,9 @@ EUTelProcessorApplyAlign::EUTelProcessorApplyAlign()
   registerOutputCollection(LCIO::TRACKERHIT, "OutputHitCollectionName",
                            "The name of the output hit collection",
                            _outputHitCollectionName, string("correctedHit"));
+  registerOptionalParameter("UndoAlignment",
+                            "Set to true to undo the alignment instead",
+                            _undoAlignment, false);
 }
 
 void EUTelProcessorApplyAlign::init() {
@@ -93,7 +98,7 @@ void EUTelProcessorApplyAlign::init() {
     exit(-1);
   }
 
-  _isFirstEvent = true;
+  _transformsReady = false;
 }
 
 void EUTelProcessorApplyAlign::processRunHeader(LCRunHeader *rdr) {
@@ -101,6 +106,9 @@ void EUTelProcessorApplyAlign::processRunHeader(LCRunHeader *rdr) {
       std::make_unique<EUTelRunHeaderImpl>(rdr);
   runHeader->addProcessor(type());
   ++_iRun;
+
+  // the alignment constants may change with the run
+  _transformsReady = false;
 }
 
 void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
@@ -125,38 +133,101 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
     LCCollectionVec *alignmentCollectionVec = dynamic_cast<LCCollectionVec *>(
         evt->getCollection(_alignmentCollectionName));
 
-    if (_isFirstEvent) {
+    if (!_transformsReady) {
       streamlog_out(MESSAGE5) << "The alignment collection contains: "
                               << alignmentCollectionVec->size() << " planes "
                               << endl;
 
+      // one affine transformation per sensor, with the rotations around
+      // the plane center
+      _alignmentTransforms.clear();
       for (size_t iPos = 0; iPos < alignmentCollectionVec->size(); ++iPos) {
         EUTelAlignmentConstant *alignment =
             static_cast<EUTelAlignmentConstant *>(
                 alignmentCollectionVec->getElementAt(iPos));
-        _lookUpTable[alignment->getSensorID()] = iPos;
-      }
-
-      map<int, int>::iterator mapIter = _lookUpTable.begin();
-      for (; mapIter != _lookUpTable.end(); mapIter++) {
-        streamlog_out(MESSAGE5) << "Sensor ID = " << mapIter->first
-                                << " is in position " << mapIter->second
-                                << endl;
+        const int sensorID = alignment->getSensorID();
+        const double zPlaneThickness = geo::gGeometry().getPlaneZSize(sensorID);
+        const double planeCenter[3] = {
+            geo::gGeometry().getPlaneXPosition(sensorID),
+            geo::gGeometry().getPlaneYPosition(sensorID),
+            geo::gGeometry().getPlaneZPosition(sensorID) +
+                zPlaneThickness / 2.};
+        _alignmentTransforms.set(
+            sensorID, planeCenter, alignment->getXOffset(),
+            alignment->getYOffset(), alignment->getZOffset(),
+            alignment->getAlpha(), alignment->getBeta(),
+            alignment->getGamma());
+
+        streamlog_out(MESSAGE5) << "Sensor ID = " << sensorID
+                                << " is in position " << iPos << endl;
       }
-      _isFirstEvent = false;
+      _transformsReady = true;
     }
 
     LCCollectionVec *outputCollectionVec =
         new LCCollectionVec(LCIO::TRACKERHIT);
     UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
 
-    for (size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
-      TrackerHitImpl *inputHit = dynamic_cast<TrackerHitImpl *>(
+    // group the hits by sensor, keeping their order within a sensor
+    const size_t nHits = inputCollectionVec->size();
+    _hitSensorIDs.resize(nHits);
+    _hitOrder.resize(nHits);
+    for (size_t iHit = 0; iHit < nHits; iHit++) {
+      TrackerHitImpl *inputHit = static_cast<TrackerHitImpl *>(
           inputCollectionVec->getElementAt(iHit));
-      // now we have to understand which layer this hit belongs to.
+      _hitSensorIDs[iHit] = hitDecoder(inputHit)["sensorID"];
+      _hitOrder[iHit] = iHit;
+    }
+    std::stable_sort(_hitOrder.begin(), _hitOrder.end(),
+                     [this](size_t a, size_t b) {
+                       return _hitSensorIDs[a] < _hitSensorIDs[b];
+                     });
+
+    _sortedPositions.resize(3 * nHits);
+    for (size_t i = 0; i < nHits; i++) {
+      const double *inputPosition =
+          static_cast<TrackerHitImpl *>(
+              inputCollectionVec->getElementAt(_hitOrder[i]))
+              ->getPosition();
+      std::copy(inputPosition, inputPosition + 3,
+                _sortedPositions.begin() + 3 * i);
+    }
 
-      UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
-      const int sensorID = hitDecoder(inputHit)["sensorID"];
+    // apply the transformation of each sensor to its contiguous
+    // positions
+    for (size_t first = 0; first < nHits;) {
+      const int sensorID = _hitSensorIDs[_hitOrder[first]];
+      size_t last = first + 1;
+      while (last < nHits && _hitSensorIDs[_hitOrder[last]] == sensorID)
+        ++last;
+
+      if (_alignmentTransforms.has(sensorID)) {
+        _alignmentTransforms.apply(sensorID, &_sortedPositions[3 * first],
+                                   &_sortedPositions[3 * first], last - first,
+                                   _undoAlignment);
+      } else {
+        // these hits belong to a plane whose sensorID is not in the
+        // alignment constants. So the idea is to eventually advice
+        // the users if running in DEBUG and copy the not aligned hits
+        // in the new collection.
+        streamlog_out(DEBUG5) << "Sensor ID " << sensorID
+                              << " not found. Skipping alignment for "
+                              << last - first << " hits" << endl;
+      }
+      first = last;
+    }
+
+    // back to the original hit order
+    _transformedPositions.resize(3 * nHits);
+    for (size_t i = 0; i < nHits; i++) {
+      std::copy(_sortedPositions.begin() + 3 * i,
+                _sortedPositions.begin() + 3 * (i + 1),
+                _transformedPositions.begin() + 3 * _hitOrder[i]);
+    }
+
+    for (size_t iHit = 0; iHit < nHits; iHit++) {
+      TrackerHitImpl *inputHit = static_cast<TrackerHitImpl *>(
+          inputCollectionVec->getElementAt(iHit));
 
       // copy the input to the output, at least for the common part
       TrackerHitImpl *outputHit = new TrackerHitImpl;
@@ -168,53 +239,13 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
       outputHit->setCellID1(inputHit->getCellID1());
       outputHit->setTime(inputHit->getTime());
 
-      // now that we know at which sensor the hit belongs to, we can
-      // get the corresponding alignment constants
-      map<int, int>::iterator positionIter = _lookUpTable.find(sensorID);
+      const double *outputPosition = &_transformedPositions[3 * iHit];
+      streamlog_out(DEBUG5)
+          << "position: " << inputHit->getPosition()[0] << ","
+          << inputHit->getPosition()[1] << "," << inputHit->getPosition()[2]
+          << " -> " << outputPosition[0] << "," << outputPosition[1] << ","
+          << outputPosition[2] << endl;
 
-      double *inputPosition = const_cast<double *>(inputHit->getPosition());
-      double outputPosition[3] = {inputPosition[0], inputPosition[1],
-                                  inputPosition[2]};
-
-      if (positionIter != _lookUpTable.end()) {
-        EUTelAlignmentConstant *alignment =
-            static_cast<EUTelAlignmentConstant *>(
-                alignmentCollectionVec->getElementAt(positionIter->second));
-        // Rotations
-        double xPlaneCenter = geo::gGeometry().getPlaneXPosition(sensorID);
-        double yPlaneCenter = geo::gGeometry().getPlaneYPosition(sensorID);
-        double zPlaneThickness = geo::gGeometry().getPlaneZSize(sensorID);
-        double zPlaneCenter =
-            geo::gGeometry().getPlaneZPosition(sensorID) + zPlaneThickness / 2.;
-
-        TVector3 inputVec(inputPosition[0] - xPlaneCenter,
-                          inputPosition[1] - yPlaneCenter,
-                          inputPosition[2] - zPlaneCenter);
-        inputVec.RotateX(-alignment->getAlpha());
-        inputVec.RotateY(-alignment->getBeta());
-        inputVec.RotateZ(-alignment->getGamma());
-
-        outputPosition[0] = inputVec.X() + xPlaneCenter;
-        outputPosition[1] = inputVec.Y() + yPlaneCenter;
-        outputPosition[2] = inputVec.Z() + zPlaneCenter;
-        // Shifts
-        outputPosition[0] -= alignment->getXOffset();
-        outputPosition[1] -= alignment->getYOffset();
-        outputPosition[2] -= alignment->getZOffset();
-
-        streamlog_out(DEBUG5)
-            << "position: " << inputPosition[0] << "," << inputPosition[1]
-            << "," << inputPosition[2] << " -> " << outputPosition[0] << ","
-            << outputPosition[1] << "," << outputPosition[2] << endl;
-      } else {
-        // this hit belongs to a plane whose sensorID is not in the
-        // alignment constants. So the idea is to eventually advice
-        // the users if running in DEBUG and copy the not aligned hit
-        // in the new collection.
-        streamlog_out(DEBUG5) << "Sensor ID " << sensorID
-                              << " not found. Skipping alignment for hit "
-                              << iHit << endl;
-      }
       outputHit->setPosition(outputPosition);
       outputCollectionVec->push_back(outputHit);
     }
@@ -49,6 +49,7 @@
 #include <IMPL/TrackImpl.h>
 
 // system includes <>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <fstream>
@@ -117,10 +118,11 @@ EUTelTestFitter::EUTelTestFitter()
       _planeScatAngle(nullptr), _planeDist(nullptr), _planeScat(nullptr), _fitX(nullptr),
       _fitEx(nullptr), _fitY(nullptr), _fitEy(nullptr), _fitArray(nullptr),
       _nominalFitArrayX(nullptr), _nominalErrorX(nullptr), _nominalFitArrayY(nullptr),
-      _nominalErrorY(nullptr), _noOfEventWOInputHit(0), _noOfEventWOTrack(0),
+      _nominalErrorY(nullptr), _fitMatrixCache(), _fitSolver(),
+      _noOfEventWOInputHit(0), _noOfEventWOTrack(0),
       _noOfTracks(0), _aidaHistoMap(), _aidaHistoMap1D(), _aidaHistoMap2D(),
       _UseSlope(false), _SlopeXLimit(0.0), _SlopeYLimit(0.0),
-      _SlopeDistanceMax(0.0), _fittedXcorr(), _fittedYcorr(), _fittedZcorr(),
+      _SlopeDistanceMax(0.0), _predictionWindow(0.0), _fittedXcorr(), _fittedYcorr(), _fittedZcorr(),
       _indexDUTneighbour(0), _zDUTneighbour(0.0), _siPlaneCenter(),
       _siPlaneNormal() {
 
@@ -231,6 +233,11 @@ EUTelTestFitter::EUTelTestFitter()
                                                 "expected position, used for "
                                                 "hit preselection in [mm]",
                             _SlopeDistanceMax, 1.f);
+  registerOptionalParameter("PredictionWindow",
+                            "Maximum hit distance from the straight line "
+                            "through the first two hits of a hit combination, "
+                            "used for hit preselection in [um] (0 = off)",
+                            _predictionWindow, 0.f);
   // -------------------------------------------------------------------------------------------------
 
   std::vector<int> initLayerIDs;
@@ -1327,6 +1334,7 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     double choiceChi2 = -1.;
     double trackChi2 = -1.;
     int ifirst = -1;
+    int isecond = -1;
     int ilast = 0;
     int nleft = 0;
 
@@ -1343,6 +1351,12 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     int firstHitMissed = 0;
     int firstTrackSlope = 0;
 
+    // First plane with a hit outside of the prediction window around
+    // the line through the first two hits, or failing any of the cuts
+
+    int firstOutOfWindow = 0;
+    int firstRejected = 0;
+
     // If beam constraint used: assume the track should go along
     // beam direction, otherwise beam is assumed to be perpendicular
     // to the sensor plane
@@ -1408,8 +1422,34 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
             lastSlopeY = slopeY;
           }
 
+          // Distance from the straight line through the first two hits
+
+          if (_predictionWindow > 0. && isecond >= 0) {
+            double lever = (_planePosition[ipl] - _planePosition[ifirst]) /
+                           (_planePosition[isecond] - _planePosition[ifirst]);
+            double expX = _planeX[ifirst] +
+                          lever * (_planeX[isecond] - _planeX[ifirst]);
+            double expY = _planeY[ifirst] +
+                          lever * (_planeY[isecond] - _planeY[ifirst]);
+            if (abs(_planeX[ipl] - expX) > _predictionWindow / 1000. ||
+                abs(_planeY[ipl] - expY) > _predictionWindow / 1000.)
+              firstOutOfWindow = ipl;
+          }
+
+          // The cuts only depend on the hits up to this plane, so all
+          // possibilities sharing them fail as well: no need to decode
+          // the remaining planes
+
+          if (firstHitMissed > 0 || firstTrackSlope > 0 ||
+              firstOutOfWindow > 0) {
+            firstRejected = ipl;
+            break;
+          }
+
           if (ifirst < 0) {
             ifirst = ipl;
+          } else if (isecond < 0) {
+            isecond = ipl;
           }
 
           ilast = ipl;
@@ -1423,6 +1463,17 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
     }
     // End of plane loop (decoding fit hypothesis)
 
+    // Preselection added before full Chi2 calculation
+    //
+    // Cuts on distance from expected position and on track slope
+    // changes: skip all possibilities with the same hits up to the
+    // plane which failed
+
+    if (firstRejected > 0) {
+      ichoice -= _planeMod[firstRejected] - 1;
+      continue;
+    }
+
     // Check number of selected hits
     // =============================
 
@@ -1447,22 +1498,6 @@ void EUTelTestFitter::processEvent(LCEvent *event) {
       continue;
     }
 
-    // Preselection added before full Chi2 calculation
-    //
-    // Cut on distance from expected position
-
-    if (firstHitMissed > 0) {
-      ichoice -= _planeMod[firstHitMissed] - 1;
-      continue;
-    }
-
-    // Cut on track slope changes
-
-    if (firstTrackSlope > 0) {
-      ichoice -= _planeMod[firstTrackSlope] - 1;
-      continue;
-    }
-
     // Select fit method
     // "Nominal" fit only if all active planes used
 
@@ -2371,12 +2406,12 @@ double EUTelTestFitter::MatrixFit() {
     _fitEy[ipl] = _planeEy[ipl];
   }
 
-  int status = DoAnalFit(_fitX, _fitEx, _beamSlopeX);
+  int status = DoAnalFit(_fitX, _fitEx, _beamSlopeX, _useNominalResolution);
 
   if (status)
     return -1.;
 
-  status = DoAnalFit(_fitY, _fitEy, _beamSlopeY);
+  status = DoAnalFit(_fitY, _fitEy, _beamSlopeY, _useNominalResolution);
 
   if (status)
     return -1.;
@@ -2393,7 +2428,7 @@ double EUTelTestFitter::SingleFit() {
     _fitEx[ipl] = _planeEx[ipl];
   }
 
-  int status = DoAnalFit(_fitX, _fitEx, _beamSlopeX);
+  int status = DoAnalFit(_fitX, _fitEx, _beamSlopeX, _useNominalResolution);
 
   if (status)
     return -1.;
@@ -2454,11 +2489,15 @@ double EUTelTestFitter::NominalFit() {
   return chi2;
 }
 
-int EUTelTestFitter::DoAnalFit(double *pos, double *err, double slope) {
+int EUTelTestFitter::DoAnalFit(double *pos, double *err, double slope,
+                               bool nominalErrors) {
+  unsigned long long fitPattern = 0;
+
   for (int ipl = 0; ipl < _nTelPlanes; ipl++) {
-    if (_isActive[ipl] && err[ipl] > 0)
+    if (_isActive[ipl] && err[ipl] > 0) {
       err[ipl] = 1. / err[ipl] / err[ipl];
-    else
+      fitPattern |= 1ULL << (ipl % 64);
+    } else
       err[ipl] = 0.;
 
     pos[ipl] *= err[ipl];
@@ -2471,6 +2510,46 @@ int EUTelTestFitter::DoAnalFit(double *pos, double *err, double slope) {
     pos[1] += slope * _planeDist[0] * _planeScat[0];
   }
 
+  // With nominal errors the fit matrix only depends on the planes
+  // used: factorise it once, then each fit is a single solve
+
+  EUTelGaussJordan *solver = &_fitSolver;
+  bool factorised = false;
+
+  if (nominalErrors && _nTelPlanes <= 64) {
+    auto cached = _fitMatrixCache.find(fitPattern);
+    if (cached != _fitMatrixCache.end()) {
+      solver = &cached->second;
+      factorised = true;
+      if (solver->isValid())
+        std::copy(solver->getInverse().begin(), solver->getInverse().end(),
+                  _fitArray);
+    } else
+      solver = &_fitMatrixCache[fitPattern];
+  }
+
+  if (!factorised) {
+    FillFitArray(err);
+    solver->factorise(_fitArray, _nTelPlanes);
+  }
+
+  int status = 0;
+
+  if (!solver->isValid()) {
+    status = 1;
+    cerr << "Singular matrix in track fitting algorithm ! " << endl;
+    for (int ipl = 0; ipl < _nTelPlanes; ipl++)
+      err[ipl] = 0.;
+  } else {
+    solver->solve(pos);
+    for (int ipl = 0; ipl < _nTelPlanes; ipl++)
+      err[ipl] = sqrt(_fitArray[ipl + ipl * _nTelPlanes]);
+  }
+
+  return status;
+}
+
+void EUTelTestFitter::FillFitArray(const double *weight) {
   for (int ipl = 0; ipl < _nTelPlanes; ipl++) {
     for (int jpl = 0; jpl < _nTelPlanes; jpl++) {
       int imx = ipl + jpl * _nTelPlanes;
@@ -2508,7 +2587,7 @@ int EUTelTestFitter::DoAnalFit(double *pos, double *err, double slope) {
       }
 
       if (jpl == ipl) {
-        _fitArray[imx] += err[ipl];
+        _fitArray[imx] += weight[ipl];
 
         if (ipl > 0 && ipl < _nTelPlanes - 1)
           _fitArray[imx] += _planeScat[ipl] *
@@ -2533,18 +2612,6 @@ int EUTelTestFitter::DoAnalFit(double *pos, double *err, double slope) {
         _fitArray[imx] -= _planeScat[0] * _planeDist[0] * _planeDist[0];
     }
   }
-
-  int status = GaussjSolve(_fitArray, pos, _nTelPlanes);
-
-  if (status) {
-    cerr << "Singular matrix in track fitting algorithm ! " << endl;
-    for (int ipl = 0; ipl < _nTelPlanes; ipl++)
-      err[ipl] = 0.;
-  } else
-    for (int ipl = 0; ipl < _nTelPlanes; ipl++)
-      err[ipl] = sqrt(_fitArray[ipl + ipl * _nTelPlanes]);
-
-  return status;
 }
 
 double EUTelTestFitter::GetFitChi2() {
@@ -2602,105 +2669,6 @@ double EUTelTestFitter::GetFitChi2() {
   return chi2;
 }
 
-int EUTelTestFitter::GaussjSolve(double *alfa, double *beta, int n) {
-  int *ipiv;
-  int *indxr;
-  int *indxc;
-  int i, j, k;
-  int irow = 0;
-  int icol = 0;
-  double abs, big, help, pivinv;
-
-  ipiv = new int[n];
-  indxr = new int[n];
-  indxc = new int[n];
-
-  for (i = 0; i < n; i++)
-    ipiv[i] = 0;
-
-  for (i = 0; i < n; i++) {
-    big = 0.;
-    for (j = 0; j < n; j++) {
-      if (ipiv[j] == 1)
-        continue;
-      for (k = 0; k < n; k++) {
-        if (ipiv[k] != 0)
-          continue;
-        abs = fabs(alfa[n * j + k]);
-        if (abs > big) {
-          big = abs;
-          irow = j;
-          icol = k;
-        }
-      }
-    }
-    ipiv[icol]++;
-
-    if (ipiv[icol] > 1) {
-      // first clean up then bail out
-      delete[] ipiv;
-      delete[] indxr;
-      delete[] indxc;
-      return 1;
-    }
-
-    if (irow != icol) {
-      help = beta[irow];
-      beta[irow] = beta[icol];
-      beta[icol] = help;
-      for (j = 0; j < n; j++) {
-        help = alfa[n * irow + j];
-        alfa[n * irow + j] = alfa[n * icol + j];
-        alfa[n * icol + j] = help;
-      }
-    }
-    indxr[i] = irow;
-    indxc[i] = icol;
-
-    if (alfa[n * icol + icol] == 0.) {
-      // first clean up then bail out
-      delete[] ipiv;
-      delete[] indxr;
-      delete[] indxc;
-      return 1;
-    }
-
-    help = alfa[n * icol + icol];
-    pivinv = 1. / help;
-    alfa[n * icol + icol] = 1.;
-    for (j = 0; j < n; j++)
-      alfa[n * icol + j] *= pivinv;
-
-    beta[icol] *= pivinv;
-
-    for (j = 0; j < n; j++) {
-      if (j == icol)
-        continue;
-      help = alfa[n * j + icol];
-      alfa[n * j + icol] = 0.;
-      for (k = 0; k < n; k++)
-        alfa[n * j + k] -= alfa[n * icol + k] * help;
-      beta[j] -= beta[icol] * help;
-    }
-  }
-
-  for (i = n - 1; i >= 0; i--) {
-    if (indxr[i] == indxc[i])
-      continue;
-    for (j = 0; j < n; j++) {
-      help = alfa[n * j + indxr[i]];
-      alfa[n * j + indxr[i]] = alfa[n * j + indxc[i]];
-      alfa[n * j + indxc[i]] = help;
-    }
-  }
-
-  delete[] ipiv;
-  delete[] indxr;
-  delete[] indxc;
-
-  return 0;
-}
-
 void EUTelTestFitter::getImpactPoint(double &x, double &y, double &z,
                                      double &slopeX, double &slopeY,
                                      double &slopeZ) {
@@ -0,0 +1,31 @@
+#ifndef EUTELBENCHMARK_H
+#define EUTELBENCHMARK_H
+
+//STL
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Timing for the tests named DISABLED_Benchmark. runUnitTests skips
+// them, "make benchmark" runs them and nothing else.
+namespace eutelbenchmark {
+
+	// Wall-clock time of f() in milliseconds
+	template <typename F> double milliseconds(F && f) {
+		auto const start = std::chrono::steady_clock::now();
+		f();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Prints "[ BENCHMARK] what: label1 t1 ms, label2 t2 ms"
+	inline void report(std::string const & what, std::vector<std::pair<std::string, double>> const & timings) {
+		std::cout << "[ BENCHMARK] " << what << ":";
+		for(size_t i = 0; i < timings.size(); ++i) {
+			std::cout << (i ? ", " : " ") << timings[i].first << " " << timings[i].second << " ms";
+		}
+		std::cout << std::endl;
+	}
+}
+#endif
@@ -0,0 +1,178 @@
+//STL
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//LCIO
+#include <lcio.h>
+#include <IO/LCReader.h>
+#include <IO/LCWriter.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCGenericObjectImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+
+//EUTelescope
+#include "AlibavaPedNoiCalIOManager.h"
+
+using alibava::AlibavaPedNoiCalIOManager;
+
+// Writes and reads back pedestal, noise and calibration files for
+// several chips, counting the file openings of each manager.
+class AlibavaPedNoiCalIOManagerTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		filename = "test_alibavapednoical.slcio";
+		std::remove(filename.c_str());
+		generator.seed(11);
+	}
+
+	virtual void TearDown() {
+		std::remove(filename.c_str());
+	}
+
+	lcio::FloatVec makeVec(float mean) {
+		std::normal_distribution<float> value(mean, 3.f);
+		lcio::FloatVec vec(128);
+		for(auto & entry : vec) entry = value(generator);
+		return vec;
+	}
+
+	std::string filename;
+	std::default_random_engine generator;
+};
+
+/** All chips and collections are staged and written with a single
+ *  opening, and read back with a single opening.
+ */
+TEST_F(AlibavaPedNoiCalIOManagerTest, MultiChipRoundTrip) {
+
+	std::vector<int> const chips = {0, 1, 3, 5};
+	std::vector<lcio::FloatVec> pedestals, noises;
+
+	AlibavaPedNoiCalIOManager writer;
+	lcio::LCRunHeaderImpl runHeader;
+	runHeader.setRunNumber(4711);
+	writer.createFile(filename, &runHeader);
+	for(int chip : chips) {
+		pedestals.push_back(makeVec(500.f));
+		noises.push_back(makeVec(4.f));
+		writer.stageForChip("pedestal", chip, pedestals.back());
+		writer.stageForChip("noise", chip, noises.back());
+	}
+	writer.writeFile(filename);
+	EXPECT_EQ(2u, writer.getNumberOfFileOpenings(filename));
+
+	AlibavaPedNoiCalIOManager reader;
+	for(size_t i = 0; i < chips.size(); ++i) {
+		EXPECT_EQ(pedestals[i], reader.getPedNoiCalForChip(filename, "pedestal", chips[i]));
+		EXPECT_EQ(noises[i], reader.getPedNoiCalForChip(filename, "noise", chips[i]));
+	}
+	EXPECT_TRUE(reader.getPedNoiCalForChip(filename, "noise", 2).empty());
+	EXPECT_TRUE(reader.getPedNoiCalForChip(filename, "calibration", 0).empty());
+	EXPECT_EQ(1u, reader.getNumberOfFileOpenings(filename));
+
+	// rewriting the table keeps the run header
+	reader.stageForChip("calibration", 1, makeVec(0.01f));
+	reader.writeFile(filename);
+	AlibavaPedNoiCalIOManager check;
+	ASSERT_TRUE(check.readFile(filename));
+	EXPECT_EQ(pedestals[3], check.getStagedForChip("pedestal", 5));
+	EXPECT_EQ(128u, check.getStagedForChip("calibration", 1).size());
+}
+
+/** addToFile keeps its behaviour: the file on disk is complete after
+ *  each call. It is read at most once and replaces existing chips.
+ */
+TEST_F(AlibavaPedNoiCalIOManagerTest, AddToFile) {
+
+	lcio::FloatVec const first = makeVec(400.f);
+	lcio::FloatVec const second = makeVec(450.f);
+	lcio::FloatVec const noise = makeVec(5.f);
+
+	{
+		AlibavaPedNoiCalIOManager man;
+		man.addToFile(filename, "pedestal", 0, first);
+		man.addToFile(filename, "noise", 0, noise);
+		// one write per call, the new file is never read
+		EXPECT_EQ(2u, man.getNumberOfFileOpenings(filename));
+	}
+	{
+		AlibavaPedNoiCalIOManager man;
+		man.addToFile(filename, "pedestal", 0, second);
+		man.addToFile(filename, "pedestal", 1, first);
+		// one read and two writes
+		EXPECT_EQ(3u, man.getNumberOfFileOpenings(filename));
+	}
+
+	AlibavaPedNoiCalIOManager reader;
+	EXPECT_EQ(second, reader.getPedNoiCalForChip(filename, "pedestal", 0));
+	EXPECT_EQ(first, reader.getPedNoiCalForChip(filename, "pedestal", 1));
+	EXPECT_EQ(noise, reader.getPedNoiCalForChip(filename, "noise", 0));
+	EXPECT_EQ(1u, reader.getNumberOfFileOpenings(filename));
+}
+
+/** Collections of another type and the parameters of the collections
+ *  have to survive addToFile, as the file is rewritten.
+ */
+TEST_F(AlibavaPedNoiCalIOManagerTest, KeepsOtherCollectionsAndParameters) {
+
+	// a file as another tool might have written it
+	{
+		lcio::LCWriter * lcWriter = lcio::LCFactory::getInstance()->createLCWriter();
+		lcWriter->open(filename, lcio::LCIO::WRITE_NEW);
+		lcio::LCRunHeaderImpl runHeader;
+		runHeader.setRunNumber(12);
+		lcWriter->writeRunHeader(&runHeader);
+
+		lcio::LCEventImpl evt;
+		lcio::LCCollectionVec * pedestal = new lcio::LCCollectionVec(lcio::LCIO::TRACKERDATA);
+		pedestal->parameters().setValue(lcio::LCIO::CellIDEncoding, std::string(alibava::ALIBAVA::ALIBAVADATA_ENCODE));
+		pedestal->parameters().setValue("method", std::string("mean"));
+		lcio::LCCollectionVec * settings = new lcio::LCCollectionVec(lcio::LCIO::LCGENERICOBJECT);
+		lcio::LCGenericObjectImpl * object = new lcio::LCGenericObjectImpl(1, 0, 0);
+		object->setIntVal(0, 42);
+		settings->push_back(object);
+		evt.addCollection(pedestal, "pedestal");
+		evt.addCollection(settings, "settings");
+		lcWriter->writeEvent(&evt);
+		lcWriter->close();
+		delete lcWriter;
+	}
+
+	AlibavaPedNoiCalIOManager man;
+	man.addToFile(filename, "pedestal", 0, makeVec(400.f));
+
+	lcio::LCReader * lcReader = lcio::LCFactory::getInstance()->createLCReader();
+	lcReader->open(filename);
+	lcio::LCEvent * evt = lcReader->readNextEvent();
+	ASSERT_NE(nullptr, evt);
+
+	lcio::LCCollection * pedestal = evt->getCollection("pedestal");
+	EXPECT_EQ(1, pedestal->getNumberOfElements());
+	EXPECT_EQ("mean", pedestal->getParameters().getStringVal("method"));
+
+	lcio::LCCollection * settings = evt->getCollection("settings");
+	EXPECT_EQ(lcio::LCIO::LCGENERICOBJECT, settings->getTypeName());
+	ASSERT_EQ(1, settings->getNumberOfElements());
+	EXPECT_EQ(42, dynamic_cast<lcio::LCGenericObject *>(settings->getElementAt(0))->getIntVal(0));
+
+	lcReader->close();
+	delete lcReader;
+}
+
+/** A missing file is reported and leaves an empty table.
+ */
+TEST_F(AlibavaPedNoiCalIOManagerTest, MissingFile) {
+
+	AlibavaPedNoiCalIOManager man;
+	EXPECT_FALSE(man.readFile(filename));
+	EXPECT_TRUE(man.getStagedForChip("pedestal", 0).empty());
+	EXPECT_TRUE(man.getPedNoiCalForChip(filename, "pedestal", 0).empty());
+	EXPECT_EQ(1u, man.getNumberOfFileOpenings(filename));
+}
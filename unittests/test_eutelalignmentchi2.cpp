@@ -0,0 +1,137 @@
+//STL
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelAlignmentChi2.h"
+
+using eutelescope::EUTelAlignmentChi2;
+
+namespace {
+
+	struct HitPair {
+		double measuredX, measuredY, predictedX, predictedY;
+	};
+
+	// The array of structs objective as used by EUTelAlign before
+	double referenceChi2(std::vector<HitPair> const & hits, double const * par) {
+		double chi2 = 0.0;
+		for(size_t i = 0; i < hits.size(); i++) {
+			double x = (cos(par[3]) * cos(par[4])) * hits[i].measuredX +
+			           ((-1) * sin(par[2]) * sin(par[3]) * cos(par[4]) + cos(par[2]) * sin(par[4])) * hits[i].measuredY +
+			           par[0];
+			double y = ((-1) * cos(par[3]) * sin(par[4])) * hits[i].measuredX +
+			           (sin(par[2]) * sin(par[3]) * sin(par[4]) + cos(par[2]) * cos(par[4])) * hits[i].measuredY +
+			           par[1];
+			double distance = ((x - hits[i].predictedX) * (x - hits[i].predictedX) +
+			                   (y - hits[i].predictedY) * (y - hits[i].predictedY)) / 100;
+			if(par[5] == 0.0 || distance < par[5]) chi2 = chi2 + distance;
+		}
+		return chi2;
+	}
+
+	std::vector<HitPair> makeHits(unsigned seed, size_t n) {
+		std::default_random_engine generator(seed);
+		std::uniform_real_distribution<double> position(-10000., 10000.);
+		std::normal_distribution<double> smear(0., 20.);
+		std::vector<HitPair> hits(n);
+		for(auto & hit : hits) {
+			hit.measuredX = position(generator);
+			hit.measuredY = position(generator);
+			hit.predictedX = hit.measuredX + 50. + smear(generator);
+			hit.predictedY = hit.measuredY - 30. + smear(generator);
+		}
+		return hits;
+	}
+
+	void fill(EUTelAlignmentChi2 & chi2, std::vector<HitPair> const & hits) {
+		chi2.reserve(hits.size());
+		for(auto const & hit : hits) {
+			chi2.addHitPair(hit.measuredX, hit.measuredY, hit.predictedX, hit.predictedY);
+		}
+	}
+}
+
+/** The structure of arrays objective has to agree with the old one, with
+ *  and without chi2 cut and independently of the number of threads.
+ */
+TEST(EUTelAlignmentChi2Test, MatchesReference) {
+
+	auto hits = makeHits(42, 20000);
+	double const parSets[3][6] = {{0, 0, 0, 0, 0, 0},
+	                              {50, -30, 0.001, -0.002, 0.003, 0},
+	                              {45, -25, 0.0, 0.0, 0.001, 20}};
+
+	EUTelAlignmentChi2 single(1);
+	EUTelAlignmentChi2 multi(4);
+	fill(single, hits);
+	fill(multi, hits);
+
+	for(auto const & par : parSets) {
+		double const reference = referenceChi2(hits, par);
+		EXPECT_NEAR(reference, single(par), 1e-9 * reference);
+		EXPECT_EQ(single(par), multi(par));
+	}
+}
+
+/** Two independent objectives, as owned by two EUTelAlign instances, are
+ *  minimised side by side and must not see each others data.
+ */
+TEST(EUTelAlignmentChi2Test, TwoInstancesSideBySide) {
+
+	auto hitsA = makeHits(1, 5000);
+	auto hitsB = makeHits(2, 7000);
+
+	EUTelAlignmentChi2 chi2A(2);
+	EUTelAlignmentChi2 chi2B(2);
+	fill(chi2A, hitsA);
+	fill(chi2B, hitsB);
+
+	double const par[6] = {50, -30, 0.0005, 0.0, -0.001, 0};
+	double resultA = 0, resultB = 0;
+
+	std::thread threadA([&]() { for(int i = 0; i < 50; ++i) resultA = chi2A(par); });
+	std::thread threadB([&]() { for(int i = 0; i < 50; ++i) resultB = chi2B(par); });
+	threadA.join();
+	threadB.join();
+
+	double const referenceA = referenceChi2(hitsA, par);
+	double const referenceB = referenceChi2(hitsB, par);
+	EXPECT_NEAR(referenceA, resultA, 1e-9 * referenceA);
+	EXPECT_NEAR(referenceB, resultB, 1e-9 * referenceB);
+	EXPECT_EQ(5000u, chi2A.size());
+	EXPECT_EQ(7000u, chi2B.size());
+}
+
+/** The threads are kept between calls: many evaluations, more hit pairs
+ *  added in between and a changed number of threads must not change the
+ *  result.
+ */
+TEST(EUTelAlignmentChi2Test, RepeatedEvaluations) {
+
+	auto hits = makeHits(7, 30000);
+
+	EUTelAlignmentChi2 single(1);
+	EUTelAlignmentChi2 multi(3);
+	fill(single, hits);
+	fill(multi, hits);
+
+	for(int i = 0; i < 500; ++i) {
+		double const par[6] = {50 + 0.01 * i, -30, 0.001, -0.002, 0.003, i % 2 ? 20. : 0.};
+		ASSERT_EQ(single(par), multi(par));
+	}
+
+	auto moreHits = makeHits(8, 5000);
+	fill(single, moreHits);
+	fill(multi, moreHits);
+	multi.setNThreads(2);
+
+	double const par[6] = {45, -25, 0.0, 0.0, 0.001, 0};
+	EXPECT_EQ(35000u, multi.size());
+	EXPECT_EQ(single(par), multi(par));
+}
@@ -0,0 +1,164 @@
+//STL
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelAlignmentTransforms.h"
+
+using eutelescope::EUTelAlignmentTransforms;
+
+namespace {
+
+	struct Constant {
+		double center[3];
+		double offset[3];
+		double alpha;
+		double beta;
+		double gamma;
+	};
+
+	// TVector3::RotateX/Y/Z
+	void rotateX(double v[3], double angle) {
+		double const s = std::sin(angle), c = std::cos(angle), y = v[1];
+		v[1] = c * y - s * v[2];
+		v[2] = s * y + c * v[2];
+	}
+	void rotateY(double v[3], double angle) {
+		double const s = std::sin(angle), c = std::cos(angle), z = v[2];
+		v[2] = c * z - s * v[0];
+		v[0] = s * z + c * v[0];
+	}
+	void rotateZ(double v[3], double angle) {
+		double const s = std::sin(angle), c = std::cos(angle), x = v[0];
+		v[0] = c * x - s * v[1];
+		v[1] = s * x + c * v[1];
+	}
+
+	// The correction formerly done hit by hit in
+	// EUTelProcessorApplyAlign::processEvent
+	void scalarCorrection(Constant const & constant, double const input[3], double output[3]) {
+		double vec[3] = {input[0] - constant.center[0], input[1] - constant.center[1], input[2] - constant.center[2]};
+		rotateX(vec, -constant.alpha);
+		rotateY(vec, -constant.beta);
+		rotateZ(vec, -constant.gamma);
+		for(int i = 0; i < 3; ++i) output[i] = vec[i] + constant.center[i] - constant.offset[i];
+	}
+
+	Constant makeConstant(std::default_random_engine & generator, double z) {
+		std::uniform_real_distribution<double> center(-5., 5.), offset(-1., 1.), angle(-0.05, 0.05);
+		return Constant{{center(generator), center(generator), z},
+		                {offset(generator), offset(generator), offset(generator)},
+		                angle(generator), angle(generator), 3. * angle(generator)};
+	}
+
+	void set(EUTelAlignmentTransforms & transforms, int sensorID, Constant const & constant) {
+		transforms.set(sensorID, constant.center, constant.offset[0], constant.offset[1], constant.offset[2],
+		               constant.alpha, constant.beta, constant.gamma);
+	}
+}
+
+/** Random alignment constants and hits on six planes up to 1 m apart:
+ *  the affine correction agrees with the rotations of the former
+ *  code within 1e-9 mm, and the inverse gives back the hit.
+ */
+TEST(EUTelAlignmentTransformsTest, MatchesRotations) {
+
+	std::default_random_engine generator(46);
+	std::uniform_real_distribution<double> local(-10., 10.), thickness(-0.05, 0.05);
+
+	for(int iSet = 0; iSet < 100; ++iSet) {
+		EUTelAlignmentTransforms transforms;
+		std::map<int, Constant> constants;
+		for(int sensorID : {0, 1, 2, 3, 4, 5, 20}) {
+			constants[sensorID] = makeConstant(generator, 150. * sensorID - 50. * (sensorID == 20));
+			set(transforms, sensorID, constants[sensorID]);
+		}
+		for(auto const & entry : constants) {
+			std::vector<double> hits;
+			for(int iHit = 0; iHit < 20; ++iHit) {
+				hits.push_back(entry.second.center[0] + local(generator));
+				hits.push_back(entry.second.center[1] + local(generator));
+				hits.push_back(entry.second.center[2] + thickness(generator));
+			}
+			std::vector<double> corrected(hits.size());
+			transforms.apply(entry.first, hits.data(), corrected.data(), 20);
+			std::vector<double> restored(hits.size());
+			transforms.apply(entry.first, corrected.data(), restored.data(), 20, true);
+
+			for(int iHit = 0; iHit < 20; ++iHit) {
+				double expected[3];
+				scalarCorrection(entry.second, &hits[3 * iHit], expected);
+				for(int i = 0; i < 3; ++i) {
+					ASSERT_NEAR(expected[i], corrected[3 * iHit + i], 1e-9);
+					ASSERT_NEAR(hits[3 * iHit + i], restored[3 * iHit + i], 1e-9);
+				}
+			}
+		}
+	}
+}
+
+/** Sensors without constants are copied, also in place, and the
+ *  transformation can be applied in place.
+ */
+TEST(EUTelAlignmentTransformsTest, UnknownSensorsAndInPlace) {
+
+	EUTelAlignmentTransforms transforms;
+	double const center[3] = {0., 0., 100.};
+	transforms.set(3, center, 0.5, -0.25, 1., 0., 0., M_PI / 2.);
+	transforms.set(-1, center, 1., 1., 1., 0., 0., 0.);
+	EXPECT_FALSE(transforms.has(-1));
+	EXPECT_FALSE(transforms.has(0));
+	EXPECT_FALSE(transforms.has(4));
+	EXPECT_TRUE(transforms.has(3));
+	EXPECT_EQ(nullptr, transforms.getMatrix(2));
+
+	double hits[6] = {1., 2., 100., -1., 0., 101.};
+	double copy[6];
+	transforms.apply(7, hits, copy, 2);
+	for(int i = 0; i < 6; ++i) EXPECT_EQ(hits[i], copy[i]);
+
+	// rotation by -90 degrees around z, then the offsets
+	transforms.apply(3, hits, hits, 2);
+	EXPECT_NEAR(2. - 0.5, hits[0], 1e-12);
+	EXPECT_NEAR(-1. + 0.25, hits[1], 1e-12);
+	EXPECT_NEAR(99., hits[2], 1e-12);
+	EXPECT_NEAR(0. - 0.5, hits[3], 1e-12);
+	EXPECT_NEAR(1. + 0.25, hits[4], 1e-12);
+	EXPECT_NEAR(100., hits[5], 1e-12);
+
+	transforms.clear();
+	EXPECT_FALSE(transforms.has(3));
+}
+
+/** 10^6 hits on one sensor, rotations hit by hit against the matrix.
+ */
+TEST(EUTelAlignmentTransformsTest, DISABLED_Benchmark) {
+
+	std::default_random_engine generator(47);
+	std::uniform_real_distribution<double> local(-10., 10.);
+	Constant const constant = makeConstant(generator, 300.);
+	EUTelAlignmentTransforms transforms;
+	set(transforms, 2, constant);
+
+	size_t const nHits = 1000000;
+	std::vector<double> hits(3 * nHits);
+	for(auto & value : hits) value = local(generator);
+	std::vector<double> expected(3 * nHits), corrected(3 * nHits);
+
+	double const scalarMs = eutelbenchmark::milliseconds([&] {
+		for(size_t iHit = 0; iHit < nHits; ++iHit) scalarCorrection(constant, &hits[3 * iHit], &expected[3 * iHit]);
+	});
+	double const affineMs = eutelbenchmark::milliseconds([&] { transforms.apply(2, hits.data(), corrected.data(), nHits); });
+
+	eutelbenchmark::report(std::to_string(nHits) + " hits", {{"rotations", scalarMs}, {"affine", affineMs}});
+	for(size_t i = 0; i < 3 * nHits; i += 997) ASSERT_NEAR(expected[i], corrected[i], 1e-9);
+}
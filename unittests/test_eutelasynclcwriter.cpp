@@ -0,0 +1,169 @@
+//STL
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//LCIO
+#include <EVENT/LCIO.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IO/LCReader.h>
+#include <IO/LCWriter.h>
+#include <IOIMPL/LCFactory.h>
+
+//EUTelescope
+#include "EUTelAsyncLCWriter.h"
+
+using eutelescope::EUTelAsyncLCWriter;
+
+// Writes the same synthetic run synchronously and through the writer
+// thread and compares the two files.
+class EUTelAsyncLCWriterTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		syncFile = "test_eutelasynclcwriter_sync.slcio";
+		asyncFile = "test_eutelasynclcwriter_async.slcio";
+		std::remove(syncFile.c_str());
+		std::remove(asyncFile.c_str());
+	}
+
+	virtual void TearDown() {
+		std::remove(syncFile.c_str());
+		std::remove(asyncFile.c_str());
+	}
+
+	// 100 events with a data collection, a transient scratch collection and
+	// an EORE-like type parameter on the last one
+	static std::unique_ptr<IMPL::LCEventImpl> makeEvent(std::default_random_engine & generator, int iEvent) {
+		std::normal_distribution<float> charge(20.f, 5.f);
+		auto event = std::make_unique<IMPL::LCEventImpl>();
+		event->setRunNumber(17);
+		event->setEventNumber(iEvent);
+		event->setTimeStamp(1000 + iEvent);
+		event->setDetectorName("synthetic");
+		event->parameters().setValue("EventType", iEvent == 99 ? 2 : 1);
+
+		auto data = new IMPL::LCCollectionVec(EVENT::LCIO::TRACKERDATA);
+		for(int i = 0; i < 1 + iEvent % 5; ++i) {
+			auto trackerData = new IMPL::TrackerDataImpl();
+			EVENT::FloatVec charges(64);
+			for(auto & value : charges) value = charge(generator);
+			trackerData->setChargeValues(charges);
+			data->push_back(trackerData);
+		}
+		event->addCollection(data, "data");
+
+		auto scratch = new IMPL::LCCollectionVec(EVENT::LCIO::TRACKERDATA);
+		scratch->setTransient(true);
+		event->addCollection(scratch, "scratch");
+		return event;
+	}
+
+	static void writeRun(std::string const & filename, bool async) {
+		std::unique_ptr<IO::LCWriter> writer(IOIMPL::LCFactory::getInstance()->createLCWriter());
+		writer->open(filename, EVENT::LCIO::WRITE_NEW);
+
+		IMPL::LCRunHeaderImpl header;
+		header.setRunNumber(17);
+		header.setDetectorName("synthetic");
+		header.parameters().setValue("GeoID", 42);
+
+		std::unique_ptr<EUTelAsyncLCWriter> asyncWriter;
+		if(async) asyncWriter = std::make_unique<EUTelAsyncLCWriter>(writer.get(), 4);
+
+		std::default_random_engine generator(23);
+		if(async) asyncWriter->writeRunHeader(&header);
+		else writer->writeRunHeader(&header);
+		for(int iEvent = 0; iEvent < 100; ++iEvent) {
+			auto event = makeEvent(generator, iEvent);
+			// the source event is deleted right away, as the reader does
+			if(async) asyncWriter->writeEvent(EUTelAsyncLCWriter::takeEvent(event.get()));
+			else writer->writeEvent(event.get());
+		}
+		if(async) asyncWriter->finish();
+		writer->close();
+	}
+
+	std::string syncFile;
+	std::string asyncFile;
+};
+
+/** Both files hold the same run header and the same events in the same
+ *  order.
+ */
+TEST_F(EUTelAsyncLCWriterTest, SameAsSynchronous) {
+
+	writeRun(syncFile, false);
+	writeRun(asyncFile, true);
+
+	std::unique_ptr<IO::LCReader> syncReader(IOIMPL::LCFactory::getInstance()->createLCReader());
+	std::unique_ptr<IO::LCReader> asyncReader(IOIMPL::LCFactory::getInstance()->createLCReader());
+	syncReader->open(syncFile);
+	asyncReader->open(asyncFile);
+
+	EVENT::LCRunHeader * syncHeader = syncReader->readNextRunHeader();
+	EVENT::LCRunHeader * asyncHeader = asyncReader->readNextRunHeader();
+	ASSERT_NE(nullptr, syncHeader);
+	ASSERT_NE(nullptr, asyncHeader);
+	EXPECT_EQ(syncHeader->getRunNumber(), asyncHeader->getRunNumber());
+	EXPECT_EQ(syncHeader->getDetectorName(), asyncHeader->getDetectorName());
+	EXPECT_EQ(42, asyncHeader->getParameters().getIntVal("GeoID"));
+
+	int nEvents = 0;
+	while(EVENT::LCEvent * syncEvent = syncReader->readNextEvent()) {
+		EVENT::LCEvent * asyncEvent = asyncReader->readNextEvent();
+		ASSERT_NE(nullptr, asyncEvent);
+		EXPECT_EQ(syncEvent->getEventNumber(), asyncEvent->getEventNumber());
+		EXPECT_EQ(syncEvent->getRunNumber(), asyncEvent->getRunNumber());
+		EXPECT_EQ(syncEvent->getTimeStamp(), asyncEvent->getTimeStamp());
+		EXPECT_EQ(syncEvent->getDetectorName(), asyncEvent->getDetectorName());
+		EXPECT_EQ(syncEvent->getParameters().getIntVal("EventType"), asyncEvent->getParameters().getIntVal("EventType"));
+		EXPECT_EQ(*syncEvent->getCollectionNames(), *asyncEvent->getCollectionNames());
+
+		EVENT::LCCollection * syncData = syncEvent->getCollection("data");
+		EVENT::LCCollection * asyncData = asyncEvent->getCollection("data");
+		ASSERT_EQ(syncData->getNumberOfElements(), asyncData->getNumberOfElements());
+		for(int i = 0; i < syncData->getNumberOfElements(); ++i) {
+			EXPECT_EQ(dynamic_cast<EVENT::TrackerData *>(syncData->getElementAt(i))->getChargeValues(),
+			          dynamic_cast<EVENT::TrackerData *>(asyncData->getElementAt(i))->getChargeValues());
+		}
+		++nEvents;
+	}
+	EXPECT_EQ(nullptr, asyncReader->readNextEvent());
+	EXPECT_EQ(100, nEvents);
+
+	syncReader->close();
+	asyncReader->close();
+}
+
+/** takeEvent() moves the collections to be written, the source event
+ *  keeps them listed but would not write them any more.
+ */
+TEST_F(EUTelAsyncLCWriterTest, TakeEvent) {
+
+	std::default_random_engine generator(24);
+	auto event = makeEvent(generator, 3);
+	EVENT::LCCollection * data = event->getCollection("data");
+
+	auto taken = EUTelAsyncLCWriter::takeEvent(event.get());
+	ASSERT_EQ(1u, taken->getCollectionNames()->size());
+	EXPECT_EQ(data, taken->getCollection("data"));
+	EXPECT_FALSE(taken->getCollection("data")->isTransient());
+	EXPECT_EQ(3, taken->getEventNumber());
+	EXPECT_EQ(1, taken->getParameters().getIntVal("EventType"));
+
+	EXPECT_EQ(data, event->getCollection("data"));
+	EXPECT_TRUE(event->getCollection("scratch")->isTransient());
+
+	// deleting the source first must leave the taken collection alone
+	event.reset();
+	EXPECT_EQ(4, taken->getCollection("data")->getNumberOfElements());
+}
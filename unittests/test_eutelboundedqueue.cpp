@@ -0,0 +1,55 @@
+//STL
+#include <memory>
+#include <thread>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelBoundedQueue.h"
+
+using eutelescope::EUTelBoundedQueue;
+
+/** Items owned by the queue come out in order on the other thread, the
+ *  queue never holds more than its capacity.
+ */
+TEST(EUTelBoundedQueueTest, OrderAndCapacity) {
+
+	EUTelBoundedQueue<std::unique_ptr<int>> queue(4);
+	std::vector<int> received;
+	size_t maxSize = 0;
+
+	std::thread consumer([&] {
+		std::unique_ptr<int> item;
+		while(queue.pop(item)) {
+			received.push_back(*item);
+		}
+	});
+	for(int i = 0; i < 10000; ++i) {
+		ASSERT_TRUE(queue.push(std::make_unique<int>(i)));
+		maxSize = std::max(maxSize, queue.size());
+	}
+	queue.close();
+	consumer.join();
+
+	ASSERT_EQ(10000u, received.size());
+	for(int i = 0; i < 10000; ++i) ASSERT_EQ(i, received[i]);
+	EXPECT_LE(maxSize, queue.capacity());
+}
+
+/** A closed queue is drained but accepts nothing new.
+ */
+TEST(EUTelBoundedQueueTest, Close) {
+
+	EUTelBoundedQueue<int> queue(0);
+	EXPECT_EQ(1u, queue.capacity());
+	EXPECT_TRUE(queue.push(1));
+	queue.close();
+	EXPECT_FALSE(queue.push(2));
+
+	int item = 0;
+	EXPECT_TRUE(queue.pop(item));
+	EXPECT_EQ(1, item);
+	EXPECT_FALSE(queue.pop(item));
+}
@@ -0,0 +1,179 @@
+//STL
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelClusterShape.h"
+
+using eutelescope::EUTelClusterShape;
+
+namespace {
+
+	// EUTelProcessorAnalysisPALPIDEfs::emptyMiddle as it was: the not
+	// fired pixels of the grown bounding box are clustered, starting from
+	// the first one, which is always outside of the cluster.
+	bool referenceEmptyMiddle(std::vector<std::vector<int>> pixVector) {
+		std::vector<std::pair<int, int>> hitPixelVec;
+		std::vector<std::pair<int, int>> newlyAdded;
+		int xMax = 0, yMax = 0, xMin = 1000000, yMin = 1000000;
+		for(size_t i = 0; i < pixVector.size(); i++) {
+			if(pixVector[i][0] > xMax) xMax = pixVector[i][0];
+			if(pixVector[i][0] < xMin) xMin = pixVector[i][0];
+			if(pixVector[i][1] > yMax) yMax = pixVector[i][1];
+			if(pixVector[i][1] < yMin) yMin = pixVector[i][1];
+		}
+		for(int n = xMin - 1; n <= xMax + 1; n++) {
+			for(int m = yMin - 1; m <= yMax + 1; m++) {
+				bool empty_pixel = true;
+				for(size_t i = 0; i < pixVector.size(); i++) {
+					if(n == pixVector[i][0] && m == pixVector[i][1]) {
+						empty_pixel = false;
+						break;
+					}
+				}
+				if(empty_pixel) hitPixelVec.push_back(std::make_pair(n, m));
+			}
+		}
+		newlyAdded.push_back(hitPixelVec.front());
+		hitPixelVec.erase(hitPixelVec.begin());
+		while(!newlyAdded.empty()) {
+			bool newlyDone = true;
+			for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
+				int const dX = newlyAdded.front().first - hitVec->first;
+				int const dY = newlyAdded.front().second - hitVec->second;
+				if(dX * dX + dY * dY <= 1) {
+					newlyAdded.push_back(*hitVec);
+					hitPixelVec.erase(hitVec);
+					newlyDone = false;
+					break;
+				}
+			}
+			if(newlyDone) newlyAdded.erase(newlyAdded.begin());
+		}
+		return !hitPixelVec.empty();
+	}
+
+	// A connected cluster grown by random steps from a seed pixel
+	std::vector<std::vector<int>> makeCluster(std::default_random_engine & generator, int nPixels) {
+		std::uniform_int_distribution<int> seed(0, 1000), step(0, 3);
+		std::vector<std::vector<int>> pixels(1, std::vector<int>{seed(generator), seed(generator)});
+		int const dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+		while(static_cast<int>(pixels.size()) < nPixels) {
+			std::uniform_int_distribution<size_t> pick(0, pixels.size() - 1);
+			std::vector<int> const & from = pixels[pick(generator)];
+			int const direction = step(generator);
+			pixels.push_back(std::vector<int>{from[0] + dx[direction], from[1] + dy[direction]});
+		}
+		return pixels;
+	}
+
+	void fill(EUTelClusterShape & shape, std::vector<std::vector<int>> const & pixels) {
+		shape.clear();
+		for(auto const & pixel : pixels) shape.addPixel(pixel[0], pixel[1]);
+		shape.build();
+	}
+}
+
+/** Rings and filled squares, the bounding box and the bitmask.
+ */
+TEST(EUTelClusterShapeTest, RingsAndSquares) {
+
+	EUTelClusterShape shape;
+	std::vector<std::vector<int>> ring;
+	for(int x = 10; x < 14; ++x) {
+		for(int y = 20; y < 23; ++y) {
+			if(x == 10 || x == 13 || y == 20 || y == 22) ring.push_back(std::vector<int>{x, y});
+		}
+	}
+	fill(shape, ring);
+	EXPECT_TRUE(shape.hasEmptyMiddle());
+	EXPECT_EQ(10u, shape.getNPixels());
+	EXPECT_EQ(10, shape.getXMin());
+	EXPECT_EQ(13, shape.getXMax());
+	EXPECT_EQ(20, shape.getYMin());
+	EXPECT_EQ(22, shape.getYMax());
+	EXPECT_EQ(4, shape.getWidthX());
+	EXPECT_EQ(3, shape.getWidthY());
+	EXPECT_TRUE(shape.isFired(10, 21));
+	EXPECT_FALSE(shape.isFired(11, 21));
+	EXPECT_FALSE(shape.isFired(9, 21));
+	EXPECT_FALSE(shape.isFired(14, 30));
+
+	// the hole connected to the outside by a diagonal only is still enclosed
+	ring.erase(ring.begin());
+	fill(shape, ring);
+	EXPECT_TRUE(shape.hasEmptyMiddle());
+
+	// an open ring
+	ring.erase(ring.begin());
+	fill(shape, ring);
+	EXPECT_FALSE(shape.hasEmptyMiddle());
+
+	fill(shape, {{5, 5}, {5, 6}, {6, 5}, {6, 6}, {6, 6}});
+	EXPECT_FALSE(shape.hasEmptyMiddle());
+	EXPECT_EQ(5u, shape.getNPixels());
+	EXPECT_EQ(2, shape.getWidthX());
+
+	fill(shape, {{0, 0}});
+	EXPECT_FALSE(shape.hasEmptyMiddle());
+	EXPECT_EQ(1, shape.getWidthY());
+
+	shape.clear();
+	shape.build();
+	EXPECT_FALSE(shape.hasEmptyMiddle());
+	EXPECT_EQ(0, shape.getWidthX());
+	EXPECT_FALSE(shape.isFired(0, 0));
+}
+
+/** Random clusters of 1 to 40 pixels: the same decision as the
+ *  former inverse clustering.
+ */
+TEST(EUTelClusterShapeTest, MatchesInverseClustering) {
+
+	std::default_random_engine generator(48);
+	std::uniform_int_distribution<int> size(1, 40);
+	EUTelClusterShape shape;
+	int nEmptyMiddle = 0;
+	for(int i = 0; i < 5000; ++i) {
+		std::vector<std::vector<int>> const pixels = makeCluster(generator, size(generator));
+		fill(shape, pixels);
+		bool const expected = referenceEmptyMiddle(pixels);
+		ASSERT_EQ(expected, shape.hasEmptyMiddle()) << "cluster " << i;
+		if(expected) ++nEmptyMiddle;
+	}
+	EXPECT_GT(nEmptyMiddle, 0);
+}
+
+/** Clusters of 30 pixels, inverse clustering against the bitmask.
+ */
+TEST(EUTelClusterShapeTest, DISABLED_Benchmark) {
+
+	std::default_random_engine generator(49);
+	std::vector<std::vector<std::vector<int>>> clusters;
+	for(int i = 0; i < 2000; ++i) clusters.push_back(makeCluster(generator, 30));
+
+	int nReference = 0;
+	double const referenceMs = eutelbenchmark::milliseconds([&] {
+		for(auto const & pixels : clusters) nReference += referenceEmptyMiddle(pixels);
+	});
+
+	int nShape = 0;
+	EUTelClusterShape shape;
+	double const shapeMs = eutelbenchmark::milliseconds([&] {
+		for(auto const & pixels : clusters) {
+			fill(shape, pixels);
+			nShape += shape.hasEmptyMiddle();
+		}
+	});
+
+	eutelbenchmark::report(std::to_string(clusters.size()) + " clusters",
+	                       {{"inverse clustering", referenceMs}, {"bitmask", shapeMs}});
+	EXPECT_EQ(nReference, nShape);
+}
@@ -0,0 +1,244 @@
+//STL
+#include <algorithm>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelDigitalFixedFrameFinder.h"
+
+using eutelescope::EUTelDigitalFixedFrameFinder;
+
+namespace {
+
+	struct Pixel {
+		int x;
+		int y;
+	};
+
+	struct Cluster {
+		int seedX;
+		int seedY;
+		std::vector<std::pair<int, int>> pixels;
+	};
+
+	// The seed class of EUTelClusteringProcessor, with its sorting criteria
+	struct Seed {
+		unsigned int x;
+		unsigned int y;
+		unsigned int neighbours;
+		unsigned int p;
+		bool operator<(Seed const & b) const {
+			bool r = true;
+			if(neighbours == b.neighbours) {
+				if(p < b.p) r = false;
+			} else if(neighbours < b.neighbours) r = false;
+			return r;
+		}
+	};
+
+	typedef std::map<unsigned int, std::map<unsigned int, bool>> SensorMatrix;
+
+	bool isSet(SensorMatrix const & sensormatrix, unsigned int x, unsigned int y) {
+		auto z = sensormatrix.find(x);
+		if(z == sensormatrix.end()) return false;
+		auto w = z->second.find(y);
+		return w != z->second.end() && w->second;
+	}
+
+	// The cluster search formerly done in
+	// EUTelClusteringProcessor::digitalFixedFrameClustering on nested maps
+	std::vector<Cluster> nestedMapClustering(std::vector<Pixel> const & frame, std::set<std::pair<int, int>> const & hot,
+	                                         int xClusterSize, int yClusterSize) {
+		SensorMatrix sensormatrix;
+		for(auto const & pixel : frame) {
+			if(hot.count({pixel.x, pixel.y})) continue;
+			sensormatrix[pixel.x][pixel.y] = true;
+		}
+
+		int const stepx = xClusterSize / 2;
+		int const stepy = yClusterSize / 2;
+
+		std::list<Seed> seedcandidates;
+		for(auto const & column : sensormatrix) {
+			for(auto const & entry : column.second) {
+				unsigned int const i = column.first;
+				unsigned int const j = entry.first;
+				int nb = 0;
+				int npixel_cl = 0;
+				for(unsigned int index_x = i - stepx; index_x <= (i + stepx); index_x++) {
+					for(unsigned int index_y = j - stepy; index_y <= (j + stepy); index_y++) {
+						if(index_x > 0 && index_y > 0 && isSet(sensormatrix, index_x, index_y)) npixel_cl++;
+					}
+				}
+				if(npixel_cl > 1) {
+					if(i >= 1) {
+						for(int index_x = static_cast<int>(i - 1); index_x <= static_cast<int>(i + 1); index_x++) {
+							if(isSet(sensormatrix, index_x, j)) nb++;
+						}
+					}
+					if(j >= 1) {
+						for(int index_y = static_cast<int>(j - 1); index_y <= static_cast<int>(j + 1); index_y++) {
+							if(isSet(sensormatrix, i, index_y)) nb++;
+						}
+					}
+				}
+				seedcandidates.push_back(Seed{i, j, static_cast<unsigned int>(nb), static_cast<unsigned int>(npixel_cl)});
+			}
+		}
+		seedcandidates.sort();
+
+		std::vector<Cluster> clusters;
+		for(auto const & seed : seedcandidates) {
+			if(!isSet(sensormatrix, seed.x, seed.y)) continue;
+			Cluster cluster{-1, -1, {}};
+			if(seed.x >= static_cast<unsigned int>(stepx) && seed.y >= static_cast<unsigned int>(stepy)) {
+				for(int index_x = static_cast<int>(seed.x - stepx); index_x <= static_cast<int>(seed.x + stepx); index_x++) {
+					for(int index_y = static_cast<int>(seed.y - stepy); index_y <= static_cast<int>(seed.y + stepy); index_y++) {
+						if(isSet(sensormatrix, index_x, index_y)) cluster.pixels.push_back({index_x, index_y});
+					}
+				}
+			}
+			if(cluster.pixels.empty()) continue;
+			for(auto const & pixel : cluster.pixels) sensormatrix[pixel.first][pixel.second] = false;
+			cluster.seedX = seed.x;
+			cluster.seedY = seed.y;
+			clusters.push_back(cluster);
+		}
+		return clusters;
+	}
+
+	std::vector<Cluster> bitmapClustering(EUTelDigitalFixedFrameFinder & finder, std::vector<Pixel> const & frame,
+	                                      int xClusterSize, int yClusterSize) {
+		for(auto const & pixel : frame) finder.addPixel(pixel.x, pixel.y);
+		finder.findClusters(xClusterSize, yClusterSize);
+		std::vector<Cluster> clusters;
+		for(auto const & found : finder.getClusters()) {
+			clusters.push_back(Cluster{found.seedX, found.seedY, {}});
+			for(size_t iPixel = found.firstPixel; iPixel < found.firstPixel + found.nPixels; ++iPixel) {
+				clusters.back().pixels.push_back({finder.getPixels()[iPixel].x, finder.getPixels()[iPixel].y});
+			}
+		}
+		return clusters;
+	}
+
+	// Sparse frame: noise hits plus small blobs, with some pixels repeated
+	std::vector<Pixel> makeFrame(std::default_random_engine & generator, int nX, int nY, int nNoise, int nBlobs) {
+		std::uniform_int_distribution<int> x(0, nX - 1), y(0, nY - 1), size(1, 6), step(-1, 1);
+		std::vector<Pixel> frame;
+		for(int i = 0; i < nNoise; ++i) frame.push_back({x(generator), y(generator)});
+		for(int i = 0; i < nBlobs; ++i) {
+			Pixel pixel{x(generator), y(generator)};
+			for(int n = size(generator); n > 0; --n) {
+				frame.push_back(pixel);
+				pixel.x = std::min(std::max(pixel.x + step(generator), 0), nX - 1);
+				pixel.y = std::min(std::max(pixel.y + step(generator), 0), nY - 1);
+			}
+		}
+		return frame;
+	}
+}
+
+/** Random sparse frames, also close to the matrix edges and with hot
+ *  pixels, give exactly the clusters of the nested map search, for
+ *  several frame sizes and with the finder reused frame after frame.
+ */
+TEST(EUTelDigitalFixedFrameFinderTest, MatchesNestedMaps) {
+
+	int const nX = 40;
+	int const nY = 24;
+	std::default_random_engine generator(43);
+	std::uniform_int_distribution<int> x(0, nX - 1), y(0, nY - 1);
+
+	std::set<std::pair<int, int>> hot;
+	EUTelDigitalFixedFrameFinder finder;
+	finder.configure(0, 0, nX - 1, nY - 1);
+	for(int i = 0; i < 10; ++i) {
+		int const hotX = x(generator);
+		int const hotY = y(generator);
+		hot.insert({hotX, hotY});
+		finder.setHotPixel(hotX + hotY * nX);
+	}
+
+	size_t nClusters = 0;
+	for(int xSize = 1; xSize <= 5; ++xSize) {
+		for(int ySize = 1; ySize <= 5; ++ySize) {
+			for(int iFrame = 0; iFrame < 40; ++iFrame) {
+				std::vector<Pixel> const frame = makeFrame(generator, nX, nY, iFrame % 20, iFrame % 7);
+				std::vector<Cluster> const reference = nestedMapClustering(frame, hot, xSize, ySize);
+				std::vector<Cluster> const clusters = bitmapClustering(finder, frame, xSize, ySize);
+
+				ASSERT_EQ(reference.size(), clusters.size());
+				for(size_t iCluster = 0; iCluster < clusters.size(); ++iCluster) {
+					ASSERT_EQ(reference[iCluster].seedX, clusters[iCluster].seedX);
+					ASSERT_EQ(reference[iCluster].seedY, clusters[iCluster].seedY);
+					ASSERT_EQ(reference[iCluster].pixels, clusters[iCluster].pixels);
+				}
+				nClusters += clusters.size();
+			}
+		}
+	}
+	EXPECT_GT(nClusters, 1000u);
+}
+
+/** Pixels outside of the matrix and hot pixels are ignored, the hot
+ *  pixels stay masked in the following frames.
+ */
+TEST(EUTelDigitalFixedFrameFinderTest, HotAndOutsidePixels) {
+
+	EUTelDigitalFixedFrameFinder finder;
+	finder.configure(0, 0, 9, 9);
+	EXPECT_TRUE(finder.isConfigured(0, 0, 9, 9));
+	EXPECT_FALSE(finder.isConfigured(0, 0, 9, 10));
+	finder.setHotPixel(5 + 5 * 10);
+
+	for(int iFrame = 0; iFrame < 2; ++iFrame) {
+		finder.addPixel(5, 5);
+		finder.addPixel(10, 5);
+		finder.addPixel(-1, 5);
+		finder.addPixel(2, 2);
+		finder.addPixel(2, 2);
+		finder.findClusters(3, 3);
+		ASSERT_EQ(1u, finder.getClusters().size());
+		EXPECT_EQ(2, finder.getClusters()[0].seedX);
+		EXPECT_EQ(2, finder.getClusters()[0].seedY);
+		EXPECT_EQ(1u, finder.getClusters()[0].nPixels);
+	}
+}
+
+/** A 1024 x 512 sensor with 200 fired pixels per frame, the nested
+ *  maps against the bitmap.
+ */
+TEST(EUTelDigitalFixedFrameFinderTest, DISABLED_Benchmark) {
+
+	int const nX = 1024;
+	int const nY = 512;
+	int const nFrames = 200;
+	std::default_random_engine generator(44);
+	std::vector<std::vector<Pixel>> frames;
+	for(int iFrame = 0; iFrame < nFrames; ++iFrame) frames.push_back(makeFrame(generator, nX, nY, 100, 30));
+
+	size_t nReference = 0;
+	double const mapMs = eutelbenchmark::milliseconds([&] {
+		for(auto const & frame : frames) nReference += nestedMapClustering(frame, {}, 3, 3).size();
+	});
+
+	size_t nClusters = 0;
+	double const bitmapMs = eutelbenchmark::milliseconds([&] {
+		EUTelDigitalFixedFrameFinder finder;
+		finder.configure(0, 0, nX - 1, nY - 1);
+		for(auto const & frame : frames) nClusters += bitmapClustering(finder, frame, 3, 3).size();
+	});
+
+	eutelbenchmark::report(std::to_string(nFrames) + " frames", {{"nested maps", mapMs}, {"bitmap", bitmapMs}});
+	EXPECT_EQ(nReference, nClusters);
+}
@@ -0,0 +1,267 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelDUTHitMatcher.h"
+
+using eutelescope::EUTelDUTHitMatcher;
+
+namespace {
+
+	struct Event {
+		std::map<int, std::vector<double>> fittedX;
+		std::map<int, std::vector<double>> fittedY;
+		std::vector<double> measuredX;
+		std::vector<double> measuredY;
+		int nTracks;
+	};
+
+	// track -> (fit, hit), hit -1 for unmatched tracks
+	typedef std::vector<std::pair<int, int>> Matches;
+
+	// The matching formerly done in EUTelDUTHistograms::processEvent,
+	// which removed the matched hits from the list. The hit indices are
+	// mapped back to the original ones.
+	Matches tripleLoopMatching(Event event, double distMax) {
+		std::vector<int> hitIndex;
+		for(size_t ihit = 0; ihit < event.measuredX.size(); ihit++) hitIndex.push_back(static_cast<int>(ihit));
+		Matches matches;
+		for(int itrack = 0; itrack < event.nTracks; itrack++) {
+			int bestfit = -1;
+			int besthit = -1;
+			double distmin = distMax * distMax + 10.;
+			for(int ifit = 0; ifit < static_cast<int>(event.fittedX[itrack].size()); ifit++) {
+				for(int ihit = 0; ihit < static_cast<int>(event.measuredX.size()); ihit++) {
+					double dist2rd = (event.measuredX[ihit] - event.fittedX[itrack][ifit]) *
+					                     (event.measuredX[ihit] - event.fittedX[itrack][ifit]) +
+					                 (event.measuredY[ihit] - event.fittedY[itrack][ifit]) *
+					                     (event.measuredY[ihit] - event.fittedY[itrack][ifit]);
+					if(dist2rd < distmin) {
+						distmin = dist2rd;
+						besthit = ihit;
+						bestfit = ifit;
+					}
+				}
+			}
+			if(distmin < distMax * distMax) {
+				matches.push_back({bestfit, hitIndex[besthit]});
+				event.measuredX.erase(event.measuredX.begin() + besthit);
+				event.measuredY.erase(event.measuredY.begin() + besthit);
+				hitIndex.erase(hitIndex.begin() + besthit);
+			} else {
+				matches.push_back({-1, -1});
+			}
+		}
+		return matches;
+	}
+
+	// All pairs by increasing distance, the first free track and hit win
+	Matches globalMatching(Event event, double distMax) {
+		std::vector<std::tuple<double, int, int, int>> pairs;
+		for(int itrack = 0; itrack < event.nTracks; itrack++) {
+			for(int ifit = 0; ifit < static_cast<int>(event.fittedX[itrack].size()); ifit++) {
+				for(int ihit = 0; ihit < static_cast<int>(event.measuredX.size()); ihit++) {
+					double const dx = event.measuredX[ihit] - event.fittedX[itrack][ifit];
+					double const dy = event.measuredY[ihit] - event.fittedY[itrack][ifit];
+					if(dx * dx + dy * dy < distMax * distMax) pairs.emplace_back(dx * dx + dy * dy, itrack, ifit, ihit);
+				}
+			}
+		}
+		std::sort(pairs.begin(), pairs.end());
+		Matches matches(event.nTracks, {-1, -1});
+		std::vector<bool> used(event.measuredX.size(), false);
+		for(auto const & pair : pairs) {
+			if(matches[std::get<1>(pair)].second != -1 || used[std::get<3>(pair)]) continue;
+			matches[std::get<1>(pair)] = {std::get<2>(pair), std::get<3>(pair)};
+			used[std::get<3>(pair)] = true;
+		}
+		return matches;
+	}
+
+	Matches matcherMatching(EUTelDUTHitMatcher & matcher, Event const & event, double distMax, bool greedy) {
+		matcher.reset(distMax);
+		for(size_t ihit = 0; ihit < event.measuredX.size(); ihit++) matcher.addHit(event.measuredX[ihit], event.measuredY[ihit]);
+		for(auto const & track : event.fittedX) {
+			for(size_t ifit = 0; ifit < track.second.size(); ifit++) {
+				matcher.addFit(track.first, static_cast<int>(ifit), track.second[ifit], event.fittedY.at(track.first)[ifit]);
+			}
+		}
+		matcher.match(event.nTracks, greedy);
+		Matches matches;
+		for(int itrack = 0; itrack < event.nTracks; itrack++) {
+			matches.push_back({matcher.getMatch(itrack).fit, matcher.getMatch(itrack).hit});
+		}
+		return matches;
+	}
+
+	// Tracks with one or two fitted positions, each close to a hit in
+	// most cases, plus noise hits. Positions are rounded to 10 um so
+	// that equal distances happen.
+	Event makeEvent(std::default_random_engine & generator, int nTracks, int nNoise, double size, double resolution) {
+		std::uniform_real_distribution<double> position(-size, size);
+		std::normal_distribution<double> smear(0., resolution);
+		std::uniform_int_distribution<int> nFits(1, 2);
+		std::bernoulli_distribution efficient(0.9);
+		auto const round = [](double value) { return std::round(value * 100.) / 100.; };
+		Event event{{}, {}, {}, {}, nTracks};
+		for(int itrack = 0; itrack < nTracks; itrack++) {
+			double const x = round(position(generator));
+			double const y = round(position(generator));
+			for(int ifit = nFits(generator); ifit > 0; --ifit) {
+				event.fittedX[itrack].push_back(round(x + smear(generator)));
+				event.fittedY[itrack].push_back(round(y + smear(generator)));
+			}
+			if(efficient(generator)) {
+				event.measuredX.push_back(round(x + smear(generator)));
+				event.measuredY.push_back(round(y + smear(generator)));
+			}
+		}
+		for(int ihit = 0; ihit < nNoise; ihit++) {
+			event.measuredX.push_back(round(position(generator)));
+			event.measuredY.push_back(round(position(generator)));
+		}
+		return event;
+	}
+}
+
+/** Two tracks compete for one hit which is closer to the second
+ *  track; the first track has a second, farther candidate. The greedy
+ *  matching gives the hit to the first track and leaves the second
+ *  one unmatched, the global matching matches both.
+ */
+TEST(EUTelDUTHitMatcherTest, DuplicateCandidates) {
+
+	Event event{{}, {}, {0.00, 0.08}, {0., 0.}, 2};
+	event.fittedX[0] = {0.03};
+	event.fittedY[0] = {0.};
+	event.fittedX[1] = {-0.025};
+	event.fittedY[1] = {0.};
+
+	EUTelDUTHitMatcher matcher;
+	Matches const greedy = matcherMatching(matcher, event, 0.1, true);
+	EXPECT_EQ(0, greedy[0].second);
+	EXPECT_EQ(-1, greedy[1].second);
+	EXPECT_EQ(1u, matcher.getNMatches());
+	EXPECT_EQ(3u, matcher.getNCandidates());
+	EXPECT_FALSE(matcher.isHitMatched(1));
+
+	Matches const global = matcherMatching(matcher, event, 0.1, false);
+	EXPECT_EQ(1, global[0].second);
+	EXPECT_EQ(0, global[1].second);
+	EXPECT_EQ(2u, matcher.getNMatches());
+	EXPECT_TRUE(matcher.isHitMatched(0));
+	EXPECT_TRUE(matcher.isHitMatched(1));
+	EXPECT_NEAR(0.05 * 0.05, matcher.getMatch(0).distance2, 1e-12);
+}
+
+/** A track with two fitted positions takes the hit closest to any of
+ *  them; equal distances go to the lower track and fitted position.
+ */
+TEST(EUTelDUTHitMatcherTest, FitsAndTies) {
+
+	Event event{{}, {}, {1.0, 2.0, 5.0}, {1.0, 1.0, 5.03125}, 3};
+	event.fittedX[0] = {2.0625, 1.015625};
+	event.fittedY[0] = {1.0, 1.0};
+	event.fittedX[1] = {0.984375};
+	event.fittedY[1] = {1.0};
+	event.fittedX[2] = {5.0, 5.0};
+	event.fittedY[2] = {5.0, 5.0};
+
+	EUTelDUTHitMatcher matcher;
+	for(bool greedy : {true, false}) {
+		Matches const matches = matcherMatching(matcher, event, 0.1, greedy);
+		EXPECT_EQ(tripleLoopMatching(event, 0.1), matches);
+		EXPECT_EQ(std::make_pair(1, 0), matches[0]);
+		EXPECT_EQ(-1, matches[1].second);
+		EXPECT_EQ(std::make_pair(0, 2), matches[2]);
+	}
+}
+
+/** Hits exactly on and around the grid cell edges, at negative
+ *  coordinates and at distMax; non finite positions and a non
+ *  positive distMax never match.
+ */
+TEST(EUTelDUTHitMatcherTest, CellEdges) {
+
+	EUTelDUTHitMatcher matcher;
+	Event event{{}, {}, {-0.25, 0.2499, -0.5}, {-0.125, 0.0, 0.0}, 3};
+	event.fittedX[0] = {-0.3125};
+	event.fittedY[0] = {-0.125};
+	event.fittedX[1] = {0.25};
+	event.fittedY[1] = {0.0};
+	event.fittedX[2] = {-0.375};
+	event.fittedY[2] = {0.0};
+	Matches const matches = matcherMatching(matcher, event, 0.125, false);
+	EXPECT_EQ(tripleLoopMatching(event, 0.125), matches);
+	EXPECT_EQ(0, matches[0].second);
+	EXPECT_EQ(1, matches[1].second);
+	// distance 0.1 is not below distMax
+	EXPECT_EQ(-1, matches[2].second);
+
+	double const nan = std::numeric_limits<double>::quiet_NaN();
+	double const inf = std::numeric_limits<double>::infinity();
+	Event odd{{}, {}, {nan, inf, 0.}, {0., 0., nan}, 2};
+	odd.fittedX[0] = {0.};
+	odd.fittedY[0] = {0.};
+	odd.fittedX[1] = {nan};
+	odd.fittedY[1] = {0.};
+	EXPECT_EQ(Matches(2, {-1, -1}), matcherMatching(matcher, odd, 0.1, false));
+	EXPECT_EQ(Matches(3, {-1, -1}), matcherMatching(matcher, event, 0., false));
+	EXPECT_EQ(Matches(3, {-1, -1}), matcherMatching(matcher, event, -1., true));
+}
+
+/** Random events: the greedy mode gives exactly the matches of the
+ *  former triple loop, the global mode those of a sort of all pairs.
+ */
+TEST(EUTelDUTHitMatcherTest, RandomEvents) {
+
+	std::default_random_engine generator(45);
+	EUTelDUTHitMatcher matcher;
+	size_t nGreedy = 0, nGlobal = 0;
+	for(int iEvent = 0; iEvent < 2000; ++iEvent) {
+		int const nTracks = iEvent % 12;
+		Event const event = makeEvent(generator, nTracks, iEvent % 7, 0.5 + iEvent % 5, 0.03);
+		double const distMax = 0.05 * (1 + iEvent % 3);
+
+		Matches const greedy = matcherMatching(matcher, event, distMax, true);
+		ASSERT_EQ(tripleLoopMatching(event, distMax), greedy);
+		nGreedy += matcher.getNMatches();
+
+		Matches const global = matcherMatching(matcher, event, distMax, false);
+		ASSERT_EQ(globalMatching(event, distMax), global);
+		nGlobal += matcher.getNMatches();
+	}
+	EXPECT_GT(nGreedy, 5000u);
+	EXPECT_GT(nGlobal, 5000u);
+}
+
+/** 1000 tracks and 1000 hits on a 20 x 20 mm DUT.
+ */
+TEST(EUTelDUTHitMatcherTest, DISABLED_Benchmark) {
+
+	std::default_random_engine generator(46);
+	Event const event = makeEvent(generator, 1000, 100, 10., 0.01);
+
+	Matches reference, greedy;
+	double const loopMs = eutelbenchmark::milliseconds([&] { reference = tripleLoopMatching(event, 0.1); });
+
+	EUTelDUTHitMatcher matcher;
+	double const gridMs = eutelbenchmark::milliseconds([&] { greedy = matcherMatching(matcher, event, 0.1, true); });
+
+	eutelbenchmark::report(std::to_string(event.nTracks) + " tracks, " + std::to_string(event.measuredX.size()) + " hits",
+	                       {{"triple loop", loopMs}, {"grid", gridMs}});
+	EXPECT_EQ(reference, greedy);
+}
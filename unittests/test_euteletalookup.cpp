@@ -0,0 +1,131 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelEtaFunctionImpl.h"
+#include "EUTelEtaLookup.h"
+#include "EUTelExceptions.h"
+
+using namespace eutelescope;
+
+namespace {
+
+	// A monotonic, non-linear eta function with non-uniform bin centers
+	EUTelEtaFunctionImpl makeEta(unsigned seed, int nBin) {
+		std::default_random_engine generator(seed);
+		std::uniform_real_distribution<double> gap(0.5, 1.5);
+		std::vector<double> centers(nBin);
+		std::vector<double> values(nBin);
+		double x = -0.5;
+		for(int i = 0; i < nBin; ++i) {
+			centers[i] = x;
+			x += gap(generator) / nBin;
+		}
+		for(int i = 0; i < nBin; ++i) {
+			double const u = (centers[i] - centers.front()) / (centers.back() - centers.front());
+			values[i] = 0.5 * (1. - std::cos(3.14159265 * u));
+		}
+		return EUTelEtaFunctionImpl(1, nBin, centers, values);
+	}
+}
+
+/** The grid lookup has to stay within the resampling bound of the binary
+ *  search result everywhere, including outside of the bin center range.
+ */
+TEST(EUTelEtaLookupTest, DeviationFromBinarySearchBounded) {
+
+	EUTelEtaFunctionImpl eta = makeEta(7, 100);
+	EUTelEtaLookup lookup = eta.makeLookup();
+
+	std::vector<double> const centers = eta.getBinCenterVector();
+	double const bound = lookup.getMaxCellIncrement();
+	EXPECT_LT(bound, 0.01);
+
+	std::default_random_engine generator(3);
+	std::uniform_real_distribution<double> cog(centers.front() - 0.2, centers.back() + 0.2);
+	double maxDeviation = 0;
+	for(int i = 0; i < 100000; ++i) {
+		double const x = cog(generator);
+		maxDeviation = std::max(maxDeviation, std::abs(lookup(x) - eta.getEtaFromCoG(x)));
+	}
+	EXPECT_LE(maxDeviation, bound);
+
+	// edges and the bin centers themselves
+	EXPECT_DOUBLE_EQ(eta.getEtaFromCoG(centers.front() - 1.), lookup(centers.front() - 1.));
+	EXPECT_DOUBLE_EQ(eta.getEtaFromCoG(centers.back() + 1.), lookup(centers.back() + 1.));
+	EXPECT_DOUBLE_EQ(eta.getEtaFromCoG(centers.front()), lookup(centers.front()));
+	EXPECT_DOUBLE_EQ(eta.getEtaFromCoG(centers.back()), lookup(centers.back()));
+	for(auto center : centers) {
+		EXPECT_NEAR(eta.getEtaFromCoG(center), lookup(center), bound);
+	}
+}
+
+/** With uniform bin centers on the grid the resampling is exact.
+ */
+TEST(EUTelEtaLookupTest, UniformBinsAreExact) {
+
+	int const nBin = 50;
+	std::vector<double> centers(nBin);
+	std::vector<double> values(nBin);
+	for(int i = 0; i < nBin; ++i) {
+		centers[i] = -0.5 + (i + 0.5) / nBin;
+		values[i] = std::sqrt((i + 0.5) / nBin);
+	}
+	EUTelEtaFunctionImpl eta(0, nBin, centers, values);
+	EUTelEtaLookup lookup = eta.makeLookup(4 * (nBin - 1) + 1);
+
+	for(double x = -0.6; x < 0.6; x += 0.00037) {
+		EXPECT_NEAR(eta.getEtaFromCoG(x), lookup(x), 1e-12);
+	}
+}
+
+/** Single bin and inconsistent input.
+ */
+TEST(EUTelEtaLookupTest, EdgeCases) {
+
+	EUTelEtaLookup single(std::vector<double>(1, 0.1), std::vector<double>(1, 0.7));
+	EXPECT_DOUBLE_EQ(0.7, single(-1.));
+	EXPECT_DOUBLE_EQ(0.7, single(0.1));
+	EXPECT_DOUBLE_EQ(0.7, single(1.));
+
+	EXPECT_THROW(EUTelEtaLookup(std::vector<double>(), std::vector<double>()), InvalidParameterException);
+	EXPECT_THROW(EUTelEtaLookup(std::vector<double>(3, 0.), std::vector<double>(2, 0.)), InvalidParameterException);
+}
+
+/** 10^7 lookups, the binary search against the uniform grid.
+ */
+TEST(EUTelEtaLookupTest, DISABLED_Benchmark) {
+
+	EUTelEtaFunctionImpl eta = makeEta(11, 200);
+	EUTelEtaLookup lookup = eta.makeLookup();
+
+	size_t const nLookups = 10000000;
+	std::vector<double> cogs(1 << 16);
+	std::default_random_engine generator(5);
+	std::uniform_real_distribution<double> cog(-0.55, 0.55);
+	for(auto & x : cogs) x = cog(generator);
+
+	double sumSearch = 0;
+	double const searchMs = eutelbenchmark::milliseconds([&] {
+		for(size_t i = 0; i < nLookups; ++i) sumSearch += eta.getEtaFromCoG(cogs[i & (cogs.size() - 1)]);
+	});
+
+	double sumLookup = 0;
+	double const gridMs = eutelbenchmark::milliseconds([&] {
+		for(size_t i = 0; i < nLookups; ++i) sumLookup += lookup(cogs[i & (cogs.size() - 1)]);
+	});
+
+	eutelbenchmark::report(std::to_string(nLookups) + " eta lookups", {{"binary search", searchMs}, {"uniform grid", gridMs}});
+
+	EXPECT_NEAR(sumSearch, sumLookup, nLookups * lookup.getMaxCellIncrement());
+}
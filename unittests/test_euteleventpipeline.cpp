@@ -0,0 +1,367 @@
+//STL
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelEventPipeline.h"
+
+using eutelescope::EUTelEventPipeline;
+
+namespace {
+
+	struct Pixel {
+		int x;
+		int y;
+		int signal;
+	};
+
+	struct Hit {
+		double x;
+		double y;
+	};
+
+	// A synthetic telescope event: raw pixels of six planes, then
+	// clusters, hits and a straight track through them
+	struct Event {
+		int number;
+		std::vector<std::vector<Pixel>> pixels;
+		std::vector<std::vector<std::vector<Pixel>>> clusters;
+		std::vector<Hit> hits;
+		double slopeX;
+		double slopeY;
+		double offsetX;
+		double offsetY;
+		double correction;
+	};
+
+	std::vector<Event> makeRun(int nEvents) {
+		std::default_random_engine generator(50);
+		std::normal_distribution<double> slope(0., 0.002), offset(0., 2.);
+		std::uniform_int_distribution<int> size(1, 6), signal(1, 100), noise(0, 40), x(0, 1151), y(0, 575);
+		std::vector<Event> run;
+		for(int i = 0; i < nEvents; ++i) {
+			Event event{i, std::vector<std::vector<Pixel>>(6), {}, {}, 0., 0., 0., 0., 0.};
+			double const sx = slope(generator), sy = slope(generator), ox = offset(generator), oy = offset(generator);
+			for(int plane = 0; plane < 6; ++plane) {
+				int const cx = 576 + static_cast<int>(std::lround((ox + 150. * plane * sx) / 0.0184));
+				int const cy = 288 + static_cast<int>(std::lround((oy + 150. * plane * sy) / 0.0184));
+				for(int n = size(generator); n > 0; --n) event.pixels[plane].push_back(Pixel{cx + n % 2, cy + n / 2, signal(generator)});
+				for(int n = noise(generator); n > 0; --n) event.pixels[plane].push_back(Pixel{x(generator), y(generator), signal(generator)});
+			}
+			run.push_back(event);
+		}
+		return run;
+	}
+
+	// Thread safe: pixels within two of each other on a plane form a
+	// cluster, the scratch buffer is per thread
+	void clustering(Event & event, std::vector<char> & used) {
+		event.clusters.assign(event.pixels.size(), {});
+		for(size_t plane = 0; plane < event.pixels.size(); ++plane) {
+			auto const & pixels = event.pixels[plane];
+			used.assign(pixels.size(), 0);
+			for(size_t seed = 0; seed < pixels.size(); ++seed) {
+				if(used[seed]) continue;
+				std::vector<Pixel> cluster(1, pixels[seed]);
+				used[seed] = 1;
+				for(size_t i = 0; i < cluster.size(); ++i) {
+					for(size_t other = 0; other < pixels.size(); ++other) {
+						if(!used[other] && std::abs(pixels[other].x - cluster[i].x) <= 2 && std::abs(pixels[other].y - cluster[i].y) <= 2) {
+							used[other] = 1;
+							cluster.push_back(pixels[other]);
+						}
+					}
+				}
+				event.clusters[plane].push_back(cluster);
+			}
+		}
+	}
+
+	// Thread safe: the largest cluster of every plane becomes its hit
+	void hitMaking(Event & event) {
+		event.hits.clear();
+		for(auto const & clusters : event.clusters) {
+			Hit hit{0., 0.};
+			int best = -1;
+			for(auto const & cluster : clusters) {
+				int total = 0;
+				double sx = 0., sy = 0.;
+				for(auto const & pixel : cluster) {
+					total += pixel.signal;
+					sx += pixel.signal * pixel.x;
+					sy += pixel.signal * pixel.y;
+				}
+				if(total > best) {
+					best = total;
+					hit = Hit{sx / total * 0.0184, sy / total * 0.0184};
+				}
+			}
+			event.hits.push_back(hit);
+		}
+	}
+
+	// Thread safe: straight line fit in x and y
+	void fitting(Event & event) {
+		double sz = 0., szz = 0., sx = 0., szx = 0., sy = 0., szy = 0.;
+		for(size_t plane = 0; plane < event.hits.size(); ++plane) {
+			double const z = 150. * plane;
+			sz += z;
+			szz += z * z;
+			sx += event.hits[plane].x;
+			szx += z * event.hits[plane].x;
+			sy += event.hits[plane].y;
+			szy += z * event.hits[plane].y;
+		}
+		double const n = static_cast<double>(event.hits.size());
+		double const det = n * szz - sz * sz;
+		event.slopeX = (n * szx - sz * sx) / det;
+		event.offsetX = (sx - event.slopeX * sz) / n;
+		event.slopeY = (n * szy - sz * sy) / det;
+		event.offsetY = (sy - event.slopeY * sz) / n;
+	}
+
+	// Not thread safe: a running mean over all former events, as an
+	// alignment or a histogram would keep it
+	struct RunningMean {
+		double sum;
+		int n;
+		void operator()(Event & event, unsigned int) {
+			event.correction = n > 0 ? sum / n : 0.;
+			sum += event.offsetX;
+			++n;
+		}
+	};
+
+	// Not thread safe: the output file
+	struct Output {
+		std::vector<std::string> records;
+		void operator()(Event & event, unsigned int) {
+			std::ostringstream record;
+			record.precision(17);
+			record << event.number << ' ' << event.slopeX << ' ' << event.slopeY << ' ' << event.offsetX << ' '
+			       << event.offsetY << ' ' << event.correction;
+			for(auto const & clusters : event.clusters) record << ' ' << clusters.size();
+			records.push_back(record.str());
+		}
+	};
+
+	// Clustering, hit making and fitting on the worker threads, the
+	// running mean and the output in event order
+	std::vector<std::string> runChain(std::vector<Event> const & run, int nThreads) {
+		EUTelEventPipeline<Event> pipeline(nThreads, 4 * static_cast<size_t>(nThreads));
+		std::vector<std::vector<char>> used(pipeline.getNThreads());
+		RunningMean mean{0., 0};
+		Output output{{}};
+		pipeline.addStage([&used](Event & event, unsigned int thread) { clustering(event, used[thread]); }, true);
+		pipeline.addStage([](Event & event, unsigned int) { hitMaking(event); }, true);
+		pipeline.addStage([](Event & event, unsigned int) { fitting(event); }, true);
+		pipeline.addStage(std::ref(mean), false);
+		pipeline.addStage(std::ref(output), false);
+
+		for(auto const & event : run) pipeline.push(event);
+		pipeline.finish();
+		EXPECT_EQ(run.size(), pipeline.getNProcessed());
+		return output.records;
+	}
+}
+
+/** Eight threads give the same output as one thread, event by event.
+ */
+TEST(EUTelEventPipelineTest, EightThreadsAsOne) {
+
+	std::vector<Event> const run = makeRun(2000);
+	std::vector<std::string> const single = runChain(run, 1);
+	ASSERT_EQ(run.size(), single.size());
+	for(int repeat = 0; repeat < 3; ++repeat) {
+		std::vector<std::string> const eight = runChain(run, 8);
+		ASSERT_EQ(single.size(), eight.size());
+		for(size_t i = 0; i < single.size(); ++i) ASSERT_EQ(single[i], eight[i]) << "event " << i;
+	}
+}
+
+/** Stages which are not thread safe see the events in order and never
+ *  two at a time, no more than maxInFlight events are in the pipeline.
+ */
+TEST(EUTelEventPipelineTest, OrderAndInFlight) {
+
+	EUTelEventPipeline<int> pipeline(8, 12);
+	EXPECT_EQ(8u, pipeline.getNThreads());
+	EXPECT_EQ(12u, pipeline.getMaxInFlight());
+
+	std::atomic<int> inFlight(0), maxInFlight(0), inSerial(0), maxInSerial(0);
+	std::vector<int> first, second;
+	std::default_random_engine generator(51);
+	std::vector<int> work(5000);
+	std::uniform_int_distribution<int> amount(0, 2000);
+	for(auto & value : work) value = amount(generator);
+
+	auto const enter = [](std::atomic<int> & counter, std::atomic<int> & maximum) {
+		int const now = ++counter;
+		int seen = maximum.load();
+		while(now > seen && !maximum.compare_exchange_weak(seen, now)) {}
+	};
+	pipeline.addStage([&](int & event, unsigned int) {
+		enter(inFlight, maxInFlight);
+		volatile double sink = 0.;
+		for(int i = 0; i < work[event]; ++i) sink = sink + std::sqrt(static_cast<double>(i));
+	}, true);
+	pipeline.addStage([&](int & event, unsigned int) {
+		enter(inSerial, maxInSerial);
+		first.push_back(event);
+		--inSerial;
+	}, false);
+	pipeline.addStage([&](int & event, unsigned int) {
+		volatile double sink = 0.;
+		for(int i = 0; i < work[work.size() - 1 - event]; ++i) sink = sink + std::sqrt(static_cast<double>(i));
+	}, true);
+	pipeline.addStage([&](int & event, unsigned int) {
+		enter(inSerial, maxInSerial);
+		second.push_back(event);
+		--inSerial;
+		--inFlight;
+	}, false);
+
+	for(int event = 0; event < static_cast<int>(work.size()); ++event) pipeline.push(event);
+	EXPECT_FALSE(pipeline.addStage([](int &, unsigned int) {}, true));
+	pipeline.finish();
+
+	ASSERT_EQ(work.size(), first.size());
+	ASSERT_EQ(work.size(), second.size());
+	for(int event = 0; event < static_cast<int>(work.size()); ++event) {
+		ASSERT_EQ(event, first[event]);
+		ASSERT_EQ(event, second[event]);
+	}
+	// the two serial stages may run at the same time, each one alone
+	EXPECT_LE(maxInSerial.load(), 2);
+	EXPECT_LE(maxInFlight.load(), 12);
+	EXPECT_EQ(work.size(), pipeline.getNProcessed());
+}
+
+/** An exception of a stage comes back in the calling thread, the
+ *  stages are not called any more afterwards.
+ */
+TEST(EUTelEventPipelineTest, Exceptions) {
+
+	for(int nThreads : {1, 8}) {
+		EUTelEventPipeline<int> pipeline(nThreads, 16);
+		std::atomic<int> nCalls(0);
+		pipeline.addStage([&](int & event, unsigned int) {
+			++nCalls;
+			if(event == 100) throw std::runtime_error("bad event");
+		}, true);
+		bool thrown = false;
+		int event = 0;
+		try {
+			for(; event < 1000; ++event) pipeline.push(event);
+			pipeline.finish();
+		} catch(std::runtime_error const & error) {
+			thrown = true;
+			EXPECT_EQ(std::string("bad event"), error.what());
+		}
+		EXPECT_TRUE(thrown);
+		EXPECT_GE(event, 100);
+		EXPECT_NO_THROW(pipeline.finish());
+		EXPECT_LE(nCalls.load(), 101 + 16);
+		EXPECT_EQ(static_cast<size_t>(event + (event < 1000 ? 1 : 0)), pipeline.getNProcessed());
+	}
+}
+
+/** The final stage runs in the calling thread, in push order, on
+ *  events which can only be moved, as the driver hands them over.
+ */
+TEST(EUTelEventPipelineTest, FinalStage) {
+
+	for(int nThreads : {1, 8}) {
+		EUTelEventPipeline<std::unique_ptr<int>> pipeline(nThreads, 10);
+		std::thread::id const caller = std::this_thread::get_id();
+		std::atomic<int> inFlight(0), maxInFlight(0);
+		std::vector<int> received;
+		bool inCaller = true;
+		unsigned int finalThread = 0;
+
+		pipeline.addStage([&](std::unique_ptr<int> & event, unsigned int) {
+			int const now = ++inFlight;
+			int seen = maxInFlight.load();
+			while(now > seen && !maxInFlight.compare_exchange_weak(seen, now)) {}
+			volatile double sink = 0.;
+			for(int i = 0; i < (*event * 7919) % 3000; ++i) sink = sink + std::sqrt(static_cast<double>(i));
+			*event *= 3;
+		}, true);
+		EXPECT_TRUE(pipeline.setFinalStage([&](std::unique_ptr<int> & event, unsigned int thread) {
+			inCaller = inCaller && std::this_thread::get_id() == caller;
+			finalThread = thread;
+			received.push_back(*event);
+			--inFlight;
+		}));
+
+		for(int event = 0; event < 3000; ++event) pipeline.push(std::unique_ptr<int>(new int(event)));
+		EXPECT_FALSE(pipeline.setFinalStage([](std::unique_ptr<int> &, unsigned int) {}));
+		pipeline.finish();
+
+		EXPECT_TRUE(inCaller);
+		EXPECT_EQ(pipeline.getNThreads(), finalThread);
+		EXPECT_LE(maxInFlight.load(), 10);
+		EXPECT_EQ(3000u, pipeline.getNProcessed());
+		ASSERT_EQ(3000u, received.size());
+		for(int event = 0; event < 3000; ++event) ASSERT_EQ(3 * event, received[event]);
+
+		// an exception of the final stage comes back the same way
+		EUTelEventPipeline<int> failing(nThreads, 10);
+		failing.setFinalStage([](int & event, unsigned int) {
+			if(event == 50) throw std::runtime_error("bad output");
+		});
+		EXPECT_THROW({
+			for(int event = 0; event < 500; ++event) failing.push(event);
+			failing.finish();
+		}, std::runtime_error);
+		EXPECT_NO_THROW(failing.finish());
+	}
+}
+
+/** A pipeline without stages and one reused after finish().
+ */
+TEST(EUTelEventPipelineTest, EmptyAndRestart) {
+
+	EUTelEventPipeline<int> empty(4, 0);
+	EXPECT_EQ(4u, empty.getMaxInFlight());
+	for(int event = 0; event < 10; ++event) empty.push(event);
+	empty.finish();
+	EXPECT_EQ(10u, empty.getNProcessed());
+
+	EUTelEventPipeline<int> pipeline(3, 6);
+	std::vector<int> received;
+	pipeline.addStage([](int & event, unsigned int) { event *= 2; }, true);
+	pipeline.addStage([&received](int & event, unsigned int) { received.push_back(event); }, false);
+	for(int event = 0; event < 10; ++event) pipeline.push(event);
+	pipeline.finish();
+	for(int event = 10; event < 20; ++event) pipeline.push(event);
+	pipeline.finish();
+	ASSERT_EQ(20u, received.size());
+	for(int event = 0; event < 20; ++event) EXPECT_EQ(2 * event, received[event]);
+}
+
+/** The synthetic reconstruction chain on one and on eight threads.
+ */
+TEST(EUTelEventPipelineTest, DISABLED_Benchmark) {
+
+	std::vector<Event> const run = makeRun(5000);
+	std::vector<std::string> single, eight;
+	double const singleMs = eutelbenchmark::milliseconds([&] { single = runChain(run, 1); });
+	double const eightMs = eutelbenchmark::milliseconds([&] { eight = runChain(run, 8); });
+	eutelbenchmark::report(std::to_string(run.size()) + " events on " + std::to_string(std::thread::hardware_concurrency()) + " cores",
+	                       {{"1 thread", singleMs}, {"8 threads", eightMs}});
+	EXPECT_EQ(single, eight);
+}
@@ -0,0 +1,106 @@
+//STL
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelFrameCache.h"
+
+using eutelescope::EUTelFrameCache;
+
+namespace {
+
+	// A synthetic raw frame: pedestal + noise, as a ShortVec
+	std::vector<short> makeFrame(std::default_random_engine & generator, size_t nPixel) {
+		std::normal_distribution<double> adc(1000., 5.);
+		std::vector<short> frame(nPixel);
+		for(auto & value : frame) value = static_cast<short>(adc(generator));
+		return frame;
+	}
+}
+
+/** Frames of several detectors come back unchanged and in event order.
+ */
+TEST(EUTelFrameCacheTest, RoundTrip) {
+
+	std::vector<size_t> const sizes = {64 * 32, 16 * 16, 128};
+	EUTelFrameCache cache;
+	cache.configure(sizes, 1 << 20);
+	ASSERT_EQ((64 * 32 + 16 * 16 + 128) * sizeof(short), cache.getEventSize());
+
+	std::default_random_engine generator(3);
+	std::vector<std::vector<std::vector<short>>> reference;
+	for(int iEvent = 0; iEvent < 50; ++iEvent) {
+		ASSERT_TRUE(cache.beginEvent());
+		reference.emplace_back();
+		for(size_t iDetector = 0; iDetector < sizes.size(); ++iDetector) {
+			reference.back().push_back(makeFrame(generator, sizes[iDetector]));
+			cache.fill(iDetector, reference.back().back());
+		}
+	}
+
+	ASSERT_TRUE(cache.isValid());
+	ASSERT_EQ(50u, cache.getNEvents());
+	for(size_t iEvent = 0; iEvent < reference.size(); ++iEvent) {
+		for(size_t iDetector = 0; iDetector < sizes.size(); ++iDetector) {
+			std::vector<short> const frame(cache.getFrame(iDetector, iEvent),
+			                               cache.getFrame(iDetector, iEvent) + cache.getFrameSize(iDetector));
+			EXPECT_EQ(reference[iEvent][iDetector], frame);
+		}
+	}
+}
+
+/** The event exceeding the budget drops the cache.
+ */
+TEST(EUTelFrameCacheTest, MemoryBudget) {
+
+	EUTelFrameCache cache;
+	cache.configure({100}, 10 * 100 * sizeof(short));
+
+	std::vector<short> const frame(100, 7);
+	for(int iEvent = 0; iEvent < 10; ++iEvent) {
+		ASSERT_TRUE(cache.beginEvent());
+		cache.fill(0, frame);
+	}
+	EXPECT_TRUE(cache.isValid());
+
+	EXPECT_FALSE(cache.beginEvent());
+	EXPECT_FALSE(cache.isValid());
+	EXPECT_EQ(EUTelFrameCache::kBudgetExceeded, cache.getStatus());
+	EXPECT_EQ(0u, cache.getNEvents());
+	EXPECT_FALSE(cache.beginEvent());
+}
+
+/** Missing, doubled or resized detectors drop the cache as well.
+ */
+TEST(EUTelFrameCacheTest, InconsistentEvents) {
+
+	std::vector<short> const small(10, 1), large(20, 1);
+
+	EUTelFrameCache missing;
+	missing.configure({10, 10}, 1 << 20);
+	missing.beginEvent();
+	missing.fill(0, small);
+	EXPECT_FALSE(missing.isValid());
+	EXPECT_FALSE(missing.beginEvent());
+	EXPECT_EQ(EUTelFrameCache::kInconsistentEvent, missing.getStatus());
+
+	EUTelFrameCache doubled;
+	doubled.configure({10, 10}, 1 << 20);
+	doubled.beginEvent();
+	doubled.fill(0, small);
+	doubled.fill(0, small);
+	EXPECT_EQ(EUTelFrameCache::kInconsistentEvent, doubled.getStatus());
+
+	EUTelFrameCache resized;
+	resized.configure({10}, 1 << 20);
+	resized.beginEvent();
+	resized.fill(0, large);
+	EXPECT_FALSE(resized.isValid());
+
+	EUTelFrameCache notConfigured;
+	EXPECT_FALSE(notConfigured.beginEvent());
+	EXPECT_EQ(EUTelFrameCache::kNotConfigured, notConfigured.getStatus());
+}
@@ -0,0 +1,184 @@
+//STL
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelGaussJordan.h"
+
+using eutelescope::EUTelGaussJordan;
+
+namespace {
+
+	// The Gauss-Jordan routine formerly used by EUTelTestFitter, inverting
+	// alfa and solving for beta in one go
+	int gaussjSolve(double * alfa, double * beta, int n) {
+		std::vector<int> ipiv(n, 0), indxr(n), indxc(n);
+		int irow = 0;
+		int icol = 0;
+		for(int i = 0; i < n; i++) {
+			double big = 0.;
+			for(int j = 0; j < n; j++) {
+				if(ipiv[j] == 1) continue;
+				for(int k = 0; k < n; k++) {
+					if(ipiv[k] != 0) continue;
+					if(std::fabs(alfa[n * j + k]) > big) {
+						big = std::fabs(alfa[n * j + k]);
+						irow = j;
+						icol = k;
+					}
+				}
+			}
+			ipiv[icol]++;
+			if(ipiv[icol] > 1) return 1;
+			if(irow != icol) {
+				std::swap(beta[irow], beta[icol]);
+				for(int j = 0; j < n; j++) std::swap(alfa[n * irow + j], alfa[n * icol + j]);
+			}
+			indxr[i] = irow;
+			indxc[i] = icol;
+			if(alfa[n * icol + icol] == 0.) return 1;
+			double const pivinv = 1. / alfa[n * icol + icol];
+			alfa[n * icol + icol] = 1.;
+			for(int j = 0; j < n; j++) alfa[n * icol + j] *= pivinv;
+			beta[icol] *= pivinv;
+			for(int j = 0; j < n; j++) {
+				if(j == icol) continue;
+				double const help = alfa[n * j + icol];
+				alfa[n * j + icol] = 0.;
+				for(int k = 0; k < n; k++) alfa[n * j + k] -= alfa[n * icol + k] * help;
+				beta[j] -= beta[icol] * help;
+			}
+		}
+		for(int i = n - 1; i >= 0; i--) {
+			if(indxr[i] == indxc[i]) continue;
+			for(int j = 0; j < n; j++) std::swap(alfa[n * j + indxr[i]], alfa[n * j + indxc[i]]);
+		}
+		return 0;
+	}
+
+	// Band matrix like the track fit one: position weights of the fired
+	// planes on the diagonal plus multiple scattering terms
+	std::vector<double> fitMatrix(std::default_random_engine & generator, int n, unsigned int fired) {
+		std::uniform_real_distribution<double> scattering(0.5, 2.);
+		std::vector<double> alfa(n * n, 0.);
+		for(int i = 1; i < n - 1; i++) {
+			double const s = scattering(generator);
+			double const d[3] = {s, -2. * s, s};
+			for(int j = 0; j < 3; j++) {
+				for(int k = 0; k < 3; k++) alfa[n * (i - 1 + j) + i - 1 + k] += d[j] * d[k];
+			}
+		}
+		for(int i = 0; i < n; i++) {
+			if(fired & (1u << i)) alfa[n * i + i] += 1. / (0.0043 * 0.0043);
+		}
+		return alfa;
+	}
+}
+
+/** Solving with a factorisation gives bit for bit what the combined
+ *  inversion and elimination gives, also when reused for several
+ *  right-hand sides.
+ */
+TEST(EUTelGaussJordanTest, MatchesGaussj) {
+
+	std::default_random_engine generator(42);
+	std::normal_distribution<double> position(0., 10.);
+	EUTelGaussJordan solver;
+
+	for(int n = 2; n <= 8; ++n) {
+		for(unsigned int fired = 0; fired < (1u << n); ++fired) {
+			std::vector<double> const alfa = fitMatrix(generator, n, fired);
+			std::vector<double> inverse = alfa;
+			bool const valid = solver.factorise(inverse.data(), n);
+
+			for(int iRhs = 0; iRhs < 3; ++iRhs) {
+				std::vector<double> reference = alfa;
+				std::vector<double> referenceBeta(n);
+				for(auto & value : referenceBeta) value = position(generator);
+				std::vector<double> beta = referenceBeta;
+
+				int const status = gaussjSolve(reference.data(), referenceBeta.data(), n);
+				ASSERT_EQ(status == 0, valid);
+				if(!valid) break;
+
+				solver.solve(beta.data());
+				for(int i = 0; i < n; ++i) ASSERT_EQ(referenceBeta[i], beta[i]);
+				for(int i = 0; i < n * n; ++i) {
+					ASSERT_EQ(reference[i], inverse[i]);
+					ASSERT_EQ(reference[i], solver.getInverse()[i]);
+				}
+			}
+		}
+	}
+}
+
+/** A singular matrix is reported as such.
+ */
+TEST(EUTelGaussJordanTest, Singular) {
+
+	EUTelGaussJordan solver;
+	std::vector<double> alfa = {1., 2.,
+	                            2., 4.};
+	EXPECT_FALSE(solver.factorise(alfa.data(), 2));
+	EXPECT_FALSE(solver.isValid());
+
+	alfa = {0., 0.,
+	        0., 0.};
+	EXPECT_FALSE(solver.factorise(alfa.data(), 2));
+
+	alfa = {2., 0.,
+	        0., 4.};
+	ASSERT_TRUE(solver.factorise(alfa.data(), 2));
+	double beta[2] = {1., 1.};
+	solver.solve(beta);
+	EXPECT_EQ(0.5, beta[0]);
+	EXPECT_EQ(0.25, beta[1]);
+}
+
+/** Reusing the factorisation of a 9 plane fit matrix instead of
+ *  eliminating again for each fit.
+ */
+TEST(EUTelGaussJordanTest, DISABLED_Benchmark) {
+
+	int const n = 9;
+	int const nFits = 100000;
+	std::default_random_engine generator(7);
+	std::normal_distribution<double> position(0., 10.);
+	std::vector<double> const alfa = fitMatrix(generator, n, (1u << n) - 1);
+	std::vector<double> beta(n);
+	double sum = 0.;
+
+	double const gaussjMs = eutelbenchmark::milliseconds([&] {
+		for(int iFit = 0; iFit < nFits; ++iFit) {
+			std::vector<double> work = alfa;
+			for(auto & value : beta) value = position(generator);
+			gaussjSolve(work.data(), beta.data(), n);
+			sum += beta[0];
+		}
+	});
+
+	double const solveMs = eutelbenchmark::milliseconds([&] {
+		EUTelGaussJordan solver;
+		std::vector<double> work = alfa;
+		solver.factorise(work.data(), n);
+		for(int iFit = 0; iFit < nFits; ++iFit) {
+			for(auto & value : beta) value = position(generator);
+			solver.solve(beta.data());
+			sum += beta[0];
+		}
+	});
+
+	eutelbenchmark::report(std::to_string(nFits) + " fits of " + std::to_string(n) + " planes",
+	                       {{"gaussj", gaussjMs}, {"cached factorisation", solveMs}});
+	// keeps the solutions from being optimised away
+	EXPECT_TRUE(std::isfinite(sum));
+}
@@ -3,6 +3,9 @@
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 //Eigen
 #include <Eigen/Core>
@@ -300,6 +303,68 @@ TEST_F(eutelgeotestTest, radLengthTest1) {
 	std::cout << "Rad: " << eugeo::gGeometry().getRadiationLengthBetweenPoints(begin3, end3) << std::endl;
 }
 
-
+/** The TGeo description read from the persistent cache has to give the same pixel names,
+ *  pixel positions and local2Master results as the one built from GEAR, bit by bit.
+ */
+TEST_F(eutelgeotestTest, GeometryCacheMatchesColdBuild) {
+
+	auto & geo = eugeo::gGeometry();
+	auto sensorIdVec = geo.sensorIDsVec();
+
+	std::uniform_real_distribution<double> distribution(-5.0,5.0);
+	std::vector<double> points(3*100);
+	for(auto & x : points) x = distribution(generator);
+
+	// pixel names, global pixel centres and transformed points of every plane
+	auto record = [&](std::vector<std::string> & names, std::vector<double> & positions) {
+		for(auto sensorID: sensorIdVec) {
+			auto pixGeoDescr = geo.getPixGeoDescr(sensorID);
+			int minX, maxX, minY, maxY;
+			pixGeoDescr->getPixelIndexRange(minX, maxX, minY, maxY);
+			for(int x : {minX, (minX+maxX)/2, maxX}) {
+				for(int y : {minY, (minY+maxY)/2, maxY}) {
+					names.push_back(pixGeoDescr->getPixName(x, y));
+					ASSERT_TRUE(geo._geoManager->cd((geo.getPlanePath(sensorID)+names.back()).c_str()));
+					double const local[3] = {0, 0, 0};
+					double global[3];
+					geo._geoManager->LocalToMaster(local, global);
+					positions.insert(positions.end(), global, global+3);
+				}
+			}
+			for(size_t i = 0; i < points.size(); i += 3) {
+				double global[3];
+				geo.local2Master(sensorID, &points[i], global);
+				positions.insert(positions.end(), global, global+3);
+			}
+		}
+	};
+
+	geo.resetTGeoDescription();
+	geo.setGeometryCacheDirectory(".");
+	std::string const cacheFile = geo.getGeometryCacheFile();
+	std::remove(cacheFile.c_str());
+
+	geo.initializeTGeoDescription("test.root", false);
+	ASSERT_FALSE(geo.isLoadedFromCache());
+	std::vector<std::string> coldNames;
+	std::vector<double> coldPositions;
+	record(coldNames, coldPositions);
+
+	geo.resetTGeoDescription();
+	geo.initializeTGeoDescription("test.root", false);
+	ASSERT_TRUE(geo.isLoadedFromCache());
+	std::vector<std::string> cachedNames;
+	std::vector<double> cachedPositions;
+	record(cachedNames, cachedPositions);
+
+	EXPECT_EQ(coldNames, cachedNames);
+	EXPECT_EQ(coldPositions, cachedPositions);
+
+	// leave a geometry built from GEAR for the other tests
+	std::remove(cacheFile.c_str());
+	geo.resetTGeoDescription();
+	geo.setGeometryCacheDirectory("");
+	geo.initializeTGeoDescription("test.root", false);
+}
 
 // }  // namespace - could surround eutelgeotestTest in a namespace
@@ -0,0 +1,275 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelHitGrid.h"
+
+using eutelescope::EUTelHitGrid;
+
+namespace {
+
+	// A hit in the telescope frame
+	struct Hit {
+		bool inDUT;
+		double x;
+		double y;
+	};
+
+	// From the telescope to the DUT frame, a rotation around z as in
+	// EUTelProcessorAnalysisPALPIDEfs::_EulerRotationBack
+	struct Frame {
+		double angle;
+		void toDUT(Hit const & hit, double & x, double & y) const {
+			double const c = std::cos(-angle), s = std::sin(-angle);
+			x = c * hit.x - s * hit.y;
+			y = s * hit.x + c * hit.y;
+		}
+		Hit toTelescope(bool inDUT, double x, double y) const {
+			double const c = std::cos(angle), s = std::sin(angle);
+			return Hit{inDUT, c * x - s * y, s * x + c * y};
+		}
+	};
+
+	// What the hit loop of EUTelProcessorAnalysisPALPIDEfs::processEvent
+	// does for one track
+	struct Outcome {
+		std::vector<int> visited;
+		int associated;
+		int nAssociated;
+		double x;
+		double y;
+	};
+
+	bool operator==(Outcome const & a, Outcome const & b) {
+		return a.visited == b.visited && a.associated == b.associated && a.nAssociated == b.nAssociated &&
+		       ((a.x == b.x && a.y == b.y) || a.associated == -1);
+	}
+
+	// The hit loop as it was: every hit is transformed to the DUT frame
+	// where it is used, every associated hit starts a loop over all
+	// following hits
+	Outcome referencePairing(std::vector<Hit> const & hits, Frame const & frame, double xFit, double yFit, double limit) {
+		Outcome outcome{{}, -1, 0, 0., 0.};
+		int const nHit = static_cast<int>(hits.size());
+		for(int ihit = 0; ihit < nHit; ihit++) {
+			if(!hits[ihit].inDUT) continue;
+			outcome.visited.push_back(ihit);
+			double xpos, ypos;
+			frame.toDUT(hits[ihit], xpos, ypos);
+			if(std::abs(xpos - xFit) < limit && std::abs(ypos - yFit) < limit) {
+				outcome.nAssociated++;
+				outcome.associated = ihit;
+				for(int jhit = ihit + 1; jhit < nHit; jhit++) {
+					if(!hits[jhit].inDUT) continue;
+					double xposNext, yposNext;
+					frame.toDUT(hits[jhit], xposNext, yposNext);
+					if(std::abs(xposNext - xFit) > limit || std::abs(yposNext - yFit) > limit) continue;
+					outcome.nAssociated++;
+					if(!((xpos - xFit) * (xpos - xFit) + (ypos - yFit) * (ypos - yFit) <
+					     (xposNext - xFit) * (xposNext - xFit) + (yposNext - yFit) * (yposNext - yFit))) {
+						xpos = xposNext;
+						ypos = yposNext;
+						outcome.associated = jhit;
+					}
+					ihit = jhit;
+				}
+				outcome.x = xpos;
+				outcome.y = ypos;
+			}
+		}
+		return outcome;
+	}
+
+	// The hit loop with the hits transformed once per event and in the
+	// grid
+	Outcome gridPairing(std::vector<Hit> const & hits, EUTelHitGrid const & grid, double xFit, double yFit, double limit,
+	                    std::vector<int> & neighbours) {
+		Outcome outcome{{}, -1, 0, 0., 0.};
+		int const nHit = static_cast<int>(hits.size());
+		for(int ihit = 0; ihit < nHit; ihit++) {
+			if(!hits[ihit].inDUT) continue;
+			outcome.visited.push_back(ihit);
+			double xpos = hits[ihit].x, ypos = hits[ihit].y;
+			if(std::abs(xpos - xFit) < limit && std::abs(ypos - yFit) < limit) {
+				outcome.nAssociated++;
+				outcome.associated = ihit;
+				grid.find(xFit, yFit, neighbours);
+				for(int jhit : neighbours) {
+					if(jhit <= ihit) continue;
+					double const xposNext = hits[jhit].x, yposNext = hits[jhit].y;
+					outcome.nAssociated++;
+					if(!((xpos - xFit) * (xpos - xFit) + (ypos - yFit) * (ypos - yFit) <
+					     (xposNext - xFit) * (xposNext - xFit) + (yposNext - yFit) * (yposNext - yFit))) {
+						xpos = xposNext;
+						ypos = yposNext;
+						outcome.associated = jhit;
+					}
+					ihit = jhit;
+				}
+				outcome.x = xpos;
+				outcome.y = ypos;
+			}
+		}
+		return outcome;
+	}
+
+	// Transform the hits of an event and fill the grid, the hits in the
+	// DUT frame are returned
+	std::vector<Hit> fill(EUTelHitGrid & grid, std::vector<Hit> const & hits, Frame const & frame, double limit) {
+		std::vector<Hit> local(hits.size(), Hit{false, 0., 0.});
+		grid.reset(limit);
+		for(size_t i = 0; i < hits.size(); ++i) {
+			local[i].inDUT = hits[i].inDUT;
+			frame.toDUT(hits[i], local[i].x, local[i].y);
+			if(hits[i].inDUT) grid.addHit(static_cast<int>(i), local[i].x, local[i].y);
+		}
+		grid.build();
+		return local;
+	}
+
+	// Hits on a 30 x 15 mm chip, some of them close to the fit, some
+	// exactly on the border of the association window
+	std::vector<Hit> makeEvent(std::default_random_engine & generator, Frame const & frame, int nHits, double xFit, double yFit,
+	                           double limit) {
+		std::uniform_real_distribution<double> x(0., 30.), y(0., 15.), close(-2. * limit, 2. * limit), kind(0., 1.);
+		std::vector<Hit> hits;
+		for(int i = 0; i < nHits; ++i) {
+			double const k = kind(generator);
+			if(k < 0.2) hits.push_back(frame.toTelescope(false, x(generator), y(generator)));
+			else if(k < 0.4) hits.push_back(frame.toTelescope(true, xFit + close(generator), yFit + close(generator)));
+			else if(k < 0.45) hits.push_back(frame.toTelescope(true, xFit + (k < 0.425 ? limit : -limit), yFit + close(generator)));
+			else hits.push_back(frame.toTelescope(true, x(generator), y(generator)));
+		}
+		return hits;
+	}
+}
+
+/** The hits inside the window, in increasing order, also for positions
+ *  without a cell and a limit which is not positive.
+ */
+TEST(EUTelHitGridTest, Window) {
+
+	EUTelHitGrid grid;
+	grid.reset(0.5);
+	grid.addHit(7, 1., 1.);
+	grid.addHit(3, 1.5, 0.5);
+	grid.addHit(9, 1.75, 1.);
+	grid.addHit(4, std::numeric_limits<double>::quiet_NaN(), 1.);
+	grid.addHit(5, 1e300, 1.);
+	grid.build();
+	EXPECT_EQ(5u, grid.getNHits());
+
+	std::vector<int> result;
+	grid.find(1., 1., result);
+	// comparisons with NaN fail, also the one rejecting a hit
+	EXPECT_EQ((std::vector<int>{3, 4, 7}), result);
+	grid.find(1.25, 1., result);
+	EXPECT_EQ((std::vector<int>{3, 4, 7, 9}), result);
+	grid.find(-3., 1., result);
+	EXPECT_EQ((std::vector<int>{4}), result);
+	grid.find(std::numeric_limits<double>::quiet_NaN(), 1., result);
+	EXPECT_EQ((std::vector<int>{3, 4, 5, 7, 9}), result);
+
+	grid.reset(0.);
+	grid.addHit(1, 1., 1.);
+	grid.addHit(0, 1., 1.5);
+	grid.build();
+	grid.find(1., 1., result);
+	EXPECT_EQ((std::vector<int>{1}), result);
+
+	grid.reset(0.5);
+	grid.build();
+	grid.find(1., 1., result);
+	EXPECT_TRUE(result.empty());
+}
+
+/** Random events: the hits visited, associated and counted by the hit
+ *  loop are the same as with the loop over all following hits. The
+ *  DUT is not rotated, so that hits are exactly on the border of the
+ *  association window.
+ */
+TEST(EUTelHitGridTest, MatchesPairLoop) {
+
+	std::default_random_engine generator(48);
+	std::uniform_real_distribution<double> xFit(0.5, 29.5), yFit(0.5, 14.5);
+	std::uniform_int_distribution<int> nHits(0, 60);
+	Frame const frame{0.};
+	EUTelHitGrid grid;
+	std::vector<int> neighbours;
+	int nMultiple = 0;
+	for(double limit : {0.05, 0.1, 0.0375}) {
+		for(int iEvent = 0; iEvent < 2000; ++iEvent) {
+			double const x = xFit(generator), y = yFit(generator);
+			std::vector<Hit> const hits = makeEvent(generator, frame, nHits(generator), x, y, limit);
+			std::vector<Hit> const local = fill(grid, hits, frame, limit);
+			Outcome const expected = referencePairing(hits, frame, x, y, limit);
+			ASSERT_TRUE(expected == gridPairing(local, grid, x, y, limit, neighbours)) << "event " << iEvent;
+			if(expected.nAssociated > 1) ++nMultiple;
+		}
+	}
+	EXPECT_GT(nMultiple, 0);
+}
+
+/** 2000 hits and 100 tracks per event on a DUT rotated by 10 mrad,
+ *  the pair loop against the grid.
+ */
+TEST(EUTelHitGridTest, DISABLED_Benchmark) {
+
+	std::default_random_engine generator(49);
+	std::uniform_real_distribution<double> xFit(0.5, 29.5), yFit(0.5, 14.5);
+	double const limit = 0.05;
+	Frame const frame{0.01};
+	std::vector<std::vector<Hit>> events;
+	std::vector<std::vector<double>> fits;
+	for(int iEvent = 0; iEvent < 20; ++iEvent) {
+		std::vector<double> fit;
+		for(int iTrack = 0; iTrack < 100; ++iTrack) {
+			fit.push_back(xFit(generator));
+			fit.push_back(yFit(generator));
+		}
+		// the hits of all tracks together
+		std::vector<Hit> hits;
+		for(int iTrack = 0; iTrack < 100; ++iTrack) {
+			std::vector<Hit> const trackHits = makeEvent(generator, frame, 20, fit[2 * iTrack], fit[2 * iTrack + 1], limit);
+			hits.insert(hits.end(), trackHits.begin(), trackHits.end());
+		}
+		std::shuffle(hits.begin(), hits.end(), generator);
+		events.push_back(hits);
+		fits.push_back(fit);
+	}
+
+	std::vector<Outcome> expected;
+	double const pairMs = eutelbenchmark::milliseconds([&] {
+		for(size_t iEvent = 0; iEvent < events.size(); ++iEvent) {
+			for(size_t iTrack = 0; iTrack < 100; ++iTrack)
+				expected.push_back(referencePairing(events[iEvent], frame, fits[iEvent][2 * iTrack], fits[iEvent][2 * iTrack + 1], limit));
+		}
+	});
+
+	std::vector<Outcome> outcomes;
+	EUTelHitGrid grid;
+	std::vector<int> neighbours;
+	double const gridMs = eutelbenchmark::milliseconds([&] {
+		for(size_t iEvent = 0; iEvent < events.size(); ++iEvent) {
+			std::vector<Hit> const local = fill(grid, events[iEvent], frame, limit);
+			for(size_t iTrack = 0; iTrack < 100; ++iTrack)
+				outcomes.push_back(gridPairing(local, grid, fits[iEvent][2 * iTrack], fits[iEvent][2 * iTrack + 1], limit, neighbours));
+		}
+	});
+
+	eutelbenchmark::report(std::to_string(events.size()) + " events of 2000 hits and 100 tracks",
+	                       {{"pair loop", pairMs}, {"grid", gridMs}});
+	ASSERT_EQ(expected.size(), outcomes.size());
+	for(size_t i = 0; i < expected.size(); ++i) ASSERT_TRUE(expected[i] == outcomes[i]);
+}
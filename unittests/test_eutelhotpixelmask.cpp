@@ -0,0 +1,179 @@
+//STL
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelHotPixelMask.h"
+
+using eutelescope::EUTelHotPixelMask;
+
+namespace {
+
+	struct HotPixel {
+		int sensorID;
+		int x;
+		int y;
+	};
+
+	// EUTelMille::FillHotPixelMap as it was
+	void referenceFill(std::map<std::string, bool> & hotPixelMap, std::vector<HotPixel> const & hotPixels) {
+		for(auto const & pixel : hotPixels) {
+			char ix[100];
+			snprintf(ix, sizeof(ix), "%d,%d,%d", pixel.sensorID, pixel.x, pixel.y);
+			hotPixelMap[ix] = true;
+		}
+	}
+
+	// EUTelMille::hitContainsHotPixels as it was, on the pixels decoded
+	// from the charge values of the cluster
+	bool referenceContains(std::map<std::string, bool> & hotPixelMap, int sensorID, std::vector<float> const & charges) {
+		for(size_t index = 0; index < charges.size(); index += 4) {
+			int const pixelX = static_cast<short>(charges[index]);
+			int const pixelY = static_cast<short>(charges[index + 1]);
+			char ix[100];
+			snprintf(ix, sizeof(ix), "%d,%d,%d", sensorID, pixelX, pixelY);
+			std::map<std::string, bool>::const_iterator z = hotPixelMap.find(ix);
+			if(z != hotPixelMap.end() && hotPixelMap[ix] == true) return true;
+		}
+		return false;
+	}
+
+	// Hot pixels spread over six Mimosa26 sensors
+	std::vector<HotPixel> makeHotPixels(std::default_random_engine & generator, int nPixels) {
+		std::uniform_int_distribution<int> sensor(0, 5), x(0, 1151), y(0, 575);
+		std::vector<HotPixel> hotPixels;
+		for(int i = 0; i < nPixels; ++i) hotPixels.push_back(HotPixel{sensor(generator), x(generator), y(generator)});
+		return hotPixels;
+	}
+
+	// A cluster around a seed as x, y, signal and time per pixel, half of
+	// the seeds are hot pixels
+	std::vector<float> makeCluster(std::default_random_engine & generator, std::vector<HotPixel> const & hotPixels, int & sensorID) {
+		std::uniform_int_distribution<int> sensor(0, 6), x(0, 1151), y(0, 575), size(1, 6), step(-1, 1), coin(0, 1);
+		std::uniform_int_distribution<size_t> pick(0, hotPixels.size() - 1);
+		int seedX = x(generator), seedY = y(generator);
+		sensorID = sensor(generator);
+		if(coin(generator)) {
+			HotPixel const & hot = hotPixels[pick(generator)];
+			sensorID = hot.sensorID;
+			seedX = hot.x + step(generator);
+			seedY = hot.y + step(generator);
+		}
+		std::vector<float> charges;
+		for(int i = size(generator); i > 0; --i) {
+			charges.push_back(static_cast<float>(seedX + step(generator)));
+			charges.push_back(static_cast<float>(seedY + step(generator)));
+			charges.push_back(1.f);
+			charges.push_back(0.f);
+		}
+		return charges;
+	}
+}
+
+/** Single pixels, the borders of the bitsets and unknown sensors.
+ */
+TEST(EUTelHotPixelMaskTest, Lookup) {
+
+	EUTelHotPixelMask mask;
+	mask.setHotPixel(2, 10, 20);
+	mask.setHotPixel(2, 13, 18);
+	mask.setHotPixel(2, 13, 18);
+	mask.setHotPixel(4, -1, 0);
+	mask.setHotPixel(-3, 1, 1);
+	EXPECT_FALSE(mask.isHot(2, 10, 20));
+	mask.build();
+	EXPECT_EQ(3u, mask.getNHotPixels());
+
+	EXPECT_TRUE(mask.isHot(2, 10, 20));
+	EXPECT_TRUE(mask.isHot(2, 13, 18));
+	EXPECT_FALSE(mask.isHot(2, 13, 20));
+	EXPECT_FALSE(mask.isHot(2, 14, 18));
+	EXPECT_FALSE(mask.isHot(2, 9, 20));
+	EXPECT_FALSE(mask.isHot(2, 10, 21));
+	EXPECT_FALSE(mask.isHot(3, 10, 20));
+	EXPECT_TRUE(mask.isHot(4, -1, 0));
+	EXPECT_FALSE(mask.isHot(-3, 1, 1));
+	EXPECT_FALSE(mask.isHot(7, 10, 20));
+
+	std::vector<float> const cluster = {12.f, 19.f, 30.f, 0.f, 13.f, 18.f, 5.f, 0.f};
+	EXPECT_TRUE(mask.containsHotPixel(2, cluster));
+	EXPECT_FALSE(mask.containsHotPixel(2, std::vector<float>(cluster.begin(), cluster.begin() + 4)));
+	EXPECT_FALSE(mask.containsHotPixel(3, cluster));
+	EXPECT_FALSE(mask.containsHotPixel(2, std::vector<float>()));
+	// three values per pixel
+	EXPECT_TRUE(mask.containsHotPixel(2, {12.f, 19.f, 30.f, 10.f, 20.f, 5.f}, 3));
+
+	mask.clear();
+	mask.build();
+	EXPECT_EQ(0u, mask.getNHotPixels());
+	EXPECT_FALSE(mask.isHot(2, 10, 20));
+}
+
+/** Random clusters, half of them touching hot pixels: the same
+ *  decision as the string keyed map.
+ */
+TEST(EUTelHotPixelMaskTest, MatchesStringMap) {
+
+	std::default_random_engine generator(49);
+	std::vector<HotPixel> const hotPixels = makeHotPixels(generator, 500);
+	std::map<std::string, bool> hotPixelMap;
+	referenceFill(hotPixelMap, hotPixels);
+	EUTelHotPixelMask mask;
+	for(auto const & pixel : hotPixels) mask.setHotPixel(pixel.sensorID, pixel.x, pixel.y);
+	mask.build();
+	EXPECT_EQ(hotPixelMap.size(), mask.getNHotPixels());
+
+	int nHot = 0, nClean = 0;
+	for(int i = 0; i < 20000; ++i) {
+		int sensorID = 0;
+		std::vector<float> const charges = makeCluster(generator, hotPixels, sensorID);
+		bool const expected = referenceContains(hotPixelMap, sensorID, charges);
+		ASSERT_EQ(expected, mask.containsHotPixel(sensorID, charges)) << "cluster " << i;
+		++(expected ? nHot : nClean);
+	}
+	EXPECT_GT(nHot, 1000);
+	EXPECT_GT(nClean, 1000);
+}
+
+/** 10^5 clusters against 2000 hot pixels, the string keyed map
+ *  against the bitsets.
+ */
+TEST(EUTelHotPixelMaskTest, DISABLED_Benchmark) {
+
+	std::default_random_engine generator(50);
+	std::vector<HotPixel> const hotPixels = makeHotPixels(generator, 2000);
+	std::vector<std::vector<float>> clusters;
+	std::vector<int> sensorIDs;
+	for(int i = 0; i < 100000; ++i) {
+		int sensorID = 0;
+		clusters.push_back(makeCluster(generator, hotPixels, sensorID));
+		sensorIDs.push_back(sensorID);
+	}
+
+	std::map<std::string, bool> hotPixelMap;
+	referenceFill(hotPixelMap, hotPixels);
+	int nReference = 0;
+	double const mapMs = eutelbenchmark::milliseconds([&] {
+		for(size_t i = 0; i < clusters.size(); ++i) nReference += referenceContains(hotPixelMap, sensorIDs[i], clusters[i]);
+	});
+
+	EUTelHotPixelMask mask;
+	for(auto const & pixel : hotPixels) mask.setHotPixel(pixel.sensorID, pixel.x, pixel.y);
+	mask.build();
+	int nMask = 0;
+	double const maskMs = eutelbenchmark::milliseconds([&] {
+		for(size_t i = 0; i < clusters.size(); ++i) nMask += mask.containsHotPixel(sensorIDs[i], clusters[i]);
+	});
+
+	eutelbenchmark::report(std::to_string(clusters.size()) + " clusters", {{"string map", mapMs}, {"bitset", maskMs}});
+	EXPECT_EQ(nReference, nMask);
+}
@@ -0,0 +1,189 @@
+//STL
+#include <cmath>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelLinearRegression.h"
+
+using eutelescope::EUTelLinearRegression;
+
+/** Points on a line give back its offset and slope.
+ */
+TEST(EUTelLinearRegressionTest, ExactLine) {
+
+	EUTelLinearRegression fit;
+	for(int i = 0; i < 20; ++i) {
+		double const x = 5000. * i;
+		fit.add(x, 12. + 0.004 * x);
+	}
+
+	double offset = 0., slope = 0.;
+	ASSERT_TRUE(fit.solve(offset, slope));
+	EXPECT_NEAR(12., offset, 1e-9);
+	EXPECT_NEAR(0.004, slope, 1e-15);
+	EXPECT_NEAR(0., fit.getResidualSum(), 1e-9);
+	EXPECT_DOUBLE_EQ(20., fit.getSumOfWeights());
+}
+
+/** An integer weight is the same as adding the point several times.
+ */
+TEST(EUTelLinearRegressionTest, Weights) {
+
+	std::default_random_engine generator(5);
+	std::uniform_real_distribution<double> x(-1e5, 0.);
+	std::normal_distribution<double> noise(0., 3.);
+
+	EUTelLinearRegression weighted, repeated;
+	for(int i = 0; i < 100; ++i) {
+		double const xi = x(generator);
+		double const yi = -0.0045 * xi + noise(generator);
+		int const w = 1 + i % 4;
+		weighted.add(xi, yi, w);
+		for(int j = 0; j < w; ++j) repeated.add(xi, yi);
+	}
+
+	double offsetW = 0., slopeW = 0., offsetR = 0., slopeR = 0.;
+	ASSERT_TRUE(weighted.solve(offsetW, slopeW));
+	ASSERT_TRUE(repeated.solve(offsetR, slopeR));
+	EXPECT_NEAR(offsetR, offsetW, 1e-9);
+	EXPECT_NEAR(slopeR, slopeW, 1e-13);
+	EXPECT_NEAR(repeated.getResidualSum(), weighted.getResidualSum(), 1e-6);
+}
+
+/** Partial sums merged together are the same as a single pass.
+ */
+TEST(EUTelLinearRegressionTest, Merge) {
+
+	std::default_random_engine generator(9);
+	std::uniform_real_distribution<double> x(0., 1e5);
+	std::normal_distribution<double> noise(0., 3.);
+
+	EUTelLinearRegression all;
+	std::vector<EUTelLinearRegression> parts(4);
+	for(int i = 0; i < 1000; ++i) {
+		double const xi = x(generator);
+		double const yi = 5. + 0.0041 * xi + noise(generator);
+		all.add(xi, yi);
+		parts[i % parts.size()].add(xi, yi);
+	}
+
+	EUTelLinearRegression merged;
+	for(auto const & part : parts) merged.merge(part);
+
+	double offsetA = 0., slopeA = 0., offsetM = 0., slopeM = 0.;
+	ASSERT_TRUE(all.solve(offsetA, slopeA));
+	ASSERT_TRUE(merged.solve(offsetM, slopeM));
+	EXPECT_NEAR(offsetA, offsetM, 1e-9);
+	EXPECT_NEAR(slopeA, slopeM, 1e-14);
+	EXPECT_DOUBLE_EQ(all.getSumOfWeights(), merged.getSumOfWeights());
+}
+
+/** Large x with a small spread, where the raw normal equations in
+ *  double precision lose most of their digits.
+ */
+TEST(EUTelLinearRegressionTest, LargeOffsetInX) {
+
+	std::default_random_engine generator(11);
+	std::normal_distribution<double> noise(0., 0.01);
+
+	EUTelLinearRegression fit;
+	long double sw = 0., sx = 0., sy = 0., sxx = 0., sxy = 0.;
+	for(int i = 0; i < 500; ++i) {
+		double const xi = 1e8 + 0.01 * i;
+		double const yi = 2. + 3. * (xi - 1e8) + noise(generator);
+		fit.add(xi, yi);
+		sw += 1.;
+		sx += xi;
+		sy += yi;
+		sxx += static_cast<long double>(xi) * xi;
+		sxy += static_cast<long double>(xi) * yi;
+	}
+	long double const mx = sx / sw, my = sy / sw;
+	long double const reference = (sxy - sw * mx * my) / (sxx - sw * mx * mx);
+
+	double offset = 0., slope = 0.;
+	ASSERT_TRUE(fit.solve(offset, slope));
+	EXPECT_NEAR(3., slope, 0.01);
+	EXPECT_NEAR(static_cast<double>(reference), slope, 0.01);
+}
+
+/** A pol1 chi2 fit of a profile as AlibavaCalibration does it: bin
+ *  centres and means, weighted by 1/error^2 with the error of the
+ *  mean. The result agrees with the chi2 minimum from the normal
+ *  equations in long double, and not with an unweighted fit.
+ */
+TEST(EUTelLinearRegressionTest, ProfileFit) {
+
+	std::default_random_engine generator(13);
+	std::uniform_real_distribution<double> charge(0., 1e5);
+	std::normal_distribution<double> unit(0., 1.);
+
+	// 500 bins of 200 e, the spread grows with the charge
+	int const nBins = 500;
+	double const binWidth = 200.;
+	std::vector<double> sumY(nBins, 0.), sumY2(nBins, 0.);
+	std::vector<int> entries(nBins, 0);
+	for(int i = 0; i < 20000; ++i) {
+		double const x = charge(generator);
+		double const y = 3. + 0.0042 * x + (0.5 + x * 5e-5) * unit(generator);
+		int const bin = static_cast<int>(x / binWidth);
+		sumY[bin] += y;
+		sumY2[bin] += y * y;
+		++entries[bin];
+	}
+
+	EUTelLinearRegression fit, unweighted;
+	long double sw = 0., sx = 0., sy = 0., sxx = 0., sxy = 0.;
+	for(int bin = 0; bin < nBins; ++bin) {
+		if(entries[bin] < 2) continue;
+		double const mean = sumY[bin] / entries[bin];
+		double const error = std::sqrt(std::abs(sumY2[bin] / entries[bin] - mean * mean) / entries[bin]);
+		if(!(error > 0.)) continue;
+		double const x = (bin + 0.5) * binWidth;
+		double const w = 1. / (error * error);
+		fit.add(x, mean, w);
+		unweighted.add(x, mean);
+		sw += w;
+		sx += w * x;
+		sy += w * mean;
+		sxx += w * static_cast<long double>(x) * x;
+		sxy += w * static_cast<long double>(x) * mean;
+	}
+	long double const slopeReference = (sw * sxy - sx * sy) / (sw * sxx - sx * sx);
+	long double const offsetReference = (sy - slopeReference * sx) / sw;
+
+	double offset = 0., slope = 0., offsetU = 0., slopeU = 0.;
+	ASSERT_TRUE(fit.solve(offset, slope));
+	ASSERT_TRUE(unweighted.solve(offsetU, slopeU));
+	EXPECT_NEAR(static_cast<double>(slopeReference), slope, 1e-9 * std::abs(slope));
+	EXPECT_NEAR(static_cast<double>(offsetReference), offset, 1e-7);
+	EXPECT_NEAR(0.0042, slope, 1e-5);
+	// the weights move the slope far more than the agreement above
+	EXPECT_GT(std::abs(slope - slopeU), 1e-5 * std::abs(slope));
+}
+
+/** Without two distinct x values there is no solution.
+ */
+TEST(EUTelLinearRegressionTest, Degenerate) {
+
+	double offset = 1., slope = 2.;
+
+	EUTelLinearRegression empty;
+	EXPECT_FALSE(empty.solve(offset, slope));
+
+	EUTelLinearRegression single;
+	single.add(3., 4.);
+	single.add(3., 5.);
+	single.add(7., 1., 0.);
+	EXPECT_FALSE(single.solve(offset, slope));
+	EXPECT_DOUBLE_EQ(1., offset);
+	EXPECT_DOUBLE_EQ(2., slope);
+	EXPECT_DOUBLE_EQ(2., single.getSumOfWeights());
+
+	single.clear();
+	EXPECT_DOUBLE_EQ(0., single.getSumOfWeights());
+}
@@ -0,0 +1,117 @@
+//STL
+#include <sstream>
+#include <string>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelMillepedeResult.h"
+
+using eutelescope::EUTelMillepedeResult;
+
+/** A regular result file with 3 parameters per sensor, mixing 5 and 6
+ *  column rows.
+ */
+TEST(EUTelMillepedeResultTest, RegularFile) {
+
+	std::istringstream res(
+		" Parameter         ! first 3 elements per line are significant (if used as input)\n"
+		"        11  0.1000E-01  0.0000E+00  0.1000E-01  0.2000E-02\n"
+		"        12 -0.2000E-01  0.0000E+00 -0.2000E-01  0.3000E-02  0.5\n"
+		"        13  0.1000E-03  0.0000E+00  0.1000E-03  0.4000E-04\n"
+		"        21  0.5000E-01  0.0000E+00  0.5000E-01  0.1000E-02\n"
+		"        22  0.6000E-01  0.0000E+00  0.6000E-01  0.1000E-02\n"
+		"        23  0.7000E-03  0.0000E+00  0.7000E-03  0.1000E-04\n");
+
+	EUTelMillepedeResult result;
+	result.parse(res);
+
+	ASSERT_EQ(2u, result.sensorIDs().size());
+	EXPECT_EQ(1, result.sensorIDs()[0]);
+	EXPECT_EQ(2, result.sensorIDs()[1]);
+	EXPECT_EQ(3, result.maxParameterNumber());
+	EXPECT_EQ(1u, result.skippedLines());
+
+	EXPECT_DOUBLE_EQ(0.01, result.getParameter(1, 1).value);
+	EXPECT_DOUBLE_EQ(0.002, result.getParameter(1, 1).error);
+	EXPECT_DOUBLE_EQ(-0.02, result.getParameter(1, 2).value);
+	EXPECT_DOUBLE_EQ(0.003, result.getParameter(1, 2).error);
+	EXPECT_DOUBLE_EQ(0.0007, result.getParameter(2, 3).value);
+	EXPECT_FALSE(result.getParameter(2, 4).present);
+}
+
+/** Fixed parameters only have 3 columns and must neither be dropped nor
+ *  shift the parameters of the following sensors.
+ */
+TEST(EUTelMillepedeResultTest, FixedParameters) {
+
+	std::istringstream res(
+		" Parameter         ! first 3 elements per line are significant (if used as input)\n"
+		"        11  0.0000E+00 -0.1000E+01\n"
+		"        12  0.0000E+00 -0.1000E+01\n"
+		"        13  0.0000E+00 -0.1000E+01\n"
+		"        21  0.5000E-01  0.0000E+00  0.5000E-01  0.1000E-02\n"
+		"        22  0.6000E-01  0.0000E+00  0.6000E-01  0.1000E-02\n"
+		"        23  0.7000E-03  0.0000E+00  0.7000E-03  0.1000E-04\n");
+
+	EUTelMillepedeResult result;
+	result.parse(res);
+
+	ASSERT_TRUE(result.hasSensor(1));
+	EXPECT_TRUE(result.getParameter(1, 2).present);
+	EXPECT_DOUBLE_EQ(-1., result.getParameter(1, 2).presigma);
+	EXPECT_DOUBLE_EQ(0., result.getParameter(1, 2).error);
+	EXPECT_DOUBLE_EQ(0.05, result.getParameter(2, 1).value);
+	EXPECT_DOUBLE_EQ(0.06, result.getParameter(2, 2).value);
+	EXPECT_DOUBLE_EQ(0.0007, result.getParameter(2, 3).value);
+}
+
+/** Absent sensors and missing or broken rows must only affect themselves.
+ */
+TEST(EUTelMillepedeResultTest, AbsentSensorsAndBrokenRows) {
+
+	std::istringstream res(
+		" Parameter         ! first 3 elements per line are significant (if used as input)\n"
+		"        21  0.5000E-01  0.0000E+00  0.5000E-01  0.1000E-02\n"
+		"\n"
+		"        23  0.7000E-03  0.0000E+00\n"
+		"        41  0.1000E-01  0.0000E+00  0.1000E-01\n"
+		"        50  0.1000E-01  0.0000E+00\n"
+		"        51  garbage  0.0000E+00\n"
+		"        56  0.1000E-01  0.0000E+00  0.1000E-01  0.2000E-02  0.1\n");
+
+	EUTelMillepedeResult result;
+	result.parse(res);
+
+	ASSERT_EQ(2u, result.sensorIDs().size());
+	EXPECT_FALSE(result.hasSensor(0));
+	EXPECT_FALSE(result.hasSensor(1));
+	EXPECT_FALSE(result.hasSensor(3));
+	EXPECT_FALSE(result.hasSensor(4));
+	EXPECT_TRUE(result.hasSensor(2));
+	EXPECT_TRUE(result.hasSensor(5));
+	EXPECT_EQ(4u, result.skippedLines());
+
+	EXPECT_TRUE(result.getParameter(2, 1).present);
+	EXPECT_FALSE(result.getParameter(2, 2).present);
+	EXPECT_DOUBLE_EQ(0.0007, result.getParameter(2, 3).value);
+	EXPECT_FALSE(result.getParameter(5, 1).present);
+	EXPECT_DOUBLE_EQ(0.002, result.getParameter(5, 6).error);
+	EXPECT_FALSE(result.getParameter(3, 1).present);
+	EXPECT_EQ(6, result.maxParameterNumber());
+}
+
+/** The parameter layouts used by the aligners.
+ */
+TEST(EUTelMillepedeResultTest, Layout) {
+
+	EXPECT_EQ(2u, EUTelMillepedeResult::layout(2).size());
+	ASSERT_EQ(3u, EUTelMillepedeResult::layout(3).size());
+	EXPECT_EQ(EUTelMillepedeResult::kGamma, EUTelMillepedeResult::layout(3)[2]);
+	ASSERT_EQ(4u, EUTelMillepedeResult::layout(4).size());
+	EXPECT_EQ(EUTelMillepedeResult::kZOff, EUTelMillepedeResult::layout(4)[3]);
+	ASSERT_EQ(6u, EUTelMillepedeResult::layout(6).size());
+	EXPECT_EQ(EUTelMillepedeResult::kZOff, EUTelMillepedeResult::layout(6)[2]);
+	EXPECT_TRUE(EUTelMillepedeResult::layout(5).empty());
+}
@@ -0,0 +1,138 @@
+//STL
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//POSIX
+#include <sys/stat.h>
+#include <unistd.h>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelPedeRunner.h"
+
+using eutelescope::EUTelPedeRunner;
+
+// The fixture writes a small shell script which mimics the pede output
+class EUTelPedeRunnerTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		char name[] = "/tmp/pedestubXXXXXX";
+		int fd = mkstemp(name);
+		ASSERT_GE(fd, 0);
+		close(fd);
+		stubName = name;
+	}
+
+	virtual void TearDown() {
+		std::remove(stubName.c_str());
+	}
+
+	void writeStub(std::string const & body) {
+		std::ofstream stub(stubName.c_str());
+		stub << "#!/bin/sh\n" << body;
+		stub.close();
+		chmod(stubName.c_str(), 0755);
+	}
+
+	std::string stubName;
+};
+
+/** A stub printing the markers pede uses in a successful and in a rejected
+ *  run, the markers have to be found and all lines forwarded in order.
+ */
+TEST_F(EUTelPedeRunnerTest, ParsesMarkersWhileStreaming) {
+
+	writeStub("echo 'Reading files'\n"
+	          "echo ' Sum(Chi^2)/Sum(Ndf) =     4566.7'\n"
+	          "echo '                     / (     4000 -  12 )'\n"
+	          "echo '                     =      1.145'\n"
+	          "echo 'Too many rejects (>33.3%)' \n"
+	          "printf 'no newline at the end'\n"
+	          "exit 0\n");
+
+	std::vector<std::string> lines;
+	EUTelPedeRunner pede(stubName, 10);
+	pede.setStdoutHandler([&lines](std::string const & line) { lines.push_back(line); });
+
+	EXPECT_TRUE(pede.run());
+	EXPECT_FALSE(pede.startFailed());
+	EXPECT_FALSE(pede.timedOut());
+	EXPECT_EQ(0, pede.exitStatus());
+	EXPECT_TRUE(pede.tooManyRejects());
+	ASSERT_TRUE(pede.hasChi2Ndf());
+	EXPECT_EQ("1.145", pede.chi2Ndf());
+	ASSERT_EQ(6u, lines.size());
+	EXPECT_EQ("Reading files", lines.front());
+	EXPECT_EQ("no newline at the end", lines.back());
+	EXPECT_TRUE(pede.errors().empty());
+}
+
+/** stderr has to be collected separately and the exit code reported.
+ */
+TEST_F(EUTelPedeRunnerTest, CollectsErrorsAndExitCode) {
+
+	writeStub("echo 'fine'\n"
+	          "echo 'something failed' 1>&2\n"
+	          "exit 3\n");
+
+	std::vector<std::string> errLines;
+	EUTelPedeRunner pede(stubName);
+	pede.setStderrHandler([&errLines](std::string const & line) { errLines.push_back(line); });
+
+	EXPECT_FALSE(pede.run());
+	EXPECT_EQ(3, pede.exitStatus());
+	EXPECT_FALSE(pede.tooManyRejects());
+	EXPECT_FALSE(pede.hasChi2Ndf());
+	ASSERT_EQ(1u, errLines.size());
+	EXPECT_EQ("something failed", errLines[0]);
+	EXPECT_EQ("something failed\n", pede.errors());
+}
+
+/** A hanging pede has to be terminated once the timeout expired.
+ */
+TEST_F(EUTelPedeRunnerTest, TerminatesOnTimeout) {
+
+	writeStub("echo 'starting'\n"
+	          "sleep 30\n"
+	          "echo 'never seen'\n");
+
+	std::vector<std::string> lines;
+	EUTelPedeRunner pede(stubName, 0.3);
+	pede.setStdoutHandler([&lines](std::string const & line) { lines.push_back(line); });
+
+	EXPECT_FALSE(pede.run());
+	EXPECT_TRUE(pede.timedOut());
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_EQ("starting", lines[0]);
+}
+
+/** A pede ignoring SIGTERM has to be killed after the grace period,
+ *  also when the shell it was started from exits on SIGTERM.
+ */
+TEST_F(EUTelPedeRunnerTest, KillsWhenTermIsIgnored) {
+
+	writeStub("trap '' TERM\n"
+	          "echo $$\n"
+	          "while true; do sleep 1; done\n");
+
+	std::vector<std::string> lines;
+	EUTelPedeRunner pede(stubName, 0.3);
+	pede.setKillGracePeriod(0.2);
+	pede.setStdoutHandler([&lines](std::string const & line) { lines.push_back(line); });
+
+	EXPECT_FALSE(pede.run());
+	EXPECT_TRUE(pede.timedOut());
+	ASSERT_EQ(1u, lines.size());
+
+	//the stub is gone or a zombie waiting for init
+	std::ifstream stat(("/proc/" + lines[0] + "/stat").c_str());
+	std::string pid, command, state;
+	if(stat >> pid >> command >> state) {
+		EXPECT_EQ("Z", state);
+	}
+}
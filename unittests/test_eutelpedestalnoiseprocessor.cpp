@@ -0,0 +1,250 @@
+//STL
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Marlin
+#include <marlin/Exceptions.h>
+#include <marlin/Global.h>
+#include <marlin/Processor.h>
+#include <marlin/ProcessorMgr.h>
+#include <marlin/StringParameters.h>
+
+//LCIO
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/TrackerData.h>
+#include <EVENT/TrackerRawData.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/TrackerRawDataImpl.h>
+#include <IO/LCReader.h>
+#include <IO/LCWriter.h>
+#include <IOIMPL/LCFactory.h>
+#include <UTIL/CellIDEncoder.h>
+
+//EUTelescope
+#include "EUTELESCOPE.h"
+#include "EUTelEventImpl.h"
+
+// Runs EUTelPedestalNoiseProcessor on a synthetic raw file the way Marlin
+// does, once rewinding the file for every loop and once replaying the
+// frames cached in the first loop, and compares the two condition files.
+class EUTelPedestalNoiseProcessorTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		rawFile = "test_eutelpedestalnoise_raw.slcio";
+		std::remove(rawFile.c_str());
+		previousGlobals = marlin::Global::parameters;
+		globals.add("MaxRecordNumber", {"0"});
+		marlin::Global::parameters = &globals;
+		writeRawFile();
+	}
+
+	virtual void TearDown() {
+		marlin::Global::parameters = previousGlobals;
+		std::remove(rawFile.c_str());
+		for(auto const & name : pedeFiles) std::remove((name + ".slcio").c_str());
+	}
+
+	// Two 32x16 sensors with per pixel pedestal and noise, a common mode
+	// per event and sensor, a few hits in every event, two events with
+	// too many hits for the common mode, a hot and a dead pixel per
+	// sensor, and an EORE at the end.
+	void writeRawFile() {
+		int const nSensors = 2, nX = 32, nY = 16, nEvents = 200;
+		std::default_random_engine generator(5);
+		std::normal_distribution<float> gauss(0.f, 1.f);
+		std::uniform_real_distribution<float> pedestalValue(80.f, 120.f), noiseValue(2.f, 5.f);
+		std::uniform_int_distribution<int> pixelIndex(0, nX * nY - 1);
+
+		std::vector<std::vector<float>> pedestal(nSensors), noise(nSensors);
+		for(int iSensor = 0; iSensor < nSensors; ++iSensor) {
+			for(int iPixel = 0; iPixel < nX * nY; ++iPixel) {
+				pedestal[iSensor].push_back(pedestalValue(generator));
+				noise[iSensor].push_back(noiseValue(generator));
+			}
+			noise[iSensor][17 + iSensor] = 40.f;
+			noise[iSensor][300 + iSensor] = 0.f;
+		}
+
+		std::unique_ptr<IO::LCWriter> writer(IOIMPL::LCFactory::getInstance()->createLCWriter());
+		writer->open(rawFile, EVENT::LCIO::WRITE_NEW);
+
+		IMPL::LCRunHeaderImpl header;
+		header.setRunNumber(23);
+		header.setDetectorName("synthetic");
+		writer->writeRunHeader(&header);
+
+		for(int iEvent = 0; iEvent <= nEvents; ++iEvent) {
+			eutelescope::EUTelEventImpl event;
+			event.setRunNumber(23);
+			event.setEventNumber(iEvent);
+			event.setDetectorName("synthetic");
+			if(iEvent == nEvents) {
+				event.setEventType(eutelescope::kEORE);
+				writer->writeEvent(&event);
+				continue;
+			}
+			event.setEventType(eutelescope::kDE);
+
+			auto rawData = new IMPL::LCCollectionVec(EVENT::LCIO::TRACKERRAWDATA);
+			UTIL::CellIDEncoder<IMPL::TrackerRawDataImpl> encoder(eutelescope::EUTELESCOPE::MATRIXDEFAULTENCODING, rawData);
+			for(int iSensor = 0; iSensor < nSensors; ++iSensor) {
+				float const commonMode = 3.f * gauss(generator);
+				std::vector<float> signal(nX * nY, 0.f);
+				int const nHits = (iEvent == 40 || iEvent == 120) ? 150 : 3;
+				for(int iHit = 0; iHit < nHits; ++iHit) signal[pixelIndex(generator)] = 80.f;
+
+				EVENT::ShortVec adcValues;
+				for(int iPixel = 0; iPixel < nX * nY; ++iPixel) {
+					float value = pedestal[iSensor][iPixel];
+					if(noise[iSensor][iPixel] > 0.f) value += commonMode + signal[iPixel] + noise[iSensor][iPixel] * gauss(generator);
+					adcValues.push_back(static_cast<short>(value));
+				}
+
+				auto frame = new IMPL::TrackerRawDataImpl();
+				encoder["sensorID"] = 6 + iSensor;
+				encoder["xMin"] = 0;
+				encoder["xMax"] = nX - 1;
+				encoder["yMin"] = 0;
+				encoder["yMax"] = nY - 1;
+				encoder.setCellID(frame);
+				frame->setADCValues(adcValues);
+				rawData->push_back(frame);
+			}
+			event.addCollection(rawData, "rawdata");
+			writer->writeEvent(&event);
+		}
+		writer->close();
+	}
+
+	// Runs a pedestal processor with the given FrameCacheSize to its
+	// StopProcessingException, rewinding the raw file when asked to.
+	// Returns the number of rewinds.
+	int runProcessor(std::string const & name, int frameCacheSize) {
+		std::string const pedeFile = "test_eutelpedestalnoise_" + name;
+		std::remove((pedeFile + ".slcio").c_str());
+		pedeFiles.push_back(pedeFile);
+
+		auto parameters = new marlin::StringParameters();
+		parameters->add("RawDataCollectionNameVec", {"rawdata"});
+		parameters->add("NoOfCMIteration", {"1"});
+		parameters->add("MaxNoOfRejectedPixels", {"100"});
+		parameters->add("BadPixelMaskingAlgorithm", {"NoiseDistribution", "DeadPixel"});
+		parameters->add("AdditionalMaskingLoop", {"true"});
+		parameters->add("PixelMaskMaxFiringFrequency", {"5"});
+		parameters->add("HitRejectionPreLoop", {"true"});
+		parameters->add("FirstEvent", {"5"});
+		parameters->add("OutputPedeFile", {pedeFile});
+		parameters->add("ASCIIOutputSwitch", {"false"});
+		parameters->add("HistogramFilling", {"false"});
+		parameters->add("FrameCacheSize", {std::to_string(frameCacheSize)});
+
+		marlin::ProcessorMgr * manager = marlin::ProcessorMgr::instance();
+		EXPECT_TRUE(manager->addActiveProcessor("EUTelPedestalNoiseProcessor", name, parameters));
+		marlin::Processor * processor = manager->getActiveProcessor(name);
+		manager->removeActiveProcessor(name);
+		processor->init();
+
+		int nRewinds = 0;
+		std::unique_ptr<IO::LCReader> reader(IOIMPL::LCFactory::getInstance()->createLCReader());
+		for(bool finished = false; !finished && nRewinds < 10;) {
+			reader->open(rawFile);
+			try {
+				processor->processRunHeader(reader->readNextRunHeader());
+				while(EVENT::LCEvent * event = reader->readNextEvent()) {
+					try {
+						processor->processEvent(event);
+					} catch(marlin::SkipEventException &) {
+					}
+				}
+				ADD_FAILURE() << name << " reached the end of the raw file";
+				finished = true;
+			} catch(marlin::RewindDataFilesException &) {
+				++nRewinds;
+			} catch(marlin::StopProcessingException &) {
+				finished = true;
+			}
+			reader->close();
+		}
+		processor->end();
+		return nRewinds;
+	}
+
+	struct Conditions {
+		std::vector<std::vector<float>> pedestal, noise;
+		std::vector<std::vector<short>> status;
+	};
+
+	// Pedestal, noise and status from the event of a condition file
+	static Conditions readConditions(std::string const & pedeFile) {
+		Conditions conditions;
+		std::unique_ptr<IO::LCReader> reader(IOIMPL::LCFactory::getInstance()->createLCReader());
+		reader->open(pedeFile + ".slcio");
+		EXPECT_NE(reader->readNextRunHeader(), nullptr);
+		EVENT::LCEvent * event = reader->readNextEvent();
+		EXPECT_NE(event, nullptr);
+		if(event) {
+			conditions.pedestal = chargesOf(event->getCollection("pedestalDB"));
+			conditions.noise = chargesOf(event->getCollection("noiseDB"));
+			EVENT::LCCollection * status = event->getCollection("statusDB");
+			for(int i = 0; i < status->getNumberOfElements(); ++i) {
+				conditions.status.push_back(dynamic_cast<EVENT::TrackerRawData *>(status->getElementAt(i))->getADCValues());
+			}
+		}
+		reader->close();
+		return conditions;
+	}
+
+	// Charge values of all TrackerData in a collection
+	static std::vector<std::vector<float>> chargesOf(EVENT::LCCollection * collection) {
+		std::vector<std::vector<float>> charges;
+		for(int i = 0; i < collection->getNumberOfElements(); ++i) {
+			charges.push_back(dynamic_cast<EVENT::TrackerData *>(collection->getElementAt(i))->getChargeValues());
+		}
+		return charges;
+	}
+
+	std::string rawFile;
+	std::vector<std::string> pedeFiles;
+	marlin::StringParameters globals;
+	marlin::StringParameters * previousGlobals;
+};
+
+/** The loops replayed from the frame cache give the same pedestal, noise
+ *  and status as rewinding the raw file for every loop, with the hot
+ *  and dead pixels masked and the events rejected by the common mode
+ *  left out of the masking loop in both.
+ */
+TEST_F(EUTelPedestalNoiseProcessorTest, CacheReplayMatchesRewind) {
+
+	// pre loop, first loop, common mode loop and masking loop
+	EXPECT_EQ(runProcessor("rewind", 0), 3);
+	// only the pre loop rewinds, the cache is filled in the first loop
+	EXPECT_EQ(runProcessor("cache", 1), 1);
+
+	Conditions const rewound = readConditions(pedeFiles[0]);
+	Conditions const replayed = readConditions(pedeFiles[1]);
+
+	ASSERT_EQ(rewound.pedestal.size(), 2u);
+	ASSERT_EQ(rewound.noise.size(), 2u);
+	ASSERT_EQ(rewound.status.size(), 2u);
+	EXPECT_EQ(rewound.pedestal, replayed.pedestal);
+	EXPECT_EQ(rewound.noise, replayed.noise);
+	EXPECT_EQ(rewound.status, replayed.status);
+
+	for(size_t iSensor = 0; iSensor < rewound.status.size(); ++iSensor) {
+		EXPECT_NE(rewound.status[iSensor][17 + iSensor], eutelescope::EUTELESCOPE::GOODPIXEL);
+		EXPECT_NE(rewound.status[iSensor][300 + iSensor], eutelescope::EUTELESCOPE::GOODPIXEL);
+		int nBad = 0;
+		for(auto status : rewound.status[iSensor]) nBad += (status != eutelescope::EUTELESCOPE::GOODPIXEL);
+		EXPECT_LT(nBad, 10);
+	}
+}
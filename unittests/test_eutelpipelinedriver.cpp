@@ -0,0 +1,206 @@
+//STL
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Marlin
+#include <marlin/Global.h>
+#include <marlin/Processor.h>
+#include <marlin/ProcessorEventSeeder.h>
+#include <marlin/ProcessorMgr.h>
+#include <marlin/StringParameters.h>
+
+//LCIO
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCIO.h>
+#include <EVENT/TrackerHit.h>
+#include <Exceptions.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDEncoder.h>
+
+//EUTelescope
+#include "EUTELESCOPE.h"
+#include "EUTelEventImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelPipelineDriver.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+#include "eutelgeotest.h"
+
+namespace {
+
+	// Not thread safe, so it stays with Marlin: one line per event with
+	// the cellID and the position of every hit, in the order of the events
+	class HitRecorder : public marlin::Processor {
+	public:
+		HitRecorder() : marlin::Processor("EUTelPipelineDriverTestHitRecorder"), records() {}
+		virtual marlin::Processor * newProcessor() { return new HitRecorder; }
+
+		virtual void processEvent(EVENT::LCEvent * event) {
+			std::ostringstream record;
+			record.precision(17);
+			EVENT::LCCollection * hits = nullptr;
+			try {
+				hits = event->getCollection("hit");
+			} catch(EVENT::DataNotAvailableException &) {
+				// the EORE
+				return;
+			}
+			record << event->getEventNumber();
+			for(int i = 0; i < hits->getNumberOfElements(); ++i) {
+				auto hit = static_cast<EVENT::TrackerHit *>(hits->getElementAt(i));
+				record << ' ' << hit->getCellID0() << ' ' << hit->getPosition()[0] << ' ' << hit->getPosition()[1] << ' ' << hit->getPosition()[2];
+			}
+			records.push_back(record.str());
+		}
+
+		std::vector<std::string> records;
+	};
+
+	HitRecorder gHitRecorder;
+
+	// Pixels of a sensor in an event: x, y and signal
+	struct Pixel {
+		int x, y;
+		float signal;
+	};
+	typedef std::vector<std::vector<Pixel>> EventPixels;
+
+	// A few clusters of one to four neighbouring pixels on each of the
+	// six sensors in every event
+	std::vector<EventPixels> makeRun(int nEvents) {
+		std::default_random_engine generator(11);
+		std::uniform_int_distribution<int> xPosition(1, 997), yPosition(1, 497), nClusters(0, 4), nPixels(1, 4);
+		std::uniform_real_distribution<float> signal(1.f, 100.f);
+		std::vector<EventPixels> run(nEvents, EventPixels(6));
+		for(auto & event : run) {
+			for(auto & sensor : event) {
+				for(int iCluster = nClusters(generator); iCluster > 0; --iCluster) {
+					int const x = xPosition(generator), y = yPosition(generator);
+					int const n = nPixels(generator);
+					for(int iPixel = 0; iPixel < n; ++iPixel) sensor.push_back(Pixel{x + iPixel % 2, y + iPixel / 2, signal(generator)});
+				}
+			}
+		}
+		return run;
+	}
+}
+
+// Runs EUTelSparseClustering, EUTelHitMaker and EUTelHitCoordinateTransformer
+// through an EUTelPipelineDriver, as eutelpipeline does, and records the
+// hits they make.
+class EUTelPipelineDriverTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		previousGlobals = marlin::Global::parameters;
+		marlin::Global::parameters = &globals;
+		if(!marlin::Global::EVENTSEEDER) marlin::Global::EVENTSEEDER = new marlin::ProcessorEventSeeder();
+		nJobs = 0;
+	}
+
+	virtual void TearDown() {
+		marlin::Global::parameters = previousGlobals;
+	}
+
+	// Adds a processor to the ProcessorMgr under a name unique to the job
+	std::string addProcessor(std::string const & type, std::vector<std::pair<std::string, std::vector<std::string>>> const & values) {
+		std::string const name = type + "_" + std::to_string(nJobs);
+		auto parameters = new marlin::StringParameters();
+		for(auto const & value : values) parameters->add(value.first, value.second);
+		EXPECT_TRUE(marlin::ProcessorMgr::instance()->addActiveProcessor(type, name, parameters));
+		return name;
+	}
+
+	std::vector<std::string> runJob(std::vector<EventPixels> const & run, int nThreads, std::vector<std::string> & concurrent) {
+		++nJobs;
+		std::vector<std::string> activeProcessors;
+		activeProcessors.push_back(addProcessor("EUTelSparseClustering", {{"ZSDataCollectionName", {"zsdata"}},
+		                                                                  {"PulseCollectionName", {"cluster"}},
+		                                                                  {"HistogramFilling", {"false"}}}));
+		activeProcessors.push_back(addProcessor("EUTelHitMaker", {{"PulseCollectionName", {"cluster"}},
+		                                                          {"HitCollectionName", {"local_hit"}},
+		                                                          {"EnableLocalCoordidates", {"true"}},
+		                                                          {"PlotHistograms", {"false"}}}));
+		activeProcessors.push_back(addProcessor("EUTelHitCoordinateTransformer", {{"hitCollectionNameInput", {"local_hit"}},
+		                                                                          {"hitCollectionNameOutput", {"hit"}}}));
+		activeProcessors.push_back(addProcessor("EUTelPipelineDriverTestHitRecorder", {}));
+
+		marlin::ProcessorMgr * manager = marlin::ProcessorMgr::instance();
+		auto recorder = static_cast<HitRecorder *>(manager->getActiveProcessor(activeProcessors.back()));
+		{
+			eutelescope::EUTelPipelineDriver driver(nThreads, 4 * static_cast<size_t>(nThreads));
+			driver.init(activeProcessors, {});
+			concurrent = driver.getConcurrentProcessors();
+
+			for(size_t iEvent = 0; iEvent <= run.size(); ++iEvent) {
+				eutelescope::EUTelEventImpl event;
+				event.setRunNumber(1);
+				event.setEventNumber(static_cast<int>(iEvent));
+				if(iEvent == run.size()) {
+					event.setEventType(eutelescope::kEORE);
+					driver.processEvent(&event);
+					continue;
+				}
+				event.setEventType(eutelescope::kDE);
+
+				auto zsData = new IMPL::LCCollectionVec(EVENT::LCIO::TRACKERDATA);
+				UTIL::CellIDEncoder<IMPL::TrackerDataImpl> encoder(eutelescope::EUTELESCOPE::ZSDATADEFAULTENCODING, zsData);
+				for(size_t iSensor = 0; iSensor < run[iEvent].size(); ++iSensor) {
+					auto trackerData = new IMPL::TrackerDataImpl();
+					encoder["sensorID"] = static_cast<int>(iSensor);
+					encoder["sparsePixelType"] = static_cast<int>(eutelescope::kEUTelGenericSparsePixel);
+					encoder.setCellID(trackerData);
+					eutelescope::EUTelTrackerDataInterfacerImpl<eutelescope::EUTelGenericSparsePixel> sparse(trackerData);
+					for(auto const & pixel : run[iEvent][iSensor]) {
+						sparse.push_back(eutelescope::EUTelGenericSparsePixel(pixel.x, pixel.y, pixel.signal));
+					}
+					zsData->push_back(trackerData);
+				}
+				event.addCollection(zsData, "zsdata");
+				driver.processEvent(&event);
+			}
+			driver.end();
+		}
+		std::vector<std::string> const records = recorder->records;
+		manager->removeActiveProcessor(activeProcessors.back());
+		return records;
+	}
+
+	eutelgeotest geometry;
+	marlin::StringParameters globals;
+	marlin::StringParameters * previousGlobals;
+	int nJobs;
+};
+
+/** The clustering, the hit making and the transformation into the
+ *  global frame give the same hits, in the same order, on eight threads
+ *  as on one.
+ */
+TEST_F(EUTelPipelineDriverTest, EightThreadsAsOne) {
+
+	std::vector<EventPixels> const run = makeRun(500);
+	std::vector<std::string> singleConcurrent, eightConcurrent;
+	std::vector<std::string> const single = runJob(run, 1, singleConcurrent);
+	std::vector<std::string> const eight = runJob(run, 8, eightConcurrent);
+
+	// the recorder is not thread safe and stays with Marlin
+	EXPECT_EQ(singleConcurrent.size(), 3u);
+	EXPECT_EQ(eightConcurrent.size(), 3u);
+
+	// one record per event, none for the EORE
+	ASSERT_EQ(single.size(), run.size());
+	ASSERT_EQ(eight.size(), run.size());
+	size_t nRecordsWithHits = 0;
+	for(size_t i = 0; i < single.size(); ++i) {
+		ASSERT_EQ(single[i], eight[i]) << "event " << i;
+		nRecordsWithHits += (single[i].find(' ') != std::string::npos);
+	}
+	EXPECT_GT(nRecordsWithHits, run.size() / 2);
+}
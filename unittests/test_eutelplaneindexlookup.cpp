@@ -0,0 +1,69 @@
+//STL
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelPlaneIndexLookup.h"
+
+using eutelescope::EUTelPlaneIndexLookup;
+
+// Six telescope planes and two DUTs in between, registered in the order
+// of the sensor ID vector (not sorted in z), z in um as in EUTelDafBase
+class EUTelPlaneIndexLookupTest : public ::testing::Test {
+protected:
+
+	virtual void SetUp() {
+		sensorIDs = {0, 1, 2, 3, 4, 5, 20, 21};
+		planeZ = {0., 150000., 300000., 500000., 650000., 800000., 380000., 420000.};
+		for(size_t i = 0; i < sensorIDs.size(); ++i) {
+			lookup.addPlane(sensorIDs[i], planeZ[i]);
+		}
+	}
+
+	EUTelPlaneIndexLookup lookup;
+	std::vector<int> sensorIDs;
+	std::vector<double> planeZ;
+};
+
+/** Hits scattered around their plane have to be assigned to the same
+ *  plane index by the sensor ID and by the z fallback.
+ */
+TEST_F(EUTelPlaneIndexLookupTest, SensorIDAndZAgree) {
+
+	ASSERT_EQ(8, lookup.getNPlanes());
+
+	std::default_random_engine generator(17);
+	std::uniform_int_distribution<size_t> plane(0, sensorIDs.size() - 1);
+	std::uniform_real_distribution<double> dz(-500., 500.);
+
+	for(int i = 0; i < 10000; ++i) {
+		size_t const p = plane(generator);
+		double const z = planeZ[p] + dz(generator);
+		int const byID = lookup.getPlaneIndex(sensorIDs[p]);
+		int const byZ = lookup.getPlaneIndexFromZ(z, 30000.);
+		ASSERT_EQ(static_cast<int>(p), byID);
+		ASSERT_EQ(byID, byZ);
+	}
+}
+
+/** Unknown IDs are reported as such, hits far from any plane as well.
+ */
+TEST_F(EUTelPlaneIndexLookupTest, UnknownSensorsAndPositions) {
+
+	EXPECT_EQ(-1, lookup.getPlaneIndex(6));
+	EXPECT_EQ(-1, lookup.getPlaneIndex(-1));
+	EXPECT_EQ(-1, lookup.getPlaneIndex(1000));
+	EXPECT_EQ(-1, lookup.getPlaneIndexFromZ(-50000., 30000.));
+	EXPECT_EQ(-1, lookup.getPlaneIndexFromZ(900000., 30000.));
+
+	// the two DUTs are closer than the tolerance, the closest one wins
+	EXPECT_EQ(6, lookup.getPlaneIndexFromZ(395000., 30000.));
+	EXPECT_EQ(7, lookup.getPlaneIndexFromZ(405000., 30000.));
+
+	lookup.clear();
+	EXPECT_EQ(0, lookup.getNPlanes());
+	EXPECT_EQ(-1, lookup.getPlaneIndex(0));
+}
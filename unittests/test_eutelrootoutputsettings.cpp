@@ -0,0 +1,189 @@
+//STL
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//ROOT
+#include <TFile.h>
+#include <TTree.h>
+
+//EUTelescope
+#include "EUTelRootOutputSettings.h"
+
+using eutelescope::EUTelRootOutputSettings;
+
+namespace {
+
+	struct Event {
+		std::vector<int> col;
+		std::vector<int> row;
+		std::vector<int> tot;
+		std::vector<int> iden;
+		std::vector<double> xPos;
+		std::vector<double> yPos;
+		std::vector<double> chi2;
+	};
+
+	// A synthetic run with the rawdata and tracks layout of
+	// EUTelAPIXTbTrackTuple
+	std::vector<Event> makeRun(int nEvents) {
+		std::default_random_engine generator(47);
+		std::uniform_int_distribution<int> nPixels(0, 40), col(0, 79), row(0, 335), tot(1, 14), iden(20, 21), nTracks(0, 3);
+		std::normal_distribution<double> position(0., 5.);
+		std::exponential_distribution<double> chi2(0.5);
+		std::vector<Event> run(nEvents, Event{{}, {}, {}, {}, {}, {}, {}});
+		for(auto & event : run) {
+			for(int i = nPixels(generator); i > 0; --i) {
+				event.col.push_back(col(generator));
+				event.row.push_back(row(generator));
+				event.tot.push_back(tot(generator));
+				event.iden.push_back(iden(generator));
+			}
+			for(int i = nTracks(generator); i > 0; --i) {
+				event.xPos.push_back(position(generator));
+				event.yPos.push_back(position(generator));
+				event.chi2.push_back(chi2(generator));
+			}
+		}
+		return run;
+	}
+
+	// Write the run as EUTelAPIXTbTrackTuple does: vector branches which
+	// are cleared and filled every event. Returns the file size.
+	long long writeRun(std::string const & fileName, std::vector<Event> const & run, EUTelRootOutputSettings const * settings) {
+		TFile file(fileName.c_str(), "RECREATE");
+		if(settings) settings->apply(&file);
+
+		Event buffer{{}, {}, {}, {}, {}, {}, {}};
+		std::vector<int> * col = &buffer.col, * row = &buffer.row, * tot = &buffer.tot, * iden = &buffer.iden;
+		std::vector<double> * xPos = &buffer.xPos, * yPos = &buffer.yPos, * chi2 = &buffer.chi2;
+		int nPixHits = 0;
+		int nTrackParams = 0;
+
+		TTree * rawdata = new TTree("rawdata", "rawdata");
+		rawdata->SetAutoSave(1000000000);
+		rawdata->Branch("nPixHits", &nPixHits);
+		rawdata->Branch("col", &col);
+		rawdata->Branch("row", &row);
+		rawdata->Branch("tot", &tot);
+		rawdata->Branch("iden", &iden);
+
+		TTree * tracks = new TTree("tracks", "tracks");
+		tracks->SetAutoSave(1000000000);
+		tracks->Branch("nTrackParams", &nTrackParams);
+		tracks->Branch("xPos", &xPos);
+		tracks->Branch("yPos", &yPos);
+		tracks->Branch("chi2", &chi2);
+
+		if(settings) {
+			settings->apply(rawdata);
+			settings->apply(tracks);
+		}
+
+		for(auto const & event : run) {
+			col->clear(); row->clear(); tot->clear(); iden->clear();
+			xPos->clear(); yPos->clear(); chi2->clear();
+			col->insert(col->end(), event.col.begin(), event.col.end());
+			row->insert(row->end(), event.row.begin(), event.row.end());
+			tot->insert(tot->end(), event.tot.begin(), event.tot.end());
+			iden->insert(iden->end(), event.iden.begin(), event.iden.end());
+			xPos->insert(xPos->end(), event.xPos.begin(), event.xPos.end());
+			yPos->insert(yPos->end(), event.yPos.begin(), event.yPos.end());
+			chi2->insert(chi2->end(), event.chi2.begin(), event.chi2.end());
+			nPixHits = static_cast<int>(event.col.size());
+			nTrackParams = static_cast<int>(event.xPos.size());
+			rawdata->Fill();
+			tracks->Fill();
+		}
+		file.Write();
+		long long const size = file.GetEND();
+		file.Close();
+		return size;
+	}
+
+	std::vector<Event> readRun(std::string const & fileName) {
+		TFile file(fileName.c_str(), "READ");
+		TTree * rawdata = nullptr;
+		TTree * tracks = nullptr;
+		file.GetObject("rawdata", rawdata);
+		file.GetObject("tracks", tracks);
+		std::vector<Event> run;
+		if(!rawdata || !tracks || rawdata->GetEntries() != tracks->GetEntries()) return run;
+
+		std::vector<int> * col = nullptr, * row = nullptr, * tot = nullptr, * iden = nullptr;
+		std::vector<double> * xPos = nullptr, * yPos = nullptr, * chi2 = nullptr;
+		rawdata->SetBranchAddress("col", &col);
+		rawdata->SetBranchAddress("row", &row);
+		rawdata->SetBranchAddress("tot", &tot);
+		rawdata->SetBranchAddress("iden", &iden);
+		tracks->SetBranchAddress("xPos", &xPos);
+		tracks->SetBranchAddress("yPos", &yPos);
+		tracks->SetBranchAddress("chi2", &chi2);
+		for(Long64_t entry = 0; entry < rawdata->GetEntries(); ++entry) {
+			rawdata->GetEntry(entry);
+			tracks->GetEntry(entry);
+			run.push_back(Event{*col, *row, *tot, *iden, *xPos, *yPos, *chi2});
+		}
+		rawdata->ResetBranchAddresses();
+		tracks->ResetBranchAddresses();
+		delete col; delete row; delete tot; delete iden;
+		delete xPos; delete yPos; delete chi2;
+		return run;
+	}
+
+	void expectSameRun(std::vector<Event> const & expected, std::vector<Event> const & run) {
+		ASSERT_EQ(expected.size(), run.size());
+		for(size_t i = 0; i < run.size(); ++i) {
+			ASSERT_EQ(expected[i].col, run[i].col);
+			ASSERT_EQ(expected[i].row, run[i].row);
+			ASSERT_EQ(expected[i].tot, run[i].tot);
+			ASSERT_EQ(expected[i].iden, run[i].iden);
+			ASSERT_EQ(expected[i].xPos, run[i].xPos);
+			ASSERT_EQ(expected[i].yPos, run[i].yPos);
+			ASSERT_EQ(expected[i].chi2, run[i].chi2);
+		}
+	}
+}
+
+/** Default settings change nothing: the file is written exactly as
+ *  without them.
+ */
+TEST(EUTelRootOutputSettingsTest, DefaultsKeepRoot) {
+
+	std::vector<Event> const run = makeRun(2000);
+	EUTelRootOutputSettings const settings;
+	long long const plainSize = writeRun("rootoutputsettings_plain.root", run, nullptr);
+	// same length of the file names, they are stored in the file
+	long long const defaultSize = writeRun("rootoutputsettings_unset.root", run, &settings);
+
+	EXPECT_EQ(plainSize, defaultSize);
+	expectSameRun(run, readRun("rootoutputsettings_unset.root"));
+	std::remove("rootoutputsettings_plain.root");
+	std::remove("rootoutputsettings_unset.root");
+}
+
+/** Larger baskets, auto flush and a stronger compression keep the
+ *  branch contents and give a file of the same size or smaller.
+ */
+TEST(EUTelRootOutputSettingsTest, TunedRun) {
+
+	std::vector<Event> const run = makeRun(20000);
+	long long const defaultSize = writeRun("rootoutputsettings_default.root", run, nullptr);
+
+	EUTelRootOutputSettings settings;
+	settings.setBasketSize(256000);
+	settings.setAutoFlush(-30000000);
+	settings.setCompressionAlgorithm(2);
+	settings.setCompressionLevel(9);
+	long long const tunedSize = writeRun("rootoutputsettings_tuned.root", run, &settings);
+
+	expectSameRun(readRun("rootoutputsettings_default.root"), readRun("rootoutputsettings_tuned.root"));
+	expectSameRun(run, readRun("rootoutputsettings_tuned.root"));
+	EXPECT_LE(tunedSize, defaultSize);
+	std::remove("rootoutputsettings_default.root");
+	std::remove("rootoutputsettings_tuned.root");
+}
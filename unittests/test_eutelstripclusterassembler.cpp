@@ -0,0 +1,96 @@
+//STL
+#include <memory>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//LCIO
+#include <IMPL/TrackerDataImpl.h>
+
+//EUTelescope
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelSparseClusterImpl.h"
+#include "EUTelStripClusterAssembler.h"
+
+using eutelescope::EUTelGenericSparsePixel;
+using eutelescope::EUTelSparseClusterImpl;
+using eutelescope::EUTelStripClusterAssembler;
+
+namespace {
+
+	// Labels as CBCClustering produces them on a sensor of 16 strips:
+	// a cluster on the first strip, two adjacent clusters (the first one
+	// cut at the maximum size), a single strip and a cluster on the last
+	// strip
+	std::vector<int> const clusterNumber = {1, 0, 0, 2, 2, 3, 0, 0, 0, 4, 0, 0, 0, 5, 5, 5};
+	std::vector<float> const signals = {1., 0., 0., 1., 1., 1., 0., 0., 0., 1., 0., 0., 0., 1., 1., 1.};
+	std::vector<std::vector<short>> const expectedStrips = {{0}, {3, 4}, {5}, {9}, {13, 14, 15}};
+
+	// Checks the pixels of every cluster with the strips either along x or y
+	void checkClusters(EUTelStripClusterAssembler const & assembler, bool stripsAlongY) {
+		for(int id = 1; id <= assembler.getMaxClusterID(); ++id) {
+			std::unique_ptr<IMPL::TrackerDataImpl> frame(new IMPL::TrackerDataImpl());
+			EUTelSparseClusterImpl<EUTelGenericSparsePixel> cluster(frame.get());
+			assembler.fillCluster(id, signals, stripsAlongY, cluster);
+
+			std::vector<short> const & strips = expectedStrips[id - 1];
+			ASSERT_EQ(strips.size(), cluster.size());
+			for(size_t i = 0; i < strips.size(); ++i) {
+				EUTelGenericSparsePixel const & pixel = cluster.at(i);
+				EXPECT_EQ(stripsAlongY ? 0 : strips[i], pixel.getXCoord());
+				EXPECT_EQ(stripsAlongY ? strips[i] : 0, pixel.getYCoord());
+				EXPECT_FLOAT_EQ(signals[strips[i]], pixel.getSignal());
+			}
+			EXPECT_FLOAT_EQ(static_cast<float>(strips.size()), cluster.getTotalCharge());
+		}
+	}
+}
+
+/** Every cluster gets its own strips, in order, including the edge
+ *  strips and adjacent clusters.
+ */
+TEST(EUTelStripClusterAssemblerTest, Buckets) {
+
+	EUTelStripClusterAssembler assembler;
+	assembler.assemble(clusterNumber);
+
+	ASSERT_EQ(5, assembler.getMaxClusterID());
+	for(int id = 1; id <= assembler.getMaxClusterID(); ++id) {
+		std::vector<short> const & strips = expectedStrips[id - 1];
+		ASSERT_EQ(strips.size(), assembler.getClusterSize(id));
+		for(size_t i = 0; i < strips.size(); ++i) {
+			EXPECT_EQ(static_cast<size_t>(strips[i]), assembler.getStrips(id)[i]);
+		}
+	}
+}
+
+/** The pixels of the output clusters carry the strip index on the
+ *  sensitive axis and the strip signal.
+ */
+TEST(EUTelStripClusterAssemblerTest, ClusterPixels) {
+
+	EUTelStripClusterAssembler assembler;
+	assembler.assemble(clusterNumber);
+	checkClusters(assembler, true);
+	checkClusters(assembler, false);
+}
+
+/** Reusing the assembler for another sensor forgets the previous one,
+ *  a sensor without clusters gives none.
+ */
+TEST(EUTelStripClusterAssemblerTest, Reuse) {
+
+	EUTelStripClusterAssembler assembler;
+	assembler.assemble(clusterNumber);
+	assembler.assemble(std::vector<int>(16, 0));
+	EXPECT_EQ(0, assembler.getMaxClusterID());
+
+	assembler.assemble({0, 2, 2, 0, 1});
+	ASSERT_EQ(2, assembler.getMaxClusterID());
+	ASSERT_EQ(1u, assembler.getClusterSize(1));
+	EXPECT_EQ(4u, assembler.getStrips(1)[0]);
+	ASSERT_EQ(2u, assembler.getClusterSize(2));
+	EXPECT_EQ(1u, assembler.getStrips(2)[0]);
+	EXPECT_EQ(2u, assembler.getStrips(2)[1]);
+}
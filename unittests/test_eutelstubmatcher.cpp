@@ -0,0 +1,91 @@
+//STL
+#include <random>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelStubMatcher.h"
+
+using eutelescope::EUTelStubMatcher;
+
+namespace {
+
+	// Hits on 1016 strips along the sensitive axis, the other coordinate
+	// is 0 as for the CBC clusters
+	std::vector<EUTelStubMatcher::Hit> makeHits(std::default_random_engine & generator, size_t n, bool stripsAlongY) {
+		std::uniform_real_distribution<float> strip(0.f, 1015.f);
+		std::uniform_real_distribution<float> charge(1.f, 4.f);
+		std::vector<EUTelStubMatcher::Hit> hits(n);
+		for(auto & hit : hits) {
+			float const position = strip(generator);
+			hit.x = stripsAlongY ? 0.f : position;
+			hit.y = stripsAlongY ? position : 0.f;
+			hit.q = charge(generator);
+		}
+		return hits;
+	}
+
+	// The pair loop CMSStubGenerator used before
+	std::vector<std::pair<size_t, size_t>> pairLoop(std::vector<EUTelStubMatcher::Hit> const & plane1,
+	                                                std::vector<EUTelStubMatcher::Hit> const & plane2, float maxResidual) {
+		std::vector<std::pair<size_t, size_t>> stubs;
+		for(size_t i1 = 0; i1 < plane1.size(); ++i1) {
+			for(size_t i2 = 0; i2 < plane2.size(); ++i2) {
+				if(EUTelStubMatcher::isStub(plane1[i1], plane2[i2], maxResidual)) stubs.emplace_back(i1, i2);
+			}
+		}
+		return stubs;
+	}
+
+	std::vector<std::pair<size_t, size_t>> window(std::vector<EUTelStubMatcher::Hit> const & plane1,
+	                                              std::vector<EUTelStubMatcher::Hit> const & plane2, float maxResidual) {
+		EUTelStubMatcher matcher;
+		matcher.setSecondPlane(plane2);
+		std::vector<std::pair<size_t, size_t>> stubs;
+		std::vector<size_t> matches;
+		for(size_t i1 = 0; i1 < plane1.size(); ++i1) {
+			matcher.findMatches(plane1[i1], maxResidual, matches);
+			for(size_t i2 : matches) stubs.emplace_back(i1, i2);
+		}
+		return stubs;
+	}
+}
+
+/** The window search finds the same stubs in the same order as the
+ *  pair loop, for both strip orientations and up to 500 hits per plane.
+ */
+TEST(EUTelStubMatcherTest, SameAsPairLoop) {
+
+	std::default_random_engine generator(21);
+	std::uniform_int_distribution<size_t> nHits(0, 500);
+	size_t nStubs = 0;
+	for(int iEvent = 0; iEvent < 200; ++iEvent) {
+		bool const stripsAlongY = iEvent % 2;
+		float const maxResidual = 0.5f + 0.05f * (iEvent % 40);
+		auto const plane1 = makeHits(generator, nHits(generator), stripsAlongY);
+		auto const plane2 = makeHits(generator, nHits(generator), stripsAlongY);
+		auto const expected = pairLoop(plane1, plane2, maxResidual);
+		ASSERT_EQ(expected, window(plane1, plane2, maxResidual));
+		nStubs += expected.size();
+	}
+	EXPECT_GT(nStubs, 0u);
+}
+
+/** Pairs right at the residual and hits at the same position.
+ */
+TEST(EUTelStubMatcherTest, Boundaries) {
+
+	std::vector<EUTelStubMatcher::Hit> const plane1 = {{10.f, 0.f, 1.f}, {20.f, 0.f, 1.f}};
+	std::vector<EUTelStubMatcher::Hit> const plane2 = {{12.f, 0.f, 1.f}, {11.99f, 0.f, 1.f}, {20.f, 0.f, 1.f},
+	                                                    {20.f, 0.f, 2.f}, {8.f, 0.f, 1.f}, {20.f, 3.f, 1.f}};
+	auto const expected = pairLoop(plane1, plane2, 2.f);
+	EXPECT_EQ(expected, window(plane1, plane2, 2.f));
+	EXPECT_EQ(3u, expected.size());
+
+	// no residual, no stubs
+	EXPECT_TRUE(window(plane1, plane2, 0.f).empty());
+	EXPECT_TRUE(window(plane1, {}, 2.f).empty());
+}
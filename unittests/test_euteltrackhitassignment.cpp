@@ -0,0 +1,233 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelTrackHitAssignment.h"
+
+using eutelescope::EUTelTrackHitAssignment;
+
+namespace {
+
+	typedef std::vector<std::vector<double>> Positions;
+
+	double gatedDistance(std::vector<double> const & track, std::vector<double> const & hit, double limit) {
+		double const dx = std::abs(hit[0] - track[0]);
+		double const dy = std::abs(hit[1] - track[1]);
+		if(dx < limit && dy < limit) return std::sqrt(dx * dx + dy * dy);
+		return -1.;
+	}
+
+	// The permutation search formerly used by EUTelProcessorAnalysisPALPIDEfs:
+	// for every order of the tracks each one takes its closest free hit, the
+	// order with the most pairs and then the smallest total distance wins
+	void permutationSearch(Positions const & pT, Positions const & pH, double limit,
+	                       unsigned int & maxAssociations, double & minDistance) {
+		int const nT = pT.size();
+		int const nH = pH.size();
+		std::vector<int> order(nT);
+		for(int iT = 0; iT < nT; iT++) order[iT] = iT;
+		maxAssociations = 0;
+		minDistance = 1e10;
+		bool run1 = true;
+		do {
+			double totaldistance = 0;
+			unsigned int associations = 0;
+			std::vector<int> aHTemp(nH, -1);
+			bool run2 = true;
+			for(unsigned int i = 0; i < order.size() && run2; i++) {
+				int iT = order[i];
+				double min = 1e10;
+				int temp = -1;
+				for(int iH = 0; iH < nH; iH++) {
+					double const dist = gatedDistance(pT[iT], pH[iH], limit);
+					if(aHTemp[iH] == -1 && dist >= 0. && dist < min) {
+						min = dist;
+						temp = iH;
+					}
+				}
+				if(temp >= 0) {
+					associations++;
+					aHTemp[temp] = iT;
+					totaldistance += min;
+				}
+				if(totaldistance > minDistance) run2 = false;
+				if((i - associations + 1) > (order.size() - maxAssociations)) run2 = false;
+			}
+			if(associations == order.size()) run1 = false;
+			if(associations >= maxAssociations && totaldistance < minDistance) {
+				maxAssociations = associations;
+				minDistance = totaldistance;
+			}
+		} while(std::next_permutation(order.begin(), order.end()) && run1);
+	}
+
+	// Exact optimum by dynamic programming over the tracks and the set of
+	// used hits: most pairs first, smallest total distance second
+	struct Best {
+		unsigned int associations;
+		double distance;
+	};
+
+	Best exhaustiveSearch(std::vector<double> const & distances, size_t nT, size_t nH, size_t iT,
+	                      unsigned int usedHits, std::vector<std::vector<Best>> & memo) {
+		if(iT == nT) return {0, 0.};
+		Best & best = memo[iT][usedHits];
+		if(best.distance >= 0.) return best;
+		best = exhaustiveSearch(distances, nT, nH, iT + 1, usedHits, memo);
+		for(size_t iH = 0; iH < nH; ++iH) {
+			double const dist = distances[iT * nH + iH];
+			if(dist < 0. || (usedHits & (1u << iH))) continue;
+			Best candidate = exhaustiveSearch(distances, nT, nH, iT + 1, usedHits | (1u << iH), memo);
+			candidate.associations++;
+			candidate.distance += dist;
+			if(candidate.associations > best.associations ||
+			   (candidate.associations == best.associations && candidate.distance < best.distance)) {
+				best = candidate;
+			}
+		}
+		return best;
+	}
+
+	// Tracks and hits crowded into a small area, so that most tracks have
+	// several candidates, with some hits missing and some noise hits
+	void makeEvent(std::default_random_engine & generator, int nTracks, double size,
+	               Positions & pT, Positions & pH) {
+		std::uniform_real_distribution<double> position(0., size);
+		std::normal_distribution<double> resolution(0., 0.01);
+		std::uniform_real_distribution<double> probability(0., 1.);
+		pT.clear();
+		pH.clear();
+		for(int iT = 0; iT < nTracks; ++iT) {
+			pT.push_back({position(generator), position(generator)});
+			if(probability(generator) < 0.8) {
+				pH.push_back({pT.back()[0] + resolution(generator), pT.back()[1] + resolution(generator)});
+			}
+			if(probability(generator) < 0.3) {
+				pH.push_back({position(generator), position(generator)});
+			}
+		}
+	}
+
+	std::vector<double> distanceMatrix(Positions const & pT, Positions const & pH, double limit) {
+		std::vector<double> distances;
+		for(auto const & track : pT) {
+			for(auto const & hit : pH) distances.push_back(gatedDistance(track, hit, limit));
+		}
+		return distances;
+	}
+}
+
+/** For up to 8 tracks competing for the hits the solver finds the exact
+ *  optimum and is never worse than the permutation search, i.e. it has
+ *  more associations or as many with at most the same total distance.
+ */
+TEST(EUTelTrackHitAssignmentTest, MatchesPermutationSearch) {
+
+	double const limit = 0.05;
+	std::default_random_engine generator(41);
+	EUTelTrackHitAssignment assignment;
+	Positions pT, pH;
+
+	int nBetter = 0;
+	int nEvents = 0;
+	for(int nTracks = 1; nTracks <= 8; ++nTracks) {
+		for(int iEvent = 0; iEvent < 40; ++iEvent) {
+			makeEvent(generator, nTracks, 0.08, pT, pH);
+			std::vector<double> const distances = distanceMatrix(pT, pH, limit);
+			assignment.solve(distances, pT.size(), pH.size());
+
+			std::vector<std::vector<Best>> memo(pT.size(), std::vector<Best>(1u << pH.size(), Best{0, -1.}));
+			Best const optimum = exhaustiveSearch(distances, pT.size(), pH.size(), 0, 0, memo);
+			ASSERT_EQ(optimum.associations, assignment.getNAssociations());
+			ASSERT_NEAR(optimum.distance, assignment.getTotalDistance(), 1e-12);
+
+			unsigned int associations;
+			double distance;
+			permutationSearch(pT, pH, limit, associations, distance);
+			ASSERT_GE(assignment.getNAssociations(), associations);
+			if(assignment.getNAssociations() == associations && associations > 0) {
+				ASSERT_LE(assignment.getTotalDistance(), distance + 1e-12);
+			}
+			if(assignment.getNAssociations() > associations ||
+			   (associations > 0 && assignment.getTotalDistance() < distance - 1e-12)) {
+				++nBetter;
+			}
+			++nEvents;
+
+			// one to one and within the gate
+			std::vector<int> used(pH.size(), 0);
+			for(size_t iT = 0; iT < pT.size(); ++iT) {
+				int const hit = assignment.getHit(iT);
+				if(hit < 0) continue;
+				ASSERT_GE(gatedDistance(pT[iT], pH[hit], limit), 0.);
+				ASSERT_EQ(0, used[hit]++);
+			}
+		}
+	}
+	std::cout << "Better than the permutation search in " << nBetter << " of " << nEvents << " events" << std::endl;
+}
+
+/** Trivial cases: nothing to associate, and one hit wanted by two tracks.
+ */
+TEST(EUTelTrackHitAssignmentTest, SmallCases) {
+
+	EUTelTrackHitAssignment assignment;
+
+	assignment.solve({}, 0, 3);
+	EXPECT_EQ(0u, assignment.getNAssociations());
+
+	assignment.solve({-1., -1.}, 2, 1);
+	EXPECT_EQ(0u, assignment.getNAssociations());
+	EXPECT_EQ(-1, assignment.getHit(0));
+	EXPECT_EQ(-1, assignment.getHit(1));
+
+	// track 1 is closer to hit 0, but only the crossed association gives two pairs
+	assignment.solve({0.02, 0.04,
+	                  0.01, -1.}, 2, 2);
+	EXPECT_EQ(2u, assignment.getNAssociations());
+	EXPECT_EQ(1, assignment.getHit(0));
+	EXPECT_EQ(0, assignment.getHit(1));
+	EXPECT_NEAR(0.05, assignment.getTotalDistance(), 1e-15);
+}
+
+/** 100 crowded tracks are solved, no time limit: it would fail on a
+ *  loaded machine or under sanitizers.
+ */
+TEST(EUTelTrackHitAssignmentTest, HundredTracks) {
+
+	double const limit = 0.05;
+	std::default_random_engine generator(43);
+	EUTelTrackHitAssignment assignment;
+	Positions pT, pH;
+	makeEvent(generator, 100, 0.5, pT, pH);
+	assignment.solve(distanceMatrix(pT, pH, limit), pT.size(), pH.size());
+	EXPECT_GT(assignment.getNAssociations(), 50u);
+}
+
+/** The same 100 crowded tracks, timed.
+ */
+TEST(EUTelTrackHitAssignmentTest, DISABLED_Benchmark) {
+
+	double const limit = 0.05;
+	std::default_random_engine generator(43);
+	EUTelTrackHitAssignment assignment;
+	Positions pT, pH;
+	makeEvent(generator, 100, 0.5, pT, pH);
+	std::vector<double> const distances = distanceMatrix(pT, pH, limit);
+
+	double const ms = eutelbenchmark::milliseconds([&] { assignment.solve(distances, pT.size(), pH.size()); });
+
+	eutelbenchmark::report(std::to_string(pT.size()) + " tracks, " + std::to_string(pH.size()) + " hits, "
+	                       + std::to_string(assignment.getNAssociations()) + " associations", {{"assignment", ms}});
+}
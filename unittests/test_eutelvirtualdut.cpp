@@ -0,0 +1,70 @@
+//STL
+#include <cmath>
+#include <random>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Eigen
+#include <Eigen/Core>
+
+//EUTelescope
+#include "EUTelVirtualDUT.h"
+
+using namespace eutelescope;
+
+// Two sensors 2 mm up- and downstream of a virtual DUT at z = 370 mm,
+// with tracks from telescope planes 2 and 3 as in CBCHitRecovery
+class EUTelVirtualDUTTest : public ::testing::Test {
+protected:
+
+	// straight line through origin with slope (tx, ty), at z
+	static Eigen::Vector3d point(Eigen::Vector3d const & origin, double tx, double ty, double z) {
+		return Eigen::Vector3d(origin.x() + tx * (z - origin.z()), origin.y() + ty * (z - origin.z()), z);
+	}
+
+	Eigen::Vector3d const normalPlus{0., 0., 1.};
+	Eigen::Vector3d const normalMinus{0., 0., -1.};
+	double const zVirtual = 370.;
+	double const zTelescope2 = 150.;
+	double const zTelescope3 = 600.;
+};
+
+/** The recovered positions are the track points on the two sensors.
+ */
+TEST_F(EUTelVirtualDUTTest, RecoveredHitPositions) {
+
+	std::default_random_engine generator(13);
+	std::uniform_real_distribution<double> position(-10., 10.);
+	std::uniform_real_distribution<double> slope(-2e-3, 2e-3);
+
+	for(int i = 0; i < 1000; ++i) {
+		double const tx = slope(generator), ty = slope(generator);
+		Eigen::Vector3d const origin(position(generator), position(generator), 0.);
+		Eigen::Vector3d const virtualHit = point(origin, tx, ty, zVirtual);
+		Eigen::Vector3d const upstream = point(origin, tx, ty, zTelescope2) - virtualHit;
+		Eigen::Vector3d const downstream = point(origin, tx, ty, zTelescope3) - virtualHit;
+
+		EXPECT_NEAR(-1., VirtualDUT::cosAlpha(upstream, downstream), 1e-12);
+
+		Eigen::Vector3d const dut0 = VirtualDUT::hitPosition(upstream, normalMinus, virtualHit, -2.);
+		Eigen::Vector3d const dut1 = VirtualDUT::hitPosition(downstream, normalPlus, virtualHit, 2.);
+		EXPECT_LT((point(origin, tx, ty, zVirtual - 2.) - dut0).norm(), 1e-9);
+		EXPECT_LT((point(origin, tx, ty, zVirtual + 2.) - dut1).norm(), 1e-9);
+	}
+}
+
+/** A tilted virtual DUT: the recovered points lie on the planes parallel
+ *  to it at the given distance.
+ */
+TEST_F(EUTelVirtualDUTTest, TiltedPlane) {
+
+	double const angle = 0.3;
+	Eigen::Vector3d const normal(std::sin(angle), 0., std::cos(angle));
+	Eigen::Vector3d const virtualHit(1., -2., zVirtual);
+	Eigen::Vector3d const track(0.01, 0.02, 1.);
+
+	Eigen::Vector3d const hit = VirtualDUT::hitPosition(track, normal, virtualHit, 2.);
+	EXPECT_NEAR(2., (hit - virtualHit).dot(normal), 1e-12);
+	EXPECT_NEAR(0., (hit - virtualHit).cross(track).norm(), 1e-12);
+}
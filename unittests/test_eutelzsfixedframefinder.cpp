@@ -0,0 +1,302 @@
+//STL
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//Benchmark
+#include "eutelbenchmark.h"
+
+//EUTelescope
+#include "EUTelZSFixedFrameFinder.h"
+
+using eutelescope::EUTelZSFixedFrameFinder;
+
+namespace {
+
+	// the EUTELESCOPE pixel status values
+	short const GOODPIXEL = 0;
+	short const BADPIXEL = 1;
+	short const HITPIXEL = -1;
+	short const MISSINGPIXEL = 2;
+
+	struct Pixel {
+		int x;
+		int y;
+		float signal;
+	};
+
+	struct Cluster {
+		int seedX;
+		int seedY;
+		bool border;
+		bool incomplete;
+		bool merged;
+		std::vector<float> charges;
+	};
+
+	struct Sensor {
+		int nX;
+		int nY;
+		std::vector<float> noise;
+		std::vector<short> status;
+		std::set<int> hot;
+	};
+
+	void resetStatus(std::vector<short> & status) {
+		for(auto & value : status) {
+			if(value == HITPIXEL || value == MISSINGPIXEL) value = GOODPIXEL;
+		}
+	}
+
+	// The cluster search formerly done in
+	// EUTelClusteringProcessor::zsFixedFrameClustering with a multimap
+	std::vector<Cluster> multimapClustering(Sensor & sensor, std::vector<Pixel> const & frame, int xSize, int ySize,
+	                                        float seedCut, float clusterCut) {
+		int const minX = 0, minY = 0, maxX = sensor.nX - 1, maxY = sensor.nY - 1;
+		std::vector<float> dataVec(sensor.noise.size(), 0.);
+		std::multimap<float, int> seedCandidateMap;
+		for(auto const & pixel : frame) {
+			int const index = pixel.x + pixel.y * sensor.nX;
+			dataVec[index] = pixel.signal;
+			if(pixel.signal > seedCut * sensor.noise[index] && sensor.status[index] == GOODPIXEL) {
+				seedCandidateMap.insert(std::make_pair(pixel.signal, index));
+			}
+		}
+
+		std::vector<Cluster> clusters;
+		for(auto rMapIter = seedCandidateMap.rbegin(); rMapIter != seedCandidateMap.rend(); ++rMapIter) {
+			if(sensor.hot.count(rMapIter->second)) continue;
+			if(sensor.status[rMapIter->second] != GOODPIXEL) continue;
+			double clusterCandidateSignal = 0.;
+			double clusterCandidateNoise2 = 0.;
+			std::vector<float> clusterCandidateCharges;
+			std::vector<int> clusterCandidateIndeces;
+			int const seedX = rMapIter->second % sensor.nX;
+			int const seedY = rMapIter->second / sensor.nX;
+			Cluster cluster{seedX, seedY, false, false, false, {}};
+			for(int yPixel = seedY - (ySize / 2); yPixel <= seedY + (ySize / 2); yPixel++) {
+				for(int xPixel = seedX - (xSize / 2); xPixel <= seedX + (xSize / 2); xPixel++) {
+					if((xPixel >= minX) && (xPixel <= maxX) && (yPixel >= minY) && (yPixel <= maxY)) {
+						int const index = xPixel + yPixel * sensor.nX;
+						bool const isHit = (sensor.status[index] == HITPIXEL);
+						bool const isGood = (sensor.status[index] == GOODPIXEL);
+						clusterCandidateIndeces.push_back(isGood ? index : -1);
+						if(isGood && !isHit) {
+							if(dataVec[index] == 0.0) sensor.status[index] = MISSINGPIXEL;
+							clusterCandidateSignal += dataVec[index];
+							clusterCandidateNoise2 += pow(sensor.noise[index], 2);
+							clusterCandidateCharges.push_back(dataVec[index]);
+						} else if(isHit) {
+							cluster.incomplete = cluster.merged = true;
+							clusterCandidateCharges.push_back(0.);
+						} else if(!isGood) {
+							cluster.incomplete = true;
+							clusterCandidateCharges.push_back(0.);
+						}
+					} else {
+						cluster.border = true;
+						clusterCandidateCharges.push_back(0.);
+					}
+				}
+			}
+			if(clusterCandidateSignal > clusterCut * sqrt(clusterCandidateNoise2)) {
+				for(int index : clusterCandidateIndeces) {
+					if(index != -1) sensor.status[index] = HITPIXEL;
+				}
+				cluster.charges = clusterCandidateCharges;
+				clusters.push_back(cluster);
+			}
+		}
+		return clusters;
+	}
+
+	std::vector<Cluster> finderClustering(EUTelZSFixedFrameFinder & finder, Sensor & sensor, std::vector<Pixel> const & frame,
+	                                      int xSize, int ySize, float seedCut, float clusterCut) {
+		if(!finder.isConfigured(0, 0, sensor.nX, sensor.nY)) {
+			finder.configure(0, 0, sensor.nX, sensor.nY);
+			for(int index : sensor.hot) finder.setHotPixel(index);
+		}
+		finder.setClusterSize(xSize, ySize);
+		for(auto const & pixel : frame) finder.addPixel(pixel.x, pixel.y, pixel.signal, sensor.status, sensor.noise, seedCut);
+		finder.findClusters(sensor.status, sensor.noise, clusterCut, sensor.nX - 1, sensor.nY - 1);
+
+		std::vector<Cluster> clusters;
+		for(auto const & found : finder.getClusters()) {
+			auto const first = finder.getCharges().begin() + found.firstCharge;
+			clusters.push_back(Cluster{found.seedX, found.seedY, found.border, found.incomplete, found.merged,
+			                           std::vector<float>(first, first + xSize * ySize)});
+		}
+		return clusters;
+	}
+
+	Sensor makeSensor(std::default_random_engine & generator, int nX, int nY) {
+		std::uniform_real_distribution<float> noise(1.5, 2.5);
+		std::uniform_real_distribution<double> probability(0., 1.);
+		Sensor sensor{nX, nY, std::vector<float>(nX * nY), std::vector<short>(nX * nY, GOODPIXEL), {}};
+		for(int index = 0; index < nX * nY; ++index) {
+			sensor.noise[index] = noise(generator);
+			if(probability(generator) < 0.02) sensor.status[index] = BADPIXEL;
+			if(probability(generator) < 0.01) sensor.hot.insert(index);
+		}
+		return sensor;
+	}
+
+	// zero suppressed frame: noise above threshold plus charge clouds,
+	// signals are rounded so that equal signals happen
+	std::vector<Pixel> makeFrame(std::default_random_engine & generator, int nX, int nY, int nNoise, int nClusters) {
+		std::uniform_int_distribution<int> x(0, nX - 1), y(0, nY - 1), step(-1, 1);
+		std::uniform_real_distribution<float> noiseSignal(4., 8.);
+		std::exponential_distribution<float> clusterSignal(0.02f);
+		std::vector<Pixel> frame;
+		for(int i = 0; i < nNoise; ++i) frame.push_back({x(generator), y(generator), std::round(noiseSignal(generator))});
+		for(int i = 0; i < nClusters; ++i) {
+			int const cx = x(generator), cy = y(generator);
+			frame.push_back({cx, cy, std::round(20.f + clusterSignal(generator))});
+			for(int n = 0; n < 4; ++n) {
+				int const px = cx + step(generator), py = cy + step(generator);
+				if(px >= 0 && px < nX && py >= 0 && py < nY) frame.push_back({px, py, std::round(4.f + clusterSignal(generator) / 4.f)});
+			}
+		}
+		return frame;
+	}
+}
+
+/** Random zero suppressed frames on a sensor with bad and hot pixels
+ *  give the same clusters, quality flags, frame charges and pixel
+ *  status as the multimap implementation, for several frame sizes.
+ */
+TEST(EUTelZSFixedFrameFinderTest, MatchesMultimap) {
+
+	std::default_random_engine generator(44);
+	Sensor reference = makeSensor(generator, 48, 32);
+	Sensor sensor = reference;
+	EUTelZSFixedFrameFinder finder(GOODPIXEL, HITPIXEL, MISSINGPIXEL);
+
+	size_t nClusters = 0;
+	for(int xSize = 1; xSize <= 7; xSize += 2) {
+		for(int ySize = 1; ySize <= 7; ySize += 2) {
+			for(int iFrame = 0; iFrame < 50; ++iFrame) {
+				std::vector<Pixel> const frame = makeFrame(generator, sensor.nX, sensor.nY, iFrame % 30, iFrame % 10);
+				resetStatus(reference.status);
+				resetStatus(sensor.status);
+				std::vector<Cluster> const expected = multimapClustering(reference, frame, xSize, ySize, 3.f, 5.f);
+				std::vector<Cluster> const clusters = finderClustering(finder, sensor, frame, xSize, ySize, 3.f, 5.f);
+
+				ASSERT_EQ(expected.size(), clusters.size());
+				for(size_t iCluster = 0; iCluster < clusters.size(); ++iCluster) {
+					ASSERT_EQ(expected[iCluster].seedX, clusters[iCluster].seedX);
+					ASSERT_EQ(expected[iCluster].seedY, clusters[iCluster].seedY);
+					ASSERT_EQ(expected[iCluster].border, clusters[iCluster].border);
+					ASSERT_EQ(expected[iCluster].incomplete, clusters[iCluster].incomplete);
+					ASSERT_EQ(expected[iCluster].merged, clusters[iCluster].merged);
+					ASSERT_EQ(expected[iCluster].charges, clusters[iCluster].charges);
+				}
+				ASSERT_EQ(reference.status, sensor.status);
+				nClusters += clusters.size();
+			}
+		}
+	}
+	EXPECT_GT(nClusters, 1000u);
+}
+
+/** Pixels outside of the matrix are refused.
+ */
+TEST(EUTelZSFixedFrameFinderTest, OutsidePixels) {
+
+	std::vector<float> const noise(100, 2.f);
+	std::vector<short> status(100, GOODPIXEL);
+	EUTelZSFixedFrameFinder finder(GOODPIXEL, HITPIXEL, MISSINGPIXEL);
+	finder.configure(0, 0, 10, 10);
+	finder.setClusterSize(3, 3);
+	EXPECT_FALSE(finder.addPixel(10, 0, 50.f, status, noise, 3.f));
+	EXPECT_FALSE(finder.addPixel(0, -1, 50.f, status, noise, 3.f));
+	EXPECT_TRUE(finder.addPixel(0, 0, 50.f, status, noise, 3.f));
+	finder.findClusters(status, noise, 5.f, 9, 9);
+	ASSERT_EQ(1u, finder.getClusters().size());
+	EXPECT_TRUE(finder.getClusters()[0].border);
+	EXPECT_EQ(50.f, finder.getCharges()[4]);
+	EXPECT_EQ(HITPIXEL, status[0]);
+	EXPECT_EQ(HITPIXEL, status[1]);
+	EXPECT_EQ(GOODPIXEL, status[2]);
+}
+
+/** Frames of even or no size are refused, hot pixels count as seed
+ *  candidates without becoming seeds.
+ */
+TEST(EUTelZSFixedFrameFinderTest, ClusterSizeAndHotSeeds) {
+
+	EUTelZSFixedFrameFinder finder(GOODPIXEL, HITPIXEL, MISSINGPIXEL);
+	EXPECT_THROW(finder.setClusterSize(4, 3), std::invalid_argument);
+	EXPECT_THROW(finder.setClusterSize(3, 2), std::invalid_argument);
+	EXPECT_THROW(finder.setClusterSize(0, 3), std::invalid_argument);
+	EXPECT_THROW(finder.setClusterSize(3, -1), std::invalid_argument);
+
+	std::vector<float> const noise(100, 2.f);
+	std::vector<short> status(100, GOODPIXEL);
+	finder.configure(0, 0, 10, 10);
+	finder.setClusterSize(1, 1);
+	finder.setHotPixel(55);
+	for(int event = 0; event < 2; ++event) {
+		EXPECT_TRUE(finder.addPixel(5, 5, 90.f, status, noise, 3.f));
+		EXPECT_TRUE(finder.addPixel(2, 2, 50.f, status, noise, 3.f));
+		EXPECT_TRUE(finder.addPixel(7, 7, 1.f, status, noise, 3.f));
+		finder.findClusters(status, noise, 5.f, 9, 9);
+		EXPECT_EQ(2u, finder.getNSeedCandidates());
+		ASSERT_EQ(1u, finder.getClusters().size());
+		EXPECT_EQ(2, finder.getClusters()[0].seedX);
+		EXPECT_EQ(GOODPIXEL, status[55]);
+		resetStatus(status);
+	}
+}
+
+/** 10^5 synthetic 5x5 frame searches on a 64 x 64 sensor.
+ */
+TEST(EUTelZSFixedFrameFinderTest, DISABLED_Benchmark) {
+
+	int const nFrames = 100000;
+	std::default_random_engine generator(45);
+	Sensor reference = makeSensor(generator, 64, 64);
+	Sensor sensor = reference;
+	std::vector<std::vector<Pixel>> frames;
+	for(int iFrame = 0; iFrame < 1000; ++iFrame) frames.push_back(makeFrame(generator, sensor.nX, sensor.nY, 10, 3));
+
+	size_t nExpected = 0;
+	double const multimapMs = eutelbenchmark::milliseconds([&] {
+		for(int iFrame = 0; iFrame < nFrames; ++iFrame) {
+			resetStatus(reference.status);
+			nExpected += multimapClustering(reference, frames[iFrame % frames.size()], 5, 5, 3.f, 5.f).size();
+		}
+	});
+
+	// as the processor uses it, without copying the clusters out
+	size_t nFound = 0;
+	EUTelZSFixedFrameFinder finder(GOODPIXEL, HITPIXEL, MISSINGPIXEL);
+	finder.configure(0, 0, sensor.nX, sensor.nY);
+	for(int index : sensor.hot) finder.setHotPixel(index);
+	double const finderMs = eutelbenchmark::milliseconds([&] {
+		for(int iFrame = 0; iFrame < nFrames; ++iFrame) {
+			resetStatus(sensor.status);
+			finder.setClusterSize(5, 5);
+			for(auto const & pixel : frames[iFrame % frames.size()])
+				finder.addPixel(pixel.x, pixel.y, pixel.signal, sensor.status, sensor.noise, 3.f);
+			finder.findClusters(sensor.status, sensor.noise, 5.f, sensor.nX - 1, sensor.nY - 1);
+			nFound += finder.getClusters().size();
+		}
+	});
+
+	// the status reset is included in both, and timed alone
+	double const resetMs = eutelbenchmark::milliseconds([&] {
+		for(int iFrame = 0; iFrame < nFrames; ++iFrame) resetStatus(sensor.status);
+	});
+
+	eutelbenchmark::report(std::to_string(nFrames) + " frames",
+	                       {{"multimap", multimapMs}, {"finder", finderMs}, {"status reset alone", resetMs}});
+	EXPECT_EQ(nExpected, nFound);
+}